@@ -1,5 +1,4 @@
 #include <algorithm>
-#include <cassert>
 #include <cstdlib>
 #include <string_view>
 #include <utility>
@@ -231,7 +230,7 @@ Cmd event() {
     return CmdEmulate { buttons };
 }
 
-void draw(const Texture& tex, u8* xbuf) {
+void draw(FceuxContext* ctx, const Texture& tex, u8* xbuf) {
     u32* p = nullptr;
     int pitch = -1;
     TextureLock lock(tex, nullptr, reinterpret_cast<void**>(&p), &pitch);
@@ -239,54 +238,54 @@ void draw(const Texture& tex, u8* xbuf) {
     LOOP(240) {
         for (const auto x : IRANGE(256)) {
             u8 r, g, b;
-            fceux_video_get_palette(*xbuf++, &r, &g, &b);
+            fceux_video_get_palette(ctx, *xbuf++, &r, &g, &b);
             p[x] = (r << 24) | (g << 16) | (b << 8) | 0xFF;
         }
         p += pitch / sizeof(p[0]);
     }
 }
 
-void cmd_save(Snapshot* snap) {
-    if (bool(fceux_snapshot_save(snap)))
+void cmd_save(FceuxContext* ctx, Snapshot* snap) {
+    if (bool(fceux_snapshot_save(ctx, snap)))
         EPRINTLN("saved snapshot");
     else
         EPRINTLN("cannot save snapshot");
 }
 
-void cmd_load(Snapshot* snap) {
-    if (bool(fceux_snapshot_load(snap)))
+void cmd_load(FceuxContext* ctx, Snapshot* snap) {
+    if (bool(fceux_snapshot_load(ctx, snap)))
         EPRINTLN("loaded snapshot");
     else
         EPRINTLN("cannot load snapshot");
 }
 
-void cmd_dump() {
+void cmd_dump(FceuxContext* ctx) {
     PRINTLN("");
     for (const auto hi : IRANGE(16)) {
         for (const auto lo : IRANGE(16)) {
             const auto addr = (hi << 4) | lo;
-            PRINT("{:02X} ", fceux_mem_read(addr, FCEUX_MEMORY_CPU));
+            PRINT("{:02X} ", fceux_mem_read(ctx, addr, FCEUX_MEMORY_CPU));
         }
         PRINTLN("");
     }
     PRINTLN("");
 }
 
-void cmd_power() {
-    fceux_power();
+void cmd_power(FceuxContext* ctx) {
+    fceux_power(ctx);
     PRINTLN("power");
 }
 
-void cmd_reset() {
-    fceux_reset();
+void cmd_reset(FceuxContext* ctx) {
+    fceux_reset(ctx);
     PRINTLN("reset");
 }
 
-void cmd_emulate(const Sdl& sdl, const Texture& tex, Audio& audio, u8 buttons) {
+void cmd_emulate(FceuxContext* ctx, const Sdl& sdl, const Texture& tex, Audio& audio, u8 buttons) {
     u8* xbuf;
     i32* soundbuf;
     i32 soundbuf_size;
-    fceux_run_frame(buttons, 0, &xbuf, &soundbuf, &soundbuf_size);
+    fceux_run_frame(ctx, buttons, 0, &xbuf, &soundbuf, &soundbuf_size);
 
     LOOP(soundbuf_size) {
         const i16 sample = (*soundbuf++) & 0xFFFF;
@@ -295,13 +294,13 @@ void cmd_emulate(const Sdl& sdl, const Texture& tex, Audio& audio, u8 buttons) {
             break;
         }
     }
-    draw(tex, xbuf);
+    draw(ctx, tex, xbuf);
 
     SDL_RenderCopy(sdl.ren(), tex.get(), nullptr, nullptr);
     SDL_RenderPresent(sdl.ren());
 }
 
-void mainloop(const Sdl& sdl, const Texture& tex, Audio& audio) {
+void mainloop(FceuxContext* ctx, const Sdl& sdl, const Texture& tex, Audio& audio) {
     auto snap = fceux_snapshot_create();
 
     audio.unpause();
@@ -310,12 +309,12 @@ void mainloop(const Sdl& sdl, const Texture& tex, Audio& audio) {
         const auto cmd = event();
         std::visit(overload {
                        [&](CmdQuit) { running = false; },
-                       [&](CmdSave) { cmd_save(snap); },
-                       [&](CmdLoad) { cmd_load(snap); },
-                       [&](CmdDump) { cmd_dump(); },
-                       [&](CmdPower) { cmd_power(); },
-                       [&](CmdReset) { cmd_reset(); },
-                       [&](CmdEmulate inp) { cmd_emulate(sdl, tex, audio, inp.buttons); },
+                       [&](CmdSave) { cmd_save(ctx, snap); },
+                       [&](CmdLoad) { cmd_load(ctx, snap); },
+                       [&](CmdDump) { cmd_dump(ctx); },
+                       [&](CmdPower) { cmd_power(ctx); },
+                       [&](CmdReset) { cmd_reset(ctx); },
+                       [&](CmdEmulate inp) { cmd_emulate(ctx, sdl, tex, audio, inp.buttons); },
                    },
             cmd);
 
@@ -363,18 +362,19 @@ int main(int argc, char** argv) {
     const Texture tex(sdl.ren(), 256, 240);
     Audio audio(audio_pull);
 
-    assert(fceux_was_init() == 0);
-    ENSURE(fceux_init(path_rom) != 0, "fceux_init() failed");
-    assert(fceux_was_init() != 0);
+    FceuxContext* ctx = fceux_create(path_rom);
+    ENSURE(ctx != nullptr, "fceux_create() failed");
 
-    ENSURE(fceux_sound_set_freq(MY_AUDIO_FREQ) != 0, "fceux_sound_set_freq() failed");
+    ENSURE(fceux_sound_set_freq(ctx, MY_AUDIO_FREQ) != 0, "fceux_sound_set_freq() failed");
 
     u64 op_count = 0;
-    fceux_hook_before_exec(hook, &op_count);
+    fceux_hook_before_exec(ctx, hook, &op_count);
 
     print_instruction();
 
-    mainloop(sdl, tex, audio);
+    mainloop(ctx, sdl, tex, audio);
+
+    fceux_destroy(ctx);
 
     return 0;
 }
@@ -1,58 +1,655 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// 初期化処理。
-// 終了処理はサポートしない。終了後に再初期化したとき正しく動く確信がないので。
-int fceux_init(const char* path_rom);
-int fceux_was_init(void);
+// エミュレータのコンテキスト。1 つのコンテキストが 1 台のゲーム機に相当する。
+//
+// 1 プロセス内で複数のコンテキストを同時に保持し、並列に動かせる。
+// コアのエミュレーション状態はスレッドごとにあり、ライブラリは状態を持つスレッド (コア) を内部に作る。
+// コンテキストは作成時に、割り当て済みのコンテキストが最も少ないコアに割り当てられる
+// (全てのコアに割り当て済みで、コア数が上限 (fceux_set_core_limit()) 未満なら新しいコアを作る)。
+// コンテキストに対する関数は、処理をそのコアのスレッドに渡して終わるまで待つ。
+// 異なるコアのコンテキストは、異なるスレッドから呼べば並列に動く。
+// 処理を渡すコストは 1 回あたり数百ナノ秒から数マイクロ秒なので、多数のバイトを読み書きするなら
+// fceux_mem_read_range() などの範囲を扱う関数を使うか、fceux_call_on_core() の中でまとめて呼ぶこと。
+//
+// ライブラリを FCEU_TLS_CORE=OFF (CMake) でビルドした場合は、コアは 1 つだけでスレッドを持たない。
+// コンテキストに対する関数は呼び出し元のスレッドでその場で実行されるので (フック関数や fceux_call_on_core() の fn も同様)、
+// 処理を渡すコストがかからず、エミュレーション自体もスレッドローカルな状態を介さない分速いが、コンテキストは並列には動かない。
+// フレーム途中で止まったコンテキストを別のスレッドから操作すると、そのフレームを先頭から実行し直す分のコストがかかる。
+//
+// 同じコアのコンテキストは 1 つずつ動く。各関数は対象のコンテキストの状態をコアに載せてから処理を行う
+// (直前にそのコアで別のコンテキストを操作していた場合、その状態は退避される)。
+// コンテキストを切り替えるたびに状態の保存とロードが 1 回ずつ、ROM が異なれば ROM のロードも行われる。
+// ROM は fceux_create() 時に読んだイメージをメモリ上に保持しており、切り替え時にファイルを読み直すことはない
+// (ロードではマッパーの初期化のみ行う)。サウンド出力の持ち越し分もコンテキストごとに保持する。
+// 同じコンテキストを続けて操作する間はこのコストはかからない。
+//
+// 同一のコンテキストに対する呼び出しは、複数のスレッドから同時に行っても 1 つずつ実行される。
+// フック関数はコンテキストのコアのスレッドで呼ばれる。
+// スナップショットなどのオブジェクトは、同じものを複数のスレッドから同時に変更してはならない
+// (ロードや直列化など、変更しない操作どうしは同時に行ってよい)。
+//
+// 切り替え時にコンテキストの ROM や状態をロードできなかった場合 (FDS の BIOS ファイルが消えたなど)、
+// その関数は何もせずに失敗を表す値 (0, NULL, -1 など。戻り値がなければ出力引数を 0 や NULL にする) を返す。
+struct FceuxContext;
+
+// 初期化処理。ROM をロードし、電源投入直後の状態のコンテキストを返す。
+// 失敗したら NULL を返す。
+struct FceuxContext* fceux_create(const char* path_rom);
+
+// コンテキストを破棄する。
+// コアにロードされたゲーム自体は、別のコンテキストが ROM をロードするまで残る。NULL なら何もしない。
+void fceux_destroy(struct FceuxContext* ctx);
+
+// コアの数の上限を設定する。0 なら既定値 (CPU のスレッド数) に戻す。
+// 以降に作成するコンテキストの割り当てにのみ影響し、既存のコアやその割り当ては変わらない。
+// FCEU_TLS_CORE=OFF のビルドでは何もしない (コアは常に 1 つ)。
+void fceux_set_core_limit(unsigned n);
+
+// fn(userdata) を ctx のコアのスレッド上で呼び、終わるまで待つ。
+// fn 内で ctx と同じコアのコンテキストに対して関数を呼ぶと、処理を渡さずにその場で実行される。
+// 小さな関数 (fceux_mem_read() など) を多数呼ぶ場合はまとめてこの中で呼ぶとよい。
+// fn 内で別のコアのコンテキストを操作してはならない (コアどうしが互いを待つことがあるため)。
+void fceux_call_on_core(struct FceuxContext* ctx, void (*fn)(void*), void* userdata);
 
-void fceux_power(void);
-void fceux_reset(void);
+void fceux_power(struct FceuxContext* ctx);
+void fceux_reset(struct FceuxContext* ctx);
 
 // joy1, joy2 は RLDUTSBA 形式。
 //
-// フレーム境界以外から呼び出したときの動作は未定義。
-// よって、フック関数内で呼び出してはならない。
-// また、フレーム境界でないスナップショットに対して利用してはならない。
-void fceux_run_frame(uint8_t joy1, uint8_t joy2, uint8_t** xbuf, int32_t** soundbuf, int32_t* soundbuf_size);
+// fceux_run_cycles() などでフレーム途中に止まっている場合は、そのフレームの残りを実行する。
+// このとき入力はフレーム先頭で読み込み済みなので、joy1, joy2 は使われない。
+// フック関数内で呼び出してはならない。
+//
+// xbuf, soundbuf が指すバッファは、次に任意のコンテキストを操作するまで有効。
+void fceux_run_frame(struct FceuxContext* ctx, uint8_t joy1, uint8_t joy2, uint8_t** xbuf, int32_t** soundbuf, int32_t* soundbuf_size);
+
+// fceux_run_frames() でどのフレームの出力を返すか。
+enum FceuxFrameOutput {
+    FCEUX_FRAME_OUTPUT_NONE,  // 出力しない
+    FCEUX_FRAME_OUTPUT_LAST,  // 最終フレームのみ
+    FCEUX_FRAME_OUTPUT_EVERY, // interval フレームごと
+};
+
+struct FceuxFrameResult {
+    // 以下は呼び出し側が設定する。
+
+    enum FceuxFrameOutput output;
+
+    // FCEUX_FRAME_OUTPUT_EVERY のとき、(i+1) が interval の倍数であるフレーム i が出力対象となる。
+    uint32_t interval;
+
+    // 出力対象フレームの映像 (256x240 Byte) を順に格納する。NULL なら映像は返さない。
+    // (出力対象フレーム数) * 256 * 240 Byte の領域が必要。
+    uint8_t* video;
+
+    // 出力対象フレームのサウンドを順に連結して格納する。NULL ならサウンドは返さない。
+    // sound_capacity を超えた分は捨てられる。
+    int32_t* sound;
+    size_t sound_capacity;
+
+    // 出力対象フレームそれぞれのサンプル数を順に格納する。NULL なら返さない。
+    // (出力対象フレーム数) 個の要素が必要。
+    int32_t* sound_sizes;
+
+    // NULL でなければ、実行した全フレームで CPU が書き込んだバイトのビットマップ
+    // (FCEUX_WRITE_BITS_SIZE Byte, 形式は fceux_write_bits() と同じ) を格納する。
+    // fceux_write_track() で有効にしていなければ全て 0 になる。
+    uint8_t* write_bits;
+
+    // 非ゼロなら、映像を返さないフレームの描画処理を省略する。
+    // 省略しても CPU から見える状態 (スプライト 0 ヒット、マッパーのスキャンライン IRQ など) は
+    // 描画した場合と同一になる。
+    int skip_video;
+
+    // 以下はライブラリが設定する。
+
+    // 出力したフレーム数。
+    size_t frame_count;
+
+    // sound に格納したサンプル数の合計。
+    size_t sound_size;
+
+    // fceux_cond_add() の条件が成り立って止まったなら、その条件の id と、止まったフレーム (0-based)。
+    // 止まらなければ stop_cond は -1、stop_frame は 0。
+    int stop_cond;
+    size_t stop_frame;
+};
+
+// n フレーム分まとめて実行し、実行したフレーム数を返す。
+// inputs[i] はフレーム i の入力で、下位 8bit が joy1, 上位 8bit が joy2 (いずれも RLDUTSBA 形式)。
+// out には出力が必要なフレームを指定する。NULL なら何も出力しない。
+//
+// フレーム途中に止まっている場合は、そのフレームの残りを 1 フレーム目とする (inputs[0] は使われず、skip_video も効かない)。
+// fceux_run_frame() と同様、フック関数内で呼び出してはならない。
+//
+// fceux_cond_add() で条件を登録していれば、いずれかが成り立った時点で止める (out->stop_cond を参照)。
+// フレーム境界で止まった場合はそのフレームまでを、フレーム途中で止まった場合はその前のフレームまでを実行したフレーム数とする。
+// 止まったフレームより後のフレームの出力は返さない。
+// 即時評価の条件でフレーム i の途中に止まった場合、戻り値と out->stop_frame はともに i で、フレーム i は途中まで実行されている
+// (その出力も返さない)。続けて fceux_run_frames(ctx, inputs + i, n - i, out) と呼べば、その 1 フレーム目が
+// フレーム i の残りとなるので、フレーム i を二重に数えることも入力がずれることもない。
+// ただし、止めた条件が値で決まるもの (FCEUX_COND_EQ など) でフレーム i の終わりにも成り立っていれば、
+// その呼び出しはフレーム i の境界で再び止まる (戻り値 1, stop_frame 0)。
+size_t fceux_run_frames(struct FceuxContext* ctx, const uint16_t* inputs, size_t n, struct FceuxFrameResult* out);
+
+// fceux_run_frames() を止める条件。条件は項 (FceuxCondTerm) を AND または OR で組み合わせたもの。
+// 各項はアドレス addr からの値を読み、op で比較する。値は CPU から見たアドレス空間から副作用なしで読む。
+//
+// 条件はフレーム境界ごとに評価する。FCEUX_COND_IMMEDIATE を指定した条件は、読むバイトのいずれかに
+// CPU が書き込むたびに、その次の命令の前でも評価し、成り立てばそこで (フレーム途中で) 止める。
+// 即時評価の対象になるのは、fceux_write_track() が記録する書き込み (内蔵 RAM と $6000-$7FFF の RAM) のみ。
+// 即時評価する条件がある間は、fceux_run_frames() も fceux_run_cycles() などと同様に命令ごとに検査しながら実行するので遅くなる
+// (アイドルループの早送りも行わない)。
+//
+// 条件はコンテキストに属し、スナップショットには含まれない。
+
+enum FceuxCondType {
+    FCEUX_COND_BYTE,   // addr の 1 Byte
+    FCEUX_COND_WORD,   // addr からの 2 Byte (リトルエンディアン)
+    FCEUX_COND_BCD,    // addr からの size Byte (1..4) のパック BCD。先頭が上位桁
+    FCEUX_COND_DIGITS, // addr からの size Byte (1..8) の各下位 4bit を 10 進の 1 桁とみなしたもの。先頭が上位桁
+};
+
+enum FceuxCondOp {
+    FCEUX_COND_EQ,        // 値 == value
+    FCEUX_COND_NE,        // 値 != value
+    FCEUX_COND_LT,        // 値 < value (符号なし)
+    FCEUX_COND_LE,        // 値 <= value
+    FCEUX_COND_GT,        // 値 > value
+    FCEUX_COND_GE,        // 値 >= value
+    FCEUX_COND_MASK_EQ,   // (値 & mask) == value
+    FCEUX_COND_DECREASED, // 値 < 前回の値 (value は使わない)
+    FCEUX_COND_INCREASED, // 値 > 前回の値
+    FCEUX_COND_CHANGED,   // 値 != 前回の値
+};
+
+// 前回の値は、fceux_run_frames() の 1 フレーム目なら呼び出し時点の値、以降は直前のフレーム境界での値。
+
+struct FceuxCondTerm {
+    uint16_t addr;
+    enum FceuxCondType type;
+    uint32_t size; // FCEUX_COND_BCD, FCEUX_COND_DIGITS のバイト数
+    enum FceuxCondOp op;
+    uint32_t value;
+    uint32_t mask; // FCEUX_COND_MASK_EQ で使う
+};
+
+enum FceuxCondCombine {
+    FCEUX_COND_ALL, // 全ての項が成り立つ (AND)
+    FCEUX_COND_ANY, // いずれかの項が成り立つ (OR)
+};
+
+// fceux_cond_add() の flags (ビット OR)。
+enum FceuxCondFlag {
+    FCEUX_COND_IMMEDIATE = 1 << 0,
+};
+
+// terms (n 個) からなる条件を登録し、その id (0 以上、コンテキスト内で一意) を返す。
+// n が 0 の場合や項が不正な場合 (アドレス空間をはみ出すなど) は何もせずに -1 を返す。
+// 複数の条件が同時に成り立った場合は、先に登録したものを報告する。
+int fceux_cond_add(struct FceuxContext* ctx, const struct FceuxCondTerm* terms, size_t n, enum FceuxCondCombine combine, uint32_t flags);
+
+// id の条件を削除し、1 を返す。なければ 0 を返す。
+int fceux_cond_remove(struct FceuxContext* ctx, int id);
+
+// 全ての条件を削除する。
+void fceux_cond_clear(struct FceuxContext* ctx);
+
+// 以下の関数は命令の実行前でエミュレーションを止める (フレーム途中でもよい)。
+// 止めた後は、fceux_mem_read() などでその時点の状態を読み書きでき、
+// 任意の fceux_run_* で続きから実行できる。スナップショットも保存できる。
+// 止めた命令に対するフック関数は、実行を再開したときに呼ばれる。
+//
+// サイクル数は、止めた命令の基本サイクル数まで含めて数える。
+// フレーム境界を越えて実行することもある。入力は最後に指定したものが使われ続ける。
+// フレーム途中で止まっている間は、アイドルループの早送りは行わない。
+// いずれもフック関数内で呼び出してはならない。
+
+// 少なくとも n サイクル実行し、実際に実行したサイクル数を返す。
+uint64_t fceux_run_cycles(struct FceuxContext* ctx, uint64_t n);
+
+// addrs (addr_count 個) のいずれかのアドレスの命令を実行する直前まで実行する。
+// 止まったら 1 を返す。見つからないまま max_cycles サイクル実行したら、そこで止めて 0 を返す。
+// フレーム境界から呼んだ場合、最初の命令も対象になる。
+int fceux_run_until_pc(struct FceuxContext* ctx, const uint16_t* addrs, size_t addr_count, uint64_t max_cycles);
 
-uint8_t fceux_reg_p();
+// 描画中のスキャンラインが sl (0..239) に変わった直後の命令の前まで実行し、1 を返す。
+// sl が範囲外なら何もせずに 0 を返す。
+int fceux_run_until_scanline(struct FceuxContext* ctx, int sl);
+
+// フレーム途中で止まっているなら非ゼロを返す。
+int fceux_midframe(struct FceuxContext* ctx);
+
+uint8_t fceux_reg_p(struct FceuxContext* ctx);
+
+// CPU のレジスタと、電源投入からの CPU サイクル数 (fceux_run_cycles() と同じ数え方)。
+struct FceuxCpuRegs {
+    uint16_t pc;
+    uint8_t a, x, y, s, p;
+    uint64_t cycles;
+};
 
+void fceux_cpu_regs(struct FceuxContext* ctx, struct FceuxCpuRegs* regs);
+
+// メモリ領域。アドレスは各領域の先頭からのオフセット。
 enum FceuxMemoryDomain {
-    FCEUX_MEMORY_CPU,
+    FCEUX_MEMORY_CPU,       // CPU から見たアドレス空間 (0x10000 Byte)。PPU/APU レジスタは副作用なしで読む
+    FCEUX_MEMORY_RAM,       // 内蔵 RAM (0x800 Byte)
+    FCEUX_MEMORY_PRG_RAM,   // カートリッジの PRG-RAM (WRAM)。マッパーが PRG チップ 0x10 として登録したもの
+    FCEUX_MEMORY_PRG_ROM,   // PRG-ROM (読み取り専用)
+    FCEUX_MEMORY_CHR,       // CHR-ROM (読み取り専用) または CHR-RAM
+    FCEUX_MEMORY_NAMETABLE, // PPU から見たネームテーブル $2000-$2FFF (0x1000 Byte)。ミラーリングはその時点のもの
+    FCEUX_MEMORY_OAM,       // スプライト RAM (0x100 Byte)
+    FCEUX_MEMORY_PALETTE,   // パレット RAM (0x20 Byte)
+    FCEUX_MEMORY_PPU_REG,   // PPU レジスタ $2000-$2007 (8 Byte, 読み取り専用)
+    FCEUX_MEMORY_APU_REG,   // APU/入出力レジスタ $4000-$4017 (0x18 Byte, 読み取り専用)
 };
 
-uint8_t fceux_mem_read(uint16_t addr, enum FceuxMemoryDomain domain);
-void fceux_mem_write(uint16_t addr, uint8_t value, enum FceuxMemoryDomain domain);
+// 範囲外のアドレスからは 0 を読み、範囲外や読み取り専用の領域への書き込みは無視する。
+// ROM はスナップショットに含まれず、同じ ROM のコンテキスト間で共有されるので読み取り専用としている。
+// FCEUX_MEMORY_CPU への書き込みはマッパーなどへの書き込みとして扱われる。
+// フレーム途中での書き込みは記録され、スナップショットのロード時などに同じ位置で再現される。
+uint8_t fceux_mem_read(struct FceuxContext* ctx, uint16_t addr, enum FceuxMemoryDomain domain);
+void fceux_mem_write(struct FceuxContext* ctx, uint16_t addr, uint8_t value, enum FceuxMemoryDomain domain);
+
+// 領域 domain のサイズを返す。ロードしている ROM にない領域なら 0 を返す。
+size_t fceux_mem_domain_size(struct FceuxContext* ctx, enum FceuxMemoryDomain domain);
+
+// 領域 domain の addr から size Byte を buf に読み、読んだバイト数を返す (領域の末尾で打ち切る)。
+size_t fceux_mem_read_range(struct FceuxContext* ctx, enum FceuxMemoryDomain domain, size_t addr, void* buf, size_t size);
 
+// 領域 domain の addr から size Byte に buf の内容を書き、書いたバイト数を返す (領域の末尾で打ち切る)。
+// 読み取り専用の領域なら何もせずに 0 を返す。
+size_t fceux_mem_write_range(struct FceuxContext* ctx, enum FceuxMemoryDomain domain, size_t addr, const void* buf, size_t size);
+
+// 領域 domain が単純な配列なら、その先頭を返して size にサイズを書く。そうでなければ NULL を返す
+// (FCEUX_MEMORY_RAM, FCEUX_MEMORY_PRG_RAM, FCEUX_MEMORY_PRG_ROM, FCEUX_MEMORY_CHR, FCEUX_MEMORY_OAM, FCEUX_MEMORY_PALETTE が該当)。
+// size は NULL でもよい。
+//
+// ポインタは ctx のコアのメモリを直接指す。同じコアのコンテキストはコアを共有するので、
+// 内容が ctx のものであるのは、次に別のコンテキストに対して関数を呼ぶまで。
+// ポインタ自体は、別の ROM のコンテキストを操作するまで変わらない。
+// 別のスレッドで ctx を実行している間は、内容を読んではならない。
+// これを通して書き換えた場合、フレーム途中の書き込みとしては記録されず、
+// fceux_snapshot_save_delta() の比較の省略にも反映されない (内蔵 RAM と WRAM は fceux_mem_write() などで書き換えること)。
+// 読み取り専用の領域 (PRG-ROM と CHR-ROM) は書き換えてはならない。
+const uint8_t* fceux_mem_domain_view(struct FceuxContext* ctx, enum FceuxMemoryDomain domain, size_t* size);
+
+// CPU による内蔵 RAM と $6000-$7FFF への書き込みの記録。
+// $6000-$7FFF はカートリッジが RAM を割り当てているページのみ対象とする。
+// そのページへの書き込みは、マッパーの書き込み処理が無視したもの (WRAM の書き込み禁止など) も含めて全て記録する。
+// 命令による書き込みのみ記録し、fceux_mem_write() などやスナップショットのロードによる変更は記録しない。
+// 無効にしている間は、記録のためのコストはかからない。
+
+#define FCEUX_WRITE_BITS_SIZE 0x500
+
+struct FceuxRamWrite {
+    uint64_t cycle;     // 書き込んだ命令の位置 (CPU サイクルの累計。fceux_run_cycles() と同じ数え方)
+    uint16_t addr;      // 内蔵 RAM は $0000-$07FF (ミラーは畳む)、それ以外は $6000-$7FFF
+    uint8_t old_value;  // 書き込み前の値
+    uint8_t new_value;  // 書き込み後の値 (書き込みが無視されたなら old_value と同じ)
+    uint32_t reserved;
+};
+
+// ctx の書き込みの記録を有効/無効にする。既定では無効。
+// フレーム途中で有効にした場合、次のスキャンラインまでの書き込みは記録されないことがある。
+void fceux_write_track(struct FceuxContext* ctx, int enable);
+
+// 現在のフレームの先頭 (フレーム境界ならその直前のフレームの先頭) 以降に書き込まれたバイトのビットマップを返す。
+// ビット n (各 Byte の LSB から数える) が内蔵 RAM の $n、ビット 0x800+n が $6000+n に対応する。
+// 記録が無効なら NULL を返す。次に任意のコンテキストを操作するまで有効。
+const uint8_t* fceux_write_bits(struct FceuxContext* ctx);
+
+// 書き込みのログを buf (capacity 個) に記録する。buf が NULL なら記録をやめる。
+// 記録は fceux_write_track() で有効にしている間のみ行う。
+// 呼ぶたびに件数を 0 に戻し、以降 i 件目 (0-based) を buf[i % capacity] に書く (古いものから上書きされる)。
+// buf は記録をやめるかコンテキストを破棄するまで有効でなければならない。
+// フレーム途中のスナップショットのロードなどで実行し直した部分は、改めて記録しない。
+void fceux_write_log_attach(struct FceuxContext* ctx, struct FceuxRamWrite* buf, size_t capacity);
+
+// fceux_write_log_attach() 以降にログに記録した件数を返す。
+uint64_t fceux_write_log_count(struct FceuxContext* ctx);
+
+// スナップショットはコンテキストに属さない。
+// ただし、ROM が異なるコンテキストにロードしたときの動作は未定義。
+//
+// フレーム途中で保存したスナップショットは、フレーム先頭の状態とそこからの位置を保持する。
+// ロード時にはその位置まで実行し直す (フック関数は呼ばれない)。
+// ロードに失敗した場合、ctx はロード前の状態 (フレーム途中ならその位置) のまま残る。
+//
+// fceux_power(), fceux_reset(), fceux_sound_set_freq() をフレーム途中で呼んだ場合、
+// そのフレームの先頭に戻してから処理を行う。
 struct Snapshot;
 
 struct Snapshot* fceux_snapshot_create(void);
 void fceux_snapshot_destroy(struct Snapshot* snap);
-int fceux_snapshot_load(struct Snapshot* snap);
-int fceux_snapshot_save(struct Snapshot* snap);
+int fceux_snapshot_load(struct FceuxContext* ctx, struct Snapshot* snap);
+int fceux_snapshot_save(struct FceuxContext* ctx, struct Snapshot* snap);
+
+// fceux_snapshot_save_ex() の flags (ビット OR)。
+enum FceuxSnapshotFlag {
+    // 映像を保存しない (64KiB 小さくなる)。ロードしても fceux_run_frame() などの出力には影響しない。
+    FCEUX_SNAPSHOT_SKIP_VIDEO = 1 << 0,
+    // 内部形式で保存する。保存・ロードが速いが、保存したのと同じプロセス内で、
+    // 同じ ROM をロードしたコンテキストにしかロードできない (それ以外では失敗する)。
+    FCEUX_SNAPSHOT_FLAT = 1 << 1,
+};
+
+// flags を指定して保存する。flags が 0 なら fceux_snapshot_save() と同じ。
+// スナップショットの領域は使い回されるので、同じスナップショットへの保存を繰り返してもメモリ確保は起こらない。
+// フレーム途中で保存する場合、映像は常に保存されず、常に FCEUX_SNAPSHOT_FLAT で保存される。
+int fceux_snapshot_save_ex(struct FceuxContext* ctx, struct Snapshot* snap, uint32_t flags);
+
+// parent からの差分として保存する。parent の状態と異なる 64 Byte 単位のページのみを保持するので、
+// 探索木のように少しずつ異なる状態を大量に保存する場合にメモリを節約できる。
+// 状態全体を保存してから parent と比較するので、保存自体は fceux_snapshot_save_ex() より速くはならない。
+// ただし fceux_write_track() で記録を有効にしていて、parent が ctx で最後に保存かロードしたフラット形式のもの
+// (フレーム境界で) であり、それ以降 fceux_run_frames() などで実行しただけなら、
+// CPU が書き込まなかった内蔵 RAM と WRAM のページは比較を省く。
+// flags は fceux_snapshot_save_ex() と同じで、FCEUX_SNAPSHOT_FLAT は常に指定されたものとして扱う。
+//
+// parent は同じ ROM のコンテキストで保存したものでなければならない。parent 自身が差分でもよい。
+// 保存したスナップショットは parent の内容を (parent を上書き・破棄しても) 参照し続ける。
+// parent がフラット形式でない場合、parent か ctx がフレーム途中の場合、
+// parent と映像の有無が異なる場合は、差分ではなく状態全体を保存する。
+// snap と parent は同じでもよい。
+int fceux_snapshot_save_delta(struct FceuxContext* ctx, struct Snapshot* snap, const struct Snapshot* parent, uint32_t flags);
+
+// fceux_snapshot_load() と同じ結果になるが、フラット形式のもの (差分やストアに保存したものを含む) は、
+// ctx の現在の状態と異なる部分のみを書き込み、マッパーのバンク切り替えなどの再設定も
+// 関係するレジスタが変わった場合のみ行う。
+// 探索で兄弟ノードに戻る場合のように、現在の状態とわずかしか違わないスナップショットを速くロードできる。
+// それ以外の形式のものは fceux_snapshot_load() と同じようにロードする。
+int fceux_snapshot_load_diff(struct FceuxContext* ctx, struct Snapshot* snap);
+
+// スナップショット自身が保持している状態のサイズ (Byte) を返す。
+// 差分の場合は親の分を含まず、ストアに保存したものはページ番号の分のみとなる。
+size_t fceux_snapshot_size(struct Snapshot* snap);
+
+// スナップショットをバッファに書き出す (ファイルへの保存やプロセス間での受け渡し用)。
+// 必要なサイズを返し、capacity がそれ以上なら buf に書き込む (buf が NULL なら書き込まない)。
+// 差分やストアに保存したものも、単独でロードできる形で書き出す。
+//
+// FCEUX_SNAPSHOT_FLAT などフラット形式のものは、同じビルドのライブラリで同じ ROM をロードしたコンテキストにしかロードできない
+// (プロセスは異なってもよい)。数値はホストのバイトオーダーで書かれる。
+size_t fceux_snapshot_serialize(struct Snapshot* snap, void* buf, size_t capacity);
+
+// fceux_snapshot_serialize() で書き出したものを snap に読み込む。不正なデータなら 0 を返し、snap は変わらない。
+// 検査するのはヘッダと大きさの整合性まで。フラット形式の ROM が合っているかなどはロード時に検査する。
+// snap の領域は使い回される。
+int fceux_snapshot_deserialize(struct Snapshot* snap, const void* buf, size_t size);
+
+// fceux_snapshot_serialize() で書き出したものを、スナップショットを介さずに直接 ctx にロードする。
+// buf は読むだけなので、読み取り専用でメモリマップしたファイルを渡してよい。不正なデータやロードの失敗なら 0 を返す。
+int fceux_snapshot_load_serialized(struct FceuxContext* ctx, const void* buf, size_t size);
+
+// スナップショットを状態の領域ごとまとめて確保しておき、使い回すプール。
+// 短命なスナップショットを大量に作っては捨てる場合に、メモリ確保の繰り返しや断片化を避けられる。
+//
+// 作成時にロードされているゲームと flags の形式での状態のサイズを求め、slab_size 個ずつの単位 (スラブ) で
+// スナップショットと状態の領域を確保する。足りなくなればスラブを追加し、プールを破棄するまで解放しない。
+// プールから確保したスナップショットも fceux_snapshot_destroy() で破棄でき、領域は次の確保で (0 埋めせずに) 再利用される。
+// 他のゲームや形式で保存してもよいが、その場合は領域が足りずに確保が起こりうる。
+// フラット形式の状態の領域はスラブごとにまとめて確保する (FCSX 形式はスナップショットごと)。
+//
+// 64 ビット環境では、確保したスナップショットには領域の世代が埋め込まれていて、破棄した後は
+// (同じ領域が再び確保されても) スナップショットを受け取る関数に渡すと失敗し、fceux_snapshot_destroy() は何もしない。
+// ただし同じ領域を 65536 回確保すると世代が一周し、その間破棄されずに残っていたものは新しい側と区別できなくなる。
+// 32 ビット環境では世代を埋め込まないので、破棄したものを渡してはならない。
+// fceux_snapshot_destroy() には、プールのものかどうかに関わらず NULL を渡してよい (何もしない)。
+//
+// 複数スレッドから同時に確保・破棄してよい。
+struct SnapshotPool;
+
+struct FceuxSnapshotPoolStats {
+    size_t state_size;     // スナップショットごとに確保した状態のサイズ (Byte)
+    size_t slab_count;
+    size_t capacity;       // 確保済みのスナップショット数
+    size_t in_use;         // 破棄されていないスナップショット数
+    size_t peak_in_use;    // in_use の最大値
+    size_t reserved_bytes; // 確保済みの領域 (Byte) のおおよその値
+};
+
+// flags は fceux_snapshot_save_ex() と同じで、確保する状態の形式を決める。slab_size が 0 なら 64 とする。
+// 状態のサイズを求められなければ NULL を返す。
+struct SnapshotPool* fceux_snapshot_pool_create(struct FceuxContext* ctx, uint32_t flags, size_t slab_size);
+
+// プールから確保したスナップショットも全て破棄される。
+void fceux_snapshot_pool_destroy(struct SnapshotPool* pool);
+
+// 保存していない状態のスナップショットを返す。
+struct Snapshot* fceux_snapshot_pool_alloc(struct SnapshotPool* pool);
+
+// プールから確保したスナップショットを全てまとめて破棄する (領域は再利用のために残る)。
+// 破棄したスナップショットを後から fceux_snapshot_destroy() に渡しても何もしない
+// (32 ビット環境では、その領域が再び確保される前に限る)。
+void fceux_snapshot_pool_release_all(struct SnapshotPool* pool);
+
+void fceux_snapshot_pool_stats(struct SnapshotPool* pool, struct FceuxSnapshotPoolStats* stats);
+
+// fceux_state_hash() の flags (ビット OR)。
+enum FceuxStateHashFlag {
+    // 経過時間を数えるだけのカウンタ (CPU サイクルの累計、フレーム数、ラグフレーム数) を除く。
+    // 同じ局面に異なる手順でたどり着いた場合に同じハッシュ値にしたいときに使う。
+    FCEUX_STATE_HASH_SKIP_COUNTERS = 1 << 0,
+    // APU の状態を除く。APU はフレーム IRQ や DMC を通してゲームの進行に影響しうるので注意。
+    FCEUX_STATE_HASH_SKIP_SOUND = 1 << 1,
+};
+
+// ctx のエミュレーション状態 (スナップショットに保存されるもの) のハッシュ値を、保存せずに直接計算する。
+// 映像は含まない。フレーム途中ではその位置も含む。
+// 値は同じビルドのライブラリで同じ ROM をロードしている間のみ比較できる。暗号学的な強度はない。
+uint64_t fceux_state_hash(struct FceuxContext* ctx, uint32_t flags);
+
+// 128bit 版。out[0], out[1] に格納する (out[0] は fceux_state_hash() と同じ値)。
+void fceux_state_hash128(struct FceuxContext* ctx, uint32_t flags, uint64_t out[2]);
+
+// スナップショットの状態をページ単位で重複排除して保持するストア。
+// 内容が同じページは、いくつのスナップショットから参照されても 1 つしか持たないので、
+// 大量のスナップショットを保持するときのメモリ使用量がスナップショット数ではなく状態の多様さに比例する。
+//
+// ストアに保存したスナップショットは fceux_snapshot_load() でロードでき、
+// fceux_snapshot_destroy() や別の保存で上書きするとページの参照を解放する。
+// ストアを破棄しても、スナップショットが参照しているページは残る。
+// FCEUX_SNAPSHOT_FLAT と同様、保存したのと同じプロセス内で、同じ ROM をロードしたコンテキストにしかロードできない。
+struct SnapStore;
+
+struct FceuxSnapStoreStats {
+    size_t page_size;
+    size_t snapshot_count; // ストアのページを参照しているスナップショット数
+    size_t page_count;     // 保持しているページ数
+    size_t page_ref_count; // スナップショットが参照しているページ数の合計 (重複排除しなかった場合のページ数)
+    size_t page_bytes;     // ページのために確保している領域 (Byte)。解放されたページの領域は再利用されるが、返却はされない
+    size_t index_bytes;    // スナップショットが持つページ番号の合計 (Byte)
+};
+
+// page_size はページのサイズ (Byte) で、8 の倍数でなければならない。0 なら 256 とする。
+// 小さいほど重複排除は効きやすくなるが、スナップショットごとのページ番号が増える。
+// page_size が不正なら NULL を返す。
+struct SnapStore* fceux_snapstore_create(size_t page_size);
+void fceux_snapstore_destroy(struct SnapStore* store);
+
+// snap をストアに保存する。flags は fceux_snapshot_save_ex() と同じ (FCEUX_SNAPSHOT_FLAT は無視される)。
+int fceux_snapstore_save(struct SnapStore* store, struct FceuxContext* ctx, struct Snapshot* snap, uint32_t flags);
+
+void fceux_snapstore_stats(struct SnapStore* store, struct FceuxSnapStoreStats* stats);
+
+// 巻き戻し用に、フレームごとの状態をメモリ使用量の上限付きで保持するバッファ。
+// keyframe_interval 個ごとに状態全体を、その間は直前の状態との差分を圧縮して持つので、
+// k 個前に戻すコストはキーフレーム 1 つのロードと高々 keyframe_interval - 1 個の差分の適用で済む。
+// 上限を超えると古いものから (キーフレームとそれに続く差分の単位で) 捨てる。ただし最新のキーフレーム以降は捨てない。
+//
+// FCEUX_SNAPSHOT_FLAT と同様、保存したのと同じプロセス内で、同じ ROM をロードしたコンテキストにしか戻せない。
+// 映像は保存しない。
+struct RewindBuffer;
+
+// budget は圧縮後の合計サイズの上限 (Byte)。keyframe_interval が 0 なら 1 とする。
+struct RewindBuffer* fceux_rewind_create(size_t budget, uint32_t keyframe_interval);
+void fceux_rewind_destroy(struct RewindBuffer* rw);
+
+// ctx の現在の状態を最新のものとして追加し、1 を返す。フレーム途中で止まっている場合は何もせず 0 を返す。
+int fceux_rewind_push(struct RewindBuffer* rw, struct FceuxContext* ctx);
+
+// k 個前 (0 なら最新) に追加した状態を ctx にロードし、それより新しいものを捨てて 1 を返す。
+// 戻した状態は最新のものとして残るので、続けて k = 1 で呼べば 1 つずつ戻っていける。
+// k が保持している個数以上か、その状態を ctx にロードできない (別の ROM のもの) なら何もせず 0 を返す。
+int fceux_rewind_back(struct RewindBuffer* rw, struct FceuxContext* ctx, size_t k);
+
+// 保持している状態の個数
+size_t fceux_rewind_count(struct RewindBuffer* rw);
+// 保持している状態の圧縮後の合計サイズ (Byte)
+size_t fceux_rewind_bytes(struct RewindBuffer* rw);
+
+// RAM サーチ。多数のサンプル (ある時点の内蔵 RAM と $6000-$7FFF の内容) を保持し、
+// サンプル間の関係やラベルとの相関でアドレスの候補を絞り込む。
+// サンプルの比較はアドレス方向にまとめて (SSE2 があれば 16 Byte ずつ) 行うので、数千サンプルでも速い。
+// サンプルは FCEUX_SEARCH_WIDTH Byte で、n < 0x800 が内蔵 RAM の $n、0x800 + n が $6000+n に対応する
+// (fceux_write_bits() と同じ並び)。
+// コンテキストを渡す関数以外は、別々のサーチであれば複数スレッドから同時に呼んでよい。
+
+#define FCEUX_SEARCH_WIDTH 0x2800
+
+enum FceuxSearchOp {
+    FCEUX_SEARCH_EQUAL,      // sample の値 == baseline の値
+    FCEUX_SEARCH_NOT_EQUAL,  // sample の値 != baseline の値
+    FCEUX_SEARCH_GREATER,    // sample の値 > baseline の値 (符号なし)
+    FCEUX_SEARCH_LESS,       // sample の値 < baseline の値 (符号なし)
+    FCEUX_SEARCH_CHANGED_BY, // sample の値 - baseline の値 == k (mod 256)
+    FCEUX_SEARCH_VALUE,      // sample の値 == k (baseline は使わない)
+};
+
+struct FceuxSearchPredicate {
+    enum FceuxSearchOp op;
+    uint32_t sample;   // サンプルの番号 (追加した順に 0 から)
+    uint32_t baseline;
+    int32_t k;
+};
+
+struct RamSearch;
+
+// 作成直後はサンプルがなく、全アドレスが候補。
+struct RamSearch* fceux_search_create(void);
+void fceux_search_destroy(struct RamSearch* search);
+
+// ctx の現在の内容をサンプルとして追加し、1 を返す。フレーム途中でもよい。
+int fceux_search_add(struct RamSearch* search, struct FceuxContext* ctx);
+// snap の内容をサンプルとして追加して 1 を返す。ロードに失敗したら何もせずに 0 を返す。
+// ctx はロードに使うだけで、状態は (フレーム途中ならその位置も含めて) 呼び出し前のまま残る。
+// そのために ctx の状態の保存とロードを 1 回ずつ余分に行う。
+int fceux_search_add_snapshot(struct RamSearch* search, struct FceuxContext* ctx, struct Snapshot* snap);
+
+size_t fceux_search_sample_count(struct RamSearch* search);
+// サンプル i (FCEUX_SEARCH_WIDTH Byte) を返す。サーチを破棄するまで有効。
+const uint8_t* fceux_search_sample(struct RamSearch* search, size_t i);
+
+// 全アドレスを候補に戻す。
+void fceux_search_reset(struct RamSearch* search);
+
+// preds (n 個) を全て満たす候補だけを残し、1 を返す。
+// 存在しないサンプルを指す条件や、op が FceuxSearchOp のいずれでもない条件があれば何もせずに 0 を返す。
+int fceux_search_filter(struct RamSearch* search, const struct FceuxSearchPredicate* preds, size_t n);
+
+// 各候補について、全サンプルにわたる値と labels (サンプルごとに 1 つ) のピアソン相関係数を求め、
+// 絶対値が min_abs_r 未満のものを候補から外して 1 を返す。値が一定のアドレスの相関係数は 0 とする。
+// labels は平均を引いてから、偏差の最大値が 32000 となるよう 16 ビット整数に丸めて計算するので、相関係数は近似値となる
+// (偏差の最大値の 1/64000 程度より細かいラベルの差は区別されない)。
+// r が NULL でなければ、この呼び出しの前に候補だったアドレスの相関係数を書く
+// (FCEUX_SEARCH_WIDTH 個。候補でなかったものは 0)。
+// サンプルが 2 つ未満なら何もせずに 0 を返す。
+int fceux_search_correlate(struct RamSearch* search, const double* labels, double min_abs_r, float* r);
+
+size_t fceux_search_count(struct RamSearch* search);
+
+// 候補の CPU アドレスを昇順に最大 capacity 個 addrs に書き、候補の総数を返す。
+size_t fceux_search_results(struct RamSearch* search, uint16_t* addrs, size_t capacity);
+
+// スナップショットをバックグラウンドのワーカースレッドで zlib 圧縮し、必要ならアーカイブファイルに追記する。
+// 呼び出し側のスレッドでは fceux_snapshot_serialize() 相当のコピーのみを行うので、
+// 長時間の実行中にチェックポイントを取ってもエミュレーションが止まらない。
+//
+// 圧縮したもの (レコード) は、16 Byte のヘッダ ("FXSZ", バージョン, 展開後のサイズ, 圧縮データのサイズ の順で
+// いずれも 4 Byte、ホストのバイトオーダー) と圧縮データからなり、アーカイブはレコードを完了順に連結したもの。
+// fceux_snapshot_serialize() と同様、フラット形式のものは同じビルドのライブラリで同じ ROM をロードしたコンテキストにしかロードできない。
+struct Compressor;
+struct CompressJob;
+
+// threads はワーカースレッド数で、0 なら CPU のスレッド数とする。
+// max_queue は圧縮を待てるジョブ数の上限で、0 なら threads の 2 倍とする。
+// level は zlib の圧縮レベル (-1 から 9、-1 は既定値)。
+// archive_path が NULL でなければ、そのファイルにレコードを追記する (なければ作る)。
+// 引数が不正な場合やファイルを開けない場合は NULL を返す。
+struct Compressor* fceux_compressor_create(unsigned threads, size_t max_queue, int level, const char* archive_path);
+
+// 投入済みのジョブが全て完了するのを待ってから破棄する。ジョブのハンドルは破棄後も使える。
+void fceux_compressor_destroy(struct Compressor* comp);
+
+// snap の圧縮を投入し、ジョブのハンドルを返す。圧縮を待っているジョブが max_queue 個あれば、空くまで待つ。
+// 戻った後は snap を変更・破棄してよい。ハンドルは fceux_compress_job_release() で解放すること。
+// snap を直列化できなければ NULL を返す。
+struct CompressJob* fceux_compressor_submit(struct Compressor* comp, struct Snapshot* snap);
+
+// 投入済みのジョブが全て完了し、アーカイブがファイルに書き出されるまで待つ。
+void fceux_compressor_flush(struct Compressor* comp);
+
+// ジョブが完了していれば 1 を返す。待たない。
+int fceux_compress_job_done(struct CompressJob* job);
+
+// ジョブの完了を待ち、成功 (アーカイブがあればその書き込みも含む) なら 1 を返す。
+int fceux_compress_job_wait(struct CompressJob* job);
+
+// ジョブの完了を待ち、レコードのサイズを返す (失敗したなら 0)。
+// capacity がそれ以上なら buf に書き込む (buf が NULL なら書き込まない)。
+size_t fceux_compress_job_result(struct CompressJob* job, void* buf, size_t capacity);
+
+// ジョブの完了を待ち、アーカイブ内のレコードの位置 (Byte) を返す。アーカイブに書いていなければ UINT64_MAX を返す。
+uint64_t fceux_compress_job_archive_offset(struct CompressJob* job);
+
+void fceux_compress_job_release(struct CompressJob* job);
+
+// buf (size Byte) の先頭にあるレコードのサイズを返す。不正なら 0 を返す。アーカイブを先頭から順にたどるのに使える。
+size_t fceux_compressed_size(const void* buf, size_t size);
+
+// buf (size Byte) の先頭にあるレコードを展開して snap に読み込む。不正なデータなら 0 を返す。
+int fceux_snapshot_decompress(struct Snapshot* snap, const void* buf, size_t size);
 
 typedef void (*FceuxHookBeforeExec)(void* userdata, uint16_t addr);
 
 // CPU 命令実行前に呼ばれる関数 hook を登録する。
-// フック関数は 1 つのみ登録可能。フック関数が既にある場合は単に置き換えられる。
+// フック関数はコンテキストごとに 1 つのみ登録可能。フック関数が既にある場合は単に置き換えられる。
 // NULL を渡すと登録解除される。
+// フック関数が登録されていない間は、命令ごとの呼び出しのオーバーヘッドはかからない。
+//
+// フック関数内では、実行中のコンテキストに対してのみ fceux_mem_read() などを呼び出してよい。
 //
 // より複雑なフック機構はこの関数を用いてクライアント側で実装可能なはず。
-void fceux_hook_before_exec(FceuxHookBeforeExec hook, void* userdata);
+void fceux_hook_before_exec(struct FceuxContext* ctx, FceuxHookBeforeExec hook, void* userdata);
+
+// 割り込みを待つだけのループ (RAM 上のフラグを待つループなど) を早送りするかどうかを設定する。
+// 既定では無効。早送りしても、エミュレーション結果は早送りしない場合と完全に同一となる。
+// fceux_hook_before_exec() でフック関数が登録されている間は早送りしない。
+void fceux_idle_skip(struct FceuxContext* ctx, int enable);
+
+// アイドルループの早送りで省略した CPU サイクル数の、コンテキスト作成以降の累計を返す。
+uint64_t fceux_idle_skipped_cycles(struct FceuxContext* ctx);
+
+// $6000-$FFFF のうちカートリッジの PRG を読むだけの 2KB のページを、読み出し関数を介さずに直接読むかどうかを設定する。
+// 既定では有効。無効にしてもエミュレーション結果は変わらず、遅くなるだけ (結果の比較や問題の切り分けのためのもの)。
+void fceux_prg_direct(struct FceuxContext* ctx, int enable);
 
 // xbuf の Byte に対応する RGB 値を得る。
-void fceux_video_get_palette(uint8_t idx, uint8_t* r, uint8_t* g, uint8_t* b);
+void fceux_video_get_palette(struct FceuxContext* ctx, uint8_t idx, uint8_t* r, uint8_t* g, uint8_t* b);
 
 // サンプリングレート設定。
 // 0, 44100, 48000, 96000 のみが指定できる。
 // 0 を指定するとサウンドが無効になる。
-int fceux_sound_set_freq(int freq);
+int fceux_sound_set_freq(struct FceuxContext* ctx, int freq);
 
 #ifdef __cplusplus
 }
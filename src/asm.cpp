@@ -256,7 +256,7 @@ int Assemble(unsigned char *output, int addr, char *str) {
 
 ///disassembles the opcodes in the buffer assuming the provided address. Uses GetMem() and 6502 current registers to query referenced values. returns a static string buffer.
 char *Disassemble(int addr, uint8 *opcode) {
-	static char str[64]={0},chr[5]={0};
+	static FCEU_TLS char str[64]={0},chr[5]={0};
 	uint16 tmp,tmp2;
 
 	//these may be replaced later with passed-in values to make a lighter-weight disassembly mode that may not query the referenced values
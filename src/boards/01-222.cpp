@@ -37,8 +37,8 @@
 
 #include "mapinc.h"
 
-static uint8 reg[4], cmd, is172, is173;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 reg[4], cmd, is172, is173;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 4, "REGS" },
 	{ &cmd, 1, "CMD" },
@@ -32,10 +32,10 @@
 
 #include "mapinc.h"
 
-static uint8 prg;
-static uint32 IRQCount, IRQa;
+static FCEU_TLS uint8 prg;
+static FCEU_TLS uint32 IRQCount, IRQa;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQCount, 4, "IRQC" },
 	{ &IRQa, 4, "IRQA" },
@@ -55,6 +55,7 @@ static DECLFW(UNLSMB2JWrite1) {
 }
 
 static DECLFW(UNLSMB2JWrite2) {
+	X6502_SyncHooks();
 	IRQa = V & 1;
 	IRQCount = 0;
 	X6502_IRQEnd(FCEU_IQEXT);
@@ -85,6 +86,15 @@ static void UNLSMB2JIRQHook(int a) {
 	}
 }
 
+// the counter stops once it reaches 5750 and the irq fires on the next call
+static int32 UNLSMB2JIRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 5750)
+		return 1;
+	return 5750 - IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -92,6 +102,7 @@ static void StateRestore(int version) {
 void UNLSMB2J_Init(CartInfo *info) {
 	info->Power = UNLSMB2JPower;
 	MapIRQHook = UNLSMB2JIRQHook;
+	MapIRQHookBudget = UNLSMB2JIRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -20,12 +20,12 @@
 
 #include "mapinc.h"
 
-static uint8 reg[16], IRQa;
-static uint32 IRQCount;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 reg[16], IRQa;
+static FCEU_TLS uint32 IRQCount;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQa, 1, "IRQA" },
 	{ &IRQCount, 4, "IRQC" },
@@ -53,9 +53,9 @@ static void Sync(void) {
 static DECLFW(M106Write) {
 	A &= 0xF;
 	switch (A) {
-	case 0xD: IRQa = 0; IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
-	case 0xE: IRQCount = (IRQCount & 0xFF00) | V; break;
-	case 0xF: IRQCount = (IRQCount & 0x00FF) | (V << 8); IRQa = 1; break;
+	case 0xD: X6502_SyncHooks(); IRQa = 0; IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xE: X6502_SyncHooks(); IRQCount = (IRQCount & 0xFF00) | V; break;
+	case 0xF: X6502_SyncHooks(); IRQCount = (IRQCount & 0x00FF) | (V << 8); IRQa = 1; break;
 	default: reg[A] = V; Sync(); break;
 	}
 }
@@ -88,6 +88,14 @@ void M106CpuHook(int a) {
 	}
 }
 
+static int32 M106CpuHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount > 0x10000)
+		return 1;
+	return 0x10001 - IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -97,6 +105,7 @@ void Mapper106_Init(CartInfo *info) {
 	info->Power = M106Power;
 	info->Close = M106Close;
 	MapIRQHook = M106CpuHook;
+	MapIRQHookBudget = M106CpuHookBudget;
 	GameStateRestore = StateRestore;
 
 	WRAMSIZE = 8192;
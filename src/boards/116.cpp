@@ -35,14 +35,14 @@
 
 #include "mapinc.h"
 
-static uint8 mode;
-static uint8 vrc2_chr[8], vrc2_prg[2], vrc2_mirr;
-static uint8 mmc3_regs[10], mmc3_ctrl, mmc3_mirr;
-static uint8 IRQCount, IRQLatch, IRQa;
-static uint8 IRQReload;
-static uint8 mmc1_regs[4], mmc1_buffer, mmc1_shift;
+static FCEU_TLS uint8 mode;
+static FCEU_TLS uint8 vrc2_chr[8], vrc2_prg[2], vrc2_mirr;
+static FCEU_TLS uint8 mmc3_regs[10], mmc3_ctrl, mmc3_mirr;
+static FCEU_TLS uint8 IRQCount, IRQLatch, IRQa;
+static FCEU_TLS uint8 IRQReload;
+static FCEU_TLS uint8 mmc1_regs[4], mmc1_buffer, mmc1_shift;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &mode, 1, "MODE" },
 	{ vrc2_chr, 8, "VRCC" },
@@ -20,10 +20,10 @@
 
 #include "mapinc.h"
 
-static uint8 prgreg[4], chrreg[8], mirror;
-static uint8 IRQa, IRQCount, IRQLatch;
+static FCEU_TLS uint8 prgreg[4], chrreg[8], mirror;
+static FCEU_TLS uint8 IRQa, IRQCount, IRQLatch;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQa, 1, "IRQA" },
 	{ &IRQCount, 1, "IRQC" },
@@ -21,11 +21,11 @@
 
 #include "mapinc.h"
 
-static uint16 latchea;
-static uint8 latched;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint16 latchea;
+static FCEU_TLS uint8 latched;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &latchea, 2, "AREG" },
 	{ &latched, 1, "DREG" },
@@ -20,11 +20,11 @@
 
 #include "mapinc.h"
 
-static uint8 chrlo[8], chrhi[8], prg, mirr, mirrisused = 0;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 chrlo[8], chrhi[8], prg, mirr, mirrisused = 0;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &prg, 1, "PREG" },
 	{ chrlo, 8, "CRGL" },
@@ -24,7 +24,7 @@
 #include "mapinc.h"
 #include "mmc3.h"
 
-static uint8 lut[8] = { 0x00, 0x00, 0x00, 0x01, 0x02, 0x04, 0x0F, 0x00 };
+static FCEU_TLS uint8 lut[8] = { 0x00, 0x00, 0x00, 0x01, 0x02, 0x04, 0x0F, 0x00 };
 
 static void UNL158BPW(uint32 A, uint8 V) {
 	if (EXPREGS[0] & 0x80) {
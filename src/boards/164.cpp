@@ -24,16 +24,16 @@
 
 #include "mapinc.h"
 
-static uint8 laststrobe, trigger;
-static uint8 reg[8];
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 laststrobe, trigger;
+static FCEU_TLS uint8 reg[8];
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static writefunc pcmwrite;
+static FCEU_TLS writefunc pcmwrite;
 
-static void (*WSync)(void);
+static FCEU_TLS void (*WSync)(void);
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &laststrobe, 1, "STB" },
 	{ &trigger, 1, "TRG" },
@@ -20,11 +20,11 @@
 
 #include "mapinc.h"
 
-static uint8 reg;
-static uint8 *CHRRAM = NULL;
-static uint32 CHRRAMSIZE;
+static FCEU_TLS uint8 reg;
+static FCEU_TLS uint8 *CHRRAM = NULL;
+static FCEU_TLS uint32 CHRRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REGS" },
 	{ 0 }
@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 reg, delay, mirr;
+static FCEU_TLS uint8 reg, delay, mirr;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REG" },
 	{ &mirr, 1, "MIRR" },
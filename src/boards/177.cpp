@@ -20,12 +20,12 @@
 
 #include "mapinc.h"
 
-static uint8 reg;
+static FCEU_TLS uint8 reg;
 
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REG" },
 	{ 0 }
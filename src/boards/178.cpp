@@ -24,23 +24,23 @@
 
 #include "mapinc.h"
 
-static uint8 reg[4];
+static FCEU_TLS uint8 reg[4];
 
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
 // Tennis with VR sensor, very simple behaviour
 extern void GetMouseData(uint32 (&md)[3]);
-static uint32 MouseData[3], click, lastclick;
-static int32 SensorDelay;
+static FCEU_TLS uint32 MouseData[3], click, lastclick;
+static FCEU_TLS int32 SensorDelay;
 
 // highly experimental, not actually working, just curious if it hapen to work with some other decoder
 // SND Registers
-static uint8 pcm_enable = 0;
-static int16 pcm_latch = 0x3F6, pcm_clock = 0x3F6;
-static writefunc pcmwrite;
+static FCEU_TLS uint8 pcm_enable = 0;
+static FCEU_TLS int16 pcm_latch = 0x3F6, pcm_clock = 0x3F6;
+static FCEU_TLS writefunc pcmwrite;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 4, "REGS" },
 	{ 0 }
@@ -170,6 +170,12 @@ static void M178SndClk(int a) {
 //	}
 }
 
+static int32 M178SndClkBudget(void) {
+	if (SensorDelay > 0x32768)
+		return 1;
+	return 0x32768 + 1 - SensorDelay;
+}
+
 static void M178Close(void) {
 	if (WRAM)
 		FCEU_gfree(WRAM);
@@ -185,6 +191,7 @@ void Mapper178_Init(CartInfo *info) {
 	info->Close = M178Close;
 	GameStateRestore = StateRestore;
 	MapIRQHook = M178SndClk;
+	MapIRQHookBudget = M178SndClkBudget;
 
 //	jedi_table_init();
 
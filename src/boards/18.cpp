@@ -20,13 +20,13 @@
 
 #include "mapinc.h"
 
-static uint8 preg[4], creg[8];
-static uint8 IRQa, mirr;
-static int32 IRQCount, IRQLatch;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 preg[4], creg[8];
+static FCEU_TLS uint8 IRQa, mirr;
+static FCEU_TLS int32 IRQCount, IRQLatch;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ preg, 4, "PREG" },
 	{ creg, 8, "CREG" },
@@ -57,8 +57,8 @@ static DECLFW(M18WriteIRQ) {
 	case 0xE001: IRQLatch &= 0xFF0F; IRQLatch |= (V & 0x0f) << 0x4; break;
 	case 0xE002: IRQLatch &= 0xF0FF; IRQLatch |= (V & 0x0f) << 0x8; break;
 	case 0xE003: IRQLatch &= 0x0FFF; IRQLatch |= (V & 0x0f) << 0xC; break;
-	case 0xF000: IRQCount = IRQLatch; break;
-	case 0xF001: IRQa = V & 1; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xF000: X6502_SyncHooks(); IRQCount = IRQLatch; break;
+	case 0xF001: X6502_SyncHooks(); IRQa = V & 1; X6502_IRQEnd(FCEU_IQEXT); break;
 	case 0xF002: mirr = V & 3; Sync(); break;
 	}
 }
@@ -103,6 +103,12 @@ static void M18IRQHook(int a) {
 	}
 }
 
+static int32 M18IRQHookBudget(void) {
+	if (!IRQa || !IRQCount)
+		return 0x7FFFFFFF;
+	return IRQCount;
+}
+
 static void M18Close(void)
 {
 	if (WRAM)
@@ -118,6 +124,7 @@ void Mapper18_Init(CartInfo *info) {
 	info->Power = M18Power;
 	info->Close = M18Close;
 	MapIRQHook = M18IRQHook;
+	MapIRQHookBudget = M18IRQHookBudget;
 	GameStateRestore = StateRestore;
 
 	WRAMSIZE = 8192;
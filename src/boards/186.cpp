@@ -49,11 +49,11 @@
 
 #include "mapinc.h"
 
-static uint8 SWRAM[3072];
-static uint8 *WRAM = NULL;
-static uint8 regs[4];
+static FCEU_TLS uint8 SWRAM[3072];
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint8 regs[4];
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 4, "DREG" },
 	{ SWRAM, 3072, "SWRM" },
@@ -21,8 +21,8 @@
 
 #include "mapinc.h"
 
-static uint8 prgr, chrr[4];
-static uint8 *WRAM = NULL;
+static FCEU_TLS uint8 prgr, chrr[4];
+static FCEU_TLS uint8 *WRAM = NULL;
 
 static void Mapper190_Sync(void) {
 	setprg8r(0x10, 0x6000, 0);
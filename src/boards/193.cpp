@@ -20,10 +20,10 @@
 
 #include "mapinc.h"
 
-static uint8 reg[8];
-static uint8 mirror, cmd, bank;
+static FCEU_TLS uint8 reg[8];
+static FCEU_TLS uint8 mirror, cmd, bank;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &cmd, 1, "CMD" },
 	{ &mirror, 1, "MIRR" },
@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 prot[4], prg, mode, chr, mirr;
+static FCEU_TLS uint8 prot[4], prg, mode, chr, mirr;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ prot, 4, "PROT" },
 	{ &prg, 1, "PRG" },
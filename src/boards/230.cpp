@@ -24,8 +24,8 @@
 
 #include "mapinc.h"
 
-static uint8 latche, reset;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 latche, reset;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reset, 1, "RST" },
 	{ &latche, 1, "LATC" },
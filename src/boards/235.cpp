@@ -20,8 +20,8 @@
 
 #include "mapinc.h"
 
-static uint16 cmdreg;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint16 cmdreg;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &cmdreg, 2, "CREG" },
 	{ 0 }
@@ -20,22 +20,22 @@
 
 #include "mapinc.h"
 
-static uint8 preg, creg;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 preg, creg;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &preg, 1, "PREG" },
 	{ &creg, 1, "CREG" },
 	{ 0 }
 };
 
-static uint8 prg_perm[4][4] = {
+static FCEU_TLS uint8 prg_perm[4][4] = {
 	{ 0, 1, 2, 3, },
 	{ 3, 2, 1, 0, },
 	{ 0, 2, 1, 3, },
 	{ 3, 1, 2, 0, },
 };
 
-static uint8 chr_perm[8][8] = {
+static FCEU_TLS uint8 chr_perm[8][8] = {
 	{ 0, 1, 2, 3, 4, 5, 6, 7, },
 	{ 0, 2, 1, 3, 4, 6, 5, 7, },
 	{ 0, 1, 4, 5, 2, 3, 6, 7, },
@@ -20,14 +20,14 @@
 
 #include "mapinc.h"
 
-static uint8 creg[8], preg[2];
-static int32 IRQa, IRQCount, IRQClock, IRQLatch;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-static uint8 *CHRRAM = NULL;
-static uint32 CHRRAMSIZE;
+static FCEU_TLS uint8 creg[8], preg[2];
+static FCEU_TLS int32 IRQa, IRQCount, IRQClock, IRQLatch;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS uint8 *CHRRAM = NULL;
+static FCEU_TLS uint32 CHRRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ creg, 8, "CREG" },
 	{ preg, 2, "PREG" },
@@ -68,9 +68,9 @@ static DECLFW(M252Write) {
 		case 0xA004:
 		case 0xA008:
 		case 0xA00C: preg[1] = V; Sync(); break;
-		case 0xF000: X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0xF0; IRQLatch |= V & 0xF; break;
-		case 0xF004: X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0x0F; IRQLatch |= V << 4; break;
-		case 0xF008: X6502_IRQEnd(FCEU_IQEXT); IRQClock = 0; IRQCount = IRQLatch; IRQa = V & 2; break;
+		case 0xF000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0xF0; IRQLatch |= V & 0xF; break;
+		case 0xF004: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0x0F; IRQLatch |= V << 4; break;
+		case 0xF008: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQClock = 0; IRQCount = IRQLatch; IRQa = V & 2; break;
 		}
 }
 
@@ -100,6 +100,13 @@ static void M252IRQ(int a) {
 	}
 }
 
+// cycles until IRQClock has ticked IRQCount over to 0x100
+static int32 M252IRQBudget(void) {
+	if (!IRQa || IRQCount > 0xFF)
+		return 0x7FFFFFFF;
+	return ((0x100 - IRQCount) * LCYCS - IRQClock + 2) / 3;
+}
+
 static void M252Close(void) {
 	if (WRAM)
 		FCEU_gfree(WRAM);
@@ -116,6 +123,7 @@ void Mapper252_Init(CartInfo *info) {
 	info->Power = M252Power;
 	info->Close = M252Close;
 	MapIRQHook = M252IRQ;
+	MapIRQHookBudget = M252IRQBudget;
 
 	CHRRAMSIZE = 2048;
 	CHRRAM = (uint8*)FCEU_gmalloc(CHRRAMSIZE);
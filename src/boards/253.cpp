@@ -20,14 +20,14 @@
 
 #include "mapinc.h"
 
-static uint8 chrlo[8], chrhi[8], prg[2], mirr, vlock;
-static int32 IRQa, IRQCount, IRQLatch, IRQClock;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-static uint8 *CHRRAM = NULL;
-static uint32 CHRRAMSIZE;
+static FCEU_TLS uint8 chrlo[8], chrhi[8], prg[2], mirr, vlock;
+static FCEU_TLS int32 IRQa, IRQCount, IRQLatch, IRQClock;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS uint8 *CHRRAM = NULL;
+static FCEU_TLS uint32 CHRRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ chrlo, 8, "CHRL" },
 	{ chrhi, 8, "CHRH" },
@@ -83,9 +83,9 @@ static DECLFW(M253Write) {
 		case 0x8010: prg[0] = V; Sync(); break;
 		case 0xA010: prg[1] = V; Sync(); break;
 		case 0x9400: mirr = V & 3; Sync(); break;
-		case 0xF000: X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0xF0; IRQLatch |= V & 0xF; break;
-		case 0xF004: X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0x0F; IRQLatch |= V << 4; break;
-		case 0xF008: X6502_IRQEnd(FCEU_IQEXT); IRQClock = 0; IRQCount = IRQLatch; IRQa = V & 2; break;
+		case 0xF000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0xF0; IRQLatch |= V & 0xF; break;
+		case 0xF004: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0x0F; IRQLatch |= V << 4; break;
+		case 0xF008: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQClock = 0; IRQCount = IRQLatch; IRQa = V & 2; break;
 		}
 }
 
@@ -124,6 +124,13 @@ static void M253IRQ(int a) {
 	}
 }
 
+// cycles until IRQClock has ticked IRQCount over to 0x100
+static int32 M253IRQBudget(void) {
+	if (!IRQa || IRQCount > 0xFF)
+		return 0x7FFFFFFF;
+	return ((0x100 - IRQCount) * LCYCS - IRQClock + 2) / 3;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -132,6 +139,7 @@ void Mapper253_Init(CartInfo *info) {
 	info->Power = M253Power;
 	info->Close = M253Close;
 	MapIRQHook = M253IRQ;
+	MapIRQHookBudget = M253IRQBudget;
 	GameStateRestore = StateRestore;
 
 	CHRRAMSIZE = 2048;
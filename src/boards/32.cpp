@@ -20,12 +20,12 @@
 
 #include "mapinc.h"
 
-static uint8 preg[2], creg[8], mirr;
+static FCEU_TLS uint8 preg[2], creg[8], mirr;
 
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ preg, 4, "PREG" },
 	{ creg, 8, "CREG" },
@@ -20,12 +20,12 @@
 
 #include "mapinc.h"
 
-static uint8 is48;
-static uint8 regs[8], mirr;
-static uint8 IRQa;
-static int16 IRQCount, IRQLatch;
+static FCEU_TLS uint8 is48;
+static FCEU_TLS uint8 regs[8], mirr;
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS int16 IRQCount, IRQLatch;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 8, "PREG" },
 	{ &mirr, 1, "MIRR" },
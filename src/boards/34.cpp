@@ -29,11 +29,11 @@
 
 #include "mapinc.h"
 
-static uint8 regs[3];
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 regs[3];
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 3, "REGS" },
 	{ 0 }
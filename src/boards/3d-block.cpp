@@ -20,12 +20,12 @@
 
 #include "mapinc.h"
 
-static uint8 reg[4], IRQa;
-static int16 IRQCount, IRQPause;
+static FCEU_TLS uint8 reg[4], IRQa;
+static FCEU_TLS int16 IRQCount, IRQPause;
 
-static int16 Count = 0x0000;
+static FCEU_TLS int16 Count = 0x0000;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 4, "REGS" },
 	{ &IRQa, 1, "IRQA" },
@@ -50,7 +50,7 @@ static DECLFW(UNL3DBlockWrite) {
 	case 0x4800: reg[0] = V; break;
 	case 0x4900: reg[1] = V; break;
 	case 0x4a00: reg[2] = V; break;
-	case 0x4e00: reg[3] = V; IRQCount = Count; IRQPause = Pause; IRQa = 1; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0x4e00: X6502_SyncHooks(); reg[3] = V; IRQCount = Count; IRQPause = Pause; IRQa = 1; X6502_IRQEnd(FCEU_IQEXT); break;
 	}
 }
 
@@ -82,6 +82,15 @@ static void UNL3DBlockIRQHook(int a) {
 	}
 }
 
+static int32 UNL3DBlockIRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	// the pause and the reload after it are stepped on every call
+	if (IRQCount <= 0)
+		return 1;
+	return IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -90,6 +99,7 @@ void UNL3DBlock_Init(CartInfo *info) {
 	info->Power = UNL3DBlockPower;
 	info->Reset = UNL3DBlockReset;
 	MapIRQHook = UNL3DBlockIRQHook;
+	MapIRQHookBudget = UNL3DBlockIRQBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -24,10 +24,10 @@
 
 #include "mapinc.h"
 
-static uint8 reg;
-static uint32 IRQCount, IRQa;
+static FCEU_TLS uint8 reg;
+static FCEU_TLS uint32 IRQCount, IRQa;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQCount, 4, "IRQC" },
 	{ &IRQa, 4, "IRQA" },
@@ -46,8 +46,8 @@ static void Sync(void) {
 
 static DECLFW(M40Write) {
 	switch (A & 0xe000) {
-	case 0x8000: IRQa = 0; IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
-	case 0xa000: IRQa = 1; break;
+	case 0x8000: X6502_SyncHooks(); IRQa = 0; IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xa000: X6502_SyncHooks(); IRQa = 1; break;
 	case 0xe000: reg = V & 7; Sync(); break;
 	}
 }
@@ -73,6 +73,15 @@ static void M40IRQHook(int a) {
 	}
 }
 
+// the irq fires on the first call after IRQCount has reached 4096
+static int32 M40IRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 4096)
+		return 1;
+	return 4096 - IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -81,6 +90,7 @@ void Mapper40_Init(CartInfo *info) {
 	info->Reset = M40Reset;
 	info->Power = M40Power;
 	MapIRQHook = M40IRQHook;
+	MapIRQHookBudget = M40IRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
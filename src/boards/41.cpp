@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 mainreg, chrreg, mirror;
+static FCEU_TLS uint8 mainreg, chrreg, mirror;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &mainreg, 1, "MREG" },
 	{ &chrreg, 1, "CREG" },
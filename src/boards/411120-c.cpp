@@ -23,7 +23,7 @@
 #include "mapinc.h"
 #include "mmc3.h"
 
-static uint8 reset_flag = 0;
+static FCEU_TLS uint8 reset_flag = 0;
 
 static void BMC411120CCW(uint32 A, uint8 V) {
 	setchr1(A, V | ((EXPREGS[0] & 3) << 7));
@@ -24,10 +24,10 @@
 
 #include "mapinc.h"
 
-static uint8 preg, creg, mirr;
-static uint32 IRQCount, IRQa;
+static FCEU_TLS uint8 preg, creg, mirr;
+static FCEU_TLS uint32 IRQCount, IRQa;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &preg, 1, "PREG" },
 	{ &creg, 1, "CREG" },
@@ -49,7 +49,7 @@ static DECLFW(M42Write) {
 	case 0x8000: creg = V; Sync(); break;
 	case 0xE000: preg = V & 0x0F; Sync(); break;
 	case 0xE001: mirr = ((V >> 3) & 1 ) ^ 1; Sync(); break;
-	case 0xE002: IRQa = V & 2; if (!IRQa) IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xE002: X6502_SyncHooks(); IRQa = V & 2; if (!IRQa) IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
 	}
 }
 
@@ -72,6 +72,15 @@ static void M42IRQHook(int a) {
 	}
 }
 
+// cycles until the irq line goes up at 24576 or back down when the counter wraps at 32768
+static int32 M42IRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount < 24576)
+		return 24576 - IRQCount;
+	return 32768 - IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -79,6 +88,7 @@ static void StateRestore(int version) {
 void Mapper42_Init(CartInfo *info) {
 	info->Power = M42Power;
 	MapIRQHook = M42IRQHook;
+	MapIRQHookBudget = M42IRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -23,10 +23,10 @@
 
 #include "mapinc.h"
 
-static uint8 reg, swap;
-static uint32 IRQCount, IRQa;
+static FCEU_TLS uint8 reg, swap;
+static FCEU_TLS uint32 IRQCount, IRQa;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQCount, 4, "IRQC" },
 	{ &IRQa, 4, "IRQA" },
@@ -55,7 +55,7 @@ static DECLFW(M43Write) {
 	case 0x4022: reg = transo[V & 7]; Sync(); break;
 	case 0x4120: swap = V & 1; Sync(); break;
 	case 0x8122:																// hacked version
-	case 0x4122: IRQa = V & 1; X6502_IRQEnd(FCEU_IQEXT); IRQCount = 0; break;	// original version
+	case 0x4122: X6502_SyncHooks(); IRQa = V & 1; X6502_IRQEnd(FCEU_IQEXT); IRQCount = 0; break;	// original version
 	}
 }
 
@@ -78,6 +78,14 @@ static void M43IRQHook(int a) {
 		}
 }
 
+static int32 M43IRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 4096)
+		return 1;
+	return 4096 - IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -86,6 +94,7 @@ void Mapper43_Init(CartInfo *info) {
 	info->Reset = M43Reset;
 	info->Power = M43Power;
 	MapIRQHook = M43IRQHook;
+	MapIRQHookBudget = M43IRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 reg0, reg1;
+static FCEU_TLS uint8 reg0, reg1;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg0, 1, "REG0" },
 	{ &reg1, 1, "REG1" },
@@ -24,10 +24,10 @@
 
 #include "mapinc.h"
 
-static uint8 reg;
-static uint32 IRQCount, IRQa;
+static FCEU_TLS uint8 reg;
+static FCEU_TLS uint32 IRQCount, IRQa;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQCount, 4, "IRQC" },
 	{ &IRQa, 4, "IRQA" },
@@ -46,7 +46,7 @@ static void Sync(void) {
 
 static DECLFW(M50Write) {
 	switch (A & 0xD160) {
-	case 0x4120: IRQa = V & 1; if (!IRQa) IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0x4120: X6502_SyncHooks(); IRQa = V & 1; if (!IRQa) IRQCount = 0; X6502_IRQEnd(FCEU_IQEXT); break;
 	case 0x4020: reg = ((V & 1) << 2) | ((V & 2) >> 1) | ((V & 4) >> 1) | (V & 8); Sync(); break;
 	}
 }
@@ -72,6 +72,15 @@ static void M50IRQHook(int a) {
 	}
 }
 
+// the irq fires on the first call after IRQCount has reached 4096
+static int32 M50IRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 4096)
+		return 1;
+	return 4096 - IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -80,6 +89,7 @@ void Mapper50_Init(CartInfo *info) {
 	info->Reset = M50Reset;
 	info->Power = M50Power;
 	MapIRQHook = M50IRQHook;
+	MapIRQHookBudget = M50IRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -21,7 +21,7 @@
 #include "mapinc.h"
 #include "mmc3.h"
 
-static uint8 lut[4] = { 0x00, 0x02, 0x02, 0x03 };
+static FCEU_TLS uint8 lut[4] = { 0x00, 0x02, 0x02, 0x03 };
 
 static DECLFW(UNL6035052ProtWrite) {
 	EXPREGS[0] = lut[V & 3];
@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 bank;
-static uint16 mode;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 bank;
+static FCEU_TLS uint16 mode;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &bank, 1, "BANK" },
 	{ &mode, 2, "MODE" },
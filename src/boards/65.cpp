@@ -21,11 +21,11 @@
 
 #include "mapinc.h"
 
-static uint8 preg[3], creg[8], mirr;
-static uint8 IRQa;
-static int16 IRQCount, IRQLatch;
+static FCEU_TLS uint8 preg[3], creg[8], mirr;
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS int16 IRQCount, IRQLatch;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ preg, 3, "PREG" },
 	{ creg, 8, "CREG" },
@@ -59,8 +59,8 @@ static DECLFW(M65Write) {
 	case 0xA000: preg[1] = V; Sync(); break;
 	case 0xC000: preg[2] = V; Sync(); break;
 	case 0x9001: mirr = ((V >> 7) & 1) ^ 1; Sync(); break;
-	case 0x9003: IRQa = V & 0x80; X6502_IRQEnd(FCEU_IQEXT); break;
-	case 0x9004: IRQCount = IRQLatch; break;
+	case 0x9003: X6502_SyncHooks(); IRQa = V & 0x80; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0x9004: X6502_SyncHooks(); IRQCount = IRQLatch; break;
 	case 0x9005: IRQLatch &= 0x00FF; IRQLatch |= V << 8; break;
 	case 0x9006: IRQLatch &= 0xFF00; IRQLatch |= V; break;
 	case 0xB000: creg[0] = V; Sync(); break;
@@ -92,6 +92,15 @@ void  M65IRQ(int a) {
 	}
 }
 
+// the irq fires once IRQCount has gone below -4
+static int32 M65IRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount < -4)
+		return 1;
+	return IRQCount + 5;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -99,6 +108,7 @@ static void StateRestore(int version) {
 void Mapper65_Init(CartInfo *info) {
 	info->Power = M65Power;
 	MapIRQHook = M65IRQ;
+	MapIRQHookBudget = M65IRQBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -21,11 +21,11 @@
 
 #include "mapinc.h"
 
-static uint8 preg, creg[4], mirr, suntoggle = 0;
-static uint8 IRQa;
-static int16 IRQCount, IRQLatch;
+static FCEU_TLS uint8 preg, creg[4], mirr, suntoggle = 0;
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS int16 IRQCount, IRQLatch;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &preg, 1, "PREG" },
 	{ &suntoggle, 1, "STOG" },
@@ -61,11 +61,13 @@ static DECLFW(M67Write) {
 	case 0xB800: creg[3] = V; Sync(); break;
 	case 0xC000:
 	case 0xC800:
+		X6502_SyncHooks();
 		IRQCount &= 0xFF << (suntoggle << 3);
 		IRQCount |= V << ((suntoggle ^ 1) << 3);
 		suntoggle ^= 1;
 		break;
 	case 0xD800:
+		X6502_SyncHooks();
 		suntoggle = 0;
 		IRQa = V & 0x10;
 		X6502_IRQEnd(FCEU_IQEXT);
@@ -93,6 +95,14 @@ void M67IRQ(int a) {
 	}
 }
 
+static int32 M67IRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount <= 0)
+		return 1;
+	return IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -100,6 +110,7 @@ static void StateRestore(int version) {
 void Mapper67_Init(CartInfo *info) {
 	info->Power = M67Power;
 	MapIRQHook = M67IRQ;
+	MapIRQHookBudget = M67IRQBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
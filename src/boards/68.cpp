@@ -20,13 +20,13 @@
 
 #include "mapinc.h"
 
-static uint8 chr_reg[4];
-static uint8 kogame, prg_reg, nt1, nt2, mirr;
+static FCEU_TLS uint8 chr_reg[4];
+static FCEU_TLS uint8 kogame, prg_reg, nt1, nt2, mirr;
 
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE, count;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE, count;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &nt1, 1, "NT1" },
 	{ &nt2, 1, "NT2" },
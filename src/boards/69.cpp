@@ -21,13 +21,13 @@
 
 #include "mapinc.h"
 
-static uint8 cmdreg, preg[4], creg[8], mirr;
-static uint8 IRQa;
-static int32 IRQCount;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 cmdreg, preg[4], creg[8], mirr;
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS int32 IRQCount;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &cmdreg, 1, "CMDR" },
 	{ preg, 4, "PREG" },
@@ -89,9 +89,9 @@ static DECLFW(M69Write1) {
 	case 0xA: preg[1] = V; Sync(); break;
 	case 0xB: preg[2] = V; Sync(); break;
 	case 0xC: mirr = V & 3; Sync();break;
-	case 0xD: IRQa = V; X6502_IRQEnd(FCEU_IQEXT); break;
-	case 0xE: IRQCount &= 0xFF00; IRQCount |= V; break;
-	case 0xF: IRQCount &= 0x00FF; IRQCount |= V << 8; break;
+	case 0xD: X6502_SyncHooks(); IRQa = V; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xE: X6502_SyncHooks(); IRQCount &= 0xFF00; IRQCount |= V; break;
+	case 0xF: X6502_SyncHooks(); IRQCount &= 0x00FF; IRQCount |= V << 8; break;
 	}
 }
 
@@ -102,12 +102,12 @@ static void AYSoundHQ(void);
 static void DoAYSQ(int x);
 static void DoAYSQHQ(int x);
 
-static uint8 sndcmd, sreg[14];
-static int32 vcount[3];
-static int32 dcount[3];
-static int CAYBC[3];
+static FCEU_TLS uint8 sndcmd, sreg[14];
+static FCEU_TLS int32 vcount[3];
+static FCEU_TLS int32 dcount[3];
+static FCEU_TLS int CAYBC[3];
 
-static SFORMAT SStateRegs[] =
+static FCEU_TLS SFORMAT SStateRegs[] =
 {
 	{ &sndcmd, 1, "SCMD" },
 	{ sreg, 14, "SREG" },
@@ -250,6 +250,12 @@ static void M69IRQHook(int a) {
 	}
 }
 
+static int32 M69IRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	return IRQCount;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -258,6 +264,7 @@ void Mapper69_Init(CartInfo *info) {
 	info->Power = M69Power;
 	info->Close = M69Close;
 	MapIRQHook = M69IRQHook;
+	MapIRQHookBudget = M69IRQHookBudget;
 	if(info->ines2)
 		WRAMSIZE = info->wram_size + info->battery_wram_size;
 	else
@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 preg, mirr;
+static FCEU_TLS uint8 preg, mirr;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &preg, 1, "PREG" },
 	{ &mirr, 1, "MIRR" },
@@ -23,9 +23,9 @@
 
 #include "mapinc.h"
 
-static uint8 preg, creg;
+static FCEU_TLS uint8 preg, creg;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &preg, 1, "PREG" },
 	{ &creg, 1, "CREG" },
@@ -20,12 +20,12 @@
 
 #include "mapinc.h"
 
-static uint8 latche;
+static FCEU_TLS uint8 latche;
 
-static uint8 *CHRRAM=NULL;
-static uint32 CHRRAMSIZE;
+static FCEU_TLS uint8 *CHRRAM=NULL;
+static FCEU_TLS uint32 CHRRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &latche, 1, "LATC" },
 	{ 0 }
@@ -21,8 +21,8 @@
 
 #include "mapinc.h"
 
-static uint8 creg, preg;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 creg, preg;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &creg, 1, "CREG" },
 	{ &preg, 1, "PREG" },
@@ -21,12 +21,12 @@
 
 #include "mapinc.h"
 
-static uint8 preg[3], creg[6], isExMirr;
-static uint8 mirr, cmd, wram_enable, wram[256];
-static uint8 mcache[8];
-static uint32 lastppu;
+static FCEU_TLS uint8 preg[3], creg[6], isExMirr;
+static FCEU_TLS uint8 mirr, cmd, wram_enable, wram[256];
+static FCEU_TLS uint8 mcache[8];
+static FCEU_TLS uint32 lastppu;
 
-static SFORMAT StateRegs80[] =
+static FCEU_TLS SFORMAT StateRegs80[] =
 {
 	{ preg, 3, "PREG" },
 	{ creg, 6, "CREG" },
@@ -36,7 +36,7 @@ static SFORMAT StateRegs80[] =
 	{ 0 }
 };
 
-static SFORMAT StateRegs95[] =
+static FCEU_TLS SFORMAT StateRegs95[] =
 {
 	{ &cmd, 1, "CMDR" },
 	{ preg, 3, "PREG" },
@@ -46,7 +46,7 @@ static SFORMAT StateRegs95[] =
 	{ 0 }
 };
 
-static SFORMAT StateRegs207[] =
+static FCEU_TLS SFORMAT StateRegs207[] =
 {
 	{ preg, 3, "PREG" },
 	{ creg, 6, "CREG" },
@@ -122,7 +122,7 @@ static DECLFW(M95Write) {
 }
 
 static void MExMirrPPU(uint32 A) {
-	static int8 lastmirr = -1, curmirr;
+	static FCEU_TLS int8 lastmirr = -1, curmirr;
 	if (A < 0x2000) {
 		lastppu = A >> 10;
 		curmirr = mcache[lastppu];
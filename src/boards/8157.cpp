@@ -23,9 +23,9 @@
 
 #include "mapinc.h"
 
-static uint16 cmdreg;
-static uint8 reset;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint16 cmdreg;
+static FCEU_TLS uint8 reset;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reset, 1, "REST" },
 	{ &cmdreg, 2, "CREG" },
@@ -23,11 +23,11 @@
 
 #include "mapinc.h"
 
-static uint8 regs[9], ctrl;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 regs[9], ctrl;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 9, "REGS" },
 	{ &ctrl, 1, "CTRL" },
@@ -25,9 +25,9 @@
 #include "mapinc.h"
 #include "mmc3.h"
 
-static uint8 cmdin;
+static FCEU_TLS uint8 cmdin;
 
-static uint8 regperm[8][8] =
+static FCEU_TLS uint8 regperm[8][8] =
 {
 	{ 0, 1, 2, 3, 4, 5, 6, 7 },
 	{ 0, 2, 6, 1, 7, 3, 4, 5 },
@@ -39,7 +39,7 @@ static uint8 regperm[8][8] =
 	{ 0, 1, 2, 3, 4, 5, 6, 7 },   // empty
 };
 
-static uint8 adrperm[8][8] =
+static FCEU_TLS uint8 adrperm[8][8] =
 {
 	{ 0, 1, 2, 3, 4, 5, 6, 7 },
 	{ 3, 2, 0, 4, 1, 5, 6, 7 },
@@ -26,30 +26,30 @@
 // Mapper 209 much compicated hardware with decribed above features disabled by default and switchable by command
 // Mapper 211 the same mapper 209 but with forced nametable control
 
-static int is209;
-static int is211;
+static FCEU_TLS int is209;
+static FCEU_TLS int is211;
 
-static uint8 IRQMode;        // from $c001
-static uint8 IRQPre;         // from $c004
-static uint8 IRQPreSize;     // from $c007
-static uint8 IRQCount;       // from $c005
-static uint8 IRQXOR;         // Loaded from $C006
-static uint8 IRQa;           // $c002, $c003, and $c000
+static FCEU_TLS uint8 IRQMode;        // from $c001
+static FCEU_TLS uint8 IRQPre;         // from $c004
+static FCEU_TLS uint8 IRQPreSize;     // from $c007
+static FCEU_TLS uint8 IRQCount;       // from $c005
+static FCEU_TLS uint8 IRQXOR;         // Loaded from $C006
+static FCEU_TLS uint8 IRQa;           // $c002, $c003, and $c000
 
-static uint8 mul[2];
-static uint8 regie;
+static FCEU_TLS uint8 mul[2];
+static FCEU_TLS uint8 regie;
 
-static uint8 tkcom[4];
-static uint8 prgb[4];
-static uint8 chrlow[8];
-static uint8 chrhigh[8];
+static FCEU_TLS uint8 tkcom[4];
+static FCEU_TLS uint8 prgb[4];
+static FCEU_TLS uint8 chrlow[8];
+static FCEU_TLS uint8 chrhigh[8];
 
-static uint8 chr[2];
+static FCEU_TLS uint8 chr[2];
 
-static uint16 names[4];
-static uint8 tekker;
+static FCEU_TLS uint16 names[4];
+static FCEU_TLS uint8 tekker;
 
-static SFORMAT Tek_StateRegs[] = {
+static FCEU_TLS SFORMAT Tek_StateRegs[] = {
 	{ &IRQMode, 1, "IRQM" },
 	{ &IRQPre, 1, "IRQP" },
 	{ &IRQPreSize, 1, "IRQR" },
@@ -244,6 +244,7 @@ static DECLFW(M90NTWrite)
 static DECLFW(M90IRQWrite)
 {
 //  FCEU_printf("bs %04x %02x\n",A,V);
+  X6502_SyncHooks();
   switch(A&7)
   {
     case 00: //FCEU_printf("%s IRQ (C000)\n",V&1?"Enable":"Disable");
@@ -372,13 +373,41 @@ void CPUWrap(int a)
   if((IRQMode&3)==0) for(x=0;x<a;x++) ClockCounter();
 }
 
+// cycles until CPUWrap raises the irq
+static int32 CPUWrapBudget(void)
+{
+  int32 scale, first, steps;
+  uint8 premask;
+
+  if((IRQMode&3)!=0 || !IRQa)
+    return 0x7FFFFFFF;
+
+  premask = (IRQMode & 0x4) ? 0x7 : 0xFF;
+  scale = premask + 1;
+  if((IRQMode>>6) == 1) // Count up
+  {
+    first = (-IRQPre) & premask;
+    if(!first) first = scale;
+    steps = IRQCount ? 0x100 - IRQCount : 0x100;
+  }
+  else if((IRQMode>>6) == 2) // Count down
+  {
+    first = (IRQPre & premask) + 1;
+    steps = IRQCount + 1;
+  }
+  else
+    return 0x7FFFFFFF;
+
+  return first + (steps - 1) * scale;
+}
+
 static void SLWrap(void)
 {
   int x;
   if((IRQMode&3)==1) for(x=0;x<8;x++) ClockCounter();
 }
 
-static uint32 lastread;
+static FCEU_TLS uint32 lastread;
 static void M90PPU(uint32 A)
 {
   if((IRQMode&3)==2)
@@ -476,6 +505,7 @@ void Mapper90_Init(CartInfo *info)
   info->Power=M90Power;
   PPU_hook=M90PPU;
   MapIRQHook=CPUWrap;
+  MapIRQHookBudget=CPUWrapBudget;
   GameHBIRQHook2=SLWrap;
   GameStateRestore=M90Restore;
   AddExState(Tek_StateRegs, ~0, 0, 0);
@@ -489,6 +519,7 @@ void Mapper209_Init(CartInfo *info)
   info->Power=M90Power;
   PPU_hook=M90PPU;
   MapIRQHook=CPUWrap;
+  MapIRQHookBudget=CPUWrapBudget;
   GameHBIRQHook2=SLWrap;
   GameStateRestore=M90Restore;
   AddExState(Tek_StateRegs, ~0, 0, 0);
@@ -501,6 +532,7 @@ void Mapper211_Init(CartInfo *info)
   info->Power=M90Power;
   PPU_hook=M90PPU;
   MapIRQHook=CPUWrap;
+  MapIRQHookBudget=CPUWrapBudget;
   GameHBIRQHook2=SLWrap;
   GameStateRestore=M90Restore;
   AddExState(Tek_StateRegs, ~0, 0, 0);
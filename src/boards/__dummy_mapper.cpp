@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 reg[8];
-static uint8 IRQa;
-static int16 IRQCount, IRQLatch;
+static FCEU_TLS uint8 reg[8];
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS int16 IRQCount, IRQLatch;
 /*
 static uint8 *WRAM = NULL;
 static uint32 WRAMSIZE;
@@ -30,7 +30,7 @@ static uint8 *CHRRAM = NULL;
 static uint32 CHRRAMSIZE;
 */
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 8, "REGS" },
 	{ &IRQa, 1, "IRQA" },
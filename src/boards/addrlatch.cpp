@@ -20,13 +20,13 @@
 
 #include "mapinc.h"
 
-static uint16 latche, latcheinit;
-static uint16 addrreg0, addrreg1;
-static uint8 dipswitch;
-static void (*WSync)(void);
-static readfunc defread;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint16 latche, latcheinit;
+static FCEU_TLS uint16 addrreg0, addrreg1;
+static FCEU_TLS uint8 dipswitch;
+static FCEU_TLS void (*WSync)(void);
+static FCEU_TLS readfunc defread;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
 static DECLFW(LatchWrite) {
 	latche = A;
@@ -22,13 +22,13 @@
 
 #include "mapinc.h"
 
-static uint8 IRQCount; //, IRQPre;
-static uint8 IRQa;
-static uint8 prg_reg[2];
-static uint8 chr_reg[8];
-static uint8 mirr;
+static FCEU_TLS uint8 IRQCount; //, IRQPre;
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS uint8 prg_reg[2];
+static FCEU_TLS uint8 chr_reg[8];
+static FCEU_TLS uint8 mirr;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQCount, 1, "IRQC" },
 	{ &IRQa, 1, "IRQA" },
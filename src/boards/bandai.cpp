@@ -24,14 +24,14 @@
 
 #include "mapinc.h"
 
-static uint8 reg[16], is153, x24c02;
-static uint8 IRQa;
-static int16 IRQCount, IRQLatch;
+static FCEU_TLS uint8 reg[16], is153, x24c02;
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS int16 IRQCount, IRQLatch;
 
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 16, "REGS" },
 	{ &IRQa, 1, "IRQA" },
@@ -48,17 +48,17 @@ static SFORMAT StateRegs[] =
 #define X24C0X_READ			3
 #define X24C0X_WRITE		4
 
-static uint8 x24c0x_data[512];
+static FCEU_TLS uint8 x24c0x_data[512];
 
-static uint8 x24c01_state;
-static uint8 x24c01_addr, x24c01_word, x24c01_latch, x24c01_bitcount;
-static uint8 x24c01_sda, x24c01_scl, x24c01_out;
+static FCEU_TLS uint8 x24c01_state;
+static FCEU_TLS uint8 x24c01_addr, x24c01_word, x24c01_latch, x24c01_bitcount;
+static FCEU_TLS uint8 x24c01_sda, x24c01_scl, x24c01_out;
 
-static uint8 x24c02_state;
-static uint8 x24c02_addr, x24c02_word, x24c02_latch, x24c02_bitcount;
-static uint8 x24c02_sda, x24c02_scl, x24c02_out;
+static FCEU_TLS uint8 x24c02_state;
+static FCEU_TLS uint8 x24c02_addr, x24c02_word, x24c02_latch, x24c02_bitcount;
+static FCEU_TLS uint8 x24c02_sda, x24c02_scl, x24c02_out;
 
-static SFORMAT x24c01StateRegs[] =
+static FCEU_TLS SFORMAT x24c01StateRegs[] =
 {
 	{ &x24c01_addr, 1, "ADDR" },
 	{ &x24c01_word, 1, "WORD" },
@@ -71,7 +71,7 @@ static SFORMAT x24c01StateRegs[] =
 	{ 0 }
 };
 
-static SFORMAT x24c02StateRegs[] =
+static FCEU_TLS SFORMAT x24c02StateRegs[] =
 {
 	{ &x24c02_addr, 1, "ADDR" },
 	{ &x24c02_word, 1, "WORD" },
@@ -269,7 +269,7 @@ static DECLFW(BandaiWrite) {
 		Sync();
 	} else
 		switch (A) {
-		case 0x0A: X6502_IRQEnd(FCEU_IQEXT); IRQa = V & 1; IRQCount = IRQLatch; break;
+		case 0x0A: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQa = V & 1; IRQCount = IRQLatch; break;
 		case 0x0B: IRQLatch &= 0xFF00; IRQLatch |= V; break;
 		case 0x0C: IRQLatch &= 0xFF; IRQLatch |= V << 8; break;
 		case 0x0D: if(x24c02) x24c02_write(V); else x24c01_write(V); break;
@@ -294,6 +294,12 @@ static void BandaiIRQHook(int a) {
 	}
 }
 
+static int32 BandaiIRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	return IRQCount < 0 ? 0 : IRQCount + 1;
+}
+
 static void BandaiPower(void) {
 	IRQa = 0;
 	if(x24c02)
@@ -315,6 +321,7 @@ void Mapper16_Init(CartInfo *info) {
 	is153 = 0;
 	info->Power = BandaiPower;
 	MapIRQHook = BandaiIRQHook;
+	MapIRQHookBudget = BandaiIRQHookBudget;
 
 	info->battery = 1;
 	info->SaveGame[0] = x24c0x_data + 256;
@@ -331,6 +338,7 @@ void Mapper159_Init(CartInfo *info) {
 	is153 = 0;
 	info->Power = BandaiPower;
 	MapIRQHook = BandaiIRQHook;
+	MapIRQHookBudget = BandaiIRQHookBudget;
 
 	info->battery = 1;
 	info->SaveGame[0] = x24c0x_data;
@@ -371,6 +379,7 @@ void Mapper153_Init(CartInfo *info) {
 	info->Power = M153Power;
 	info->Close = M153Close;
 	MapIRQHook = BandaiIRQHook;
+	MapIRQHookBudget = BandaiIRQHookBudget;
 
 	WRAMSIZE = 8192;
 	WRAM = (uint8*)FCEU_gmalloc(WRAMSIZE);
@@ -388,10 +397,10 @@ void Mapper153_Init(CartInfo *info) {
 
 // Datach Barcode Battler
 
-static uint8 BarcodeData[256];
-static int BarcodeReadPos;
-static int BarcodeCycleCount;
-static uint32 BarcodeOut;
+static FCEU_TLS uint8 BarcodeData[256];
+static FCEU_TLS int BarcodeReadPos;
+static FCEU_TLS int BarcodeCycleCount;
+static FCEU_TLS uint32 BarcodeOut;
 
 // #define INTERL2OF5
 
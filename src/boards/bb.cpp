@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 reg, chr;
+static FCEU_TLS uint8 reg, chr;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REG" },
 	{ &chr, 1, "CHR" },
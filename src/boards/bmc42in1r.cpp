@@ -24,9 +24,9 @@
 
 #include "mapinc.h"
 
-static uint8 isresetbased = 0;
-static uint8 latche[2], reset;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 isresetbased = 0;
+static FCEU_TLS uint8 latche[2], reset;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reset, 1, "RST" },
 	{ latche, 2, "LATC" },
@@ -22,9 +22,9 @@
 
 #include "mapinc.h"
 
-static uint8 regs[4];
+static FCEU_TLS uint8 regs[4];
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 4, "REGS" },
 	{ 0 }
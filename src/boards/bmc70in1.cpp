@@ -20,13 +20,13 @@
 
 #include "mapinc.h"
 
-static uint8 is_large_banks, hw_switch;
-static uint8 large_bank;
-static uint8 prg_bank;
-static uint8 chr_bank;
-static uint8 bank_mode;
-static uint8 mirroring;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 is_large_banks, hw_switch;
+static FCEU_TLS uint8 large_bank;
+static FCEU_TLS uint8 prg_bank;
+static FCEU_TLS uint8 chr_bank;
+static FCEU_TLS uint8 bank_mode;
+static FCEU_TLS uint8 mirroring;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &large_bank, 1, "LB" },
 	{ &hw_switch, 1, "DPSW" },
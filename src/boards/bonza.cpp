@@ -22,9 +22,9 @@
 
 #define CARD_EXTERNAL_INSERED 0x80
 
-static uint8 prg_reg;
-static uint8 chr_reg;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 prg_reg;
+static FCEU_TLS uint8 chr_reg;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &prg_reg, 1, "PREG" },
 	{ &chr_reg, 1, "CREG" },
@@ -84,7 +84,7 @@ byte_8C29:           .BYTE   0,$76,  0,  0,  8
 byte_8CC6:           .BYTE   0,$78,  0,  0,$12
 */
 
-static uint8 sim0reset[0x1F] = {
+static FCEU_TLS uint8 sim0reset[0x1F] = {
 	0x3B, 0xE9, 0x00, 0xFF, 0xC1, 0x10, 0x31, 0xFE,
 	0x55, 0xC8, 0x10, 0x20, 0x55, 0x47, 0x4F, 0x53,
 	0x56, 0x53, 0x43, 0xAD, 0x10, 0x10, 0x10, 0x10,
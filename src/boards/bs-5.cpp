@@ -20,11 +20,11 @@
 
 #include "mapinc.h"
 
-static uint8 reg_prg[4];
-static uint8 reg_chr[4];
-static uint8 dip_switch;
+static FCEU_TLS uint8 reg_prg[4];
+static FCEU_TLS uint8 reg_chr[4];
+static FCEU_TLS uint8 dip_switch;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg_prg, 4, "PREG" },
 	{ reg_chr, 4, "CREG" },
@@ -32,25 +32,25 @@
 #include "mapinc.h"
 #include "../ines.h"
 
-static uint8 reg;
-static uint8 *CHRRAM = NULL;
+static FCEU_TLS uint8 reg;
+static FCEU_TLS uint8 *CHRRAM = NULL;
 const uint32 CHRRAMSIZE = 1024 * 32;
 
-static bool flash = false;
-static uint8 flash_mode;
-static uint8 flash_sequence;
-static uint8 flash_id;
-static uint8 *FLASHROM = NULL;
+static FCEU_TLS bool flash = false;
+static FCEU_TLS uint8 flash_mode;
+static FCEU_TLS uint8 flash_sequence;
+static FCEU_TLS uint8 flash_id;
+static FCEU_TLS uint8 *FLASHROM = NULL;
 const uint32 FLASHROMSIZE = 1024 * 512;
 
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REG" },
 	{ 0 }
 };
 
-static SFORMAT FlashRegs[] =
+static FCEU_TLS SFORMAT FlashRegs[] =
 {
 	{ &flash_mode, 1, "FMOD" },
 	{ &flash_sequence, 1, "FSEQ" },
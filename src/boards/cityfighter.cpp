@@ -22,13 +22,13 @@
 
 #include "mapinc.h"
 
-static int32 IRQCount;
-static uint8 IRQa;
-static uint8 prg_reg, prg_mode, mirr;
-static uint8 chr_reg[8];
-static writefunc pcmwrite;
+static FCEU_TLS int32 IRQCount;
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS uint8 prg_reg, prg_mode, mirr;
+static FCEU_TLS uint8 chr_reg[8];
+static FCEU_TLS writefunc pcmwrite;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQCount, 4, "IRQC" },
 	{ &IRQa, 1, "IRQA" },
@@ -86,9 +86,9 @@ static DECLFW(UNLCITYFIGHTWrite) {
 	case 0xE004: chr_reg[6] = (chr_reg[6] & 0x0F) | (V << 4); break;
 	case 0xE008: chr_reg[7] = (chr_reg[7] & 0xF0) | (V & 0x0F); break;
 	case 0xE00C: chr_reg[7] = (chr_reg[7] & 0x0F) | (V << 4); break;
-	case 0xF000: IRQCount = ((IRQCount & 0x1E0) | ((V & 0xF) << 1)); break;
-	case 0xF004: IRQCount = ((IRQCount & 0x1E) | ((V & 0xF) << 5)); break;
-	case 0xF008: IRQa = V & 2; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xF000: X6502_SyncHooks(); IRQCount = ((IRQCount & 0x1E0) | ((V & 0xF) << 1)); break;
+	case 0xF004: X6502_SyncHooks(); IRQCount = ((IRQCount & 0x1E) | ((V & 0xF) << 5)); break;
+	case 0xF008: X6502_SyncHooks(); IRQa = V & 2; X6502_IRQEnd(FCEU_IQEXT); break;
 	default:
 		break;
 	}
@@ -104,6 +104,14 @@ static void UNLCITYFIGHTIRQ(int a) {
 	}
 }
 
+static int32 UNLCITYFIGHTIRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount <= 0)
+		return 1;
+	return IRQCount;
+}
+
 static void UNLCITYFIGHTPower(void) {
 	prg_reg = 0;
 	Sync();
@@ -119,6 +127,7 @@ static void StateRestore(int version) {
 void UNLCITYFIGHT_Init(CartInfo *info) {
 	info->Power = UNLCITYFIGHTPower;
 	MapIRQHook = UNLCITYFIGHTIRQ;
+	MapIRQHookBudget = UNLCITYFIGHTIRQBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -20,12 +20,12 @@
 
 #include "mapinc.h"
 
-static uint8 prg, mode;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-static uint32 lastnt = 0;
+static FCEU_TLS uint8 prg, mode;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS uint32 lastnt = 0;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &prg, 1, "REGS" },
 	{ &mode, 1, "MODE" },
@@ -21,11 +21,11 @@
 #include "mapinc.h"
 #include "../ines.h"
 
-static uint8 latche, latcheinit, bus_conflict;
-static uint16 addrreg0, addrreg1;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-static void (*WSync)(void);
+static FCEU_TLS uint8 latche, latcheinit, bus_conflict;
+static FCEU_TLS uint16 addrreg0, addrreg1;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS void (*WSync)(void);
 
 static DECLFW(LatchWrite) {
 //	FCEU_printf("bs %04x %02x\n",A,V);
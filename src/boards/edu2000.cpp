@@ -21,10 +21,10 @@
 
 #include "mapinc.h"
 
-static uint8 *WRAM = NULL;
-static uint8 reg;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint8 reg;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REG" },
 	{ 0 }
@@ -20,10 +20,10 @@
 
 #include "mapinc.h"
 
-static uint16 addrlatch;
-static uint8 datalatch, hw_mode;
+static FCEU_TLS uint16 addrlatch;
+static FCEU_TLS uint8 datalatch, hw_mode;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &addrlatch, 2, "ADRL" },
 	{ &datalatch, 1, "DATL" },
@@ -52,6 +52,17 @@
 #include <math.h>
 #include "emu2413.h"
 
+/* per-core state in the library build. same as FCEU_TLS in types.h, which this file does not include */
+#ifdef FCEU_TLS_CORE
+#if defined(_MSC_VER)
+#define FCEU_TLS __declspec(thread)
+#else
+#define FCEU_TLS _Thread_local
+#endif
+#else
+#define FCEU_TLS
+#endif
+
 static const unsigned char default_inst[15][8] = {
 	/* VRC7 instruments, March 15, 2019 dumped by Nuke.YKT */
 	{ 0x03, 0x21, 0x05, 0x06, 0xE8, 0x81, 0x42, 0x27 },
@@ -159,45 +170,45 @@ static const unsigned char default_inst[15][8] = {
 #define BIT(s, b) (((s) >> (b)) & 1)
 
 /* Input clock */
-static uint32 clk = 844451141;
+static FCEU_TLS uint32 clk = 844451141;
 /* Sampling rate */
-static uint32 rate = 3354932;
+static FCEU_TLS uint32 rate = 3354932;
 
 /* WaveTable for each envelope amp */
-static uint16 fullsintable[PG_WIDTH];
-static uint16 halfsintable[PG_WIDTH];
+static FCEU_TLS uint16 fullsintable[PG_WIDTH];
+static FCEU_TLS uint16 halfsintable[PG_WIDTH];
 
-static uint16 *waveform[2] = { fullsintable, halfsintable };
+static FCEU_TLS uint16 *waveform[2]; /* set by makeSinTable */
 
 /* LFO Table */
-static int32 pmtable[PM_PG_WIDTH];
-static int32 amtable[AM_PG_WIDTH];
+static FCEU_TLS int32 pmtable[PM_PG_WIDTH];
+static FCEU_TLS int32 amtable[AM_PG_WIDTH];
 
 /* Phase delta for LFO */
-static uint32 pm_dphase;
-static uint32 am_dphase;
+static FCEU_TLS uint32 pm_dphase;
+static FCEU_TLS uint32 am_dphase;
 
 /* dB to Liner table */
-static int16 DB2LIN_TABLE[(DB_MUTE + DB_MUTE) * 2];
+static FCEU_TLS int16 DB2LIN_TABLE[(DB_MUTE + DB_MUTE) * 2];
 
 /* Liner to Log curve conversion table (for Attack rate). */
-static uint16 AR_ADJUST_TABLE[1 << EG_BITS];
+static FCEU_TLS uint16 AR_ADJUST_TABLE[1 << EG_BITS];
 
 /* Definition of envelope mode */
 enum
 { SETTLE, ATTACK, DECAY, SUSHOLD, SUSTINE, RELEASE, FINISH };
 
 /* Phase incr table for Attack */
-static uint32 dphaseARTable[16][16];
+static FCEU_TLS uint32 dphaseARTable[16][16];
 /* Phase incr table for Decay and Release */
-static uint32 dphaseDRTable[16][16];
+static FCEU_TLS uint32 dphaseDRTable[16][16];
 
 /* KSL + TL Table */
-static uint32 tllTable[16][8][1 << TL_BITS][4];
-static int32 rksTable[2][8][2];
+static FCEU_TLS uint32 tllTable[16][8][1 << TL_BITS][4];
+static FCEU_TLS int32 rksTable[2][8][2];
 
 /* Phase incr table for PG */
-static uint32 dphaseTable[512][8][16];
+static FCEU_TLS uint32 dphaseTable[512][8][16];
 
 /***************************************************
 
@@ -261,6 +272,9 @@ static void makeSinTable(void) {
 		halfsintable[i] = fullsintable[i];
 	for (i = PG_WIDTH / 2; i < PG_WIDTH; i++)
 		halfsintable[i] = fullsintable[0];
+
+	waveform[0] = fullsintable;
+	waveform[1] = halfsintable;
 }
 
 /* Table for Pitch Modulator */
@@ -294,7 +308,7 @@ static void makeDphaseTable(void) {
 static void makeTllTable(void) {
 #define dB2(x) ((x) * 2)
 
-	static double kltable[16] = {
+	static FCEU_TLS double kltable[16] = {
 		dB2(0.000), dB2(9.000), dB2(12.000), dB2(13.875), dB2(15.000), dB2(16.125), dB2(16.875), dB2(17.625),
 		dB2(18.000), dB2(18.750), dB2(19.125), dB2(19.500), dB2(19.875), dB2(20.250), dB2(20.625), dB2(21.000)
 	};
@@ -695,7 +709,7 @@ INLINE static void calc_phase(OPLL_SLOT * slot, int32 lfo) {
 static void calc_envelope(OPLL_SLOT * slot, int32 lfo) {
 #define S2E(x) (SL2EG((int32)(x / SL_STEP)) << (EG_DP_BITS - EG_BITS))
 
-	static uint32 SL[16] = {
+	static FCEU_TLS uint32 SL[16] = {
 		S2E(0.0), S2E(3.0), S2E(6.0), S2E(9.0), S2E(12.0), S2E(15.0), S2E(18.0), S2E(21.0),
 		S2E(24.0), S2E(27.0), S2E(30.0), S2E(33.0), S2E(36.0), S2E(39.0), S2E(42.0), S2E(48.0)
 	};
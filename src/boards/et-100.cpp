@@ -41,8 +41,8 @@
 #include "mapinc.h"
 #include "mmc3.h"
 
-static uint8 *CHRRAM;
-static uint32 CHRRAMSize;
+static FCEU_TLS uint8 *CHRRAM;
+static FCEU_TLS uint32 CHRRAMSize;
 
 static void BMC1024CA1PW(uint32 A, uint8 V) {
 	if ((EXPREGS[0]>>3)&1)
@@ -41,10 +41,10 @@ Example Game:
 #include "mapinc.h"
 #include "mmc3.h"
 
-static uint8 *CHRRAM;
-static uint32 CHRRAMSize;
-static uint8 PPUCHRBus;
-static uint8 TKSMIR[8];
+static FCEU_TLS uint8 *CHRRAM;
+static FCEU_TLS uint32 CHRRAMSize;
+static FCEU_TLS uint8 PPUCHRBus;
+static FCEU_TLS uint8 TKSMIR[8];
 
 static void BMC810131C_PW(uint32 A, uint8 V) {
 	if ((EXPREGS[0] >> 3) & 1)
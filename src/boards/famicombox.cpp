@@ -20,11 +20,11 @@
 
 #include "mapinc.h"
 
-static uint8 regs[8];
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 regs[8];
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 8, "REGS" },
 	{ 0 }
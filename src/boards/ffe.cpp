@@ -23,13 +23,13 @@
 
 #include "mapinc.h"
 
-static uint8 preg[4], creg[8], latch, ffemode;
-static uint8 IRQa, mirr;
-static int32 IRQCount, IRQLatch;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 preg[4], creg[8], latch, ffemode;
+static FCEU_TLS uint8 IRQa, mirr;
+static FCEU_TLS int32 IRQCount, IRQLatch;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ preg, 4, "PREG" },
 	{ creg, 8, "CREG" },
@@ -68,6 +68,7 @@ static DECLFW(FFEWriteMirr) {
 }
 
 static DECLFW(FFEWriteIRQ) {
+	X6502_SyncHooks();
 	switch (A) {
 	case 0x4501: IRQa = 0; X6502_IRQEnd(FCEU_IQEXT); break;
 	case 0x4502: IRQCount &= 0xFF00; IRQCount |= V; X6502_IRQEnd(FCEU_IQEXT); break;
@@ -116,6 +117,14 @@ static void FFEIRQHook(int a) {
 	}
 }
 
+static int32 FFEIRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 0x10000)
+		return 1;
+	return 0x10000 - IRQCount;
+}
+
 static void FFEClose(void)
 {
 	if (WRAM)
@@ -134,6 +143,7 @@ void Mapper6_Init(CartInfo *info) {
 	info->Power = FFEPower;
 	info->Close = FFEClose;
 	MapIRQHook = FFEIRQHook;
+	MapIRQHookBudget = FFEIRQHookBudget;
 	GameStateRestore = StateRestore;
 
 	WRAMSIZE = 8192;
@@ -25,14 +25,14 @@
 
 #include "mapinc.h"
 
-static uint8 DRegs[4];
-static uint8 Buffer, BufferShift;
+static FCEU_TLS uint8 DRegs[4];
+static FCEU_TLS uint8 Buffer, BufferShift;
 
-static uint32 WRAMSIZE;
-static uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS uint8 *WRAM = NULL;
 
-static int kanji_pos, kanji_page, r40C0;
-static int IRQa, IRQCount;
+static FCEU_TLS int kanji_pos, kanji_page, r40C0;
+static FCEU_TLS int IRQa, IRQCount;
 
 static DECLFW(MBWRAM) {
 	if (!(DRegs[3] & 0x10))
@@ -81,7 +81,7 @@ static void MMC1MIRROR(void) {
 	}
 }
 
-static uint64 lreset;
+static FCEU_TLS uint64 lreset;
 static DECLFW(MMC1_write) {
 	int n = (A >> 13) - 4;
 	if ((timestampbase + timestamp) < (lreset + 2))
@@ -137,14 +137,17 @@ static void MMC1CMReset(void) {
 static DECLFW(FNC_cmd_write) {
 	switch (A) {
 	case 0x40A6: {
+		X6502_SyncHooks();
 		IRQCount = (IRQCount & 0xFF00) | V;
 		break;
 	}
 	case 0x40A7: {
+		X6502_SyncHooks();
 		IRQCount = (IRQCount & 0x00FF) | (V << 8);
 		break;
 	}
 	case 0x40A8: {
+		X6502_SyncHooks();
 		IRQa = V;
 		break;
 	}
@@ -166,6 +169,7 @@ static DECLFW(FNC_cmd_write) {
 static DECLFR(FNC_stat_read) {
 	switch (A) {
 	case 0x40A2: {
+		X6502_SyncHooks();
 		int ret = (IRQa >> 1);
 		X6502_IRQEnd(FCEU_IQEXT);
 		IRQa = 0;
@@ -215,6 +219,14 @@ void  NFC_IRQ(int a) {
 	}
 }
 
+static int32 NFC_IRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount <= 0)
+		return 1;
+	return IRQCount;
+}
+
 static void FNS_Power(void) {
 	lreset = 0;
 	SetWriteHandler(0x8000, 0xFFFF, MMC1_write);
@@ -248,6 +260,7 @@ void FNS_Init(CartInfo *info) {
 
 	GameStateRestore = MMC1_Restore;
 	MapIRQHook = NFC_IRQ;
+	MapIRQHookBudget = NFC_IRQBudget;
 
 	WRAMSIZE = (8 + 32) * 1024;
 	WRAM = (uint8*)FCEU_gmalloc(WRAMSIZE);
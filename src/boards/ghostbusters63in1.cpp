@@ -21,12 +21,12 @@
 
 #include "mapinc.h"
 
-static uint8 reg[2], bank;
-static uint8 banks[4] = { 0, 0, 1, 2 };
-static uint8 *CHRROM = NULL;
-static uint32 CHRROMSIZE;
+static FCEU_TLS uint8 reg[2], bank;
+static FCEU_TLS uint8 banks[4] = { 0, 0, 1, 2 };
+static FCEU_TLS uint8 *CHRROM = NULL;
+static FCEU_TLS uint32 CHRROMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 2, "REGS" },
 	{ &bank, 1, "BANK" },
@@ -21,7 +21,7 @@
 #include "mapinc.h"
 #include "mmc3.h"
 
-extern uint8 m114_perm[8];
+extern FCEU_TLS uint8 m114_perm[8];
 
 static void H2288PW(uint32 A, uint8 V) {
 	if (EXPREGS[0] & 0x40) {
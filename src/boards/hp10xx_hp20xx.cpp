@@ -28,8 +28,8 @@
 #include "mmc3.h"
 #include "../ines.h"
 
-static uint8 unromchr, lock;
-static uint32 dipswitch;
+static FCEU_TLS uint8 unromchr, lock;
+static FCEU_TLS uint32 dipswitch;
 
 static void BMCHPxxCW(uint32 A, uint8 V)
 {
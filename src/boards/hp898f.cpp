@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 regs[2];
+static FCEU_TLS uint8 regs[2];
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 2, "REGS" },
 	{ 0 }
@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 regs[8];
+static FCEU_TLS uint8 regs[8];
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ regs, 8, "REGS" },
 	{ 0 }
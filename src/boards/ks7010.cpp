@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint8 preg[4], creg, mirr;
+static FCEU_TLS uint8 preg[4], creg, mirr;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ preg, 4, "PREG" },
 	{ &creg, 1, "CREG" },
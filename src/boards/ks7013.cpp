@@ -24,9 +24,9 @@
 
 #include "mapinc.h"
 
-static uint8 reg, mirr;
+static FCEU_TLS uint8 reg, mirr;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REGS" },
 	{ &mirr, 1, "MIRR" },
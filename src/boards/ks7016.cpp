@@ -26,9 +26,9 @@
 
 #include "mapinc.h"
 
-static uint8 preg;
+static FCEU_TLS uint8 preg;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &preg, 1, "PREG" },
 	{ 0 }
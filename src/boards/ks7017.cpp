@@ -23,12 +23,12 @@
 
 #include "mapinc.h"
 
-static uint8 reg, mirr;
-static int32 IRQa, IRQCount, IRQLatch;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 reg, mirr;
+static FCEU_TLS int32 IRQa, IRQCount, IRQLatch;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &mirr, 1, "MIRR" },
 	{ &reg, 1, "REGS" },
@@ -51,10 +51,12 @@ static DECLFW(UNLKS7017Write) {
 	} else if ((A & 0xFF00) == 0x5100) {
 		Sync();
 	} else if (A == 0x4020) {
+		X6502_SyncHooks();
 		X6502_IRQEnd(FCEU_IQEXT);
 		IRQCount &= 0xFF00;
 		IRQCount |= V;
 	} else if (A == 0x4021) {
+		X6502_SyncHooks();
 		X6502_IRQEnd(FCEU_IQEXT);
 		IRQCount &= 0xFF;
 		IRQCount |= V << 8;
@@ -64,6 +66,7 @@ static DECLFW(UNLKS7017Write) {
 	}
 }
 static DECLFR(FDSRead4030) {
+	X6502_SyncHooks();
 	X6502_IRQEnd(FCEU_IQEXT);
 	return X.IRQlow & FCEU_IQEXT ? 1 : 0;
 }
@@ -78,6 +81,14 @@ static void UNL7017IRQ(int a) {
 	}
 }
 
+static int32 UNL7017IRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount <= 0)
+		return 1;
+	return IRQCount;
+}
+
 static void UNLKS7017Power(void) {
 	Sync();
 	setchr8(0);
@@ -104,6 +115,7 @@ void UNLKS7017_Init(CartInfo *info) {
 	info->Power = UNLKS7017Power;
 	info->Close = UNLKS7017Close;
 	MapIRQHook = UNL7017IRQ;
+	MapIRQHookBudget = UNL7017IRQBudget;
 
 	WRAMSIZE = 8192;
 	WRAM = (uint8*)FCEU_gmalloc(WRAMSIZE);
@@ -23,9 +23,9 @@
 
 #include "mapinc.h"
 
-static uint8 reg[4];
+static FCEU_TLS uint8 reg[4];
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 4, "REGS" },
 	{ 0 }
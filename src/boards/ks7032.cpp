@@ -20,10 +20,10 @@
 
 #include "mapinc.h"
 
-static uint8 reg[8], cmd, IRQa = 0, isirqused = 0;
-static int32 IRQCount;
+static FCEU_TLS uint8 reg[8], cmd, IRQa = 0, isirqused = 0;
+static FCEU_TLS int32 IRQCount;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &cmd, 1, "CMD" },
 	{ reg, 8, "REGS" },
@@ -45,11 +45,12 @@ static DECLFW(UNLKS7032Write) {
 //	FCEU_printf("bs %04x %02x\n",A,V);
 	switch (A & 0xF000) {
 //	case 0x8FFF: reg[4]=V; Sync(); break;
-	case 0x8000: X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0x000F) | (V & 0x0F); isirqused = 1; break;
-	case 0x9000: X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0x00F0) | ((V & 0x0F) << 4); isirqused = 1; break;
-	case 0xA000: X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0x0F00) | ((V & 0x0F) << 8); isirqused = 1; break;
-	case 0xB000: X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0xF000) | (V << 12); isirqused = 1; break;
+	case 0x8000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0x000F) | (V & 0x0F); isirqused = 1; break;
+	case 0x9000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0x00F0) | ((V & 0x0F) << 4); isirqused = 1; break;
+	case 0xA000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0x0F00) | ((V & 0x0F) << 8); isirqused = 1; break;
+	case 0xB000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQCount = (IRQCount & 0xF000) | (V << 12); isirqused = 1; break;
 	case 0xC000: if (isirqused) {
+			X6502_SyncHooks();
 			X6502_IRQEnd(FCEU_IQEXT); IRQa = 1;
 	}
 		break;
@@ -69,6 +70,14 @@ static void UNLSMB2JIRQHook(int a) {
 	}
 }
 
+static int32 UNLSMB2JIRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 0xFFFF)
+		return 1;
+	return 0xFFFF - IRQCount;
+}
+
 static void UNLKS7032Power(void) {
 	Sync();
 	SetReadHandler(0x6000, 0x7FFF, CartBR);
@@ -83,6 +92,7 @@ static void StateRestore(int version) {
 void UNLKS7032_Init(CartInfo *info) {
 	info->Power = UNLKS7032Power;
 	MapIRQHook = UNLSMB2JIRQHook;
+	MapIRQHookBudget = UNLSMB2JIRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -23,13 +23,13 @@
 
 #include "mapinc.h"
 
-static uint8 reg[8], cmd;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 reg[8], cmd;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static void (*WSync)(void);
+static FCEU_TLS void (*WSync)(void);
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &cmd, 1, "CMD" },
 	{ reg, 8, "REGS" },
@@ -23,8 +23,8 @@
 
 #include "mapinc.h"
 
-static uint8 reg[8], mirror;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 reg[8], mirror;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 8, "PRG" },
 	{ &mirror, 1, "MIRR" },
@@ -23,8 +23,8 @@
 
 #include "mapinc.h"
 
-static uint8 chr;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 chr;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &chr, 1, "CHR" },
 	{ 0 }
@@ -23,12 +23,12 @@
 
 #include "mapinc.h"
 
-static uint8 reg, IRQa;
-static int32 IRQCount;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 reg, IRQa;
+static FCEU_TLS int32 IRQCount;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &reg, 1, "REG" },
 	{ &IRQa, 1, "IRQA" },
@@ -60,6 +60,7 @@ static DECLFW(LH53Write) {
 }
 
 static DECLFW(LH53IRQaWrite) {
+	X6502_SyncHooks();
 	IRQa = V & 2;
 	IRQCount = 0;
 	if (!IRQa)
@@ -74,6 +75,14 @@ static void LH53IRQ(int a) {
 	}
 }
 
+static int32 LH53IRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount > 7560)
+		return 1;
+	return 7561 - IRQCount;
+}
+
 static void LH53Power(void) {
 	Sync();
 	SetReadHandler(0x6000, 0xFFFF, CartBR);
@@ -97,6 +106,7 @@ void LH53_Init(CartInfo *info) {
 	info->Power = LH53Power;
 	info->Close = LH53Close;
 	MapIRQHook = LH53IRQ;
+	MapIRQHookBudget = LH53IRQBudget;
 	GameStateRestore = StateRestore;
 
 	WRAMSIZE = 8192;
@@ -20,9 +20,9 @@
 
 #include "mapinc.h"
 
-static uint16 latche;
+static FCEU_TLS uint16 latche;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &latche, 2, "LATC" },
 	{ 0 }
@@ -24,18 +24,18 @@
 static void GenMMC1Power(void);
 static void GenMMC1Init(CartInfo *info, int prg, int chr, int wram, int bram);
 
-static uint8 DRegs[4];
-static uint8 Buffer, BufferShift;
+static FCEU_TLS uint8 DRegs[4];
+static FCEU_TLS uint8 Buffer, BufferShift;
 
-static uint32 WRAMSIZE;
-static uint32 NONBRAMSIZE; // size of non-battery-backed portion of WRAM
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS uint32 NONBRAMSIZE; // size of non-battery-backed portion of WRAM
 
-static void (*MMC1CHRHook4)(uint32 A, uint8 V);
-static void (*MMC1PRGHook16)(uint32 A, uint8 V);
+static FCEU_TLS void (*MMC1CHRHook4)(uint32 A, uint8 V);
+static FCEU_TLS void (*MMC1PRGHook16)(uint32 A, uint8 V);
 
-static uint8 *WRAM = NULL;
-static uint8 *CHRRAM = NULL;
-static int is155, is171;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint8 *CHRRAM = NULL;
+static FCEU_TLS int is155, is171;
 
 static DECLFW(MBWRAM) {
 	if (!(DRegs[3] & 0x10) || is155)
@@ -121,7 +121,7 @@ static void MMC1MIRROR(void) {
 		}
 }
 
-static uint64 lreset;
+static FCEU_TLS uint64 lreset;
 static DECLFW(MMC1_write) {
 	int n = (A >> 13) - 4;
 
@@ -215,8 +215,8 @@ static int DetectMMC1WRAMSize(CartInfo *info, int *bs) {
 	return ws;
 }
 
-static uint32 NWCIRQCount;
-static uint8 NWCRec;
+static FCEU_TLS uint32 NWCIRQCount;
+static FCEU_TLS uint8 NWCRec;
 #define NWCDIP 0xE
 
 static void NWCIRQHook(int a) {
@@ -229,7 +229,21 @@ static void NWCIRQHook(int a) {
 	}
 }
 
+static int32 NWCIRQHookBudget(void) {
+	uint32 v;
+	if (NWCRec & 0x10)
+		return 0x7FFFFFFF;
+	// the test above only looks at bits 25 and up, so find the first such step the count reaches
+	for (v = NWCIRQCount >> 25; v < 0x80; v++)
+		if (((v << 25) | (NWCDIP << 25)) >= 0x3e000000)
+			break;
+	if ((v << 25) <= NWCIRQCount)
+		return 1;
+	return (v << 25) - NWCIRQCount;
+}
+
 static void NWCCHRHook(uint32 A, uint8 V) {
+	X6502_SyncHooks();
 	if ((V & 0x10)) { // && !(NWCRec&0x10))
 		NWCIRQCount = 0;
 		X6502_IRQEnd(FCEU_IQEXT);
@@ -259,6 +273,7 @@ void Mapper105_Init(CartInfo *info) {
 	MMC1CHRHook4 = NWCCHRHook;
 	MMC1PRGHook16 = NWCPRGHook;
 	MapIRQHook = NWCIRQHook;
+	MapIRQHookBudget = NWCIRQHookBudget;
 	info->Power = NWCPower;
 }
 
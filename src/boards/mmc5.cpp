@@ -31,8 +31,8 @@
 #define PPUON       (PPU[1] & 0x18)	//PPU should operate
 #define Sprite16    (PPU[0] & 0x20)	//Sprites 8x16/8x8
 
-static void (*sfun)(int P);
-static void (*psfun)(void);
+static FCEU_TLS void (*sfun)(int P);
+static FCEU_TLS void (*psfun)(void);
 
 void MMC5RunSound(int Count);
 void MMC5RunSoundHQ(void);
@@ -83,32 +83,32 @@ static INLINE void MMC5BGVROM_BANK8(uint32 V) {
 	}
 }
 
-static std::array<uint8,4> PRGBanks;
-static uint8 WRAMPage;
-static std::array<uint16,8> CHRBanksA;
-static std::array<uint16,4> CHRBanksB;
-static std::array<uint8,2> WRAMMaskEnable;
-uint8 mmc5ABMode;                /* A=0, B=1 */
+static FCEU_TLS std::array<uint8,4> PRGBanks;
+static FCEU_TLS uint8 WRAMPage;
+static FCEU_TLS std::array<uint16,8> CHRBanksA;
+static FCEU_TLS std::array<uint16,4> CHRBanksB;
+static FCEU_TLS std::array<uint8,2> WRAMMaskEnable;
+FCEU_TLS uint8 mmc5ABMode;                /* A=0, B=1 */
 
-static uint8 IRQScanline, IRQEnable;
-static uint8 CHRMode, NTAMirroring, NTFill, ATFill;
+static FCEU_TLS uint8 IRQScanline, IRQEnable;
+static FCEU_TLS uint8 CHRMode, NTAMirroring, NTFill, ATFill;
 
-static uint8 MMC5IRQR;
-static uint8 MMC5LineCounter;
-static uint8 mmc5psize, mmc5vsize;
-static std::array<uint8,2> mul;
+static FCEU_TLS uint8 MMC5IRQR;
+static FCEU_TLS uint8 MMC5LineCounter;
+static FCEU_TLS uint8 mmc5psize, mmc5vsize;
+static FCEU_TLS std::array<uint8,2> mul;
 
-static uint32 WRAMSIZE = 0;
-static uint8 *WRAM = NULL;
-static uint8 *MMC5fill = NULL;
-static uint8 *ExRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE = 0;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint8 *MMC5fill = NULL;
+static FCEU_TLS uint8 *ExRAM = NULL;
 
 const int MMC5WRAMMAX = 1<<7; // 7 bits in register interface (real MMC5 has only 4 pins, however)
-static uint8 MMC5WRAMsize; //configuration, not state
-static uint8 MMC5WRAMIndex[MMC5WRAMMAX]; //configuration, not state
+static FCEU_TLS uint8 MMC5WRAMsize; //configuration, not state
+static FCEU_TLS uint8 MMC5WRAMIndex[MMC5WRAMMAX]; //configuration, not state
 
-static std::array<uint8,4> MMC5ROMWrProtect;
-static std::array<uint8,5> MMC5MemIn;
+static FCEU_TLS std::array<uint8,4> MMC5ROMWrProtect;
+static FCEU_TLS std::array<uint8,5> MMC5MemIn;
 
 static void MMC5CHRA(void);
 static void MMC5CHRB(void);
@@ -149,8 +149,8 @@ uint8* MMC5BGVRAMADR(uint32 A)
 
 static void mmc5_PPUWrite(uint32 A, uint8 V) {
 	uint32 tmp = A;
-	extern uint8 PALRAM[0x20];
-	extern uint8 UPALRAM[0x03];
+	extern FCEU_TLS uint8 PALRAM[0x20];
+	extern FCEU_TLS uint8 UPALRAM[0x03];
 
 	if (tmp >= 0x3F00) {
 		if (!(tmp & 3)) {
@@ -171,7 +171,7 @@ static void mmc5_PPUWrite(uint32 A, uint8 V) {
 	}
 }
 
-extern uint32 NTRefreshAddr;
+extern FCEU_TLS uint32 NTRefreshAddr;
 uint8 FASTCALL mmc5_PPURead(uint32 A)
 {
 	bool split = false;
@@ -274,7 +274,7 @@ uint8 FASTCALL mmc5_PPURead(uint32 A)
 	}
 }
 
-cartdata MMC5CartList[] =
+FCEU_TLS cartdata MMC5CartList[] =
 {
 	{ 0x6f4e4312, 4 }, /* Aoki Ookami to Shiroki Mejika - Genchou Hishi */
 	{ 0x15fe6d0f, 2 }, /* Bandit Kings of Ancient China */
@@ -707,7 +707,7 @@ typedef struct {
 	int32 vcount[2];
 } MMC5APU;
 
-static MMC5APU MMC5Sound;
+static FCEU_TLS MMC5APU MMC5Sound;
 
 
 static void Do5PCM() {
@@ -772,7 +772,7 @@ static DECLFW(Mapper5_SW) {
 }
 
 static void Do5SQ(int P) {
-	static int tal[4] = { 1, 2, 4, 6 };
+	static FCEU_TLS int tal[4] = { 1, 2, 4, 6 };
 	int32 V, amp, rthresh, wl;
 	int32 start, end;
 
@@ -807,7 +807,7 @@ static void Do5SQ(int P) {
 }
 
 static void Do5SQHQ(int P) {
-	static int tal[4] = { 1, 2, 4, 6 };
+	static FCEU_TLS int tal[4] = { 1, 2, 4, 6 };
 	uint32 V;
 	int32 amp, rthresh, wl;
 
@@ -948,7 +948,7 @@ static void GenMMC5Power(void) {
 	FCEU_CheatAddRAM(1, 0x5c00, ExRAM);
 }
 
-static SFORMAT MMC5_StateRegs[] = {
+static FCEU_TLS SFORMAT MMC5_StateRegs[] = {
 	{ &PRGBanks, 4, "PRGB" },
 	{ &CHRBanksA, 16, "CHRA" },
 	{ &CHRBanksB, 8, "CHRB" },
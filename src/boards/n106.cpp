@@ -20,11 +20,11 @@
 
 #include "mapinc.h"
 
-static uint16 IRQCount;
-static uint8 IRQa;
+static FCEU_TLS uint16 IRQCount;
+static FCEU_TLS uint8 IRQa;
 
-static uint8 WRAM[8192];
-static uint8 IRAM[128];
+static FCEU_TLS uint8 WRAM[8192];
+static FCEU_TLS uint8 IRAM[128];
 
 static DECLFR(AWRAM) {
 	return(WRAM[A - 0x6000]);
@@ -36,11 +36,11 @@ static DECLFW(BWRAM) {
 
 void Mapper19_ESI(void);
 
-static uint8 NTAPage[4];
+static FCEU_TLS uint8 NTAPage[4];
 
-static uint8 dopol;
-static uint8 gorfus;
-static uint8 gorko;
+static FCEU_TLS uint8 dopol;
+static FCEU_TLS uint8 gorfus;
+static FCEU_TLS uint8 gorko;
 
 static void NamcoSound(int Count);
 static void NamcoSoundHack(void);
@@ -48,12 +48,12 @@ static void DoNamcoSound(int32 *Wave, int Count);
 static void DoNamcoSoundHQ(void);
 static void SyncHQ(int32 ts);
 
-static int is210;        /* Lesser mapper. */
+static FCEU_TLS int is210;        /* Lesser mapper. */
 
-static uint8 PRG[3];
-static uint8 CHR[8];
+static FCEU_TLS uint8 PRG[3];
+static FCEU_TLS uint8 CHR[8];
 
-static SFORMAT N106_StateRegs[] = {
+static FCEU_TLS SFORMAT N106_StateRegs[] = {
 	{ PRG, 3, "PRG" },
 	{ CHR, 8, "CHR" },
 	{ NTAPage, 4, "NTA" },
@@ -92,6 +92,14 @@ static void NamcoIRQHook(int a) {
 	}
 }
 
+static int32 NamcoIRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 0x7FFF)
+		return 1;
+	return 0x7FFF - IRQCount;
+}
+
 static DECLFR(Namco_Read4800) {
 	uint8 ret = IRAM[dopol & 0x7f];
 	/* Maybe I should call NamcoSoundHack() here? */
@@ -104,10 +112,12 @@ static DECLFR(Namco_Read4800) {
 }
 
 static DECLFR(Namco_Read5000) {
+	X6502_SyncHooks();
 	return(IRQCount);
 }
 
 static DECLFR(Namco_Read5800) {
+	X6502_SyncHooks();
 	return(IRQCount >> 8);
 }
 
@@ -146,9 +156,9 @@ static DECLFW(Mapper19C0D8_write) {
 	DoNTARAMROM((A - 0xC000) >> 11, V);
 }
 
-static uint32 FreqCache[8];
-static uint32 EnvCache[8];
-static uint32 LengthCache[8];
+static FCEU_TLS uint32 FreqCache[8];
+static FCEU_TLS uint32 EnvCache[8];
+static FCEU_TLS uint32 LengthCache[8];
 
 static void FixCache(int a, int V) {
 	int w = (a >> 3) & 0x7;
@@ -189,8 +199,10 @@ static DECLFW(Mapper19_write) {
 		case 0xf800:
 			dopol = V; break;
 		case 0x5000:
+			X6502_SyncHooks();
 			IRQCount &= 0xFF00; IRQCount |= V; X6502_IRQEnd(FCEU_IQEXT); break;
 		case 0x5800:
+			X6502_SyncHooks();
 			IRQCount &= 0x00ff; IRQCount |= (V & 0x7F) << 8;
 			IRQa = V & 0x80;
 			X6502_IRQEnd(FCEU_IQEXT);
@@ -216,7 +228,7 @@ static DECLFW(Mapper19_write) {
 		}
 }
 
-static int dwave = 0;
+static FCEU_TLS int dwave = 0;
 
 static void NamcoSoundHack(void) {
 	int32 z, a;
@@ -238,9 +250,9 @@ static void NamcoSound(int Count) {
 	dwave = 0;
 }
 
-static uint32 PlayIndex[8];
-static int32 vcount[8];
-static int32 CVBC;
+static FCEU_TLS uint32 PlayIndex[8];
+static FCEU_TLS int32 vcount[8];
+static FCEU_TLS int32 CVBC;
 
 #define TOINDEX        (16 + 1)
 
@@ -378,7 +390,7 @@ void NSFN106_Init(void) {
 	Mapper19_ESI();
 }
 
-static int battery = 0;
+static FCEU_TLS int battery = 0;
 
 static void N106_Power(void) {
 	int x;
@@ -416,6 +428,7 @@ void Mapper19_Init(CartInfo *info) {
 	info->Power = N106_Power;
 
 	MapIRQHook = NamcoIRQHook;
+	MapIRQHookBudget = NamcoIRQHookBudget;
 	GameStateRestore = Mapper19_StateRestore;
 	GameExpSound.RChange = M19SC;
 
@@ -24,9 +24,9 @@
 
 #include "mapinc.h"
 
-static uint16 cmd, bank;
+static FCEU_TLS uint16 cmd, bank;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &cmd, 2, "CMD" },
 	{ &bank, 2, "BANK" },
@@ -50,7 +50,7 @@ static void Sync(void) {
 	}
 }
 
-static uint16 ass = 0;
+static FCEU_TLS uint16 ass = 0;
 
 static DECLFW(UNLN625092WriteCommand) {
 	cmd = A;
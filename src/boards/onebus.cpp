@@ -28,26 +28,26 @@
 #include "mapinc.h"
 
 // General Purpose Registers
-static uint8 cpu410x[16], ppu201x[16], apu40xx[64];
+static FCEU_TLS uint8 cpu410x[16], ppu201x[16], apu40xx[64];
 
 // IRQ Registers
-static uint8 IRQCount, IRQa, IRQReload;
+static FCEU_TLS uint8 IRQCount, IRQa, IRQReload;
 #define IRQLatch cpu410x[0x1]	// accc cccc, a = 0, AD12 switching, a = 1, HSYNC switching
 
 // MMC3 Registers
-static uint8 inv_hack = 0;		// some OneBus Systems have swapped PRG reg commans in MMC3 inplementation,
+static FCEU_TLS uint8 inv_hack = 0;		// some OneBus Systems have swapped PRG reg commans in MMC3 inplementation,
 								// trying to autodetect unusual behavior, due not to add a new mapper.
 #define mmc3cmd  cpu410x[0x5]	// pcv- ----, p - program swap, c - video swap, v - internal VRAM enable
 #define mirror   cpu410x[0x6]	// ---- ---m, m = 0 - H, m = 1 - V
 
 // APU Registers
-static uint8 pcm_enable = 0, pcm_irq = 0;
-static int16 pcm_addr, pcm_size, pcm_latch, pcm_clock = 0xE1;
+static FCEU_TLS uint8 pcm_enable = 0, pcm_irq = 0;
+static FCEU_TLS int16 pcm_addr, pcm_size, pcm_latch, pcm_clock = 0xE1;
 
-static writefunc defapuwrite[64];
-static readfunc defapuread[64];
+static FCEU_TLS writefunc defapuwrite[64];
+static FCEU_TLS readfunc defapuread[64];
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ cpu410x, 16, "REGC" },
 	{ ppu201x, 16, "REGS" },
@@ -181,6 +181,7 @@ static void UNLOneBusIRQHook(void) {
 
 static DECLFW(UNLOneBusWriteAPU40XX) {
 //	if(((A & 0x3f)!=0x16) && ((apu40xx[0x30] & 0x10) || ((A & 0x3f)>0x17)))FCEU_printf("APU %04x:%04x\n",A,V);
+	X6502_SyncHooks();
 	apu40xx[A & 0x3f] = V;
 	switch (A & 0x3f) {
 	case 0x12:
@@ -215,6 +216,7 @@ static DECLFR(UNLOneBusReadAPU40XX) {
 	switch (A & 0x3f) {
 	case 0x15:
 		if (apu40xx[0x30] & 0x10) {
+			X6502_SyncHooks();
 			result = (result & 0x7f) | pcm_irq;
 		}
 		break;
@@ -243,6 +245,15 @@ static void UNLOneBusCpuHook(int a) {
 	}
 }
 
+// the hook plays at most one sample per call, so it only has to run when the latch runs out
+static int32 UNLOneBusCpuHookBudget(void) {
+	if (!pcm_enable)
+		return 0x7FFFFFFF;
+	if (pcm_latch <= 0)
+		return 1;
+	return pcm_latch;
+}
+
 static void UNLOneBusPower(void) {
 	uint32 i;
 	IRQReload = IRQCount = IRQa = 0;
@@ -292,6 +303,7 @@ void UNLOneBus_Init(CartInfo *info) {
 
 	GameHBIRQHook = UNLOneBusIRQHook;
 	MapIRQHook = UNLOneBusCpuHook;
+	MapIRQHookBudget = UNLOneBusCpuHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -23,19 +23,19 @@
 
 #include "mapinc.h"
 
-static uint8 reg[8];
-static uint32 lastnt = 0;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 reg[8];
+static FCEU_TLS uint32 lastnt = 0;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 2, "REG" },
 	{ &lastnt, 4, "LNT" },
 	{ 0 }
 };
 
-static uint8 bs_tbl[128] = {
+static FCEU_TLS uint8 bs_tbl[128] = {
 	0x03, 0x13, 0x23, 0x33, 0x03, 0x13, 0x23, 0x33, 0x03, 0x13, 0x23, 0x33, 0x03, 0x13, 0x23, 0x33, // 00
 	0x45, 0x67, 0x45, 0x67, 0x45, 0x67, 0x45, 0x67, 0x45, 0x67, 0x45, 0x67, 0x45, 0x67, 0x45, 0x67, // 10
 	0x03, 0x13, 0x23, 0x33, 0x03, 0x13, 0x23, 0x33, 0x03, 0x13, 0x23, 0x33, 0x03, 0x13, 0x23, 0x33, // 20
@@ -46,7 +46,7 @@ static uint8 bs_tbl[128] = {
 	0x47, 0x67, 0x47, 0x67, 0x47, 0x67, 0x47, 0x67, 0x47, 0x67, 0x47, 0x67, 0x47, 0x67, 0x47, 0x67, // 70
 };
 
-static uint8 br_tbl[16] = {
+static FCEU_TLS uint8 br_tbl[16] = {
 	0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
 };
 
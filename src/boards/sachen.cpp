@@ -20,8 +20,8 @@
 
 #include "mapinc.h"
 
-static uint8 cmd, dip;
-static uint8 latch[8];
+static FCEU_TLS uint8 cmd, dip;
+static FCEU_TLS uint8 latch[8];
 
 static void S74LS374MSync(uint8 mirr) {
 	switch (mirr & 3) {
@@ -130,7 +130,7 @@ void S74LS374NA_Init(CartInfo *info) {
 	AddExState(&cmd, 1, 0, "CMD");
 }
 
-static int type;
+static FCEU_TLS int type;
 static void S8259Synco(void) {
 	int x;
 	setprg32(0x8000, latch[5] & 7);
@@ -223,7 +223,7 @@ void S8259D_Init(CartInfo *info) { // Kevin's Horton 137 mapper
 	type = 3;
 }
 
-static void (*WSync)(void);
+static FCEU_TLS void (*WSync)(void);
 
 static DECLFW(SAWrite) {
 	if (A & 0x100) {
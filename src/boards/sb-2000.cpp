@@ -20,17 +20,17 @@
 
 #include "mapinc.h"
 
-static uint8 preg[8];
-static uint8 IRQa;
-static int16 IRQCount, IRQLatch;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 preg[8];
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS int16 IRQCount, IRQLatch;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 /*
 static uint8 *CHRRAM = NULL;
 static uint32 CHRRAMSIZE;
 */
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ preg, 8, "PREG" },
 	{ &IRQa, 1, "IRQA" },
@@ -22,12 +22,12 @@
 
 #include "mapinc.h"
 
-static uint8 reg[8], chr[8];
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-static uint16 IRQCount, IRQa;
+static FCEU_TLS uint8 reg[8], chr[8];
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+static FCEU_TLS uint16 IRQCount, IRQa;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ reg, 8, "REGS" },
 	{ chr, 8, "CHRS" },
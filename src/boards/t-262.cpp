@@ -20,8 +20,8 @@
 
 #include "mapinc.h"
 
-static uint8 bank, base, lock, mirr, mode;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 bank, base, lock, mirr, mode;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &bank, 1, "BANK" },
 	{ &base, 1, "BASE" },
@@ -20,10 +20,10 @@
 
 #include "mapinc.h"
 
-static uint8 cmd, mirr, regs[11];
-static uint8 rmode, IRQmode, IRQCount, IRQa, IRQLatch;
+static FCEU_TLS uint8 cmd, mirr, regs[11];
+static FCEU_TLS uint8 rmode, IRQmode, IRQCount, IRQa, IRQLatch;
 
-static SFORMAT StateRegs[] = {
+static FCEU_TLS SFORMAT StateRegs[] = {
 	{ regs, 11, "REGS" },
 	{ &cmd, 1, "CMDR" },
 	{ &mirr, 1, "MIRR" },
@@ -35,8 +35,9 @@ static SFORMAT StateRegs[] = {
 	{ 0 }
 };
 
+static FCEU_TLS int32 smallcount;
+
 static void M64IRQHook(int a) {
-	static int32 smallcount;
 	if (IRQmode) {
 		smallcount += a;
 		while (smallcount >= 4) {
@@ -48,6 +49,15 @@ static void M64IRQHook(int a) {
 	}
 }
 
+static int32 M64IRQHookBudget(void) {
+	if (!IRQmode || !IRQa)
+		return 0x7FFFFFFF;
+	// the counter wraps to 0xFF after IRQCount + 1 steps of 4 cycles
+	if (4 * (IRQCount + 1) <= smallcount)
+		return 1;
+	return 4 * (IRQCount + 1) - smallcount;
+}
+
 static void M64HBHook(void) {
 	if ((!IRQmode) && (scanline != 240)) {
 		rmode = 0;
@@ -94,22 +104,26 @@ static DECLFW(M64Write) {
 		Sync();
 		break;
 	case 0xC000:
+		X6502_SyncHooks();
 		IRQLatch = V;
 		if (rmode == 1)
 			IRQCount = IRQLatch;
 		break;
 	case 0xC001:
+		X6502_SyncHooks();
 		rmode = 1;
 		IRQCount = IRQLatch;
 		IRQmode = V & 1;
 		break;
 	case 0xE000:
+		X6502_SyncHooks();
 		IRQa = 0;
 		X6502_IRQEnd(FCEU_IQEXT);
 		if (rmode == 1)
 			IRQCount = IRQLatch;
 		break;
 	case 0xE001:
+		X6502_SyncHooks();
 		IRQa = 1;
 		if (rmode == 1)
 			IRQCount = IRQLatch;
@@ -134,6 +148,7 @@ void Mapper64_Init(CartInfo *info) {
 	info->Power = M64Power;
 	GameHBIRQHook = M64HBHook;
 	MapIRQHook = M64IRQHook;
+	MapIRQHookBudget = M64IRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -20,13 +20,13 @@
 
 #include "mapinc.h"
 
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
 unsigned int *GetKeyboard(void);	// FIXME: 10/28 - now implemented in SDL as well.  should we rename this to a FCEUI_* function?
 
-static unsigned int *TransformerKeys, oldkeys[256];
-static int TransformerCycleCount, TransformerChar = 0;
+static FCEU_TLS unsigned int *TransformerKeys, oldkeys[256];
+static FCEU_TLS int TransformerCycleCount, TransformerChar = 0;
 
 static void TransformerIRQHook(int a) {
 	TransformerCycleCount += a;
@@ -49,6 +49,12 @@ static void TransformerIRQHook(int a) {
 	}
 }
 
+static int32 TransformerIRQHookBudget(void) {
+	if (TransformerCycleCount >= 1000)
+		return 1;
+	return 1000 - TransformerCycleCount;
+}
+
 static DECLFR(TransformerRead) {
 	uint8 ret = 0;
 	switch (A & 3) {
@@ -74,6 +80,7 @@ static void TransformerPower(void) {
 	FCEU_CheatAddRAM(WRAMSIZE >> 10, 0x6000, WRAM);
 
 	MapIRQHook = TransformerIRQHook;
+	MapIRQHookBudget = TransformerIRQHookBudget;
 }
 
 static void TransformerClose(void) {
@@ -35,17 +35,17 @@
 #include "mapinc.h"
 #include "../ines.h"
 
-static uint8 latche, latcheinit, bus_conflict, chrram_mask, software_id=false;
-static uint16 latcha;
-static uint8 *flashdata;
-static uint32 *flash_write_count;
-static uint8 *FlashPage[32];
-static uint32 *FlashWriteCountPage[32];
-static uint8 flashloaded = false;
+static FCEU_TLS uint8 latche, latcheinit, bus_conflict, chrram_mask, software_id=false;
+static FCEU_TLS uint16 latcha;
+static FCEU_TLS uint8 *flashdata;
+static FCEU_TLS uint32 *flash_write_count;
+static FCEU_TLS uint8 *FlashPage[32];
+static FCEU_TLS uint32 *FlashWriteCountPage[32];
+static FCEU_TLS uint8 flashloaded = false;
 
-static uint8 flash_save=0, flash_state=0, flash_mode=0, flash_bank;
-static void (*WLSync)(void);
-static void (*WHSync)(void);
+static FCEU_TLS uint8 flash_save=0, flash_state=0, flash_mode=0, flash_bank;
+static FCEU_TLS void (*WLSync)(void);
+static FCEU_TLS void (*WHSync)(void);
 
 static INLINE void setfpageptr(int s, uint32 A, uint8 *p) {
 	uint32 AB = A >> 11;
@@ -23,8 +23,8 @@
 
 #include "mapinc.h"
 
-static uint8 preg[3], creg[2], mode;
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 preg[3], creg[2], mode;
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &mode, 1, "MODE" },
 	{ creg, 2, "CREG" },
@@ -20,20 +20,20 @@
 
 #include "mapinc.h"
 
-static bool isPirate;
-static uint8 is22, reg1mask, reg2mask;
-static uint16 IRQCount;
-static uint8 IRQLatch, IRQa;
-static uint8 prgreg[2], chrreg[8];
-static uint16 chrhi[8];
-static uint8 regcmd, irqcmd, mirr, big_bank;
-static uint16 acount = 0;
-static uint16 weirdo = 0;
-
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-
-static SFORMAT StateRegs[] =
+static FCEU_TLS bool isPirate;
+static FCEU_TLS uint8 is22, reg1mask, reg2mask;
+static FCEU_TLS uint16 IRQCount;
+static FCEU_TLS uint8 IRQLatch, IRQa;
+static FCEU_TLS uint8 prgreg[2], chrreg[8];
+static FCEU_TLS uint16 chrhi[8];
+static FCEU_TLS uint8 regcmd, irqcmd, mirr, big_bank;
+static FCEU_TLS uint16 acount = 0;
+static FCEU_TLS uint16 weirdo = 0;
+
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ prgreg, 2, "PREG" },
 	{ chrreg, 8, "CREG" },
@@ -120,10 +120,10 @@ static DECLFW(VRC24Write) {
 		case 0x9001: if (V != 0xFF) mirr = V; Sync(); break;
 		case 0x9002:
 		case 0x9003: regcmd = V; Sync(); break;
-		case 0xF000: X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0xF0; IRQLatch |= V & 0xF; break;
-		case 0xF001: X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0x0F; IRQLatch |= V << 4; break;
-		case 0xF002: X6502_IRQEnd(FCEU_IQEXT); acount = 0; IRQCount = IRQLatch; IRQa = V & 2; irqcmd = V & 1; break;
-		case 0xF003: X6502_IRQEnd(FCEU_IQEXT); IRQa = irqcmd; break;
+		case 0xF000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0xF0; IRQLatch |= V & 0xF; break;
+		case 0xF001: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQLatch &= 0x0F; IRQLatch |= V << 4; break;
+		case 0xF002: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); acount = 0; IRQCount = IRQLatch; IRQa = V & 2; irqcmd = V & 1; break;
+		case 0xF003: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQa = irqcmd; break;
 		}
 }
 
@@ -157,6 +157,13 @@ void VRC24IRQHook(int a) {
 	}
 }
 
+// cycles until the prescaler has ticked IRQCount over to 0x100
+static int32 VRC24IRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	return ((0x100 - IRQCount) * LCYCS - acount + 2) / 3;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -171,6 +178,7 @@ static void VRC24_Init(CartInfo *info) {
 	info->Power = VRC24Power;
 	info->Close = VRC24Close;
 	MapIRQHook = VRC24IRQHook;
+	MapIRQHookBudget = VRC24IRQHookBudget;
 	GameStateRestore = StateRestore;
 
 	WRAMSIZE = 8192;
@@ -23,15 +23,15 @@
 
 #include "mapinc.h"
 
-static uint8 preg;
-static uint8 IRQx;	//autoenable
-static uint8 IRQm;	//mode
-static uint8 IRQa;
-static uint16 IRQReload, IRQCount;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 preg;
+static FCEU_TLS uint8 IRQx;	//autoenable
+static FCEU_TLS uint8 IRQm;	//mode
+static FCEU_TLS uint8 IRQa;
+static FCEU_TLS uint16 IRQReload, IRQCount;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &preg, 1, "PREG" },
 	{ &IRQa, 1, "IRQA" },
@@ -56,6 +56,7 @@ static DECLFW(M73Write) {
 	case 0xA000: IRQReload &= 0xF0FF; IRQReload |= (V & 0xF) << 8;  break;
 	case 0xB000: IRQReload &= 0x0FFF; IRQReload |= (V & 0xF) << 12; break;
 	case 0xC000:
+		X6502_SyncHooks();
 		IRQm = V & 4;
 		IRQx = V & 1;
 		IRQa = V & 2;
@@ -68,7 +69,7 @@ static DECLFW(M73Write) {
 		}
 		X6502_IRQEnd(FCEU_IQEXT);
 		break;
-	case 0xD000: X6502_IRQEnd(FCEU_IQEXT); IRQa = IRQx; break;
+	case 0xD000: X6502_SyncHooks(); X6502_IRQEnd(FCEU_IQEXT); IRQa = IRQx; break;
 	case 0xF000: preg = V; Sync(); break;
 	}
 }
@@ -100,6 +101,15 @@ static void M73IRQHook(int a) {
 	}
 }
 
+// cycles until the counter (its low byte in 8-bit mode) wraps
+static int32 M73IRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQm)
+		return 0x100 - (IRQCount & 0xFF);
+	return 0x10000 - IRQCount;
+}
+
 static void M73Power(void) {
 	IRQReload = IRQm = IRQx = 0;
 	Sync();
@@ -124,6 +134,7 @@ void Mapper73_Init(CartInfo *info) {
 	info->Power = M73Power;
 	info->Close = M73Close;
 	MapIRQHook = M73IRQHook;
+	MapIRQHookBudget = M73IRQHookBudget;
 
 	WRAMSIZE = 8192;
 	WRAM = (uint8*)FCEU_gmalloc(WRAMSIZE);
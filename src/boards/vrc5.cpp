@@ -31,16 +31,16 @@
 // bankings here.
 // extra NT RAM handling is in PPU code now.
 
-static uint16 CHRSIZE = 8192;
+static FCEU_TLS uint16 CHRSIZE = 8192;
 // there are two separate WRAMs 8K each, on main system cartridge (not battery
 // backed), and one on the daughter cart (with battery). both are accessed
 // via the same registers with additional selector flags.
-static uint16 WRAMSIZE = 8192 + 8192;
-static uint8 *CHRRAM = NULL;
-static uint8 *WRAM = NULL;
+static FCEU_TLS uint16 WRAMSIZE = 8192 + 8192;
+static FCEU_TLS uint8 *CHRRAM = NULL;
+static FCEU_TLS uint8 *WRAM = NULL;
 
-static uint8 IRQa, K4IRQ;
-static uint32 IRQLatch, IRQCount;
+static FCEU_TLS uint8 IRQa, K4IRQ;
+static FCEU_TLS uint32 IRQLatch, IRQCount;
 
 // some kind of 16-bit text  encoding (actually 14-bit) used in game resources
 // may be converted by the hardware into the tile indexes for internal CHR ROM
@@ -52,7 +52,7 @@ static uint32 IRQLatch, IRQCount;
 // table read out from hardware registers as is
 
 ///*
-static uint8 conv_tbl[4][8] = {
+static FCEU_TLS uint8 conv_tbl[4][8] = {
 	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
 	{ 0x00, 0x00, 0x40, 0x10, 0x28, 0x00, 0x18, 0x30 },
 	{ 0x00, 0x00, 0x48, 0x18, 0x30, 0x08, 0x20, 0x38 },
@@ -128,8 +128,8 @@ static uint8 conv_tbl[64][4] = {
 };
 */
 
-static uint8 regs[16];
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 regs[16];
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &IRQCount, 1, "IRQC" },
 	{ &IRQLatch, 1, "IRQL" },
@@ -169,10 +169,10 @@ static void Sync(void) {
 static DECLFW(QTAiWrite) {
 	regs[(A & 0x0F00) >> 8] = V;	// IRQ pretty the same as in other VRC mappers by Konami
 	switch (A) {
-	case 0xd600: IRQLatch &= 0xFF00; IRQLatch |= V; break;
-	case 0xd700: IRQLatch &= 0x00FF; IRQLatch |= V << 8; break;
-	case 0xd900: IRQCount = IRQLatch; IRQa = V & 2; K4IRQ = V & 1; X6502_IRQEnd(FCEU_IQEXT); break;
-	case 0xd800: IRQa = K4IRQ; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xd600: X6502_SyncHooks(); IRQLatch &= 0xFF00; IRQLatch |= V; break;
+	case 0xd700: X6502_SyncHooks(); IRQLatch &= 0x00FF; IRQLatch |= V << 8; break;
+	case 0xd900: X6502_SyncHooks(); IRQCount = IRQLatch; IRQa = V & 2; K4IRQ = V & 1; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xd800: X6502_SyncHooks(); IRQa = K4IRQ; X6502_IRQEnd(FCEU_IQEXT); break;
 	case 0xda00: qtaintramreg = regs[0xA] & 3;	break; // register shadow to share it with ppu
 	}
 	Sync();
@@ -213,6 +213,15 @@ static void VRC5IRQ(int a) {
 	}
 }
 
+// cycles until IRQCount carries into bit 16
+static int32 VRC5IRQBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount >= 0x10000)
+		return 1;
+	return 0x10000 - IRQCount;
+}
+
 static void QTAiPower(void) {
 	SetReadHandler(0x6000, 0xFFFF, CartBR);
 	SetWriteHandler(0x6000, 0x7FFF, CartBW);
@@ -244,6 +253,7 @@ void QTAi_Init(CartInfo *info) {
 	GameStateRestore = StateRestore;
 
 	MapIRQHook = VRC5IRQ;
+	MapIRQHookBudget = VRC5IRQBudget;
 
 	CHRRAM = (uint8*)FCEU_gmalloc(CHRSIZE);
 	SetupCartCHRMapping(0x10, CHRRAM, CHRSIZE, 1);
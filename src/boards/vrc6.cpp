@@ -23,14 +23,14 @@
 
 #include "mapinc.h"
 
-static uint8 is26;
-static uint8 prg[2], chr[8], mirr;
-static uint8 IRQLatch, IRQa, IRQd;
-static int32 IRQCount, CycleCount;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
-
-static SFORMAT StateRegs[] =
+static FCEU_TLS uint8 is26;
+static FCEU_TLS uint8 prg[2], chr[8], mirr;
+static FCEU_TLS uint8 IRQLatch, IRQa, IRQd;
+static FCEU_TLS int32 IRQCount, CycleCount;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
+
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ prg, 2, "PRG" },
 	{ chr, 8, "CHR" },
@@ -43,14 +43,14 @@ static SFORMAT StateRegs[] =
 	{ 0 }
 };
 
-static void(*sfun[3]) (void);
-static uint8 vpsg1[8];
-static uint8 vpsg2[4];
-static int32 cvbc[3];
-static int32 vcount[3];
-static int32 dcount[2];
+static FCEU_TLS void(*sfun[3]) (void);
+static FCEU_TLS uint8 vpsg1[8];
+static FCEU_TLS uint8 vpsg2[4];
+static FCEU_TLS int32 cvbc[3];
+static FCEU_TLS int32 vcount[3];
+static FCEU_TLS int32 dcount[2];
 
-static SFORMAT SStateRegs[] =
+static FCEU_TLS SFORMAT SStateRegs[] =
 {
 	{ vpsg1, 8, "PSG1" },
 	{ vpsg2, 4, "PSG2" },
@@ -107,8 +107,9 @@ static DECLFW(VRC6Write) {
 	case 0xE001: chr[5] = V; Sync(); break;
 	case 0xE002: chr[6] = V; Sync(); break;
 	case 0xE003: chr[7] = V; Sync(); break;
-	case 0xF000: IRQLatch = V; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xF000: X6502_SyncHooks(); IRQLatch = V; X6502_IRQEnd(FCEU_IQEXT); break;
 	case 0xF001:
+		X6502_SyncHooks();
 		IRQa = V & 2;
 		IRQd = V & 1;
 		if (V & 2)
@@ -117,6 +118,7 @@ static DECLFW(VRC6Write) {
 		X6502_IRQEnd(FCEU_IQEXT);
 		break;
 	case 0xF002:
+		X6502_SyncHooks();
 		IRQa = IRQd;
 		X6502_IRQEnd(FCEU_IQEXT);
 	}
@@ -144,6 +146,13 @@ static void VRC6IRQHook(int a) {
 	}
 }
 
+// cycles until CycleCount has ticked IRQCount over to 0x100
+static int32 VRC6IRQHookBudget(void) {
+	if (!IRQa || IRQCount > 0xFF)
+		return 0x7FFFFFFF;
+	return ((0x100 - IRQCount) * 341 - CycleCount + 2) / 3;
+}
+
 static void VRC6Close(void)
 {
 	if (WRAM)
@@ -209,11 +218,11 @@ static void DoSawV(void) {
 	cvbc[2] = end;
 
 	if (vpsg2[2] & 0x80) {
-		static int32 saw1phaseacc = 0;
+		static FCEU_TLS int32 saw1phaseacc = 0;
 		uint32 freq3;
-		static uint8 b3 = 0;
-		static int32 phaseacc = 0;
-		static uint32 duff = 0;
+		static FCEU_TLS uint8 b3 = 0;
+		static FCEU_TLS int32 phaseacc = 0;
+		static FCEU_TLS uint32 duff = 0;
 
 		freq3 = (vpsg2[1] + ((vpsg2[2] & 15) << 8) + 1);
 
@@ -273,8 +282,8 @@ static void DoSQV2HQ(void) {
 }
 
 static void DoSawVHQ(void) {
-	static uint8 b3 = 0;
-	static int32 phaseacc = 0;
+	static FCEU_TLS uint8 b3 = 0;
+	static FCEU_TLS int32 phaseacc = 0;
 	int32 V;
 
 	if (vpsg2[2] & 0x80) {
@@ -347,6 +356,7 @@ void Mapper24_Init(CartInfo *info) {
 	is26 = 0;
 	info->Power = VRC6Power;
 	MapIRQHook = VRC6IRQHook;
+	MapIRQHookBudget = VRC6IRQHookBudget;
 	VRC6_ESI();
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
@@ -357,6 +367,7 @@ void Mapper26_Init(CartInfo *info) {
 	info->Power = VRC6Power;
 	info->Close = VRC6Close;
 	MapIRQHook = VRC6IRQHook;
+	MapIRQHookBudget = VRC6IRQHookBudget;
 	VRC6_ESI();
 	GameStateRestore = StateRestore;
 
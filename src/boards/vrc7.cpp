@@ -20,19 +20,19 @@
 
 #include "mapinc.h"
 
-static uint8 vrc7idx, preg[3], creg[8], mirr;
-static uint8 IRQLatch, IRQa, IRQd;
-static int32 IRQCount, CycleCount;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 vrc7idx, preg[3], creg[8], mirr;
+static FCEU_TLS uint8 IRQLatch, IRQa, IRQd;
+static FCEU_TLS int32 IRQCount, CycleCount;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
 #include "emu2413.h"
 
-static int32 dwave = 0;
-static OPLL *VRC7Sound = NULL;
-static OPLL **VRC7Sound_saveptr = &VRC7Sound;
+static FCEU_TLS int32 dwave = 0;
+static FCEU_TLS OPLL *VRC7Sound = NULL;
+static FCEU_TLS OPLL **VRC7Sound_saveptr = &VRC7Sound;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &vrc7idx, 1, "VRCI" },
 	{ preg, 3, "PREG" },
@@ -132,8 +132,9 @@ static DECLFW(VRC7Write) {
 		case 0x9000: preg[2] = V; Sync(); break;
 		case 0x9010: vrc7idx = V; break;
 		case 0xE000: mirr = V & 3; Sync(); break;
-		case 0xE010: IRQLatch = V; X6502_IRQEnd(FCEU_IQEXT); break;
+		case 0xE010: X6502_SyncHooks(); IRQLatch = V; X6502_IRQEnd(FCEU_IQEXT); break;
 		case 0xF000:
+			X6502_SyncHooks();
 			IRQa = V & 2;
 			IRQd = V & 1;
 			if (V & 2)
@@ -142,6 +143,7 @@ static DECLFW(VRC7Write) {
 			X6502_IRQEnd(FCEU_IQEXT);
 			break;
 		case 0xF010:
+			X6502_SyncHooks();
 			IRQa = IRQd;
 			X6502_IRQEnd(FCEU_IQEXT);
 			break;
@@ -177,6 +179,13 @@ static void VRC7IRQHook(int a) {
 	}
 }
 
+// cycles until CycleCount has ticked IRQCount over to 0x100
+static int32 VRC7IRQHookBudget(void) {
+	if (!IRQa || IRQCount > 0xFF)
+		return 0x7FFFFFFF;
+	return ((0x100 - IRQCount) * 341 - CycleCount + 2) / 3;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -185,6 +194,7 @@ void Mapper85_Init(CartInfo *info) {
 	info->Power = VRC7Power;
 	info->Close = VRC7Close;
 	MapIRQHook = VRC7IRQHook;
+	MapIRQHookBudget = VRC7IRQHookBudget;
 	WRAMSIZE = 8192;
 	WRAM = (uint8*)FCEU_gmalloc(WRAMSIZE);
 	SetupCartPRGMapping(0x10, WRAM, WRAMSIZE, 1);
@@ -22,11 +22,11 @@
 
 #include "mapinc.h"
 
-static uint8 prg[3], chr[8], mirr;
-static uint8 IRQLatch, IRQa, IRQd;
-static int32 IRQCount, CycleCount;
+static FCEU_TLS uint8 prg[3], chr[8], mirr;
+static FCEU_TLS uint8 IRQLatch, IRQa, IRQd;
+static FCEU_TLS int32 IRQCount, CycleCount;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ prg, 3, "PRG" },
 	{ chr, 8, "CHR" },
@@ -69,8 +69,9 @@ static DECLFW(UNLVRC7Write) {
 	case 0xd000: chr[6] = V; Sync(); break;
 	case 0xd008: chr[7] = V; Sync(); break;
 	case 0xe000: mirr = V; Sync(); break;
-	case 0xe008: IRQLatch = V; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0xe008: X6502_SyncHooks(); IRQLatch = V; X6502_IRQEnd(FCEU_IQEXT); break;
 	case 0xf000:
+		X6502_SyncHooks();
 		IRQa = V & 2;
 		IRQd = V & 1;
 		if (V & 2)
@@ -79,6 +80,7 @@ static DECLFW(UNLVRC7Write) {
 		X6502_IRQEnd(FCEU_IQEXT);
 		break;
 	case 0xf008:
+		X6502_SyncHooks();
 		if (IRQd)
 			IRQa = 1;
 		else
@@ -108,6 +110,13 @@ static void UNLVRC7IRQHook(int a) {
 	}
 }
 
+// cycles until CycleCount has ticked IRQCount up to 248
+static int32 UNLVRC7IRQHookBudget(void) {
+	if (!IRQa || IRQCount >= 248)
+		return 0x7FFFFFFF;
+	return ((248 - IRQCount) * 341 - CycleCount + 2) / 3;
+}
+
 static void StateRestore(int version) {
 	Sync();
 }
@@ -115,6 +124,7 @@ static void StateRestore(int version) {
 void UNLVRC7_Init(CartInfo *info) {
 	info->Power = UNLVRC7Power;
 	MapIRQHook = UNLVRC7IRQHook;
+	MapIRQHookBudget = UNLVRC7IRQHookBudget;
 	GameStateRestore = StateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
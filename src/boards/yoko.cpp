@@ -28,14 +28,14 @@
 
 #include "mapinc.h"
 
-static uint8 mode, bank, reg[11], low[4], dip, IRQa;
-static int32 IRQCount;
-static uint8 *WRAM = NULL;
-static uint32 WRAMSIZE;
+static FCEU_TLS uint8 mode, bank, reg[11], low[4], dip, IRQa;
+static FCEU_TLS int32 IRQCount;
+static FCEU_TLS uint8 *WRAM = NULL;
+static FCEU_TLS uint32 WRAMSIZE;
 
-static uint8 is2kbank, isnot2kbank;
+static FCEU_TLS uint8 is2kbank, isnot2kbank;
 
-static SFORMAT StateRegs[] =
+static FCEU_TLS SFORMAT StateRegs[] =
 {
 	{ &mode, 1, "MODE" },
 	{ &bank, 1, "BANK" },
@@ -103,8 +103,8 @@ static DECLFW(UNLYOKOWrite) {
 	switch (A & 0x8C17) {
 	case 0x8000: bank = V; UNLYOKOSync(); break;
 	case 0x8400: mode = V; UNLYOKOSync(); break;
-	case 0x8800: IRQCount &= 0xFF00; IRQCount |= V; X6502_IRQEnd(FCEU_IQEXT); break;
-	case 0x8801: IRQa = mode & 0x80; IRQCount &= 0xFF; IRQCount |= V << 8; break;
+	case 0x8800: X6502_SyncHooks(); IRQCount &= 0xFF00; IRQCount |= V; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0x8801: X6502_SyncHooks(); IRQa = mode & 0x80; IRQCount &= 0xFF; IRQCount |= V << 8; break;
 	case 0x8c00: reg[0] = V; UNLYOKOSync(); break;
 	case 0x8c01: reg[1] = V; UNLYOKOSync(); break;
 	case 0x8c02: reg[2] = V; UNLYOKOSync(); break;
@@ -122,8 +122,8 @@ static DECLFW(M83Write) {
 	case 0xB0FF:                                              // Dragon Ball Z Party [p1] BMC
 	case 0xB1FF: bank = V; mode |= 0x40; M83Sync(); break;    // Dragon Ball Z Party [p1] BMC
 	case 0x8100: mode = V | (mode & 0x40); M83Sync(); break;
-	case 0x8200: IRQCount &= 0xFF00; IRQCount |= V; X6502_IRQEnd(FCEU_IQEXT); break;
-	case 0x8201: IRQa = mode & 0x80; IRQCount &= 0xFF; IRQCount |= V << 8; break;
+	case 0x8200: X6502_SyncHooks(); IRQCount &= 0xFF00; IRQCount |= V; X6502_IRQEnd(FCEU_IQEXT); break;
+	case 0x8201: X6502_SyncHooks(); IRQa = mode & 0x80; IRQCount &= 0xFF; IRQCount |= V << 8; break;
 	case 0x8300: reg[8] = V; mode &= 0xBF; M83Sync(); break;
 	case 0x8301: reg[9] = V; mode &= 0xBF; M83Sync(); break;
 	case 0x8302: reg[10] = V; mode &= 0xBF; M83Sync(); break;
@@ -205,6 +205,14 @@ static void UNLYOKOIRQHook(int a) {
 	}
 }
 
+static int32 UNLYOKOIRQHookBudget(void) {
+	if (!IRQa)
+		return 0x7FFFFFFF;
+	if (IRQCount < 0)
+		return 1;
+	return IRQCount + 1;
+}
+
 static void UNLYOKOStateRestore(int version) {
 	UNLYOKOSync();
 }
@@ -217,6 +225,7 @@ void UNLYOKO_Init(CartInfo *info) {
 	info->Power = UNLYOKOPower;
 	info->Reset = UNLYOKOReset;
 	MapIRQHook = UNLYOKOIRQHook;
+	MapIRQHookBudget = UNLYOKOIRQHookBudget;
 	GameStateRestore = UNLYOKOStateRestore;
 	AddExState(&StateRegs, ~0, 0, 0);
 }
@@ -226,6 +235,7 @@ void Mapper83_Init(CartInfo *info) {
 	info->Reset = M83Reset;
 	info->Close = M83Close;
 	MapIRQHook = UNLYOKOIRQHook;
+	MapIRQHookBudget = UNLYOKOIRQHookBudget;
 	GameStateRestore = M83StateRestore;
 
 	WRAMSIZE = 8192;
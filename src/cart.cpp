@@ -38,45 +38,45 @@
 #include <cstdio>
 #include <climits>
 
-uint8 *Page[32], *VPage[8];
-uint8 **VPageR = VPage;
-uint8 *VPageG[8];
-uint8 *MMC5SPRVPage[8];
-uint8 *MMC5BGVPage[8];
+FCEU_TLS uint8 *Page[32], *VPage[8];
+FCEU_TLS uint8 **VPageR = VPage;
+FCEU_TLS uint8 *VPageG[8];
+FCEU_TLS uint8 *MMC5SPRVPage[8];
+FCEU_TLS uint8 *MMC5BGVPage[8];
 
-static uint8 PRGIsRAM[32];  /* This page is/is not PRG RAM. */
+FCEU_TLS uint8 PRGIsRAM[32];  /* This page is/is not PRG RAM. */
 
 /* 16 are (sort of) reserved for UNIF/iNES and 16 to map other stuff. */
-uint8 CHRram[32];
-uint8 PRGram[32];
+FCEU_TLS uint8 CHRram[32];
+FCEU_TLS uint8 PRGram[32];
 
-uint8 *PRGptr[32];
-uint8 *CHRptr[32];
+FCEU_TLS uint8 *PRGptr[32];
+FCEU_TLS uint8 *CHRptr[32];
 
-uint32 PRGsize[32];
-uint32 CHRsize[32];
+FCEU_TLS uint32 PRGsize[32];
+FCEU_TLS uint32 CHRsize[32];
 
-uint32 PRGmask2[32];
-uint32 PRGmask4[32];
-uint32 PRGmask8[32];
-uint32 PRGmask16[32];
-uint32 PRGmask32[32];
+FCEU_TLS uint32 PRGmask2[32];
+FCEU_TLS uint32 PRGmask4[32];
+FCEU_TLS uint32 PRGmask8[32];
+FCEU_TLS uint32 PRGmask16[32];
+FCEU_TLS uint32 PRGmask32[32];
 
-uint32 CHRmask1[32];
-uint32 CHRmask2[32];
-uint32 CHRmask4[32];
-uint32 CHRmask8[32];
+FCEU_TLS uint32 CHRmask1[32];
+FCEU_TLS uint32 CHRmask2[32];
+FCEU_TLS uint32 CHRmask4[32];
+FCEU_TLS uint32 CHRmask8[32];
 
-int geniestage = 0;
+FCEU_TLS int geniestage = 0;
 
-int modcon;
+FCEU_TLS int modcon;
 
-uint8 genieval[3];
-uint8 geniech[3];
+FCEU_TLS uint8 genieval[3];
+FCEU_TLS uint8 geniech[3];
 
-uint32 genieaddr[3];
+FCEU_TLS uint32 genieaddr[3];
 
-CartInfo *currCartInfo;
+FCEU_TLS CartInfo *currCartInfo;
 
 static INLINE void setpageptr(int s, uint32 A, uint8 *p, int ram) {
 	uint32 AB = A >> 11;
@@ -94,7 +94,7 @@ static INLINE void setpageptr(int s, uint32 A, uint8 *p, int ram) {
 		}
 }
 
-static uint8 nothing[8192];
+static FCEU_TLS uint8 nothing[8192];
 void ResetCartMapping(void) {
 	int x;
 
@@ -299,7 +299,7 @@ void setntamem(uint8 *p, int ram, uint32 b) {
 		PPUNTARAM |= 1 << b;
 }
 
-static int mirrorhard = 0;
+static FCEU_TLS int mirrorhard = 0;
 void setmirrorw(int a, int b, int c, int d) {
 	FCEUPPU_LineUpdate();
 	vnapage[0] = NTARAM + a * 0x400;
@@ -343,7 +343,7 @@ void SetupCartMirroring(int m, int hard, uint8 *extra) {
 	mirrorhard = hard;
 }
 
-static uint8 *GENIEROM = 0;
+static FCEU_TLS uint8 *GENIEROM = 0;
 
 void FixGenieMap(void);
 
@@ -454,7 +454,7 @@ static DECLFW(GenieWrite) {
 	}
 }
 
-static readfunc GenieBackup[3];
+static FCEU_TLS readfunc GenieBackup[3];
 
 static DECLFR(GenieFix1) {
 	uint8 r = GenieBackup[0](A);
@@ -554,7 +554,7 @@ void FCEU_SaveGameSave(CartInfo *LocalHWInfo) {
 }
 
 // hack, movie.cpp has to communicate with this function somehow
-int disableBatteryLoading = 0;
+FCEU_TLS int disableBatteryLoading = 0;
 
 void FCEU_LoadGameSave(CartInfo *LocalHWInfo) {
 	if (LocalHWInfo->battery && LocalHWInfo->SaveGame[0] && !disableBatteryLoading) {
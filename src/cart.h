@@ -28,13 +28,13 @@ typedef struct {
 					// other code in the future.
 } CartInfo;
 
-extern CartInfo *currCartInfo;
+extern FCEU_TLS CartInfo *currCartInfo;
 
 void FCEU_SaveGameSave(CartInfo *LocalHWInfo);
 void FCEU_LoadGameSave(CartInfo *LocalHWInfo);
 void FCEU_ClearGameSave(CartInfo *LocalHWInfo);
 
-extern uint8 *Page[32], *VPage[8], *MMC5SPRVPage[8], *MMC5BGVPage[8];
+extern FCEU_TLS uint8 *Page[32], *VPage[8], *MMC5SPRVPage[8], *MMC5BGVPage[8];
 
 void ResetCartMapping(void);
 void SetupCartPRGMapping(int chip, uint8 *p, uint32 size, int ram);
@@ -45,25 +45,26 @@ DECLFR(CartBROB);
 DECLFR(CartBR);
 DECLFW(CartBW);
 
-extern uint8 PRGram[32];
-extern uint8 CHRram[32];
+extern FCEU_TLS uint8 PRGram[32];
+extern FCEU_TLS uint8 PRGIsRAM[32];
+extern FCEU_TLS uint8 CHRram[32];
 
-extern uint8 *PRGptr[32];
-extern uint8 *CHRptr[32];
+extern FCEU_TLS uint8 *PRGptr[32];
+extern FCEU_TLS uint8 *CHRptr[32];
 
-extern uint32 PRGsize[32];
-extern uint32 CHRsize[32];
+extern FCEU_TLS uint32 PRGsize[32];
+extern FCEU_TLS uint32 CHRsize[32];
 
-extern uint32 PRGmask2[32];
-extern uint32 PRGmask4[32];
-extern uint32 PRGmask8[32];
-extern uint32 PRGmask16[32];
-extern uint32 PRGmask32[32];
+extern FCEU_TLS uint32 PRGmask2[32];
+extern FCEU_TLS uint32 PRGmask4[32];
+extern FCEU_TLS uint32 PRGmask8[32];
+extern FCEU_TLS uint32 PRGmask16[32];
+extern FCEU_TLS uint32 PRGmask32[32];
 
-extern uint32 CHRmask1[32];
-extern uint32 CHRmask2[32];
-extern uint32 CHRmask4[32];
-extern uint32 CHRmask8[32];
+extern FCEU_TLS uint32 CHRmask1[32];
+extern FCEU_TLS uint32 CHRmask2[32];
+extern FCEU_TLS uint32 CHRmask4[32];
+extern FCEU_TLS uint32 CHRmask8[32];
 
 void setprg2(uint32 A, uint32 V);
 void setprg4(uint32 A, uint32 V);
@@ -96,7 +97,7 @@ void setntamem(uint8 *p, int ram, uint32 b);
 #define MI_0 2
 #define MI_1 3
 
-extern int geniestage;
+extern FCEU_TLS int geniestage;
 
 void FCEU_GeniePower(void);
 
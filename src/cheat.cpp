@@ -36,10 +36,10 @@
 
 using namespace std;
 
-static uint8 *CheatRPtrs[64];
+static FCEU_TLS uint8 *CheatRPtrs[64];
 
-vector<uint16> FrozenAddresses;			//List of addresses that are currently frozen
-unsigned int FrozenAddressCount = 0;		//Keeps up with the Frozen address count, necessary for using in other dialogs (such as hex editor)
+FCEU_TLS vector<uint16> FrozenAddresses;			//List of addresses that are currently frozen
+FCEU_TLS unsigned int FrozenAddressCount = 0;		//Keeps up with the Frozen address count, necessary for using in other dialogs (such as hex editor)
 
 void FCEU_CheatResetRAM(void)
 {
@@ -59,21 +59,21 @@ void FCEU_CheatAddRAM(int s, uint32 A, uint8 *p)
 }
 
 
-CHEATF_SUBFAST SubCheats[256] = { 0 };
-uint32 numsubcheats = 0;
-int globalCheatDisabled = 0;
-int disableAutoLSCheats = 0;
-bool disableShowGG = 0;
-static _8BYTECHEATMAP* cheatMap = NULL;
-struct CHEATF *cheats = 0, *cheatsl = 0;
+FCEU_TLS CHEATF_SUBFAST SubCheats[256] = { 0 };
+FCEU_TLS uint32 numsubcheats = 0;
+FCEU_TLS int globalCheatDisabled = 0;
+FCEU_TLS int disableAutoLSCheats = 0;
+FCEU_TLS bool disableShowGG = 0;
+static FCEU_TLS _8BYTECHEATMAP* cheatMap = NULL;
+FCEU_TLS struct CHEATF *cheats = 0, *cheatsl = 0;
 
 
 #define CHEATC_NONE     0x8000
 #define CHEATC_EXCLUDED 0x4000
 #define CHEATC_NOSHOW   0xC000
 
-static uint16 *CheatComp = 0;
-int savecheats = 0;
+static FCEU_TLS uint16 *CheatComp = 0;
+FCEU_TLS int savecheats = 0;
 
 static DECLFR(SubCheatsRead)
 {
@@ -493,7 +493,7 @@ int FCEUI_GetCheat(uint32 which, char **name, uint32 *a, uint8 *v, int *compare,
 
 static int GGtobin(char c)
 {
-	static char lets[16]={'A','P','Z','L','G','I','T','Y','E','O','X','U','K','S','V','N'};
+	static FCEU_TLS char lets[16]={'A','P','Z','L','G','I','T','Y','E','O','X','U','K','S','V','N'};
 	int x;
 
 	for(x=0;x<16;x++)
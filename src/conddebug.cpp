@@ -51,11 +51,11 @@
 #include <cassert>
 #include <cctype>
 
-uint16 debugLastAddress = 0; // used by 'T' and 'R' conditions
-uint8 debugLastOpcode; // used to evaluate 'W' condition
+FCEU_TLS uint16 debugLastAddress = 0; // used by 'T' and 'R' conditions
+FCEU_TLS uint8 debugLastOpcode; // used to evaluate 'W' condition
 
 // Next non-whitespace character in string
-char next;
+FCEU_TLS char next;
 
 int ishex(char c)
 {
@@ -76,6 +76,7 @@ void freeTree(Condition* c)
 {
 	if (c->lhs) freeTree(c->lhs);
 	if (c->rhs) freeTree(c->rhs);
+	if (c->code) free(c->code);
 
 	free(c);
 }
@@ -519,5 +520,193 @@ Condition* generateCondition(const char* str)
 	c = Connect(&str);
 
 	if (!c || next != 0) return 0;
-	else return c;
+
+	// Conditions are evaluated for every matching instruction, so compile them once here
+	c->code = compileCondition(c);
+	return c;
+}
+
+/*
+* Bytecode compiler
+*
+* Emits a CC_* program that computes the same value as evaluate() in debug.cpp,
+* so checking a breakpoint neither recurses nor re-dispatches on node types.
+* Subtrees made of numbers only are folded into one CC_NUM, reads from constant
+* addresses become CC_MEM, and || and && skip their right side once the result is known
+* (reads done for conditions have no side effects).
+*/
+
+typedef struct
+{
+	int* code;
+	int len;
+	int depth;
+	int maxDepth;
+} CondCompiler;
+
+static void emit(CondCompiler* cc, int v)
+{
+	cc->code[cc->len++] = v;
+}
+
+static void pushed(CondCompiler* cc)
+{
+	if (++cc->depth > cc->maxDepth) cc->maxDepth = cc->depth;
+}
+
+static int countNodes(Condition* c)
+{
+	return 1 + (c->lhs ? countNodes(c->lhs) : 0) + (c->rhs ? countNodes(c->rhs) : 0);
+}
+
+// Computes the value of c if it does not depend on the machine state
+static int foldCondition(Condition* c, int* value)
+{
+	int value1, value2;
+
+	if (c->type1 != TYPE_NO && c->type1 != TYPE_NUM) return 0;
+
+	if (c->lhs)
+	{
+		if (!foldCondition(c->lhs, &value1)) return 0;
+	}
+	else if (c->type1 == TYPE_NUM)
+	{
+		value1 = c->value1;
+	}
+	else
+	{
+		return 0;
+	}
+
+	if (!c->op)
+	{
+		*value = value1;
+		return 1;
+	}
+
+	if (c->type2 != TYPE_NO && c->type2 != TYPE_NUM) return 0;
+
+	if (c->rhs)
+	{
+		if (!foldCondition(c->rhs, &value2)) return 0;
+	}
+	else
+	{
+		// evaluate() reads a missing right side through getValue(type2), which is 0 for TYPE_NO
+		value2 = c->type2 == TYPE_NUM ? c->value2 : 0;
+	}
+
+	*value = applyConditionOp(c->op, value1, value2);
+	return 1;
+}
+
+static void compileNode(CondCompiler* cc, Condition* c);
+
+// Emits code pushing one side of a node: (lhs, type1, value1) or (rhs, type2, value2)
+static void compileOperand(CondCompiler* cc, Condition* sub, unsigned int type, unsigned int value, int first)
+{
+	int address;
+
+	switch (type)
+	{
+		// These replace whatever the subtree computed
+		case TYPE_PC_BANK: emit(cc, CC_PC_BANK); pushed(cc); return;
+		case TYPE_DATA_BANK: emit(cc, CC_DATA_BANK); pushed(cc); return;
+		case TYPE_VALUE_READ: emit(cc, CC_VALUE_READ); pushed(cc); return;
+		case TYPE_VALUE_WRITE: emit(cc, CC_VALUE_WRITE); pushed(cc); return;
+
+		case TYPE_ADDR:
+			if (!sub || foldCondition(sub, &address))
+			{
+				emit(cc, CC_MEM);
+				emit(cc, (sub ? address : (int)value) & 0xFFFF);
+				pushed(cc);
+			}
+			else
+			{
+				compileNode(cc, sub);
+				emit(cc, CC_MEMIND);
+			}
+			return;
+	}
+
+	if (sub)
+	{
+		compileNode(cc, sub);
+	}
+	else if (type == TYPE_NUM)
+	{
+		emit(cc, CC_NUM);
+		emit(cc, value);
+		pushed(cc);
+	}
+	else
+	{
+		// evaluate() looks up the right side by its type rather than its value
+		emit(cc, CC_REG);
+		emit(cc, first ? value : type);
+		pushed(cc);
+	}
+}
+
+static void compileNode(CondCompiler* cc, Condition* c)
+{
+	int value;
+
+	if (foldCondition(c, &value))
+	{
+		emit(cc, CC_NUM);
+		emit(cc, value);
+		pushed(cc);
+		return;
+	}
+
+	compileOperand(cc, c->lhs, c->type1, c->value1, 1);
+
+	if (!c->op) return;
+
+	if (c->op == OP_OR || c->op == OP_AND)
+	{
+		int at;
+
+		emit(cc, c->op == OP_OR ? CC_JUMP_TRUE : CC_JUMP_FALSE);
+		at = cc->len;
+		emit(cc, 0);
+		cc->depth--;
+
+		compileOperand(cc, c->rhs, c->type2, c->value2, 0);
+		emit(cc, CC_BOOL);
+
+		cc->code[at] = cc->len - (at + 1);
+	}
+	else
+	{
+		compileOperand(cc, c->rhs, c->type2, c->value2, 0);
+		emit(cc, CC_BINOP);
+		emit(cc, c->op);
+		cc->depth--;
+	}
+}
+
+int* compileCondition(Condition* c)
+{
+	CondCompiler cc;
+
+	// No node emits more than 9 ints of its own
+	cc.code = (int*)malloc(sizeof(int) * (countNodes(c) * 10 + 1));
+	if (!cc.code)
+		return 0;
+	cc.len = cc.depth = cc.maxDepth = 0;
+
+	compileNode(&cc, c);
+	emit(&cc, CC_END);
+
+	if (cc.maxDepth > COND_STACK_SIZE)
+	{
+		free(cc.code);
+		return 0;
+	}
+
+	return cc.code;
 }
@@ -47,8 +47,26 @@
 #define OP_OR 11
 #define OP_AND 12
 
-extern uint16 debugLastAddress;
-extern uint8 debugLastOpcode;
+//opcodes of a compiled condition, see compileCondition().
+//a small stack machine over int; operands follow their opcode in the code array.
+#define CC_END 0
+#define CC_NUM 1        //push operand
+#define CC_MEM 2        //push the byte at constant address operand
+#define CC_MEMIND 3     //replace top with the byte at that address
+#define CC_REG 4        //push getValue(operand)
+#define CC_PC_BANK 5
+#define CC_DATA_BANK 6
+#define CC_VALUE_READ 7
+#define CC_VALUE_WRITE 8
+#define CC_BINOP 9      //pop rhs, apply OP_* operand to top and rhs
+#define CC_JUMP_TRUE 10 //if top is nonzero, set it to 1 and skip operand ints; else pop
+#define CC_JUMP_FALSE 11 //if top is zero, skip operand ints; else pop
+#define CC_BOOL 12      //top = top != 0
+
+#define COND_STACK_SIZE 32
+
+extern FCEU_TLS uint16 debugLastAddress;
+extern FCEU_TLS uint8 debugLastOpcode;
 
 //mbg merge 7/18/06 turned into sane c++
 struct Condition
@@ -63,9 +81,36 @@ struct Condition
 
 	unsigned int type2;
 	unsigned int value2;
+
+	//compiled form, only on the root returned by generateCondition(). null if it could not be compiled
+	int* code;
 };
 
 void freeTree(Condition* c);
 Condition* generateCondition(const char* str);
 
+//applies a binary OP_* to two evaluated operands
+static INLINE int applyConditionOp(unsigned int op, int value1, int value2)
+{
+	switch (op)
+	{
+		case OP_EQ: return value1 == value2;
+		case OP_NE: return value1 != value2;
+		case OP_GE: return value1 >= value2;
+		case OP_LE: return value1 <= value2;
+		case OP_G: return value1 > value2;
+		case OP_L: return value1 < value2;
+		case OP_MULT: return value1 * value2;
+		case OP_DIV: return (value2==0) ? 0 : (value1 / value2);
+		case OP_PLUS: return value1 + value2;
+		case OP_MINUS: return value1 - value2;
+		case OP_OR: return value1 || value2;
+		case OP_AND: return value1 && value2;
+	}
+	return value1;
+}
+
+//compiles c into a CC_END terminated program (free() it), or returns null if it is too deep
+int* compileCondition(Condition* c);
+
 #endif
@@ -11,7 +11,7 @@
 #include <cstdio>
 #include <cstdlib>
 
-static char *aboutString = 0;
+static FCEU_TLS char *aboutString = 0;
 
 // returns a string suitable for use in an aboutbox
 char *FCEUI_GetAboutString() {
@@ -14,9 +14,9 @@
 #include <cstdlib>
 #include <cstring>
 
-unsigned int debuggerPageSize = 14;
-int vblankScanLines = 0;	//Used to calculate scanlines 240-261 (vblank)
-int vblankPixel = 0;		//Used to calculate the pixels in vblank
+FCEU_TLS unsigned int debuggerPageSize = 14;
+FCEU_TLS int vblankScanLines = 0;	//Used to calculate scanlines 240-261 (vblank)
+FCEU_TLS int vblankPixel = 0;		//Used to calculate the pixels in vblank
 
 int offsetStringToInt(unsigned int type, const char* offsetBuffer)
 {
@@ -336,6 +336,55 @@ uint8 evaluateWrite(uint8 opcode, uint16 address)
 	return 0;
 }
 
+//reads for CC_MEM and CC_MEMIND. plain ram and prg pages are read directly, the rest through GetMem
+static INLINE int conditionMem(uint32 A)
+{
+	if (GameInfo)
+	{
+		if (A < 0x2000 && RAMDirect)
+			return RAM[A & 0x7FF];
+		if (PRGDirect[A >> 11] && Page[A >> 11])
+			return Page[A >> 11][A];
+	}
+	return GetMem(A);
+}
+
+//runs a program made by compileCondition()
+static int runCondition(const int* code)
+{
+	int stack[COND_STACK_SIZE];
+	int top = -1;
+
+	for (;;)
+	{
+		switch (*code++)
+		{
+			case CC_END: return stack[0];
+			case CC_NUM: stack[++top] = *code++; break;
+			case CC_MEM: stack[++top] = conditionMem(*code++); break;
+			case CC_MEMIND: stack[top] = conditionMem(stack[top] & 0xFFFF); break;
+			case CC_REG: stack[++top] = getValue(*code++); break;
+			case CC_PC_BANK: stack[++top] = getBank(_PC); break;
+			case CC_DATA_BANK: stack[++top] = getBank(debugLastAddress); break;
+			case CC_VALUE_READ: stack[++top] = GetMem(debugLastAddress); break;
+			case CC_VALUE_WRITE: stack[++top] = evaluateWrite(debugLastOpcode, debugLastAddress); break;
+			case CC_BINOP:
+				top--;
+				stack[top] = applyConditionOp(*code++, stack[top], stack[top + 1]);
+				break;
+			case CC_JUMP_TRUE:
+				if (stack[top]) { stack[top] = 1; code += *code + 1; }
+				else { top--; code++; }
+				break;
+			case CC_JUMP_FALSE:
+				if (!stack[top]) code += *code + 1;
+				else { top--; code++; }
+				break;
+			case CC_BOOL: stack[top] = stack[top] != 0; break;
+		}
+	}
+}
+
 // Evaluates a condition
 int evaluate(Condition* c)
 {
@@ -343,6 +392,9 @@ int evaluate(Condition* c)
 
 	int value1, value2;
 
+	if (c->code)
+		return runCondition(c->code);
+
 	if (c->lhs)
 	{
 		value1 = evaluate(c->lhs);
@@ -393,21 +445,7 @@ int evaluate(Condition* c)
 		case TYPE_VALUE_WRITE: value2 = evaluateWrite(debugLastOpcode, debugLastAddress); break;
 	}
 
-		switch (c->op)
-		{
-			case OP_EQ: f = value1 == value2; break;
-			case OP_NE: f = value1 != value2; break;
-			case OP_GE: f = value1 >= value2; break;
-			case OP_LE: f = value1 <= value2; break;
-			case OP_G: f = value1 > value2; break;
-			case OP_L: f = value1 < value2; break;
-			case OP_MULT: f = value1 * value2; break;
-			case OP_DIV: f = (value2==0) ? 0 : (value1 / value2); break;
-			case OP_PLUS: f = value1 + value2; break;
-			case OP_MINUS: f = value1 - value2; break;
-			case OP_OR: f = value1 || value2; break;
-			case OP_AND: f = value1 && value2; break;
-		}
+		f = applyConditionOp(c->op, value1, value2);
 	}
 
 	return f;
@@ -421,12 +459,12 @@ int condition(watchpointinfo* wp)
 
 //---------------------
 
-volatile int codecount = 0, datacount = 0, undefinedcount = 0;
-unsigned char *cdloggerdata = NULL;
-unsigned int cdloggerdataSize = 0;
-static int indirectnext = 0;
+FCEU_TLS volatile int codecount = 0, datacount = 0, undefinedcount = 0;
+FCEU_TLS unsigned char *cdloggerdata = NULL;
+FCEU_TLS unsigned int cdloggerdataSize = 0;
+static FCEU_TLS int indirectnext = 0;
 
-int debug_loggingCD = 0;
+FCEU_TLS int debug_loggingCD = 0;
 
 //called by the cpu to perform logging if CDLogging is enabled
 void LogCDVectors(int which){
@@ -487,25 +525,25 @@ void LogCDData(uint8 *opcode, uint16 A, int size) {
 
 //-----------debugger stuff
 
-watchpointinfo watchpoint[65]; //64 watchpoints, + 1 reserved for step over
-int iaPC;
-uint32 iapoffset; //mbg merge 7/18/06 changed from int
-int u; //deleteme
-int skipdebug; //deleteme
-int numWPs;
+FCEU_TLS watchpointinfo watchpoint[65]; //64 watchpoints, + 1 reserved for step over
+FCEU_TLS int iaPC;
+FCEU_TLS uint32 iapoffset; //mbg merge 7/18/06 changed from int
+FCEU_TLS int u; //deleteme
+FCEU_TLS int skipdebug; //deleteme
+FCEU_TLS int numWPs;
 
-bool break_asap = false;
+FCEU_TLS bool break_asap = false;
 // for CPU cycles and Instructions counters
-uint64 total_cycles_base = 0;
-uint64 delta_cycles_base = 0;
-bool break_on_cycles = false;
-uint64 break_cycles_limit = 0;
-uint64 total_instructions = 0;
-uint64 delta_instructions = 0;
-bool break_on_instructions = false;
-uint64 break_instructions_limit = 0;
+FCEU_TLS uint64 total_cycles_base = 0;
+FCEU_TLS uint64 delta_cycles_base = 0;
+FCEU_TLS bool break_on_cycles = false;
+FCEU_TLS uint64 break_cycles_limit = 0;
+FCEU_TLS uint64 total_instructions = 0;
+FCEU_TLS uint64 delta_instructions = 0;
+FCEU_TLS bool break_on_instructions = false;
+FCEU_TLS uint64 break_instructions_limit = 0;
 
-static DebuggerState dbgstate;
+static FCEU_TLS DebuggerState dbgstate;
 
 DebuggerState &FCEUI_Debugger() { return dbgstate; }
 
@@ -570,8 +608,8 @@ void BreakHit(int bp_num)
 //#endif
 }
 
-int StackAddrBackup;
-uint16 StackNextIgnorePC = 0xFFFF;
+FCEU_TLS int StackAddrBackup;
+FCEU_TLS uint16 StackNextIgnorePC = 0xFFFF;
 
 ///fires a breakpoint
 static void breakpoint(uint8 *opcode, uint16 A, int size) {
@@ -867,3 +905,11 @@ void DebugCycle()
 
 	FCEUD_TraceInstruction(opcode, size);
 }
+
+//whether DebugCycle() would do anything at all. the cpu core skips calling it when it wouldn't.
+bool DebugCycleActive()
+{
+	return numWPs || dbgstate.step || dbgstate.runline || dbgstate.stepout || watchpoint[64].flags || dbgstate.badopbreak || break_on_cycles || break_on_instructions || break_asap
+		|| debug_loggingCD
+		|| FCEUD_TraceInstructionActive();
+}
@@ -57,9 +57,9 @@ typedef struct {
 } watchpointinfo;
 
 //mbg merge 7/18/06 had to make this extern
-extern watchpointinfo watchpoint[65]; //64 watchpoints, + 1 reserved for step over
+extern FCEU_TLS watchpointinfo watchpoint[65]; //64 watchpoints, + 1 reserved for step over
 
-extern unsigned int debuggerPageSize;
+extern FCEU_TLS unsigned int debuggerPageSize;
 int getBank(int offs);
 int GetNesFileAddress(int A);
 int GetPRGAddress(int A);
@@ -70,15 +70,17 @@ uint8 *GetNesCHRPointer(int A);
 void KillDebugger();
 uint8 GetMem(uint16 A);
 uint8 GetPPUMem(uint8 A);
+//value of a condition made by generateCondition(); runs its compiled form when it has one, else walks the tree
+int evaluate(Condition* c);
 
 //---------CDLogger
 void LogCDVectors(int which);
 void LogCDData(uint8 *opcode, uint16 A, int size);
-extern volatile int codecount, datacount, undefinedcount;
-extern unsigned char *cdloggerdata;
-extern unsigned int cdloggerdataSize;
+extern FCEU_TLS volatile int codecount, datacount, undefinedcount;
+extern FCEU_TLS unsigned char *cdloggerdata;
+extern FCEU_TLS unsigned int cdloggerdataSize;
 
-extern int debug_loggingCD;
+extern FCEU_TLS int debug_loggingCD;
 static INLINE void FCEUI_SetLoggingCD(int val) { debug_loggingCD = val; }
 static INLINE int FCEUI_GetLoggingCD() { return debug_loggingCD; }
 //-------
@@ -91,21 +93,22 @@ static INLINE int FCEUI_GetLoggingCD() { return debug_loggingCD; }
 //---------
 
 //--------debugger
-extern int iaPC;
-extern uint32 iapoffset; //mbg merge 7/18/06 changed from int
+extern FCEU_TLS int iaPC;
+extern FCEU_TLS uint32 iapoffset; //mbg merge 7/18/06 changed from int
 void DebugCycle();
+bool DebugCycleActive();
 bool CondForbidTest(int bp_num);
 void BreakHit(int bp_num);
 
-extern bool break_asap;
-extern uint64 total_cycles_base;
-extern uint64 delta_cycles_base;
-extern bool break_on_cycles;
-extern uint64 break_cycles_limit;
-extern uint64 total_instructions;
-extern uint64 delta_instructions;
-extern bool break_on_instructions;
-extern uint64 break_instructions_limit;
+extern FCEU_TLS bool break_asap;
+extern FCEU_TLS uint64 total_cycles_base;
+extern FCEU_TLS uint64 delta_cycles_base;
+extern FCEU_TLS bool break_on_cycles;
+extern FCEU_TLS uint64 break_cycles_limit;
+extern FCEU_TLS uint64 total_instructions;
+extern FCEU_TLS uint64 delta_instructions;
+extern FCEU_TLS bool break_on_instructions;
+extern FCEU_TLS uint64 break_instructions_limit;
 extern void ResetDebugStatisticsCounters();
 extern void ResetCyclesCounter();
 extern void ResetInstructionsCounter();
@@ -114,11 +117,11 @@ extern void IncrementInstructionsCounters();
 //-------------
 
 //internal variables that debuggers will want access to
-extern uint8 *vnapage[4],*VPage[8];
-extern uint8 PPU[4],PALRAM[0x20],UPALRAM[3],SPRAM[0x100],VRAMBuffer,PPUGenLatch,XOffset;
+extern FCEU_TLS uint8 *vnapage[4],*VPage[8];
+extern FCEU_TLS uint8 PPU[4],PALRAM[0x20],UPALRAM[3],SPRAM[0x100],VRAMBuffer,PPUGenLatch,XOffset;
 extern uint32 FCEUPPU_PeekAddress();
 extern uint8 READPAL_MOTHEROFALL(uint32 A);
-extern int numWPs;
+extern FCEU_TLS int numWPs;
 
 ///encapsulates the operational state of the debugger core
 class DebuggerState {
@@ -145,17 +148,17 @@ public:
 	}
 };
 
-extern NSF_HEADER NSFHeader;
-
-extern uint8 PSG[0x10];
-extern uint8 DMCFormat;
-extern uint8 RawDALatch;
-extern uint8 DMCAddressLatch;
-extern uint8 DMCSizeLatch;
-extern uint8 EnabledChannels;
-extern uint8 SpriteDMA;
-extern uint8 RawReg4016;
-extern uint8 IRQFrameMode;
+extern FCEU_TLS NSF_HEADER NSFHeader;
+
+extern FCEU_TLS uint8 PSG[0x10];
+extern FCEU_TLS uint8 DMCFormat;
+extern FCEU_TLS uint8 RawDALatch;
+extern FCEU_TLS uint8 DMCAddressLatch;
+extern FCEU_TLS uint8 DMCSizeLatch;
+extern FCEU_TLS uint8 EnabledChannels;
+extern FCEU_TLS uint8 SpriteDMA;
+extern FCEU_TLS uint8 RawReg4016;
+extern FCEU_TLS uint8 IRQFrameMode;
 
 ///retrieves the core's DebuggerState
 DebuggerState &FCEUI_Debugger();
@@ -5,7 +5,7 @@
 #include "movie.h"
 #include "driver.h"
 
-static uint8 Font6x7[792] =
+static FCEU_TLS uint8 Font6x7[792] =
 {
 	6,  0,  0,  0,  0,  0,  0,  0,	// 0x20 - Spacebar
 	3, 64, 64, 64, 64, 64,  0, 64,
@@ -107,7 +107,7 @@ static uint8 Font6x7[792] =
 void DrawTextLineBG(uint8 *dest)
 {
 	int x,y;
-	static int otable[7]={81,49,30,17,8,3,0};
+	static FCEU_TLS int otable[7]={81,49,30,17,8,3,0};
 	//100,40,15,10,7,5,2};
 	for(y=0;y<14;y++)
 	{
@@ -190,7 +190,7 @@ void DrawMessage(bool beforeMovie)
 
 
 
-static uint8 sstat[2541] =
+static FCEU_TLS uint8 sstat[2541] =
 {
 	0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,
 	0x80,0x80,0x80,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,0x83,
@@ -213,7 +213,7 @@ static uint8 sstat[2541] =
 
 
 
-static uint8 play_slines[]=
+static FCEU_TLS uint8 play_slines[]=
 {
 	0, 0, 1,
 	1, 0, 2,
@@ -233,7 +233,7 @@ static uint8 play_slines[]=
 	99,
 };
 
-static uint8 record_slines[]=
+static FCEU_TLS uint8 record_slines[]=
 {
 	0, 5, 9,
 	1, 3, 11,
@@ -253,7 +253,7 @@ static uint8 record_slines[]=
 	99,
 };
 
-static uint8 pause_slines[]=
+static FCEU_TLS uint8 pause_slines[]=
 {
 	0, 2, 6,
 	1, 2, 6,
@@ -289,12 +289,12 @@ static uint8 pause_slines[]=
 	99,
 };
 
-static uint8 no_slines[]=
+static FCEU_TLS uint8 no_slines[]=
 {
 	99
 };
 
-static uint8* sline_icons[4]=
+static FCEU_TLS uint8* sline_icons[4]=
 {
 	no_slines,
 	play_slines,
@@ -400,7 +400,7 @@ static int JoedCharWidth(uint8 ch)
 	return Font6x7[FixJoedChar(ch)*8];
 }
 
-char target[64][256];
+FCEU_TLS char target[64][256];
 
 void DrawTextTransWH(uint8 *dest, int width, uint8 *textmsg, uint8 fgcolor, int max_w, int max_h, int border)
 {
@@ -11,6 +11,7 @@
 #include <iosfwd>
 
 void FCEUD_CallHookBeforeExec(std::uint16_t addr);
+bool FCEUD_HookBeforeExecActive();
 
 FILE *FCEUD_UTF8fopen(const char *fn, const char *mode);
 inline FILE *FCEUD_UTF8fopen(const std::string &n, const char *mode) { return FCEUD_UTF8fopen(n.c_str(),mode); }
@@ -107,6 +108,13 @@ FCEUGI *FCEUI_LoadGame(const char *name, int OverwriteVidMode, bool silent = fal
 //name is the logical path to open; archiveFilename is the archive which contains name
 FCEUGI *FCEUI_LoadGameVirtual(const char *name, int OverwriteVidMode, bool silent = false);
 
+//reads the rom file name the way FCEUI_LoadGame sees it (unpacked, with its ips patch applied). returns false if it failed
+bool FCEUI_ReadGame(const char *name, std::vector<uint8> &data, bool silent = false);
+
+//same as FCEUI_LoadGame, except that the rom comes from data (as read by FCEUI_ReadGame) and no file is read for it.
+//name is still used to derive the names of the save, palette and cheat files
+FCEUGI *FCEUI_LoadGameMemory(const char *name, const uint8 *data, size_t size, int OverwriteVidMode, bool silent = false);
+
 //general purpose emulator initialization. returns true if successful
 bool FCEUI_Initialize();
 
@@ -326,6 +334,9 @@ void FCEUD_DebugBreakpoint(int bp_num);
 ///the driver should log the current instruction, if it wants (we should move the code in the win driver that does this to the shared area)
 void FCEUD_TraceInstruction(uint8 *opcode, int size);
 
+///returns whether FCEUD_TraceInstruction() currently does anything. the cpu core only calls it when it does
+bool FCEUD_TraceInstructionActive();
+
 ///the driver might should update its NTView (only used if debugging support is compiled in)
 void FCEUD_UpdateNTView(int scanline, bool drawall);
 
@@ -5,14 +5,14 @@
 //*****************************************************************
 // Define Global Variables to be shared with FCEU Core
 //*****************************************************************
-extern int dendy;
+extern FCEU_TLS int dendy;
 extern int eoptions;
 extern int isLoaded;
-extern int pal_emulation;
+extern FCEU_TLS int pal_emulation;
 extern int gametype;
-extern int closeFinishedMovie;
-extern bool turbo;
-extern bool swapDuty;
+extern FCEU_TLS int closeFinishedMovie;
+extern FCEU_TLS bool turbo;
+extern FCEU_TLS bool swapDuty;
 extern bool pauseAfterPlayback;
 extern bool suggestReadOnlyReplay;
 extern unsigned int gui_draw_area_width;
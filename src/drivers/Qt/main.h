@@ -40,7 +40,7 @@ extern int _sound;
 extern long soundrate;
 extern long soundbufsize;
 
-extern int pal_emulation;
+extern FCEU_TLS int pal_emulation;
 
 int CLImain(int argc, char *argv[]);
 
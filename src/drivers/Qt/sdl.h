@@ -20,9 +20,9 @@ const int INVALID_STATE = 99;
 extern int noGui;
 extern int isloaded;
 
-extern int dendy;
-extern int pal_emulation;
-extern bool swapDuty;
+extern FCEU_TLS int dendy;
+extern FCEU_TLS int pal_emulation;
+extern FCEU_TLS bool swapDuty;
 
 int LoadGame(const char *path, bool silent);
 int CloseGame(void);
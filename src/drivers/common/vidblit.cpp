@@ -30,11 +30,11 @@
 #include "../../utils/memory.h"
 #include "nes_ntsc.h"
 
-extern u8 *XBuf;
-extern u8 *XBackBuf;
-extern u8 *XDBuf;
-extern u8 *XDBackBuf;
-extern pal *palo;
+extern FCEU_TLS u8 *XBuf;
+extern FCEU_TLS u8 *XBackBuf;
+extern FCEU_TLS u8 *XDBuf;
+extern FCEU_TLS u8 *XDBackBuf;
+extern FCEU_TLS pal *palo;
 
 #include "../../ppu.h"  // for PPU[]
 
@@ -71,7 +71,7 @@ int    palsharpness    = 50;
 int    palcontrast     = 100;
 int    palbrightness   = 50;
 bool   palupdate       = 1;
-bool   paldeemphswap   = 0;
+FCEU_TLS bool   paldeemphswap   = 0;
 
 static int Round(float value)
 {
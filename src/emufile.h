@@ -261,6 +261,78 @@ public:
 	virtual int size() { return (int)len; }
 };
 
+//reads memory owned by somebody else, without copying it. writing fails.
+class EMUFILE_MEMORY_VIEW : public EMUFILE {
+protected:
+	const u8 *data;
+	s32 pos, len;
+
+public:
+
+	EMUFILE_MEMORY_VIEW(const void* buf, s32 size) : data((const u8*)buf), pos(0), len(size) { }
+
+	virtual EMUFILE* memwrap() { return this; }
+
+	virtual void truncate(s32 length) { failbit = true; }
+
+	virtual FILE *get_fp() { return NULL; }
+
+	virtual int fprintf(const char *format, ...) {
+		failbit = true;
+		return 0;
+	}
+
+	virtual int fgetc() {
+		if(pos >= len) {
+			failbit = true;
+			return -1;
+		}
+		return data[pos++];
+	}
+	virtual int fputc(int c) {
+		failbit = true;
+		return EOF;
+	}
+
+	virtual size_t _fread(const void *ptr, size_t bytes){
+		size_t todo = pos < len ? std::min<size_t>(len-pos,bytes) : 0;
+		if(todo < bytes)
+			failbit = true;
+		memcpy((void*)ptr,data+pos,todo);
+		pos += (s32)todo;
+		return todo;
+	}
+
+	virtual void fwrite(const void *ptr, size_t bytes){
+		failbit = true;
+	}
+
+	virtual int fseek(int offset, int origin){
+		switch(origin) {
+			case SEEK_SET:
+				pos = offset;
+				break;
+			case SEEK_CUR:
+				pos += offset;
+				break;
+			case SEEK_END:
+				pos = len+offset;
+				break;
+			default:
+				assert(false);
+		}
+		return 0;
+	}
+
+	virtual int ftell() {
+		return pos;
+	}
+
+	virtual void fflush() {}
+
+	virtual int size() { return (int)len; }
+};
+
 class EMUFILE_FILE : public EMUFILE {
 protected:
 	FILE* fp;
@@ -53,7 +53,7 @@ extern void ResetDebugStatisticsCounters();
 extern void SetMainWindowText();
 extern bool isTaseditorRecording();
 
-extern int32 fps_scale;
+extern FCEU_TLS int32 fps_scale;
 extern int32 fps_scale_unpaused;
 extern int32 fps_scale_frameadvance;
 #endif
@@ -99,23 +99,23 @@ using namespace std;
 // overclock the console by adding dummy scanlines to PPU loop or to vblank
 // disables DMC DMA, WaveHi filling and image rendering for these dummies
 // doesn't work with new PPU
-bool overclock_enabled = 0;
-bool overclocking = 0;
-bool skip_7bit_overclocking = 1; // 7-bit samples have priority over overclocking
-int normalscanlines;
-int totalscanlines;
-int postrenderscanlines = 0;
-int vblankscanlines = 0;
+FCEU_TLS bool overclock_enabled = 0;
+FCEU_TLS bool overclocking = 0;
+FCEU_TLS bool skip_7bit_overclocking = 1; // 7-bit samples have priority over overclocking
+FCEU_TLS int normalscanlines;
+FCEU_TLS int totalscanlines;
+FCEU_TLS int postrenderscanlines = 0;
+FCEU_TLS int vblankscanlines = 0;
 //------------
 
-int AFon = 1, AFoff = 1, AutoFireOffset = 0; //For keeping track of autofire settings
-bool justLagged = false;
-bool frameAdvanceLagSkip = false; //If this is true, frame advance will skip over lag frame (i.e. it will emulate 2 frames instead of 1)
-bool AutoSS = false;        //Flagged true when the first auto-savestate is made while a game is loaded, flagged false on game close
-bool movieSubtitles = true; //Toggle for displaying movie subtitles
-bool DebuggerWasUpdated = false; //To prevent the debugger from updating things without being updated.
-bool AutoResumePlay = false;
-char romNameWhenClosingEmulator[2048] = {0};
+FCEU_TLS int AFon = 1, AFoff = 1, AutoFireOffset = 0; //For keeping track of autofire settings
+FCEU_TLS bool justLagged = false;
+FCEU_TLS bool frameAdvanceLagSkip = false; //If this is true, frame advance will skip over lag frame (i.e. it will emulate 2 frames instead of 1)
+FCEU_TLS bool AutoSS = false;        //Flagged true when the first auto-savestate is made while a game is loaded, flagged false on game close
+FCEU_TLS bool movieSubtitles = true; //Toggle for displaying movie subtitles
+FCEU_TLS bool DebuggerWasUpdated = false; //To prevent the debugger from updating things without being updated.
+FCEU_TLS bool AutoResumePlay = false;
+FCEU_TLS char romNameWhenClosingEmulator[2048] = {0};
 
 
 FCEUGI::FCEUGI()
@@ -177,7 +177,7 @@ static void FCEU_CloseGame(void)
 		}
 
 #ifdef WIN32
-		extern char LoadedRomFName[2048];
+		extern FCEU_TLS char LoadedRomFName[2048];
 		if (storePreferences(mass_replace(LoadedRomFName, "|", ".").c_str()))
 			FCEUD_PrintError("Couldn't store debugging data");
 		CDLoggerROMClosed();
@@ -210,7 +210,7 @@ static void FCEU_CloseGame(void)
 		ResetExState(0, 0);
 
 		//clear screen when game is closed
-		extern uint8 *XBuf;
+		extern FCEU_TLS uint8 *XBuf;
 		if (XBuf)
 			memset(XBuf, 0, 256 * 256);
 
@@ -233,38 +233,41 @@ static void FCEU_CloseGame(void)
 }
 
 
-uint64 timestampbase;
+FCEU_TLS uint64 timestampbase;
 
 
-FCEUGI *GameInfo = NULL;
+FCEU_TLS FCEUGI *GameInfo = NULL;
 
-void (*GameInterface)(GI h);
-void (*GameStateRestore)(int version);
+FCEU_TLS void (*GameInterface)(GI h);
+FCEU_TLS void (*GameStateRestore)(int version);
 
-readfunc ARead[0x10000];
-writefunc BWrite[0x10000];
-static readfunc *AReadG;
-static writefunc *BWriteG;
-static int RWWrap = 0;
+FCEU_TLS readfunc ARead[0x10000];
+FCEU_TLS writefunc BWrite[0x10000];
+FCEU_TLS bool RAMDirect = false;
+FCEU_TLS bool PRGDirect[32];
+static FCEU_TLS bool PRGDirectEnabled = true;
+static FCEU_TLS readfunc *AReadG;
+static FCEU_TLS writefunc *BWriteG;
+static FCEU_TLS int RWWrap = 0;
 
 //mbg merge 7/18/06 docs
 //bit0 indicates whether emulation is paused
 //bit1 indicates whether emulation is in frame step mode
-int EmulationPaused = 0;
-bool frameAdvanceRequested=false;
-int frameAdvance_Delay_count = 0;
-int frameAdvance_Delay = FRAMEADVANCE_DELAY_DEFAULT;
+FCEU_TLS int EmulationPaused = 0;
+FCEU_TLS bool frameAdvanceRequested=false;
+FCEU_TLS int frameAdvance_Delay_count = 0;
+FCEU_TLS int frameAdvance_Delay = FRAMEADVANCE_DELAY_DEFAULT;
 
 //indicates that the emulation core just frame advanced (consumed the frame advance state and paused)
-bool JustFrameAdvanced = false;
+FCEU_TLS bool JustFrameAdvanced = false;
 
-static int *AutosaveStatus; //is it safe to load Auto-savestate
-static int AutosaveIndex = 0; //which Auto-savestate we're on
-int AutosaveQty = 4; // Number of Autosaves to store
-int AutosaveFrequency = 256; // Number of frames between autosaves
+static FCEU_TLS int *AutosaveStatus; //is it safe to load Auto-savestate
+static FCEU_TLS int AutosaveIndex = 0; //which Auto-savestate we're on
+FCEU_TLS int AutosaveQty = 4; // Number of Autosaves to store
+FCEU_TLS int AutosaveFrequency = 256; // Number of frames between autosaves
 
 // Flag that indicates whether the Auto-save option is enabled or not
-int EnableAutosave = 0;
+FCEU_TLS int EnableAutosave = 0;
 
 ///a wrapper for unzip.c
 extern "C" FILE *FCEUI_UTF8fopen_C(const char *n, const char *m) {
@@ -278,6 +281,51 @@ static DECLFR(ANull) {
 	return(X.DB);
 }
 
+static DECLFR(ARAML);
+static DECLFR(ARAMH);
+static DECLFW(BRAML);
+static DECLFW(BRAMH);
+
+//the cpu may bypass ARead/BWrite for $0000-$1FFF only while nothing (cheats, boards) has hooked any of it
+static void UpdateRAMDirect(void) {
+	int32 x;
+
+	RAMDirect = false;
+	for (x = 0; x < 0x2000; x++) {
+		if (ARead[x] != (x < 0x800 ? ARAML : ARAMH))
+			return;
+		if (BWrite[x] != (x < 0x800 ? BRAML : BRAMH))
+			return;
+	}
+	RAMDirect = true;
+}
+
+//likewise for each 2K page of $6000-$FFFF that is read through CartBR alone.
+//such reads go straight to Page[], which setprg* keeps current.
+static void UpdatePRGDirect(int32 start, int32 end) {
+	int32 x, page;
+
+	if (start < 0x6000)
+		start = 0x6000;
+	for (page = start >> 11; page <= (end >> 11); page++) {
+		PRGDirect[page] = PRGDirectEnabled;
+		if (!PRGDirectEnabled)
+			continue;
+		for (x = page << 11; x < ((page + 1) << 11); x++)
+			if (ARead[x] != CartBR) {
+				PRGDirect[page] = false;
+				break;
+			}
+	}
+}
+
+void FCEU_SetPRGDirect(bool enable) {
+	if (PRGDirectEnabled == enable)
+		return;
+	PRGDirectEnabled = enable;
+	UpdatePRGDirect(0x6000, 0xFFFF);
+}
+
 int AllocGenieRW(void) {
 	if (!(AReadG = (readfunc*)FCEU_malloc(0x8000 * sizeof(readfunc))))
 		return 0;
@@ -295,6 +343,7 @@ void FlushGenieRW(void) {
 			ARead[x + 0x8000] = AReadG[x];
 			BWrite[x + 0x8000] = BWriteG[x];
 		}
+		UpdatePRGDirect(0x8000, 0xFFFF);
 		free(AReadG);
 		free(BWriteG);
 		AReadG = NULL;
@@ -326,6 +375,11 @@ void SetReadHandler(int32 start, int32 end, readfunc func) {
 	else
 		for (x = end; x >= start; x--)
 			ARead[x] = func;
+
+	if (start < 0x2000)
+		UpdateRAMDirect();
+	if (end >= 0x6000)
+		UpdatePRGDirect(start, end);
 }
 
 writefunc GetWriteHandler(int32 a) {
@@ -351,9 +405,12 @@ void SetWriteHandler(int32 start, int32 end, writefunc func) {
 	else
 		for (x = end; x >= start; x--)
 			BWrite[x] = func;
+
+	if (start < 0x2000)
+		UpdateRAMDirect();
 }
 
-uint8 *RAM;
+FCEU_TLS uint8 *RAM;
 
 //---------
 //windows might need to allocate these differently, so we have some special code
@@ -368,7 +425,7 @@ static void FreeBuffers() {
 }
 //------
 
-uint8 PAL = 0;
+FCEU_TLS uint8 PAL = 0;
 
 static DECLFW(BRAML) {
 	RAM[A] = V;
@@ -399,6 +456,8 @@ void ResetGameLoaded(void) {
 		GameExpSound.Kill();
 	memset(&GameExpSound, 0, sizeof(GameExpSound));
 	MapIRQHook = NULL;
+	MapIRQHookBudget = NULL;
+	X6502_IdleCyclesSkipped = 0;
 	MMC5Hack = 0;
 	PEC586Hack = 0;
 	QTAIHack = 0;
@@ -412,32 +471,31 @@ int FDSLoad(const char *name, FCEUFILE *fp);
 int NSFLoad(const char *name, FCEUFILE *fp);
 
 //name should be UTF-8, hopefully, or else there may be trouble
-FCEUGI *FCEUI_LoadGameVirtual(const char *name, int OverwriteVidMode, bool silent)
+static FCEUFILE *OpenGame(const char *name, bool silent)
 {
-	//----------
-	//attempt to open the files
-	FCEUFILE *fp;
-	char fullname[2048];	// this name contains both archive name and ROM file name
-	int lastpal = PAL;
-	int lastdendy = dendy;
-
 	const char* romextensions[] = { "nes", "fds", 0 };
 
 	// indicator for if the operaton was canceled by user
 	// currently there's only one situation:
 	// the user clicked cancel form the open from archive dialog
 	int userCancel = 0;
-	fp = FCEU_fopen(name, 0, "rb", 0, -1, romextensions, &userCancel);
+	FCEUFILE *fp = FCEU_fopen(name, 0, "rb", 0, -1, romextensions, &userCancel);
 
-	if (!fp)
-	{
-		// Although !fp, if the operation was canceled from archive select dialog box, don't show the error message;
-		if (!silent && !userCancel)
-			FCEU_PrintError("Error opening \"%s\"!", name);
+	// Although !fp, if the operation was canceled from archive select dialog box, don't show the error message;
+	if (!fp && !silent && !userCancel)
+		FCEU_PrintError("Error opening \"%s\"!", name);
 
-		return 0;
-	}
-	else if (fp->archiveFilename != "")
+	return fp;
+}
+
+//loads the game from an opened file and closes it
+static FCEUGI *LoadGameFile(FCEUFILE *fp, const char *name, int OverwriteVidMode, bool silent)
+{
+	char fullname[2048];	// this name contains both archive name and ROM file name
+	int lastpal = PAL;
+	int lastdendy = dendy;
+
+	if (fp->archiveFilename != "")
 	{
 		strcpy(fullname, fp->archiveFilename.c_str());
 		strcat(fullname, "|");
@@ -487,7 +545,7 @@ FCEUGI *FCEUI_LoadGameVirtual(const char *name, int OverwriteVidMode, bool silen
 
 #ifdef WIN32
 		// ################################## Start of SP CODE ###########################
-		extern char LoadedRomFName[2048];
+		extern FCEU_TLS char LoadedRomFName[2048];
 		extern int loadDebugDataFailed;
 
 		if ((loadDebugDataFailed = loadPreferences(mass_replace(LoadedRomFName, "|", ".").c_str())))
@@ -569,11 +627,45 @@ FCEUGI *FCEUI_LoadGameVirtual(const char *name, int OverwriteVidMode, bool silen
 	return GameInfo;
 }
 
+FCEUGI *FCEUI_LoadGameVirtual(const char *name, int OverwriteVidMode, bool silent)
+{
+	FCEUFILE *fp = OpenGame(name, silent);
+	if (!fp)
+		return 0;
+
+	return LoadGameFile(fp, name, OverwriteVidMode, silent);
+}
+
 FCEUGI *FCEUI_LoadGame(const char *name, int OverwriteVidMode, bool silent)
 {
 	return FCEUI_LoadGameVirtual(name, OverwriteVidMode, silent);
 }
 
+bool FCEUI_ReadGame(const char *name, std::vector<uint8> &data, bool silent)
+{
+	FCEUFILE *fp = OpenGame(name, silent);
+	if (!fp)
+		return false;
+
+	data.resize(fp->size);
+	const bool ok = data.empty() || FCEU_fread(&data[0], 1, data.size(), fp) == data.size();
+	FCEU_fclose(fp);
+	return ok;
+}
+
+FCEUGI *FCEUI_LoadGameMemory(const char *name, const uint8 *data, size_t size, int OverwriteVidMode, bool silent)
+{
+	FCEUFILE *fp = new FCEUFILE();
+	fp->filename = name;
+	fp->logicalPath = name;
+	fp->fullFilename = name;
+	fp->archiveIndex = -1;
+	fp->stream = new EMUFILE_MEMORY((void*)data, (s32)size);
+	fp->size = (int)size;
+
+	return LoadGameFile(fp, name, OverwriteVidMode, silent);
+}
+
 
 //Return: Flag that indicates whether the function was succesful or not.
 bool FCEUI_Initialize() {
@@ -618,9 +710,9 @@ void FCEUI_Kill(void) {
 	FreeBuffers();
 }
 
-int rapidAlternator = 0;
-int AutoFirePattern[8] = { 1, 0, 0, 0, 0, 0, 0, 0 };
-int AutoFirePatternLength = 2;
+FCEU_TLS int rapidAlternator = 0;
+FCEU_TLS int AutoFirePattern[8] = { 1, 0, 0, 0, 0, 0, 0, 0 };
+FCEU_TLS int AutoFirePatternLength = 2;
 
 void SetAutoFirePattern(int onframes, int offframes) {
 	int i;
@@ -646,7 +738,7 @@ void SetAutoFireOffset(int offset) {
 }
 
 void AutoFire(void) {
-	static int counter = 0;
+	static FCEU_TLS int counter = 0;
 	if (justLagged == false)
 		counter = (counter + 1) % (8 * 7 * 5 * 3);
 	//If recording a movie, use the frame # for the autofire so the offset
@@ -662,7 +754,8 @@ void UpdateAutosave(void);
 
 ///Emulates a single frame.
 
-///Skip may be passed in, if FRAMESKIP is #defined, to cause this to emulate more than one frame
+///Skip may be passed in to emulate the frame without rendering it. The CPU-visible state
+///(sprite 0 hit, mapper scanline IRQs, ...) is the same as with a rendered frame.
 void FCEUI_Emulate(uint8 **pXBuf, int32 **SoundBuf, int32 *SoundBufSize, int skip) {
 	//skip initiates frame skip if 1, or frame skip and sound skip if 2
 	int r, ssize;
@@ -748,11 +841,11 @@ void FCEUI_Emulate(uint8 **pXBuf, int32 **SoundBuf, int32 *SoundBufSize, int ski
 	RamChange();
 	//FCEUI_AviVideoUpdate(XBuf);
 
-	extern int KillFCEUXonFrame;
+	extern FCEU_TLS int KillFCEUXonFrame;
 	if (KillFCEUXonFrame && (FCEUMOV_GetFrame() >= KillFCEUXonFrame))
 		DoFCEUExit();
 #else
-		extern int KillFCEUXonFrame;
+		extern FCEU_TLS int KillFCEUXonFrame;
 	if (KillFCEUXonFrame && (FCEUMOV_GetFrame() >= KillFCEUXonFrame))
 		exit(0);
 #endif
@@ -807,15 +900,15 @@ void ResetNES(void) {
 	X6502_Reset();
 
 	// clear back baffer
-	extern uint8 *XBackBuf;
+	extern FCEU_TLS uint8 *XBackBuf;
 	memset(XBackBuf, 0, 256 * 256);
 
 	FCEU_DispMessage("Reset", 0);
 }
 
 
-int RAMInitSeed = 0;
-int RAMInitOption = 0;
+FCEU_TLS int RAMInitSeed = 0;
+FCEU_TLS int RAMInitOption = 0;
 
 u64 splitmix64(u32 input) {
 	u64 z = (input + 0x9e3779b97f4a7c15);
@@ -828,7 +921,7 @@ static inline u64 xoroshiro128plus_rotl(const u64 x, int k) {
 	return (x << k) | (x >> (64 - k));
 }
 
-u64 xoroshiro128plus_s[2];
+FCEU_TLS u64 xoroshiro128plus_s[2];
 void xoroshiro128plus_seed(u32 input)
 {
 //http://xoroshiro.di.unimi.it/splitmix64.c
@@ -900,7 +993,7 @@ void PowerNES(void) {
 	if (!GameInfo) return;
 
 	//reseed random, unless we're in a movie
-	extern int disableBatteryLoading;
+	extern FCEU_TLS int disableBatteryLoading;
 	if(FCEUMOV_Mode(MOVIEMODE_INACTIVE) && !disableBatteryLoading)
 	{
 		RAMInitSeed = rand() ^ (u32)xoroshiro128plus_next();
@@ -935,7 +1028,7 @@ void PowerNES(void) {
 		FCEU_VSUniPower();
 
 	//if we are in a movie, then reset the saveram
-	extern int disableBatteryLoading;
+	extern FCEU_TLS int disableBatteryLoading;
 	if (disableBatteryLoading)
 		GameInterface(GI_RESETSAVE);
 
@@ -947,7 +1040,7 @@ void PowerNES(void) {
 	FCEU_PowerCheats();
 	LagCounterReset();
 	// clear back buffer
-	extern uint8 *XBackBuf;
+	extern FCEU_TLS uint8 *XBackBuf;
 	memset(XBackBuf, 0, 256 * 256);
 
 #ifdef WIN32
@@ -982,7 +1075,7 @@ void FCEU_ResetVidSys(void) {
 	SetSoundVariables();
 }
 
-FCEUS FSettings;
+FCEU_TLS FCEUS FSettings;
 
 void FCEU_printf(const char *format, ...) 
 {
@@ -1148,7 +1241,7 @@ void FCEUI_FrameAdvance(void) {
 	frameAdvance_Delay_count = 0;
 }
 
-static int AutosaveCounter = 0;
+static FCEU_TLS int AutosaveCounter = 0;
 
 void UpdateAutosave(void) {
 	if (!EnableAutosave || turbo)
@@ -1280,7 +1373,7 @@ protected:
 //void SetReadHandler(int32 start, int32 end, readfunc func) {
 };
 
-FCEUXCart* cart = 0;
+FCEU_TLS FCEUXCart* cart = 0;
 
 //uint8 Read_ByteFromRom(uint32 A) {
 //	if(A>=cart->prgSize) return 0xFF;
@@ -1368,7 +1461,7 @@ bool FCEUXLoad(const char *name, FCEUFILE *fp) {
 }
 
 uint8 FCEU_ReadRomByte(uint32 i) {
-	extern iNES_HEADER head;
+	extern FCEU_TLS iNES_HEADER head;
 	if (i < 16)
 		return *((unsigned char*)&head + i);
 	if (i < 16 + PRGsize[0])
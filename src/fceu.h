@@ -3,21 +3,21 @@
 
 #include "types.h"
 
-extern int fceuindbg;
-extern int newppu;
+extern FCEU_TLS int fceuindbg;
+extern FCEU_TLS int newppu;
 void ResetGameLoaded(void);
 
 //overclocking-related
-extern bool overclock_enabled;
-extern bool overclocking;
-extern bool skip_7bit_overclocking;
-extern int normalscanlines;
-extern int totalscanlines;
-extern int postrenderscanlines;
-extern int vblankscanlines;
+extern FCEU_TLS bool overclock_enabled;
+extern FCEU_TLS bool overclocking;
+extern FCEU_TLS bool skip_7bit_overclocking;
+extern FCEU_TLS int normalscanlines;
+extern FCEU_TLS int totalscanlines;
+extern FCEU_TLS int postrenderscanlines;
+extern FCEU_TLS int vblankscanlines;
 
-extern bool AutoResumePlay;
-extern char romNameWhenClosingEmulator[];
+extern FCEU_TLS bool AutoResumePlay;
+extern FCEU_TLS char romNameWhenClosingEmulator[];
 
 #define DECLFR(x) uint8 x (uint32 A)
 #define DECLFW(x) void x (uint32 A, uint8 V)
@@ -45,37 +45,41 @@ void FCEUI_RewindToLastAutosave(void);
 //mbg 7/23/06
 char *FCEUI_GetAboutString();
 
-extern uint64 timestampbase;
+extern FCEU_TLS uint64 timestampbase;
 
 // MMC5 external shared buffers/vars
-extern int MMC5Hack;
-extern uint32 MMC5HackVROMMask;
-extern uint8 *MMC5HackExNTARAMPtr;
-extern uint8 *MMC5HackVROMPTR;
-extern uint8 MMC5HackCHRMode;
-extern uint8 MMC5HackSPMode;
-extern uint8 MMC50x5130;
-extern uint8 MMC5HackSPScroll;
-extern uint8 MMC5HackSPPage;
-
-extern int PEC586Hack;
+extern FCEU_TLS int MMC5Hack;
+extern FCEU_TLS uint32 MMC5HackVROMMask;
+extern FCEU_TLS uint8 *MMC5HackExNTARAMPtr;
+extern FCEU_TLS uint8 *MMC5HackVROMPTR;
+extern FCEU_TLS uint8 MMC5HackCHRMode;
+extern FCEU_TLS uint8 MMC5HackSPMode;
+extern FCEU_TLS uint8 MMC50x5130;
+extern FCEU_TLS uint8 MMC5HackSPScroll;
+extern FCEU_TLS uint8 MMC5HackSPPage;
+
+extern FCEU_TLS int PEC586Hack;
 
 // VRCV extarnal shared buffers/vars
-extern int QTAIHack;
-extern uint8 QTAINTRAM[2048];
-extern uint8 qtaintramreg;
+extern FCEU_TLS int QTAIHack;
+extern FCEU_TLS uint8 QTAINTRAM[2048];
+extern FCEU_TLS uint8 qtaintramreg;
 
 #define GAME_MEM_BLOCK_SIZE 131072
 
-extern  uint8  *RAM;            //shared memory modifications
-extern int EmulationPaused;
-extern int frameAdvance_Delay;
+extern FCEU_TLS  uint8  *RAM;            //shared memory modifications
+extern FCEU_TLS int EmulationPaused;
+extern FCEU_TLS int frameAdvance_Delay;
 
 uint8 FCEU_ReadRomByte(uint32 i);
 void FCEU_WriteRomByte(uint32 i, uint8 value);
 
-extern readfunc ARead[0x10000];
-extern writefunc BWrite[0x10000];
+extern FCEU_TLS readfunc ARead[0x10000];
+extern FCEU_TLS writefunc BWrite[0x10000];
+extern FCEU_TLS bool RAMDirect; //$0000-$1FFF is plain mirrored RAM with the stock handlers
+extern FCEU_TLS bool PRGDirect[32]; //this 2K page is read through CartBR only (always false below $6000)
+//on by default. off keeps every PRGDirect flag false, so all reads go through ARead as they did before it
+void FCEU_SetPRGDirect(bool enable);
 
 enum GI {
 	GI_RESETM2	=1,
@@ -84,17 +88,17 @@ enum GI {
 	GI_RESETSAVE = 4
 };
 
-extern void (*GameInterface)(GI h);
-extern void (*GameStateRestore)(int version);
+extern FCEU_TLS void (*GameInterface)(GI h);
+extern FCEU_TLS void (*GameStateRestore)(int version);
 
 
 #include "git.h"
-extern FCEUGI *GameInfo;
-extern int GameAttributes;
+extern FCEU_TLS FCEUGI *GameInfo;
+extern FCEU_TLS int GameAttributes;
 
-extern uint8 PAL;
-extern int dendy;
-extern bool movieSubtitles;
+extern FCEU_TLS uint8 PAL;
+extern FCEU_TLS int dendy;
+extern FCEU_TLS bool movieSubtitles;
 
 //#include "driver.h"
 
@@ -131,7 +135,7 @@ typedef struct {
 int FCEU_TextScanlineOffset(int y);
 int FCEU_TextScanlineOffsetFromBottom(int y);
 
-extern FCEUS FSettings;
+extern FCEU_TLS FCEUS FSettings;
 
 bool CheckFileExists(const char* filename);	//Receives a filename (fullpath) and checks to see if that file exists
 
@@ -153,9 +157,9 @@ extern void UpdateCheckedMenuItems();
 extern void PushCurrentVideoSettings();
 #endif
 
-extern uint8 Exit;
-extern int default_palette_selection;
-extern uint8 vsdip;
+extern FCEU_TLS uint8 Exit;
+extern FCEU_TLS int default_palette_selection;
+extern FCEU_TLS uint8 vsdip;
 
 //#define FCEUDEF_DEBUGGER //mbg merge 7/17/06 - cleaning out conditional compiles
 
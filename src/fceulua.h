@@ -28,6 +28,7 @@ enum LuaMemHookType
 	LUAMEMHOOK_COUNT
 };
 void CallRegisteredLuaMemHook(unsigned int address, int size, unsigned int value, LuaMemHookType hookType);
+bool AnyRegisteredLuaMemHook(LuaMemHookType hookType);
 
 struct LuaSaveData
 {
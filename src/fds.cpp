@@ -41,9 +41,9 @@
 //	and the when it can be successfully read/written to.  This should
 //	prevent writes to wrong places OR add code to prevent disk ejects
 //	when the virtual motor is on (mmm...virtual motor).
-extern int disableBatteryLoading;
+extern FCEU_TLS int disableBatteryLoading;
 
-bool isFDS = false; //flag for determining if a FDS game is loaded, movie.cpp needs this
+FCEU_TLS bool isFDS = false; //flag for determining if a FDS game is loaded, movie.cpp needs this
 
 static DECLFR(FDSRead4030);
 static DECLFR(FDSRead4031);
@@ -62,40 +62,41 @@ static void FDSInit(void);
 static void FDSClose(void);
 
 static void FDSFix(int a);
+static int32 FDSFixBudget(void);
 
-static uint8 FDSRegs[6];
-static int32 IRQLatch, IRQCount;
-static uint8 IRQa;
+static FCEU_TLS uint8 FDSRegs[6];
+static FCEU_TLS int32 IRQLatch, IRQCount;
+static FCEU_TLS uint8 IRQa;
 
-static uint8 *FDSRAM = NULL;
-static uint32 FDSRAMSize;
-static uint8 *FDSBIOS = NULL;
-static uint32 FDSBIOSsize;
-static uint8 *CHRRAM = NULL;
-static uint32 CHRRAMSize;
+static FCEU_TLS uint8 *FDSRAM = NULL;
+static FCEU_TLS uint32 FDSRAMSize;
+static FCEU_TLS uint8 *FDSBIOS = NULL;
+static FCEU_TLS uint32 FDSBIOSsize;
+static FCEU_TLS uint8 *CHRRAM = NULL;
+static FCEU_TLS uint32 CHRRAMSize;
 
 /* Original disk data backup, to help in creating save states. */
-static uint8 *diskdatao[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static FCEU_TLS uint8 *diskdatao[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
-static uint8 *diskdata[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static FCEU_TLS uint8 *diskdata[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
-static int TotalSides; //mbg merge 7/17/06 - unsignedectomy
-static uint8 DiskWritten = 0;    /* Set to 1 if disk was written to. */
-static uint8 writeskip;
-static int32 DiskPtr;
-static int32 DiskSeekIRQ;
-static uint8 SelectDisk, InDisk;
+static FCEU_TLS int TotalSides; //mbg merge 7/17/06 - unsignedectomy
+static FCEU_TLS uint8 DiskWritten = 0;    /* Set to 1 if disk was written to. */
+static FCEU_TLS uint8 writeskip;
+static FCEU_TLS int32 DiskPtr;
+static FCEU_TLS int32 DiskSeekIRQ;
+static FCEU_TLS uint8 SelectDisk, InDisk;
 
 /* 4024(w), 4025(w), 4031(r) by dink(fbneo) */
 #define USE_DINK // remove this and old code after testing phase
 enum FDS_DiskBlockIDs { DSK_INIT = 0, DSK_VOLUME, DSK_FILECNT, DSK_FILEHDR, DSK_FILEDATA };
-static uint8  mapperFDS_control;    // 4025(w) control register
-static uint16 mapperFDS_filesize;	// size of file being read/written
-static uint8  mapperFDS_block;		// block-id of current block
-static uint16 mapperFDS_blockstart;	// start-address of current block
-static uint16 mapperFDS_blocklen;	// length of current block
-static uint16 mapperFDS_diskaddr;   // current address relative to blockstart
-static uint8  mapperFDS_diskaccess;	// disk needs to be accessed at least once before writing
+static FCEU_TLS uint8  mapperFDS_control;    // 4025(w) control register
+static FCEU_TLS uint16 mapperFDS_filesize;	// size of file being read/written
+static FCEU_TLS uint8  mapperFDS_block;		// block-id of current block
+static FCEU_TLS uint16 mapperFDS_blockstart;	// start-address of current block
+static FCEU_TLS uint16 mapperFDS_blocklen;	// length of current block
+static FCEU_TLS uint16 mapperFDS_diskaddr;   // current address relative to blockstart
+static FCEU_TLS uint8  mapperFDS_diskaccess;	// disk needs to be accessed at least once before writing
 #define fds_disk() (diskdata[InDisk][mapperFDS_blockstart + mapperFDS_diskaddr])
 #define mapperFDS_diskinsert (InDisk != 255)
 
@@ -138,6 +139,7 @@ static void FDSInit(void) {
 	setchr8(0);					// 8KB CHR RAM
 
 	MapIRQHook = FDSFix;
+	MapIRQHookBudget = FDSFixBudget;
 	GameStateRestore = FDSStateRestore;
 
 	SetReadHandler(0x4030, 0x4030, FDSRead4030);
@@ -220,6 +222,16 @@ void FCEU_FDSSelect(void)
 	FCEU_DispMessage("Disk %d Side %c Selected", 0, SelectDisk >> 1, (SelectDisk & 1) ? 'B' : 'A');
 }
 
+// cycles until the timer irq or the disk irq fires
+static int32 FDSFixBudget(void) {
+	int32 budget = 0x7FFFFFFF;
+	if ((IRQa & 2) && IRQCount)
+		budget = IRQCount;
+	if (DiskSeekIRQ > 0 && DiskSeekIRQ < budget)
+		budget = DiskSeekIRQ;
+	return budget;
+}
+
 static void FDSFix(int a) {
 	if ((IRQa & 2) && IRQCount) {
 		IRQCount -= a;
@@ -263,6 +275,7 @@ static DECLFR(FDSRead4031) {
 		z = diskdata[InDisk][DiskPtr];
 		if (!fceuindbg) {
 			if (DiskPtr < 64999) DiskPtr++;
+			X6502_SyncHooks();
 			DiskSeekIRQ = 150;
 			X6502_IRQEnd(FCEU_IQEXT2);
 		}
@@ -273,7 +286,7 @@ static DECLFR(FDSRead4031) {
 #else
 
 static DECLFR(FDSRead4031) {
-	static uint8 ret = 0;
+	static FCEU_TLS uint8 ret = 0;
 
 	ret = 0xff;
 	if (mapperFDS_diskinsert && mapperFDS_control & 0x04) {
@@ -305,6 +318,7 @@ static DECLFR(FDSRead4031) {
 				break;
 		}
 
+		X6502_SyncHooks();
 		DiskSeekIRQ = 150;
 		X6502_IRQEnd(FCEU_IQEXT2);
 	}
@@ -353,7 +367,7 @@ typedef struct {
 	uint8 SPSG[0xB];
 } FDSSOUND;
 
-static FDSSOUND fdso;
+static FCEU_TLS FDSSOUND fdso;
 
 #define  SPSG  fdso.SPSG
 #define b19shiftreg60  fdso.b19shiftreg60
@@ -429,7 +443,7 @@ static void DoEnv() {
 
 	for (x = 0; x < 2; x++)
 		if (!(SPSG[x << 2] & 0x80) && !(SPSG[0x3] & 0x40)) {
-			static int counto[2] = { 0, 0 };
+			static FCEU_TLS int counto[2] = { 0, 0 };
 
 			if (counto[x] <= 0) {
 				if (!(SPSG[x << 2] & 0x80)) {
@@ -456,7 +470,7 @@ static DECLFW(FDSWaveWrite) {
 		fdso.cwave[A & 0x3f] = V & 0x3F;
 }
 
-static int ta;
+static FCEU_TLS int ta;
 static INLINE void ClockRise(void) {
 	if (!clockcount) {
 		ta++;
@@ -518,7 +532,7 @@ static INLINE int32 FDSDoSound(void) {
 	}
 }
 
-static int32 FBC = 0;
+static FCEU_TLS int32 FBC = 0;
 
 static void RenderSound(void) {
 	int32 end, start;
@@ -585,6 +599,9 @@ void FDSSoundReset(void) {
 }
 
 static DECLFW(FDSWrite) {
+	//everything FDSFix counts with, including the disk irq enable in $4025
+	if (A != 0x4023 && A != 0x4024)
+		X6502_SyncHooks();
 	switch (A) {
 	case 0x4020:
 		X6502_IRQEnd(FCEU_IQEXT);
@@ -874,7 +891,7 @@ int FDSLoad(const char *name, FCEUFILE *fp) {
 		free(fn);
 	}
 
-	extern char LoadedRomFName[2048];
+	extern FCEU_TLS char LoadedRomFName[2048];
 	strcpy(LoadedRomFName, name); //For the debugger list
 
 	GameInfo->type = GIT_FDS;
@@ -1,4 +1,4 @@
-extern bool isFDS;
+extern FCEU_TLS bool isFDS;
 void FDSSoundReset(void);
 
 void FCEU_FDSInsert(void);
@@ -55,11 +55,11 @@
 
 using namespace std;
 
-bool bindSavestate = true;	//Toggle that determines if a savestate filename will include the movie filename
-static std::string BaseDirectory;
-static char FileExt[2048];	//Includes the . character, as in ".nes"
-char FileBase[2048];
-static char FileBaseDirectory[2048];
+FCEU_TLS bool bindSavestate = true;	//Toggle that determines if a savestate filename will include the movie filename
+static FCEU_TLS std::string BaseDirectory;
+static FCEU_TLS char FileExt[2048];	//Includes the . character, as in ".nes"
+FCEU_TLS char FileBase[2048];
+static FCEU_TLS char FileBaseDirectory[2048];
 
 
 void ApplyIPS(FILE *ips, FCEUFILE* fp)
@@ -450,7 +450,7 @@ int FCEU_fisarchive(FCEUFILE *fp)
 std::string GetMfn() //Retrieves the movie filename from curMovieFilename (for adding to savestate and auto-save files)
 {
 	std::string movieFilenamePart;
-	extern char curMovieFilename[512];
+	extern FCEU_TLS char curMovieFilename[512];
 	if(*curMovieFilename)
 		{
 		char drv[PATH_MAX], dir[PATH_MAX], name[PATH_MAX], ext[PATH_MAX];
@@ -471,7 +471,7 @@ const char *FCEUI_GetBaseDirectory(void)
 	return BaseDirectory.c_str();
 }
 
-static char *odirs[FCEUIOD__COUNT]={0,0,0,0,0,0,0,0,0,0,0,0,0};     // odirs, odors. ^_^
+static FCEU_TLS char *odirs[FCEUIOD__COUNT]={0,0,0,0,0,0,0,0,0,0,0,0,0};     // odirs, odors. ^_^
 
 void FCEUI_SetDirOverride(int which, char *n)
 {
@@ -13,11 +13,14 @@
 #include <cmath>
 #include <cstdio>
 
-static int32 sq2coeffs[SQ2NCOEFFS];
-static int32 coeffs[NCOEFFS];
+static FCEU_TLS int32 sq2coeffs[SQ2NCOEFFS];
+static FCEU_TLS int32 coeffs[NCOEFFS];
 
-static uint32 mrindex;
-static uint32 mrratio;
+static FCEU_TLS uint32 mrindex;
+static FCEU_TLS uint32 mrratio;
+
+static FCEU_TLS int64 acc1=0,acc2=0;	//SexyFilter
+static FCEU_TLS int64 lpacc=0;		//SexyFilter2
 
 void SexyFilter2(int32 *in, int32 count)
 {
@@ -32,15 +35,14 @@ void SexyFilter2(int32 *in, int32 count)
  c=p*0x100000;
  //printf("%f\n",(double)c/0x100000);
  #endif
- static int64 acc=0;
 
  while(count--)
  {
   int64 dropcurrent;
-  dropcurrent=((*in<<16)-acc)>>3;
+  dropcurrent=((*in<<16)-lpacc)>>3;
 
-  acc+=dropcurrent;
-  *in=acc>>16;
+  lpacc+=dropcurrent;
+  *in=lpacc>>16;
   in++;
   //acc=((int64)0x100000-c)* *in + ((c*acc)>>20);
   //*in=acc>>20;
@@ -50,7 +52,6 @@ void SexyFilter2(int32 *in, int32 count)
 
 void SexyFilter(int32 *in, int32 *out, int32 count)
 {
- static int64 acc1=0,acc2=0;
  int32 mul1,mul2,vmul;
 
  mul1=(94<<16)/FSettings.SndRate;
@@ -165,6 +166,28 @@ int32 NeoFilterSound(int32 *in, int32 *out, uint32 inlen, int32 *leftover)
 	return(count);
 }
 
+void GetFilterState(FilterState *fs)
+{
+ fs->mrindex=mrindex;
+ fs->acc1=acc1;
+ fs->acc2=acc2;
+ fs->lpacc=lpacc;
+}
+
+void SetFilterState(const FilterState *fs)
+{
+ mrindex=fs->mrindex;
+ acc1=fs->acc1;
+ acc2=fs->acc2;
+ lpacc=fs->lpacc;
+}
+
+void ResetFilterState(void)
+{
+ mrindex=((FSettings.soundq==2?SQ2NCOEFFS:NCOEFFS)+1)<<16;
+ acc1=acc2=lpacc=0;
+}
+
 void MakeFilters(int32 rate)
 {
  const int32 *tabs[6]={C44100NTSC,C44100PAL,C48000NTSC,C48000PAL,C96000NTSC,
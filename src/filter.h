@@ -1,3 +1,21 @@
+#ifndef _FILTER_H_
+#define _FILTER_H_
+
 int32 NeoFilterSound(int32 *in, int32 *out, uint32 inlen, int32 *leftover);
 void MakeFilters(int32 rate);
 void SexyFilter(int32 *in, int32 *out, int32 count);
+
+//the resampler's position and the filters' memory. they carry over from one flush to the next
+struct FilterState
+{
+ uint32 mrindex;
+ int64 acc1,acc2;	//SexyFilter
+ int64 lpacc;		//SexyFilter2
+};
+
+void GetFilterState(FilterState *fs);
+void SetFilterState(const FilterState *fs);
+//back to where MakeFilters starts
+void ResetFilterState(void);
+
+#endif
@@ -42,28 +42,28 @@
 #include <cstdlib>
 #include <cstring>
 
-extern SFORMAT FCEUVSUNI_STATEINFO[];
+extern FCEU_TLS SFORMAT FCEUVSUNI_STATEINFO[];
 
 //mbg merge 6/29/06 - these need to be global
-uint8 *trainerpoo = NULL;
-uint8 *ROM = NULL;
-uint8 *VROM = NULL;
-uint8 *ExtraNTARAM = NULL;
-iNES_HEADER head;
+FCEU_TLS uint8 *trainerpoo = NULL;
+FCEU_TLS uint8 *ROM = NULL;
+FCEU_TLS uint8 *VROM = NULL;
+FCEU_TLS uint8 *ExtraNTARAM = NULL;
+FCEU_TLS iNES_HEADER head;
 
-static CartInfo iNESCart;
+static FCEU_TLS CartInfo iNESCart;
 
-uint8 Mirroring = 0;
-uint32 ROM_size = 0;
-uint32 VROM_size = 0;
-char LoadedRomFName[2048]; //mbg merge 7/17/06 added
+FCEU_TLS uint8 Mirroring = 0;
+FCEU_TLS uint32 ROM_size = 0;
+FCEU_TLS uint32 VROM_size = 0;
+FCEU_TLS char LoadedRomFName[2048]; //mbg merge 7/17/06 added
 
-static int CHRRAMSize = -1;
+static FCEU_TLS int CHRRAMSize = -1;
 static int iNES_Init(int num);
 
-static int MapperNo = 0;
+static FCEU_TLS int MapperNo = 0;
 
-int iNES2 = 0;
+FCEU_TLS int iNES2 = 0;
 
 static DECLFR(TrainerRead) {
 	return(trainerpoo[A & 0x1FF]);
@@ -127,7 +127,7 @@ void iNESGI(GI h) { //bbit edited: removed static keyword
 	}
 }
 
-uint32 iNESGameCRC32 = 0;
+FCEU_TLS uint32 iNESGameCRC32 = 0;
 
 struct CRCMATCH {
 	uint32 crc;
@@ -142,7 +142,7 @@ struct INPSEL {
 };
 
 static void SetInput(void) {
-	static struct INPSEL moo[] =
+	static FCEU_TLS struct INPSEL moo[] =
 	{
 		{0x19b0a9f1,	SI_GAMEPAD,		SI_ZAPPER,		SIFC_NONE		},	// 6-in-1 (MGC-023)(Unl)[!]
 		{0x29de87af,	SI_GAMEPAD,		SI_GAMEPAD,		SIFC_FTRAINERB	},	// Aerobics Studio
@@ -237,7 +237,7 @@ struct BADINF {
 	uint32 type;
 };
 
-static struct BADINF BadROMImages[] =
+static FCEU_TLS struct BADINF BadROMImages[] =
 {
 	#include "ines-bad.h"
 };
@@ -272,8 +272,8 @@ static const TMasterRomInfo sMasterRomInfo[] = {
 	{ 0x9342bf9bae1c798aULL, "bonus=0" }, //4-in-1 (FK23C8079) [p1][!].nes
 	{ 0x164eea6097a1e313ULL, "busc=1" }, //Cybernoid - The Fighting Machine (U)[!].nes -- needs bus conflict emulation
 };
-const TMasterRomInfo* MasterRomInfo;
-TMasterRomInfoParams MasterRomInfoParams;
+FCEU_TLS const TMasterRomInfo* MasterRomInfo;
+FCEU_TLS TMasterRomInfoParams MasterRomInfoParams;
 
 static void CheckHInfo(void) {
 	/* ROM images that have the battery-backed bit set in the header that really
@@ -283,7 +283,7 @@ static void CheckHInfo(void) {
 	Lower 64 bits of the MD5 hash.
 	*/
 
-	static uint64 savie[] =
+	static FCEU_TLS uint64 savie[] =
 	{
 		0xc04361e499748382ULL,	/* AD&D Heroes of the Lance */
 		0xb72ee2337ced5792ULL,	/* AD&D Hillsfar */
@@ -320,7 +320,7 @@ static void CheckHInfo(void) {
 		0						/* Abandon all hope if the game has 0 in the lower 64-bits of its MD5 hash */
 	};
 
-	static struct CHINF moo[] =
+	static FCEU_TLS struct CHINF moo[] =
 	{
 		#include "ines-correct.h"
 	};
@@ -447,12 +447,12 @@ typedef struct {
 // so we need either add here ALL ines 2.0 mappers 
 // with not power2 roms or change logic here
 // to something more unified for ines 2.0 specific
-static int not_power2[] =
+static FCEU_TLS int not_power2[] =
 {
 	53, 198, 228, 547
 };
 
-BMAPPINGLocal bmap[] = {
+FCEU_TLS BMAPPINGLocal bmap[] = {
 	{"NROM",				  0, NROM_Init},
 	{"MMC1",				  1, Mapper1_Init},
 	{"UNROM",				  2, UNROM_Init},
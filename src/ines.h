@@ -38,17 +38,17 @@ public:
 };
 
 //mbg merge 6/29/06
-extern uint8 *ROM;
-extern uint8 *VROM;
-extern uint32 VROM_size;
-extern uint32 ROM_size;
-extern uint8 *ExtraNTARAM;
+extern FCEU_TLS uint8 *ROM;
+extern FCEU_TLS uint8 *VROM;
+extern FCEU_TLS uint32 VROM_size;
+extern FCEU_TLS uint32 ROM_size;
+extern FCEU_TLS uint8 *ExtraNTARAM;
 extern int iNesSave(void); //bbit Edited: line added
 extern int iNesSaveAs(const char* name);
-extern char LoadedRomFName[2048]; //bbit Edited: line added
+extern FCEU_TLS char LoadedRomFName[2048]; //bbit Edited: line added
 extern char *iNesShortFName(void);
-extern const TMasterRomInfo* MasterRomInfo;
-extern TMasterRomInfoParams MasterRomInfoParams;
+extern FCEU_TLS const TMasterRomInfo* MasterRomInfo;
+extern FCEU_TLS TMasterRomInfoParams MasterRomInfoParams;
 
 //mbg merge 7/19/06 changed to c++ decl format
 struct iNES_HEADER {
@@ -80,7 +80,7 @@ struct iNES_HEADER {
 	}
 };
 
-extern struct iNES_HEADER head; //for mappers usage
+extern FCEU_TLS struct iNES_HEADER head; //for mappers usage
 
 void NSFVRC6_Init(void);
 void NSFMMC5_Init(void);
@@ -84,20 +84,20 @@ extern INPUTCFC *FCEU_InitBarcodeWorld(void);
 //---------------
 
 //global lag variables
-unsigned int lagCounter;
-bool lagCounterDisplay;
-char lagFlag;
-extern bool frameAdvanceLagSkip;
-extern bool movieSubtitles;
+FCEU_TLS unsigned int lagCounter;
+FCEU_TLS bool lagCounterDisplay;
+FCEU_TLS char lagFlag;
+extern FCEU_TLS bool frameAdvanceLagSkip;
+extern FCEU_TLS bool movieSubtitles;
 //-------------
 
-static uint8 joy_readbit[2];
-uint8 joy[4]={0,0,0,0}; //HACK - should be static but movie needs it
-uint16 snesjoy[4]={0,0,0,0}; //HACK - should be static but movie needs it
-static uint8 LastStrobe;
-uint8 RawReg4016 = 0; // Joystick strobe (W)
+static FCEU_TLS uint8 joy_readbit[2];
+FCEU_TLS uint8 joy[4]={0,0,0,0}; //HACK - should be static but movie needs it
+FCEU_TLS uint16 snesjoy[4]={0,0,0,0}; //HACK - should be static but movie needs it
+static FCEU_TLS uint8 LastStrobe;
+FCEU_TLS uint8 RawReg4016 = 0; // Joystick strobe (W)
 
-bool replaceP2StartWithMicrophone = false;
+FCEU_TLS bool replaceP2StartWithMicrophone = false;
 
 //This function is a quick hack to get the NSF player to use emulated gamepad input.
 uint8 FCEU_GetJoyJoy(void)
@@ -105,22 +105,22 @@ uint8 FCEU_GetJoyJoy(void)
 	return(joy[0]|joy[1]|joy[2]|joy[3]);
 }
 
-extern uint8 coinon;
+extern FCEU_TLS uint8 coinon;
 
 //set to true if the fourscore is attached
-static bool FSAttached = false;
+static FCEU_TLS bool FSAttached = false;
 
-JOYPORT joyports[2] = { JOYPORT(0), JOYPORT(1) };
-FCPORT portFC;
+FCEU_TLS JOYPORT joyports[2] = { JOYPORT(0), JOYPORT(1) };
+FCEU_TLS FCPORT portFC;
 
-FILE* DumpInputFile;
-FILE* PlayInputFile;
+FCEU_TLS FILE* DumpInputFile;
+FCEU_TLS FILE* PlayInputFile;
 
 static DECLFR(JPRead)
 {
 	lagFlag = 0;
 	uint8 ret=0;
-	static bool microphone = false;
+	static FCEU_TLS bool microphone = false;
 
 	ret|=joyports[A&1].driver->Read(A&1);
 
@@ -188,13 +188,13 @@ static DECLFW(B4016)
 }
 
 //a main joystick port driver representing the case where nothing is plugged in
-static INPUTC DummyJPort={0};
+static FCEU_TLS INPUTC DummyJPort={0};
 //and an expansion port driver for the same ting
-static INPUTCFC DummyPortFC={0};
+static FCEU_TLS INPUTCFC DummyPortFC={0};
 
 
 //--------4 player driver for expansion port--------
-static uint8 F4ReadBit[2];
+static FCEU_TLS uint8 F4ReadBit[2];
 static void StrobeFami4(void)
 {
 	F4ReadBit[0]=F4ReadBit[1]=0;
@@ -211,7 +211,7 @@ static uint8 ReadFami4(int w, uint8 ret)
 	return(ret);
 }
 
-static INPUTCFC FAMI4C={ReadFami4,0,StrobeFami4,0,0,0};
+static FCEU_TLS INPUTCFC FAMI4C={ReadFami4,0,StrobeFami4,0,0,0};
 //------------------
 
 //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
@@ -374,7 +374,7 @@ static void StrobeSNES(int w)
 //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 
 //--------Hori 4 player driver for expansion port--------
-static uint8 Hori4ReadBit[2];
+static FCEU_TLS uint8 Hori4ReadBit[2];
 static void StrobeHori4(void)
 {
 	Hori4ReadBit[0] = Hori4ReadBit[1] = 0;
@@ -402,14 +402,14 @@ static uint8 ReadHori4(int w, uint8 ret)
 	return(ret);
 }
 
-static INPUTCFC HORI4C = { ReadHori4,0,StrobeHori4,0,0,0 };
+static FCEU_TLS INPUTCFC HORI4C = { ReadHori4,0,StrobeHori4,0,0,0 };
 //------------------
 
 //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 
-static INPUTC GPC={ReadGP,0,StrobeGP,UpdateGP,0,0,LogGP,LoadGP};
-static INPUTC GPCVS={ReadGPVS,0,StrobeGP,UpdateGP,0,0,LogGP,LoadGP};
-static INPUTC GPSNES={ReadSNES,0,StrobeSNES,UpdateSNES,0,0,LogSNES,LoadSNES};
+static FCEU_TLS INPUTC GPC={ReadGP,0,StrobeGP,UpdateGP,0,0,LogGP,LoadGP};
+static FCEU_TLS INPUTC GPCVS={ReadGPVS,0,StrobeGP,UpdateGP,0,0,LogGP,LoadGP};
+static FCEU_TLS INPUTC GPSNES={ReadSNES,0,StrobeSNES,UpdateSNES,0,0,LogSNES,LoadSNES};
 
 void FCEU_DrawInput(uint8 *buf)
 {
@@ -479,6 +479,14 @@ void InputScanlineHook(uint8 *bg, uint8 *spr, uint32 linets, int final)
 	portFC.driver->SLHook(bg,spr,linets,final);
 }
 
+bool InputScanlineHookUsed(void)
+{
+	for(int port=0;port<2;port++)
+		if(joyports[port].driver->_SLHook)
+			return true;
+	return portFC.driver->_SLHook != 0;
+}
+
 #include <iostream>
 //binds JPorts[pad] to the driver specified in JPType[pad]
 static void SetInputStuff(int port)
@@ -610,6 +618,7 @@ void InitializeInput(void)
 	memset(joy_readbit,0,sizeof(joy_readbit));
 	memset(joy,0,sizeof(joy));
 	LastStrobe = 0;
+	lagFlag = 0;
 
 	if(GameInfo->type==GIT_VSUNI)
 	{
@@ -642,8 +651,8 @@ void FCEUI_SetInputFourscore(bool attachFourscore)
 }
 
 //mbg 6/18/08 HACK
-extern ZAPPER ZD[2];
-SFORMAT FCEUCTRL_STATEINFO[]={
+extern FCEU_TLS ZAPPER ZD[2];
+FCEU_TLS SFORMAT FCEUCTRL_STATEINFO[]={
 	{ joy_readbit,	2, "JYRB"},
 	{ joy,			4, "JOYS"},
 	{ &LastStrobe,	1, "LSTS"},
@@ -722,7 +731,7 @@ void FCEUI_VSUniCoin(void)
 //Resets the frame counter if movie inactive and rom is reset or power-cycle
 void ResetFrameCounter()
 {
-extern EMOVIEMODE movieMode;
+extern FCEU_TLS EMOVIEMODE movieMode;
 	if(movieMode == MOVIEMODE_INACTIVE)
 		currFrameCounter = 0;
 }
@@ -749,7 +758,7 @@ void FCEUI_PowerNES(void)
 	ResetFrameCounter();
 }
 
-const char* FCEUI_CommandTypeNames[]=
+FCEU_TLS const char* FCEUI_CommandTypeNames[]=
 {
 	"Misc.",
 	"Speed",
@@ -805,7 +814,7 @@ static void TaseditorRewindOff(void);
 static void TaseditorCommand(void);
 extern void FCEUI_ToggleShowFPS();
 
-struct EMUCMDTABLE FCEUI_CommandTable[]=
+FCEU_TLS struct EMUCMDTABLE FCEUI_CommandTable[]=
 {
 	{ EMUCMD_POWER,							EMUCMDTYPE_MISC,	FCEUI_PowerNES,					0, 0, "Power", EMUCMDFLAG_TASEDITOR },
 	{ EMUCMD_RESET,							EMUCMDTYPE_MISC,	FCEUI_ResetNES,					0, 0, "Reset", EMUCMDFLAG_TASEDITOR },
@@ -953,7 +962,7 @@ struct EMUCMDTABLE FCEUI_CommandTable[]=
 
 #define NUM_EMU_CMDS		(sizeof(FCEUI_CommandTable)/sizeof(FCEUI_CommandTable[0]))
 
-static int execcmd, i;
+static FCEU_TLS int execcmd, i;
 
 void FCEUI_HandleEmuCommands(TestCommandState* testfn)
 {
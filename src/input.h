@@ -8,8 +8,8 @@
 
 void LagCounterToggle(void);
 
-extern FILE* PlayInputFile;
-extern FILE* DumpInputFile;
+extern FCEU_TLS FILE* PlayInputFile;
+extern FCEU_TLS FILE* DumpInputFile;
 
 
 class MovieRecord;
@@ -71,7 +71,7 @@ struct INPUTCFC
 	void (*_Load)(MovieRecord* mr);
 };
 
-extern struct JOYPORT
+extern FCEU_TLS struct JOYPORT
 {
 	JOYPORT(int _w)
 		: w(_w), attrib(0), type(SI_UNSET), ptr(0), driver(0)
@@ -87,7 +87,7 @@ extern struct JOYPORT
 	void load(MovieRecord* mr) { driver->Load(w,mr); }
 } joyports[2];
 
-extern struct FCPORT
+extern FCEU_TLS struct FCPORT
 {
 	int attrib;
 	ESIFC type;
@@ -100,10 +100,12 @@ void FCEU_DrawInput(uint8 *buf);
 void FCEU_UpdateInput(void);
 void InitializeInput(void);
 void FCEU_UpdateBot(void);
-extern void (*PStrobe[2])(void);
+extern FCEU_TLS void (*PStrobe[2])(void);
 
 //called from PPU on scanline events.
 extern void InputScanlineHook(uint8 *bg, uint8 *spr, uint32 linets, int final);
+//true if any attached device looks at the rendered scanlines (e.g. zapper).
+bool InputScanlineHookUsed(void);
 
 void FCEU_DoSimpleCommand(int cmd);
 
@@ -278,7 +280,7 @@ enum EMUCMDTYPE
 	EMUCMDTYPE_MAX
 };
 
-extern const char* FCEUI_CommandTypeNames[];
+extern FCEU_TLS const char* FCEUI_CommandTypeNames[];
 
 typedef void EMUCMDFN(void);
 
@@ -299,12 +301,12 @@ struct EMUCMDTABLE
 	int flags; //EMUCMDFLAG
 };
 
-extern struct EMUCMDTABLE FCEUI_CommandTable[];
+extern FCEU_TLS struct EMUCMDTABLE FCEUI_CommandTable[];
 
-extern unsigned int lagCounter;
-extern bool lagCounterDisplay;
-extern char lagFlag;
-extern bool turbo;
+extern FCEU_TLS unsigned int lagCounter;
+extern FCEU_TLS bool lagCounterDisplay;
+extern FCEU_TLS char lagFlag;
+extern FCEU_TLS bool turbo;
 void LagCounterReset();
 
 #endif //_INPUT_H_
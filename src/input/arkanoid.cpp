@@ -27,8 +27,8 @@ typedef struct {
 	uint32 readbit;
 } ARK;
 
-static ARK NESArk[2];
-static ARK FCArk;
+static FCEU_TLS ARK NESArk[2];
+static FCEU_TLS ARK FCArk;
 
 static void StrobeARKFC(void)
 {
@@ -71,7 +71,7 @@ static void UpdateARKFC(void *data, int arg)
  FCArk.mzb=ptr[2]?1:0;
 }
 
-static INPUTCFC ARKCFC={ReadARKFC,0,StrobeARKFC,UpdateARKFC,0,0};
+static FCEU_TLS INPUTCFC ARKCFC={ReadARKFC,0,StrobeARKFC,UpdateARKFC,0,0};
 
 INPUTCFC *FCEU_InitArkanoidFC(void)
 {
@@ -109,7 +109,7 @@ static void UpdateARK(int w, void *data, int arg)
  NESArk[w].mzb=ptr[2]?1:0;
 }
 
-static INPUTC ARKC={ReadARK, 0, StrobeARK, UpdateARK, 0, 0};
+static FCEU_TLS INPUTC ARKC={ReadARK, 0, StrobeARK, UpdateARK, 0, 0};
 
 INPUTC *FCEU_InitArkanoid(int w)
 {
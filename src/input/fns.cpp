@@ -24,8 +24,8 @@
 #include <string.h>
 #include "share.h"
 
-static int readbit;
-static int32 readdata;
+static FCEU_TLS int readbit;
+static FCEU_TLS int32 readdata;
 
 static uint8 Read(int w, uint8 ret)
 {
@@ -50,7 +50,7 @@ static void Update(void *data, int arg)
 	readdata = *(uint32*)data;
 }
 
-static INPUTCFC FamiNetSys = { Read, 0, Strobe, Update, 0, 0 };
+static FCEU_TLS INPUTCFC FamiNetSys = { Read, 0, Strobe, Update, 0, 0 };
 
 INPUTCFC *FCEU_InitFamiNetSys(void)
 {
@@ -21,8 +21,8 @@
 #include <string.h>
 #include "share.h"
 
-static uint32 FTVal,FTValR;
-static char side;
+static FCEU_TLS uint32 FTVal,FTValR;
+static FCEU_TLS char side;
 
 static uint8 FT_Read(int w, uint8 ret)
 {
@@ -56,7 +56,7 @@ static void FT_Update(void *data, int arg)
  FTVal=*(uint32 *)data;
 }
 
-static INPUTCFC FamilyTrainer={FT_Read,FT_Write,0,FT_Update,0,0};
+static FCEU_TLS INPUTCFC FamilyTrainer={FT_Read,FT_Write,0,FT_Update,0,0};
 
 INPUTCFC *FCEU_InitFamilyTrainerA(void)
 {
@@ -17,8 +17,8 @@
 
 #include "share.h"
 
-static uint32 lcdCompZapperStrobe[2];
-static uint32 lcdCompZapperData[2];
+static FCEU_TLS uint32 lcdCompZapperStrobe[2];
+static FCEU_TLS uint32 lcdCompZapperData[2];
 
 static uint8 ReadLCDCompZapper(int w)
 {
@@ -40,7 +40,7 @@ void UpdateLCDCompZapper(int w, void* data, int arg)
 		                (((*(uint32*)data) & 2 ^ 2) << 2));
 }
 
-static INPUTC LCDCompZapperCtrl = { ReadLCDCompZapper,0,StrobeLCDCompZapper,UpdateLCDCompZapper,0,0 };
+static FCEU_TLS INPUTC LCDCompZapperCtrl = { ReadLCDCompZapper,0,StrobeLCDCompZapper,UpdateLCDCompZapper,0,0 };
 
 INPUTC* FCEU_InitLCDCompZapper(int w)
 {
@@ -21,7 +21,7 @@
 #include <string.h>
 #include "share.h"
 
-static uint32 MReal,MRet;
+static FCEU_TLS uint32 MReal,MRet;
 
 static uint8 MJ_Read(int w, uint8 ret)
 {
@@ -70,7 +70,7 @@ static void MJ_Update(void *data, int arg)
  //HSVal=*(uint8*)data;
 }
 
-static INPUTCFC Mahjong={MJ_Read,MJ_Write,0,MJ_Update,0,0};
+static FCEU_TLS INPUTCFC Mahjong={MJ_Read,MJ_Write,0,MJ_Update,0,0};
 
 INPUTCFC *FCEU_InitMahjong(void)
 {
@@ -21,9 +21,9 @@
 #include <string.h>
 #include "share.h"
 
-static uint8 OKValR,LastWR;
-static uint32 OKData;
-static uint32 OKX,OKY,OKB;
+static FCEU_TLS uint8 OKValR,LastWR;
+static FCEU_TLS uint32 OKData;
+static FCEU_TLS uint32 OKX,OKY,OKB;
 
 static uint8 OK_Read(int w, uint8 ret)
 {
@@ -86,7 +86,7 @@ static void DrawOeka(uint8 *buf, int arg)
   FCEU_DrawCursor(buf, OKX, OKY);
 }  
 
-static INPUTCFC OekaKids={OK_Read,OK_Write,0,OK_Update,0,DrawOeka};
+static FCEU_TLS INPUTCFC OekaKids={OK_Read,OK_Write,0,OK_Update,0,DrawOeka};
 
 INPUTCFC *FCEU_InitOekaKids(void)
 {
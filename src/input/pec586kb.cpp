@@ -24,13 +24,13 @@
 
 #define AK(x)	FKB_ ## x
 
-static uint8 bufit[0x66];
-static uint8 kspos, kstrobe;
-static uint8 ksindex;
+static FCEU_TLS uint8 bufit[0x66];
+static FCEU_TLS uint8 kspos, kstrobe;
+static FCEU_TLS uint8 ksindex;
 
 //TODO: check all keys, some of the are wrong
 
-static uint16 matrix[13][8] =
+static FCEU_TLS uint16 matrix[13][8] =
 {
 	{ AK(ESCAPE),AK(SPACE),AK(LMENU),AK(LCONTROL),AK(LSHIFT),AK(GRAVE),AK(TAB),AK(CAPITAL) },
 	{ AK(F6),AK(F7),AK(F5),AK(F4),AK(F8),AK(F2),AK(F1),AK(F3) },
@@ -87,7 +87,7 @@ static void PEC586KB_Update(void *data, int arg) {
 	memcpy(bufit + 1, data, sizeof(bufit) - 1);
 }
 
-static INPUTCFC PEC586KB = { PEC586KB_Read, PEC586KB_Write, PEC586KB_Strobe, PEC586KB_Update, 0, 0 };
+static FCEU_TLS INPUTCFC PEC586KB = { PEC586KB_Read, PEC586KB_Write, PEC586KB_Strobe, PEC586KB_Update, 0, 0 };
 
 INPUTCFC *FCEU_InitPEC586KB(void) {
 	memset(bufit, 0, sizeof(bufit));
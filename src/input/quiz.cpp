@@ -21,8 +21,8 @@
 #include <string.h>
 #include "share.h"
 
-static uint8 QZVal,QZValR;
-static uint8 FunkyMode;
+static FCEU_TLS uint8 QZVal,QZValR;
+static FCEU_TLS uint8 FunkyMode;
 
 static uint8 QZ_Read(int w, uint8 ret)
 {
@@ -66,7 +66,7 @@ static void QZ_Update(void *data, int arg)
  QZVal=*(uint8 *)data;
 }
 
-static INPUTCFC QuizKing={QZ_Read,QZ_Write,QZ_Strobe,QZ_Update,0,0};
+static FCEU_TLS INPUTCFC QuizKing={QZ_Read,QZ_Write,QZ_Strobe,QZ_Update,0,0};
 
 INPUTCFC *FCEU_InitQuizKing(void)
 {
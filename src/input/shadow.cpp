@@ -31,7 +31,7 @@ typedef struct {
         uint64 zaphit;
 } ZAPPER;
 
-static ZAPPER ZD;
+static FCEU_TLS ZAPPER ZD;
 
 static void ZapperFrapper(uint8 *bg, uint8 *spr, uint32  linets, int final)
 {
@@ -139,7 +139,7 @@ static void StrobeShadow(void)
  ZD.zap_readbit=0;
 }
 
-static INPUTCFC SHADOWC={ReadZapper,0,StrobeShadow,UpdateZapper,ZapperFrapper,DrawZapper};
+static FCEU_TLS INPUTCFC SHADOWC={ReadZapper,0,StrobeShadow,UpdateZapper,ZapperFrapper,DrawZapper};
 
 INPUTCFC *FCEU_InitSpaceShadow(void)
 {
@@ -30,7 +30,7 @@ typedef struct {
 	int32 mb; // current buttons
 } SNES_MOUSE;
 
-static SNES_MOUSE SNESMouse;
+static FCEU_TLS SNES_MOUSE SNESMouse;
 
 static uint8 ReadSNESMouse(int w)
 {
@@ -96,7 +96,7 @@ static void UpdateSNESMouse(int w, void *data, int arg)
 	SNESMouse.mb = ptr[2] & 3; // bit 0 = left button, bit 1 = right button
 }
 
-static INPUTC SNES_MOUSEC =
+static FCEU_TLS INPUTC SNES_MOUSEC =
 {
 	ReadSNESMouse, // Read
 	WriteSNESMouse, // Write
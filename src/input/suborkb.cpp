@@ -23,11 +23,11 @@
 #include "suborkb.h"
 #define AK(x)	FKB_ ## x
 
-static uint8 bufit[0x66];
-static uint8 ksmode;
-static uint8 ksindex;
+static FCEU_TLS uint8 bufit[0x66];
+static FCEU_TLS uint8 ksmode;
+static FCEU_TLS uint8 ksindex;
 
-static uint16 matrix[13][2][4] =
+static FCEU_TLS uint16 matrix[13][2][4] =
 {
 	{ { AK(4), AK(G), AK(F), AK(C) }, { AK(F2), AK(E), AK(5), AK(V) } },
 	{ { AK(2), AK(D), AK(S), AK(END) }, { AK(F1), AK(W), AK(3), AK(X) } },
@@ -75,7 +75,7 @@ static void SuborKB_Update(void *data, int arg) {
 	memcpy(bufit + 1, data, sizeof(bufit) - 1);
 }
 
-static INPUTCFC SuborKB = { SuborKB_Read, SuborKB_Write, SuborKB_Strobe, SuborKB_Update, 0, 0 };
+static FCEU_TLS INPUTCFC SuborKB = { SuborKB_Read, SuborKB_Write, SuborKB_Strobe, SuborKB_Update, 0, 0 };
 
 INPUTCFC *FCEU_InitSuborKB(void) {
 	memset(bufit, 0, sizeof(bufit));
@@ -25,7 +25,7 @@
 #include "zapper.h"
 #include "../movie.h"
 
-ZAPPER ZD[2];
+FCEU_TLS ZAPPER ZD[2];
 
 static void ZapperFrapper(int w, uint8 *bg, uint8 *spr, uint32 linets, int final)
 {
@@ -99,7 +99,7 @@ static INLINE int CheckColor(int w)
 
         if(!block && mousetime < nowtime && mousetime >= nowtime - 384)
         {
-            extern uint8 *XBuf;
+            extern FCEU_TLS uint8 *XBuf;
             uint8 *pix = XBuf+(ZD[w].mzy<<8);
             uint8 a1 = pix[ZD[w].mzx];
             a1&=63;
@@ -209,8 +209,8 @@ static void LoadZapper(int w, MovieRecord* mr)
 }
 
 
-static INPUTC ZAPC={ReadZapper,0,0,UpdateZapper,ZapperFrapper,DrawZapper,LogZapper,LoadZapper};
-static INPUTC ZAPVSC={ReadZapperVS,0,StrobeZapperVS,UpdateZapper,ZapperFrapper,DrawZapper,LogZapper,LoadZapper};
+static FCEU_TLS INPUTC ZAPC={ReadZapper,0,0,UpdateZapper,ZapperFrapper,DrawZapper,LogZapper,LoadZapper};
+static FCEU_TLS INPUTC ZAPVSC={ReadZapperVS,0,StrobeZapperVS,UpdateZapper,ZapperFrapper,DrawZapper,LogZapper,LoadZapper};
 
 INPUTC *FCEU_InitZapper(int w)
 {
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "zlib.h"
+
+#include "lib-compress.hpp"
+
+namespace {
+
+constexpr char RECORD_MAGIC[4] = { 'F', 'X', 'S', 'Z' };
+constexpr std::uint32_t RECORD_VERSION = 1;
+
+bool parse_record(const void* buf, std::size_t size, CompressRecordHeader& h) {
+    if(size < sizeof(h)) return false;
+
+    std::memcpy(&h, buf, sizeof(h));
+    if(std::memcmp(h.magic, RECORD_MAGIC, 4) != 0 || h.version != RECORD_VERSION) return false;
+    return size - sizeof(h) >= h.data_size;
+}
+
+} // anonymous namespace
+
+bool compress_record(const std::uint8_t* data, std::size_t size, int level, std::vector<std::uint8_t>& out) {
+    if(size > std::numeric_limits<std::uint32_t>::max()) return false;
+
+    uLongf data_size = compressBound(static_cast<uLong>(size));
+    out.resize(sizeof(CompressRecordHeader) + data_size);
+    if(compress2(out.data() + sizeof(CompressRecordHeader), &data_size, data, static_cast<uLong>(size), level) != Z_OK)
+        return false;
+    out.resize(sizeof(CompressRecordHeader) + data_size);
+
+    CompressRecordHeader h {};
+    std::memcpy(h.magic, RECORD_MAGIC, 4);
+    h.version = RECORD_VERSION;
+    h.raw_size = static_cast<std::uint32_t>(size);
+    h.data_size = static_cast<std::uint32_t>(data_size);
+    std::memcpy(out.data(), &h, sizeof(h));
+    return true;
+}
+
+std::size_t compress_record_size(const void* buf, std::size_t size) {
+    CompressRecordHeader h;
+    if(!parse_record(buf, size, h)) return 0;
+    return sizeof(h) + h.data_size;
+}
+
+bool decompress_record(const void* buf, std::size_t size, std::vector<std::uint8_t>& out) {
+    CompressRecordHeader h;
+    if(!parse_record(buf, size, h)) return false;
+
+    out.resize(h.raw_size);
+    uLongf raw_size = h.raw_size;
+    const auto data = static_cast<const Bytef*>(buf) + sizeof(h);
+    if(uncompress(out.data(), &raw_size, data, h.data_size) != Z_OK) return false;
+    return raw_size == h.raw_size;
+}
+
+CompressPool::CompressPool(unsigned threads, std::size_t max_queue, int level, std::FILE* archive)
+    : max_queue_(std::max<std::size_t>(max_queue, 1)), level_(level), archive_(archive)
+{
+    if(archive_) {
+        std::fseek(archive_, 0, SEEK_END);
+        const long end = std::ftell(archive_);
+        archive_end_ = end > 0 ? static_cast<std::uint64_t>(end) : 0;
+    }
+
+    threads = std::max(threads, 1U);
+    for(unsigned i = 0; i < threads; ++i)
+        threads_.emplace_back([this] { work(); });
+}
+
+CompressPool::~CompressPool() {
+    flush();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_work_.notify_all();
+    for(auto& t : threads_)
+        t.join();
+
+    if(archive_) std::fclose(archive_);
+}
+
+std::shared_ptr<CompressTask> CompressPool::submit(std::vector<std::uint8_t>&& data) {
+    auto task = std::make_shared<CompressTask>();
+    task->data = std::move(data);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_space_.wait(lock, [this] { return queue_.size() < max_queue_; });
+        queue_.push_back(task);
+    }
+    cv_work_.notify_one();
+
+    return task;
+}
+
+void CompressPool::wait(const CompressTask& task) {
+    if(task.done.load(std::memory_order_acquire)) return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_done_.wait(lock, [&task] { return task.done.load(std::memory_order_acquire); });
+}
+
+void CompressPool::flush() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_done_.wait(lock, [this] { return queue_.empty() && running_ == 0; });
+    }
+
+    if(archive_) {
+        std::lock_guard<std::mutex> lock(archive_mutex_);
+        std::fflush(archive_);
+    }
+}
+
+void CompressPool::work() {
+    std::vector<std::uint8_t> out;
+
+    for(;;) {
+        std::shared_ptr<CompressTask> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_work_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if(queue_.empty()) return;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            ++running_;
+        }
+        cv_space_.notify_one();
+
+        // 圧縮前のデータの領域は out として次のジョブで使い回す
+        task->ok = compress_record(task->data.data(), task->data.size(), level_, out);
+        task->data.swap(out);
+
+        if(task->ok && archive_) {
+            std::lock_guard<std::mutex> lock(archive_mutex_);
+            // 書き込みに一度失敗したら、以降の位置は当てにならないので書かない
+            if(!archive_failed_ && std::fwrite(task->data.data(), 1, task->data.size(), archive_) == task->data.size()) {
+                task->archive_offset = archive_end_;
+                archive_end_ += task->data.size();
+            }
+            else {
+                archive_failed_ = true;
+                task->ok = false;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task->done.store(true, std::memory_order_release);
+            --running_;
+        }
+        cv_done_.notify_all();
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 圧縮レコードの形式。ヘッダ、zlib で圧縮したデータ (data_size Byte) の順に並ぶ。数値はホストのバイトオーダー。
+// アーカイブはこれを単に連結したもの。
+struct CompressRecordHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t raw_size;
+    std::uint32_t data_size;
+};
+static_assert(sizeof(CompressRecordHeader) == 16, "CompressRecordHeader must be 16 bytes");
+
+// data (size Byte) を圧縮レコードにして out に書く。
+bool compress_record(const std::uint8_t* data, std::size_t size, int level, std::vector<std::uint8_t>& out);
+
+// buf (size Byte) の先頭の圧縮レコードのサイズを返す。不正なら 0 を返す。
+std::size_t compress_record_size(const void* buf, std::size_t size);
+
+// buf (size Byte) の先頭の圧縮レコードを展開して out に書く。
+bool decompress_record(const void* buf, std::size_t size, std::vector<std::uint8_t>& out);
+
+// 圧縮ジョブ。
+struct CompressTask {
+    static constexpr std::uint64_t NO_OFFSET = ~std::uint64_t(0);
+
+    // 投入時は圧縮前のデータ、完了後は圧縮レコード
+    std::vector<std::uint8_t> data {};
+    // アーカイブに書いた位置 (書かなかった場合は NO_OFFSET)
+    std::uint64_t archive_offset { NO_OFFSET };
+    bool ok {};
+    // true になった後はワーカーから触られない
+    std::atomic<bool> done { false };
+};
+
+// ワーカースレッドでデータを圧縮し、必要ならアーカイブファイルに追記する。
+// 投入を待っているジョブが max_queue 個あるときは、submit() は空きができるまで待つ。
+class CompressPool {
+public:
+    // archive が null でなければ、圧縮したものを完了順に追記する。archive はこのオブジェクトが閉じる。
+    CompressPool(unsigned threads, std::size_t max_queue, int level, std::FILE* archive);
+    // 投入済みのジョブを全て終えてから戻る。
+    ~CompressPool();
+
+    CompressPool(const CompressPool&) = delete;
+    CompressPool& operator=(const CompressPool&) = delete;
+
+    std::shared_ptr<CompressTask> submit(std::vector<std::uint8_t>&& data);
+
+    // task が完了するまで待つ。
+    void wait(const CompressTask& task);
+
+    // 投入済みのジョブが全て完了し、アーカイブが書き出されるまで待つ。
+    void flush();
+
+private:
+    void work();
+
+    const std::size_t max_queue_;
+    const int level_;
+
+    std::mutex mutex_ {};
+    std::condition_variable cv_work_ {};  // ジョブが来たか停止する
+    std::condition_variable cv_space_ {}; // キューに空きができた
+    std::condition_variable cv_done_ {};  // ジョブが完了した
+    std::deque<std::shared_ptr<CompressTask>> queue_ {};
+    std::size_t running_ {};
+    bool stop_ {};
+
+    std::mutex archive_mutex_ {};
+    std::FILE* archive_;
+    std::uint64_t archive_end_ {};
+    bool archive_failed_ {};
+
+    std::vector<std::thread> threads_ {};
+};
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cstring>
+
+#include "lib-cond.hpp"
+
+namespace {
+
+// 項 term が読むバイト数。不正なら 0。
+std::uint32_t term_bytes(const FceuxCondTerm& term) {
+    switch(term.type) {
+    case FCEUX_COND_BYTE: return 1;
+    case FCEUX_COND_WORD: return 2;
+    case FCEUX_COND_BCD: return term.size >= 1 && term.size <= 4 ? term.size : 0;
+    case FCEUX_COND_DIGITS: return term.size >= 1 && term.size <= 8 ? term.size : 0;
+    default: return 0;
+    }
+}
+
+bool op_valid(FceuxCondOp op) {
+    switch(op) {
+    case FCEUX_COND_EQ:
+    case FCEUX_COND_NE:
+    case FCEUX_COND_LT:
+    case FCEUX_COND_LE:
+    case FCEUX_COND_GT:
+    case FCEUX_COND_GE:
+    case FCEUX_COND_MASK_EQ:
+    case FCEUX_COND_DECREASED:
+    case FCEUX_COND_INCREASED:
+    case FCEUX_COND_CHANGED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+int StopConditions::add(const FceuxCondTerm* terms, std::size_t n, FceuxCondCombine combine, std::uint32_t flags) {
+    if(n == 0) return -1;
+    if(combine != FCEUX_COND_ALL && combine != FCEUX_COND_ANY) return -1;
+
+    Cond cond {};
+    cond.any = combine == FCEUX_COND_ANY;
+    cond.immediate = (flags & FCEUX_COND_IMMEDIATE) != 0;
+    cond.terms.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        const FceuxCondTerm& t = terms[i];
+        const std::uint32_t bytes = term_bytes(t);
+        if(bytes == 0 || !op_valid(t.op)) return -1;
+        if(t.addr + bytes > 0x10000) return -1;
+        cond.terms.push_back(Term { t.addr, t.type, bytes, t.op, t.value, t.mask, 0 });
+    }
+
+    cond.id = next_id_++;
+    if(cond.immediate) ++immediate_count_;
+    conds_.push_back(std::move(cond));
+    return conds_.back().id;
+}
+
+bool StopConditions::remove(int id) {
+    const auto it = std::find_if(conds_.begin(), conds_.end(), [id](const Cond& c) { return c.id == id; });
+    if(it == conds_.end()) return false;
+
+    if(it->immediate) --immediate_count_;
+    conds_.erase(it);
+    return true;
+}
+
+void StopConditions::clear() {
+    conds_.clear();
+    immediate_count_ = 0;
+}
+
+int StopConditions::check(Reader read, bool immediate_only) const {
+    for(const Cond& cond : conds_) {
+        if(immediate_only && !cond.immediate) continue;
+
+        // ALL なら偽の項、ANY なら真の項が見つかった時点で決まる
+        bool result = !cond.any;
+        for(const Term& term : cond.terms) {
+            if(eval(term, read) == cond.any) {
+                result = cond.any;
+                break;
+            }
+        }
+        if(result) return cond.id;
+    }
+
+    return -1;
+}
+
+void StopConditions::update(Reader read) {
+    for(Cond& cond : conds_) {
+        for(Term& term : cond.terms)
+            term.prev = read_value(term, read);
+    }
+}
+
+void StopConditions::watch_bits(std::uint8_t* bits) const {
+    std::memset(bits, 0, FCEUX_WRITE_BITS_SIZE);
+
+    for(const Cond& cond : conds_) {
+        if(!cond.immediate) continue;
+        for(const Term& term : cond.terms) {
+            for(std::uint32_t i = 0; i < term.size; ++i) {
+                const std::uint32_t addr = term.addr + i;
+                std::uint32_t bit;
+                if(addr < 0x2000)
+                    bit = addr & 0x7FF;
+                else if(addr >= 0x6000 && addr < 0x8000)
+                    bit = 0x800 + (addr - 0x6000);
+                else
+                    continue;
+                bits[bit >> 3] |= 1 << (bit & 7);
+            }
+        }
+    }
+}
+
+std::uint32_t StopConditions::read_value(const Term& term, Reader read) {
+    switch(term.type) {
+    case FCEUX_COND_BYTE:
+        return read(term.addr);
+    case FCEUX_COND_WORD:
+        return read(term.addr) | (read(term.addr + 1) << 8);
+    case FCEUX_COND_BCD: {
+        std::uint32_t value = 0;
+        for(std::uint32_t i = 0; i < term.size; ++i) {
+            const std::uint8_t b = read(term.addr + i);
+            value = 100*value + 10*(b >> 4) + (b & 0x0F);
+        }
+        return value;
+    }
+    case FCEUX_COND_DIGITS: {
+        std::uint32_t value = 0;
+        for(std::uint32_t i = 0; i < term.size; ++i)
+            value = 10*value + (read(term.addr + i) & 0x0F);
+        return value;
+    }
+    default:
+        return 0;
+    }
+}
+
+bool StopConditions::eval(const Term& term, Reader read) {
+    const std::uint32_t x = read_value(term, read);
+
+    switch(term.op) {
+    case FCEUX_COND_EQ: return x == term.value;
+    case FCEUX_COND_NE: return x != term.value;
+    case FCEUX_COND_LT: return x < term.value;
+    case FCEUX_COND_LE: return x <= term.value;
+    case FCEUX_COND_GT: return x > term.value;
+    case FCEUX_COND_GE: return x >= term.value;
+    case FCEUX_COND_MASK_EQ: return (x & term.mask) == term.value;
+    case FCEUX_COND_DECREASED: return x < term.prev;
+    case FCEUX_COND_INCREASED: return x > term.prev;
+    case FCEUX_COND_CHANGED: return x != term.prev;
+    default: return false;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fceux.h"
+
+// fceux_run_frames() を止める条件の集まり。
+// 登録時に各項を読むバイトの並びと比較方法に変換しておき、評価時は読み出し関数でバイトを読むだけにする。
+struct StopConditions {
+    // 副作用なしで CPU アドレス空間の 1 Byte を読む関数
+    using Reader = std::uint8_t (*)(std::uint16_t);
+
+    // terms (n 個) を検査して条件を登録し、id を返す。不正なら何もせずに -1 を返す。
+    int add(const FceuxCondTerm* terms, std::size_t n, FceuxCondCombine combine, std::uint32_t flags);
+    bool remove(int id);
+    void clear();
+
+    bool empty() const { return conds_.empty(); }
+    bool has_immediate() const { return immediate_count_ != 0; }
+
+    // 成り立っている条件のうち先に登録したものの id を返す。なければ -1。
+    // immediate_only なら即時評価する条件のみを評価する。
+    int check(Reader read, bool immediate_only) const;
+
+    // 各項の前回の値を現在の値にする。
+    void update(Reader read);
+
+    // 即時評価する条件が読むバイトのビットマップ (X6502_WriteTracker::bits と同じ形式) を bits に書く。
+    void watch_bits(std::uint8_t* bits) const;
+
+private:
+    struct Term {
+        std::uint16_t addr;
+        FceuxCondType type;
+        std::uint32_t size; // 読むバイト数
+        FceuxCondOp op;
+        std::uint32_t value;
+        std::uint32_t mask;
+        std::uint32_t prev;
+    };
+
+    struct Cond {
+        int id;
+        bool any;
+        bool immediate;
+        std::vector<Term> terms;
+    };
+
+    static std::uint32_t read_value(const Term& term, Reader read);
+    static bool eval(const Term& term, Reader read);
+
+    std::vector<Cond> conds_ {};
+    int next_id_ {};
+    std::size_t immediate_count_ {};
+};
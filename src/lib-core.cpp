@@ -0,0 +1,101 @@
+#include "lib-core.hpp"
+
+#ifdef FCEU_TLS_CORE
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace {
+
+// スピンで待つ回数の上限。1 回あたり数十ナノ秒程度
+constexpr int SPIN_LIMIT = 2000;
+
+void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+}
+
+// pred() が真になるまでスピンする。上限までに真にならなければ false を返す。
+// CPU が 1 つしかなければ相手が動けないだけなので、スピンしない。
+template<class Pred>
+bool spin(Pred pred) {
+    static const bool multicore = std::thread::hardware_concurrency() > 1;
+
+    for(int i = 0; multicore && i < SPIN_LIMIT; ++i) {
+        if(pred()) return true;
+        cpu_relax();
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+thread_local CoreThread* CoreThread::current_ = nullptr;
+
+CoreThread::CoreThread() : thread_([this] { loop(); }) {}
+
+CoreThread::~CoreThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void CoreThread::run(void (*fn)(void*), void* arg) {
+    std::lock_guard<std::mutex> caller(call_mutex_);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn_ = fn;
+        arg_ = arg;
+        state_.store(PENDING, std::memory_order_release);
+    }
+    cv_.notify_all();
+
+    const auto done = [this] { return state_.load(std::memory_order_acquire) == DONE; };
+    if(!spin(done)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, done);
+    }
+    state_.store(IDLE, std::memory_order_relaxed);
+
+    if(error_) {
+        std::exception_ptr e = error_;
+        error_ = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void CoreThread::loop() {
+    current_ = this;
+
+    const auto pending = [this] { return state_.load(std::memory_order_acquire) == PENDING; };
+    for(;;) {
+        if(!spin(pending)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] { return pending() || stop_; });
+            if(!pending()) return;
+        }
+
+        try {
+            fn_(arg_);
+        }
+        catch(...) {
+            error_ = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state_.store(DONE, std::memory_order_release);
+        }
+        cv_.notify_all();
+    }
+}
+
+#endif
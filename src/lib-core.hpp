@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#ifdef FCEU_TLS_CORE
+
+// コアを 1 つ動かすスレッド。
+// コアの状態 (types.h の FCEU_TLS が付いた変数) はスレッドごとにあるので、スレッドごとに別のコアとなる。
+// 処理を依頼されるとこのスレッド上で実行し、終わるまで依頼元を待たせる。
+// 依頼が短い間隔で続く場合に備え、待つ側はしばらくスピンしてから眠る (CPU が 1 つしかなければスピンしない)。
+class CoreThread {
+public:
+    CoreThread();
+    // 実行中の処理を終えてからスレッドを止める。
+    ~CoreThread();
+
+    CoreThread(const CoreThread&) = delete;
+    CoreThread& operator=(const CoreThread&) = delete;
+
+    // f() をこのスレッド上で実行し、終わるまで待ってその戻り値を返す (戻り値の型は既定構築できること)。
+    // このスレッド上 (フック関数の中など) から呼んだ場合はその場で実行する。
+    // 複数のスレッドから同時に呼ぶと 1 つずつ実行される。f() が投げた例外は呼び出し元で投げ直す。
+    template<class F>
+    auto call(F f) -> decltype(f()) {
+        return call_impl(f, std::is_void<decltype(f())> {});
+    }
+
+    // 呼び出し元のスレッドが CoreThread ならそれを返す。
+    static CoreThread* current() { return current_; }
+
+private:
+    template<class F>
+    void call_impl(F& f, std::true_type) {
+        if(current_ == this) {
+            f();
+            return;
+        }
+        run(&invoke<F>, &f);
+    }
+
+    template<class F>
+    auto call_impl(F& f, std::false_type) -> decltype(f()) {
+        if(current_ == this) return f();
+
+        decltype(f()) result {};
+        auto g = [&] { result = f(); };
+        run(&invoke<decltype(g)>, &g);
+        return result;
+    }
+
+    template<class F>
+    static void invoke(void* f) { (*static_cast<F*>(f))(); }
+
+    void run(void (*fn)(void*), void* arg);
+    void loop();
+
+    enum State { IDLE, PENDING, DONE };
+
+    static thread_local CoreThread* current_;
+
+    std::mutex call_mutex_ {}; // 依頼元どうしを直列化する
+
+    std::mutex mutex_ {};
+    std::condition_variable cv_ {};
+    std::atomic<int> state_ { IDLE };
+    bool stop_ {};
+
+    void (*fn_)(void*) {};
+    void* arg_ {};
+    std::exception_ptr error_ {};
+
+    std::thread thread_ {};
+};
+
+#else
+
+// FCEU_TLS_CORE を定義しないビルドでは、コアの状態は普通のグローバル変数で、コアは 1 つしかない。
+// スレッドは持たず、依頼された処理を呼び出し元のスレッド上でその場で実行する (処理を渡すコストがかからない)。
+// 複数のスレッドから同時に呼ぶと 1 つずつ実行される。f() の中から呼んでもよい。
+class CoreThread {
+public:
+    CoreThread() = default;
+
+    CoreThread(const CoreThread&) = delete;
+    CoreThread& operator=(const CoreThread&) = delete;
+
+    template<class F>
+    auto call(F f) -> decltype(f()) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        return f();
+    }
+
+private:
+    std::recursive_mutex mutex_ {};
+};
+
+#endif
@@ -9,30 +9,41 @@
 
 namespace {
 
-std::array<std::array<std::uint8_t, 3>, 256> palette {};
+FCEU_TLS std::array<std::array<std::uint8_t, 3>, 256> palette {};
+
+// LoadGame() でゲームをロード済みか
+FCEU_TLS bool is_loaded = false;
 
 } // anonymous namespace
 
-FceuxHookBeforeExec hook_before_exec = nullptr;
-void* hook_before_exec_userdata = nullptr;
+FCEU_TLS FceuxHookBeforeExec hook_before_exec = nullptr;
+FCEU_TLS void* hook_before_exec_userdata = nullptr;
+
+FCEU_TLS void (*break_before_exec)(std::uint16_t addr) = nullptr;
 
 // とりあえず定数とする
-int KillFCEUXonFrame = 0;
-int closeFinishedMovie = 0;
-int dendy = 0;
-int pal_emulation = 0;
-bool swapDuty = false;
-bool turbo = false;
+FCEU_TLS int KillFCEUXonFrame = 0;
+FCEU_TLS int closeFinishedMovie = 0;
+FCEU_TLS int dendy = 0;
+FCEU_TLS int pal_emulation = 0;
+FCEU_TLS bool swapDuty = false;
+FCEU_TLS bool turbo = false;
 
 //--------------------------------------------------------------------
 // hook
 //--------------------------------------------------------------------
 
 void FCEUD_CallHookBeforeExec(std::uint16_t addr) {
+    if(break_before_exec)
+        break_before_exec(addr);
     if(hook_before_exec)
         hook_before_exec(hook_before_exec_userdata, addr);
 }
 
+bool FCEUD_HookBeforeExecActive() {
+    return hook_before_exec != nullptr || break_before_exec != nullptr;
+}
+
 //--------------------------------------------------------------------
 // message
 //--------------------------------------------------------------------
@@ -100,9 +111,8 @@ ArchiveScanRecord FCEUD_ScanArchive(std::string) {
 //--------------------------------------------------------------------
 
 int LoadGame(const char* path, bool silent) {
-    static bool is_loaded = false;
-
     if (is_loaded) FCEUI_CloseGame();
+    is_loaded = false;
 
     if (!FCEUI_LoadGame(path, 1, silent)) return 0;
 
@@ -111,6 +121,17 @@ int LoadGame(const char* path, bool silent) {
     return 1;
 }
 
+int LoadGame(const char* path, const std::vector<std::uint8_t>& image, bool silent) {
+    if (is_loaded) FCEUI_CloseGame();
+    is_loaded = false;
+
+    if (!FCEUI_LoadGameMemory(path, image.data(), image.size(), 1, silent)) return 0;
+
+    is_loaded = true;
+
+    return 1;
+}
+
 // サポートしない
 int reloadLastGame() {
     return 0;
@@ -187,7 +208,9 @@ void GetMouseData(uint32 (&md)[3]) {
 }
 
 unsigned int* GetKeyboard() {
-    return nullptr;
+    // キーは押されない。呼び出し元は 256 個分読む
+    static unsigned int keys[256] {};
+    return keys;
 }
 
 //--------------------------------------------------------------------
@@ -230,6 +253,9 @@ void FCEUD_HideMenuToggle() {}
 
 void FCEUD_DebugBreakpoint(int) {}
 void FCEUD_TraceInstruction(uint8*, int) {}
+bool FCEUD_TraceInstructionActive() {
+    return false;
+}
 void FCEUD_UpdateNTView(int, bool) {}
 void FCEUD_UpdatePPUView(int, int) {}
 
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "fceux.h"
 
 int LoadGame(const char* path, bool silent);
 
-extern FceuxHookBeforeExec hook_before_exec;
-extern void* hook_before_exec_userdata;
+// FCEUI_ReadGame() で読んだ ROM の内容 image を、path の ROM としてロードする。ROM ファイルは読まない。
+int LoadGame(const char* path, const std::vector<std::uint8_t>& image, bool silent);
+
+extern FCEU_TLS FceuxHookBeforeExec hook_before_exec;
+extern FCEU_TLS void* hook_before_exec_userdata;
+
+// 命令実行前、クライアントのフック関数より先に呼ばれる。フレーム途中での停止に使う。
+extern FCEU_TLS void (*break_before_exec)(std::uint16_t addr);
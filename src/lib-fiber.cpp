@@ -0,0 +1,148 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <ucontext.h>
+#endif
+
+#include "lib-fiber.hpp"
+
+namespace {
+
+// フック関数の中でクライアントが何をするか分からないので、余裕を持たせる
+constexpr std::size_t STACK_SIZE = 1 << 20;
+
+} // anonymous namespace
+
+#ifdef _WIN32
+
+struct Fiber::Impl {
+    void* fiber {};
+    void* caller {};
+    void (*entry)(void*) {};
+    void* arg {};
+    bool active {};
+    std::thread::id owner {};
+
+    static void WINAPI proc(void* param) {
+        auto impl = static_cast<Impl*>(param);
+        // fiber proc は返ってはならないので、終わったら呼び出し元に戻り続ける
+        for(;;) {
+            impl->entry(impl->arg);
+            impl->active = false;
+            SwitchToFiber(impl->caller);
+        }
+    }
+};
+
+Fiber::Fiber() : impl(new Impl) {}
+
+Fiber::~Fiber() {
+    if(impl->fiber) DeleteFiber(impl->fiber);
+}
+
+void Fiber::start(void (*entry)(void*), void* arg) {
+    // 実行途中の fiber は再利用できないので作り直す
+    if(impl->fiber) DeleteFiber(impl->fiber);
+    impl->fiber = CreateFiber(STACK_SIZE, Impl::proc, impl.get());
+    assert(impl->fiber);
+
+    impl->entry = entry;
+    impl->arg = arg;
+    impl->active = true;
+    impl->owner = std::this_thread::get_id();
+}
+
+void Fiber::resume() {
+    assert(impl->active);
+    assert(impl->owner == std::this_thread::get_id());
+
+    // fiber に変換したスレッドは、戻ってきたら元に戻す (変換したままだとスレッドの終了時まで fiber のデータが残る)。
+    // 戻した後も impl->fiber は有効で、次の resume() でまた変換して切り替える
+    const bool converted = !IsThreadAFiber();
+    if(converted) {
+        void* const self = ConvertThreadToFiber(nullptr);
+        assert(self);
+        (void)self;
+    }
+    impl->caller = GetCurrentFiber();
+    SwitchToFiber(impl->fiber);
+    if(converted) ConvertFiberToThread();
+}
+
+void Fiber::suspend() {
+    SwitchToFiber(impl->caller);
+}
+
+#else
+
+struct Fiber::Impl {
+    std::unique_ptr<char[]> stack {};
+    ucontext_t self {};
+    ucontext_t caller {};
+    void (*entry)(void*) {};
+    void* arg {};
+    bool active {};
+    std::thread::id owner {};
+
+    // makecontext() の引数は int なので、this を上位と下位の 32bit に分けて渡す。
+    // 静的な変数を介すと、複数のスレッドが同時に start() したときに取り違える
+    static void proc(unsigned int hi, unsigned int lo) {
+        const std::uintptr_t p = (static_cast<std::uintptr_t>(hi) << 16 << 16) | lo;
+        Impl* impl = reinterpret_cast<Impl*>(p);
+        impl->entry(impl->arg);
+        impl->active = false;
+        // 返ると uc_link (caller) に戻る
+    }
+};
+
+Fiber::Fiber() : impl(new Impl) {}
+
+Fiber::~Fiber() = default;
+
+void Fiber::start(void (*entry)(void*), void* arg) {
+    if(!impl->stack) impl->stack.reset(new char[STACK_SIZE]);
+
+    getcontext(&impl->self);
+    impl->self.uc_stack.ss_sp = impl->stack.get();
+    impl->self.uc_stack.ss_size = STACK_SIZE;
+    impl->self.uc_link = &impl->caller;
+    const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(impl.get());
+    makecontext(&impl->self, reinterpret_cast<void (*)()>(Impl::proc), 2,
+        static_cast<unsigned int>(p >> 16 >> 16), static_cast<unsigned int>(p & 0xFFFFFFFF));
+
+    impl->entry = entry;
+    impl->arg = arg;
+    impl->active = true;
+    impl->owner = std::this_thread::get_id();
+}
+
+void Fiber::resume() {
+    assert(impl->active);
+    assert(impl->owner == std::this_thread::get_id());
+
+    swapcontext(&impl->caller, &impl->self);
+}
+
+void Fiber::suspend() {
+    swapcontext(&impl->self, &impl->caller);
+}
+
+#endif
+
+void Fiber::abandon() {
+    impl->active = false;
+}
+
+bool Fiber::active() const {
+    return impl->active;
+}
+
+bool Fiber::resumable_here() const {
+    return impl->active && impl->owner == std::this_thread::get_id();
+}
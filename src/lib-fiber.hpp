@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+
+// 専用のスタック上で関数を実行し、実行途中で呼び出し元に制御を戻せるようにする。
+// 同じスレッド上で切り替えるだけなので、呼び出し元が持つロックなどはそのまま有効。
+//
+// start() したスレッド以外から resume() してはならない (fiber 内のコードはコアのスレッドローカルな状態を使うため)。
+// 別のスレッドで続きを実行する手段はないので、スレッドをまたぐ場合は abandon() して start() し直すこと。
+// スレッドごとに別の Fiber を使う分には制限はない。
+class Fiber {
+public:
+    Fiber();
+    ~Fiber();
+
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+
+    // entry(arg) を実行する準備をする。実行途中のものがあれば破棄する。
+    // 以降の resume() は、このスレッドから呼ぶこと。
+    void start(void (*entry)(void*), void* arg);
+
+    // 実行途中のものを破棄する。スタック上のオブジェクトのデストラクタは呼ばれない。
+    void abandon();
+
+    // fiber に制御を移す。fiber 内で suspend() が呼ばれるか、entry が返ると戻る。
+    void resume();
+
+    // fiber 内から呼び出し、resume() の呼び出し元に制御を戻す。
+    void suspend();
+
+    // start() 後、entry が返るか破棄されるまでの間 true。
+    bool active() const;
+
+    // active() で、呼び出し元のスレッドから resume() してよければ true。
+    bool resumable_here() const;
+
+    struct Impl;
+
+private:
+    std::unique_ptr<Impl> impl;
+};
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "lib-pagestore.hpp"
+
+PageStore::PageStore(std::uint32_t page_size) : page_size_(page_size) {
+    assert(page_size > 0 && page_size % 8 == 0);
+}
+
+// 64bit 単位の乗算ハッシュ。依存関係の連鎖で律速しないよう 4 列に分けて計算する。
+std::uint64_t PageStore::hash(const std::uint8_t* p) const {
+    constexpr std::uint64_t K = 0x9E3779B97F4A7C15;
+    std::uint64_t h[4] = { page_size_, 1, 2, 3 };
+    std::uint32_t i = 0;
+    for(; i + 32 <= page_size_; i += 32) {
+        for(int j = 0; j < 4; ++j) {
+            std::uint64_t w;
+            std::memcpy(&w, p + i + 8*j, 8);
+            h[j] = (h[j] ^ w) * K;
+            h[j] ^= h[j] >> 29;
+        }
+    }
+    for(; i < page_size_; i += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h[0] = (h[0] ^ w) * K;
+        h[0] ^= h[0] >> 29;
+    }
+
+    std::uint64_t r = h[0];
+    for(int j = 1; j < 4; ++j) {
+        r = (r ^ h[j]) * K;
+        r ^= r >> 29;
+    }
+    return r;
+}
+
+// 内容が p と同じページの参照を増やす。ハッシュが衝突した場合は重複排除せずに新しいページを作る。
+// hint は同じ内容かもしれないページで、そうであればハッシュの計算を省く。
+std::uint32_t PageStore::acquire(const std::uint8_t* p, std::uint32_t hint) {
+    if(hint < refs_.size() && refs_[hint] != 0 && std::memcmp(page(hint), p, page_size_) == 0) {
+        ++refs_[hint];
+        return hint;
+    }
+
+    const std::uint64_t h = hash(p);
+
+    const auto it = index_.find(h);
+    if(it != index_.end() && std::memcmp(page(it->second), p, page_size_) == 0) {
+        ++refs_[it->second];
+        return it->second;
+    }
+
+    std::uint32_t id;
+    if(!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+    }
+    else {
+        id = static_cast<std::uint32_t>(refs_.size());
+        if(id % BLOCK_PAGES == 0)
+            blocks_.emplace_back(new std::uint8_t[std::size_t(BLOCK_PAGES) * page_size_]);
+        refs_.push_back(0);
+        hashes_.push_back(0);
+    }
+
+    std::memcpy(page(id), p, page_size_);
+    refs_[id] = 1;
+    hashes_[id] = h;
+    if(it == index_.end()) index_.emplace(h, id);
+    return id;
+}
+
+void PageStore::store(const std::uint8_t* data, std::uint32_t size, std::vector<std::uint32_t>& ids) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    // 直前に扱った状態から変わっていないページが多いはずなので、同じ位置のページを先に比べる
+    const auto hint = [this](std::size_t i) { return i < recent_.size() ? recent_[i] : NO_PAGE; };
+
+    ids.clear();
+    std::uint32_t offset = 0;
+    for(; offset + page_size_ <= size; offset += page_size_)
+        ids.push_back(acquire(data + offset, hint(ids.size())));
+    if(offset < size) {
+        std::vector<std::uint8_t> last(page_size_);
+        std::memcpy(last.data(), data + offset, size - offset);
+        ids.push_back(acquire(last.data(), hint(ids.size())));
+    }
+    recent_ = ids;
+
+    ++lists_;
+    page_refs_ += ids.size();
+}
+
+void PageStore::load(const std::vector<std::uint32_t>& ids, std::uint8_t* out, std::uint32_t size) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    std::uint32_t offset = 0;
+    for(const std::uint32_t id : ids) {
+        if(offset >= size) break;
+        std::memcpy(out + offset, page(id), std::min(page_size_, size - offset));
+        offset += page_size_;
+    }
+    recent_ = ids;
+}
+
+void PageStore::release(const std::vector<std::uint32_t>& ids) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    for(const std::uint32_t id : ids) {
+        assert(refs_[id] > 0);
+        if(--refs_[id] != 0) continue;
+
+        const auto it = index_.find(hashes_[id]);
+        if(it != index_.end() && it->second == id) index_.erase(it);
+        free_.push_back(id);
+    }
+
+    --lists_;
+    page_refs_ -= ids.size();
+}
+
+PageStore::Stats PageStore::stats() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    Stats st {};
+    st.lists = lists_;
+    st.pages = refs_.size() - free_.size();
+    st.page_refs = page_refs_;
+    st.page_bytes = blocks_.size() * std::size_t(BLOCK_PAGES) * page_size_;
+    return st;
+}
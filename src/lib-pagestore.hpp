@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 固定サイズのページを内容で重複排除して保持する。
+// ページは参照カウントを持ち、参照がなくなると領域が再利用される。
+// 複数スレッドから同時に使ってよい。
+class PageStore {
+public:
+    // page_size は 8 の倍数でなければならない。
+    explicit PageStore(std::uint32_t page_size);
+
+    PageStore(const PageStore&) = delete;
+    PageStore& operator=(const PageStore&) = delete;
+
+    std::uint32_t page_size() const { return page_size_; }
+
+    // data (size Byte) をページに分割して格納し、各ページの番号を ids に設定する。
+    // 末尾の半端なページは 0 で埋める。
+    void store(const std::uint8_t* data, std::uint32_t size, std::vector<std::uint32_t>& ids);
+
+    // store() で得た ids の内容を out (size Byte) に書き出す。
+    void load(const std::vector<std::uint32_t>& ids, std::uint8_t* out, std::uint32_t size) const;
+
+    // store() で得た ids の参照を解放する。
+    void release(const std::vector<std::uint32_t>& ids);
+
+    struct Stats {
+        std::size_t lists;        // 解放されていない ids の数
+        std::size_t pages;        // 保持しているページ数
+        std::size_t page_refs;    // ids から参照されているページ数の合計
+        std::size_t page_bytes;   // ページのために確保している領域
+    };
+    Stats stats() const;
+
+private:
+    static constexpr std::uint32_t BLOCK_PAGES = 1024;
+    static constexpr std::uint32_t NO_PAGE = ~std::uint32_t(0);
+
+    std::uint8_t* page(std::uint32_t id) const {
+        return blocks_[id / BLOCK_PAGES].get() + std::size_t(id % BLOCK_PAGES) * page_size_;
+    }
+    std::uint64_t hash(const std::uint8_t* p) const;
+    std::uint32_t acquire(const std::uint8_t* p, std::uint32_t hint);
+
+    const std::uint32_t page_size_;
+
+    mutable std::mutex mutex_ {};
+    std::vector<std::unique_ptr<std::uint8_t[]>> blocks_ {};
+    std::vector<std::uint32_t> refs_ {};
+    std::vector<std::uint64_t> hashes_ {};
+    std::vector<std::uint32_t> free_ {};
+    std::unordered_map<std::uint64_t, std::uint32_t> index_ {};
+
+    // 最後に store() か load() で扱ったページ
+    mutable std::vector<std::uint32_t> recent_ {};
+
+    std::size_t lists_ {};
+    std::size_t page_refs_ {};
+};
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "lib-rewind.hpp"
+
+namespace {
+
+void put_varint(std::vector<std::uint8_t>& out, std::uint32_t x) {
+    while(x >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(x | 0x80));
+        x >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(x));
+}
+
+std::uint32_t get_varint(const std::uint8_t*& p) {
+    std::uint32_t x = 0;
+    for(int shift = 0; ; shift += 7) {
+        const std::uint8_t b = *p++;
+        x |= std::uint32_t(b & 0x7F) << shift;
+        if(!(b & 0x80)) return x;
+    }
+}
+
+// a XOR b (base が null なら a そのもの) を、(0 の個数, 非 0 区間の長さ, 非 0 区間) の繰り返しとして out に書く。
+// 途中に短い 0 の連続があっても区切らずに非 0 区間に含める。
+void encode(const std::uint8_t* a, const std::uint8_t* base, std::uint32_t size, std::vector<std::uint8_t>& out) {
+    const auto at = [a, base](std::uint32_t i) -> std::uint8_t { return base ? a[i] ^ base[i] : a[i]; };
+
+    out.clear();
+    std::uint32_t i = 0;
+    while(i < size) {
+        const std::uint32_t zero_begin = i;
+        // 8 Byte ずつ飛ばせるところは飛ばす
+        while(i + 8 <= size) {
+            std::uint64_t x, y = 0;
+            std::memcpy(&x, a + i, 8);
+            if(base) std::memcpy(&y, base + i, 8);
+            if(x != y) break;
+            i += 8;
+        }
+        while(i < size && at(i) == 0) ++i;
+        if(i == size && zero_begin != i) {
+            put_varint(out, i - zero_begin);
+            put_varint(out, 0);
+            break;
+        }
+
+        // 区切るより含めたほうが短くなる程度の 0 の連続は非 0 区間に含める
+        const std::uint32_t lit_begin = i;
+        std::uint32_t lit_end = i;
+        for(; i < size && i - lit_end <= 4; ++i)
+            if(at(i) != 0) lit_end = i + 1;
+        i = lit_end;
+
+        put_varint(out, lit_begin - zero_begin);
+        put_varint(out, i - lit_begin);
+        for(std::uint32_t j = lit_begin; j < i; ++j) out.push_back(at(j));
+    }
+}
+
+// encode() の出力を state に XOR する。
+void apply(const std::vector<std::uint8_t>& in, std::uint8_t* state, std::uint32_t size) {
+    const std::uint8_t* p = in.data();
+    const std::uint8_t* const end = p + in.size();
+    std::uint32_t i = 0;
+    while(p < end) {
+        i += get_varint(p);
+        const std::uint32_t len = get_varint(p);
+        assert(i + len <= size); (void)size;
+        for(std::uint32_t j = 0; j < len; ++j) state[i + j] ^= p[j];
+        p += len;
+        i += len;
+    }
+}
+
+} // anonymous namespace
+
+RewindBuffer::RewindBuffer(std::size_t budget, std::uint32_t keyframe_interval)
+    : budget_(budget), keyframe_interval_(std::max<std::uint32_t>(keyframe_interval, 1)) {}
+
+void RewindBuffer::push(const std::uint8_t* state, std::uint32_t size) {
+    // 状態のサイズが変わった (別のゲームのものになった) らキーフレームから始める
+    const bool key = entries_.empty() || since_key_ + 1 >= keyframe_interval_ || last_.size() != size;
+
+    Entry entry { key, size, {} };
+    encode(state, key ? nullptr : last_.data(), size, entry.data);
+    bytes_ += entry.data.size();
+    entries_.push_back(std::move(entry));
+
+    since_key_ = key ? 0 : since_key_ + 1;
+    last_.assign(state, state + size);
+    peeked_k_ = 0;
+
+    trim();
+}
+
+void RewindBuffer::trim() {
+    while(bytes_ > budget_) {
+        // 最も古いキーフレームの次のキーフレームを探す。なければ (最新のグループなので) 残す
+        std::size_t next = 1;
+        while(next < entries_.size() && !entries_[next].key) ++next;
+        if(next == entries_.size()) break;
+
+        for(std::size_t i = 0; i < next; ++i) {
+            bytes_ -= entries_.front().data.size();
+            entries_.pop_front();
+        }
+    }
+}
+
+void RewindBuffer::build(std::size_t end, std::vector<std::uint8_t>& out) const {
+    std::size_t key = end - 1;
+    while(!entries_[key].key) --key;
+
+    const std::uint32_t size = entries_[end - 1].size;
+    out.assign(size, 0);
+    for(std::size_t i = key; i < end; ++i)
+        apply(entries_[i].data, out.data(), size);
+}
+
+const std::vector<std::uint8_t>* RewindBuffer::peek(std::size_t k) {
+    if(k >= entries_.size()) return nullptr;
+    if(k == 0) return &last_;
+
+    if(peeked_k_ != k) {
+        build(entries_.size() - k, peeked_);
+        peeked_k_ = k;
+    }
+    return &peeked_;
+}
+
+void RewindBuffer::rewind(std::size_t k) {
+    assert(k < entries_.size());
+    if(k == 0) return;
+
+    if(peeked_k_ != k) build(entries_.size() - k, peeked_);
+    last_.swap(peeked_);
+    peeked_k_ = 0;
+
+    for(std::size_t i = 0; i < k; ++i) {
+        bytes_ -= entries_.back().data.size();
+        entries_.pop_back();
+    }
+
+    std::size_t key = entries_.size() - 1;
+    while(!entries_[key].key) --key;
+    since_key_ = static_cast<std::uint32_t>(entries_.size() - 1 - key);
+}
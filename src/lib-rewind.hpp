@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// 状態の履歴をメモリ使用量の上限付きで保持する。
+// keyframe_interval 個ごとに状態をそのまま、その間は直前の状態との XOR を持ち、いずれも 0 の連続を詰めて符号化する。
+// 上限を超えたら、最も古いキーフレームとそれに続く差分をまとめて捨てる。
+struct RewindBuffer {
+    RewindBuffer(std::size_t budget, std::uint32_t keyframe_interval);
+
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+    // state (size Byte) を最新の状態として追加する。
+    void push(const std::uint8_t* state, std::uint32_t size);
+
+    // k 個前 (0 なら最新) の状態を返す。履歴は変えない。k が count() 以上なら nullptr を返す。
+    // 返したポインタは次に push(), peek(), rewind() のいずれかを呼ぶまで有効。
+    const std::vector<std::uint8_t>* peek(std::size_t k);
+
+    // k 個前の状態を最新とし、それより新しいものを捨てる。k は count() 未満であること。
+    // 直前の peek(k) で組み立てた状態があればそれを使う。
+    void rewind(std::size_t k);
+
+    std::size_t count() const { return entries_.size(); }
+    std::size_t bytes() const { return bytes_; }
+
+private:
+    struct Entry {
+        bool key;
+        std::uint32_t size;
+        std::vector<std::uint8_t> data;
+    };
+
+    void trim();
+    // entries_[0, end) を適用した状態を out に組み立てる
+    void build(std::size_t end, std::vector<std::uint8_t>& out) const;
+
+    const std::size_t budget_;
+    const std::uint32_t keyframe_interval_;
+
+    std::deque<Entry> entries_ {};
+    std::size_t bytes_ {};
+
+    // 最新の状態
+    std::vector<std::uint8_t> last_ {};
+
+    // 最新のキーフレームから数えた位置
+    std::uint32_t since_key_ {};
+
+    // 最後に peek() で組み立てた状態と、その k (組み立てていなければ 0)
+    std::vector<std::uint8_t> peeked_ {};
+    std::size_t peeked_k_ {};
+};
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "lib-search.hpp"
+
+namespace {
+
+constexpr std::size_t WIDTH = RamSearch::WIDTH;
+
+// 相関係数の計算で、一度に扱うブロック (16 Byte) の数とサンプル数。
+// アキュムレータが L1 に収まり、32bit の和があふれない範囲にする。
+constexpr std::size_t TILE_BLOCKS = 64;
+constexpr std::size_t GROUP_ROWS = 256;
+
+// ラベルは絶対値がこれ以下の整数に量子化して扱う
+constexpr double LABEL_SCALE = 32000.0;
+
+// 1 ブロック分の積和。各アドレスについて値の和、二乗和、ラベルとの積和を持つ
+struct BlockSums {
+    std::int32_t v[16];
+    std::int32_t vv[16];
+    std::int32_t vl[16];
+};
+
+#ifdef __SSE2__
+
+using Vec = __m128i;
+
+Vec load(const std::uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const Vec*>(p)); }
+void store(std::uint8_t* p, Vec v) { _mm_storeu_si128(reinterpret_cast<Vec*>(p), v); }
+
+Vec ones() { return _mm_set1_epi8(-1); }
+Vec splat(std::int32_t k) { return _mm_set1_epi8(static_cast<char>(k)); }
+
+Vec keep_equal(Vec x, Vec y) { return _mm_cmpeq_epi8(x, y); }
+Vec keep_not_equal(Vec x, Vec y) { return _mm_xor_si128(_mm_cmpeq_epi8(x, y), ones()); }
+// 符号なしで x > y なら max(x, y) != y
+Vec keep_greater(Vec x, Vec y) { return _mm_xor_si128(_mm_cmpeq_epi8(_mm_max_epu8(x, y), y), ones()); }
+Vec keep_less(Vec x, Vec y) { return _mm_xor_si128(_mm_cmpeq_epi8(_mm_max_epu8(x, y), x), ones()); }
+Vec keep_changed_by(Vec x, Vec y, Vec k) { return _mm_cmpeq_epi8(_mm_sub_epi8(x, y), k); }
+
+// alive のうち keep(v, base) が偽の Byte を 0 にする。既に候補がないブロックは飛ばす。
+template<class Keep>
+void filter_rows(std::uint8_t* alive, const std::uint8_t* v, const std::uint8_t* base, Keep keep) {
+    for(std::size_t i = 0; i < WIDTH; i += 16) {
+        const Vec m = load(alive + i);
+        if(_mm_movemask_epi8(m) == 0) continue;
+        store(alive + i, _mm_and_si128(m, keep(load(v + i), load(base + i))));
+    }
+}
+
+// 2 つのサンプル p, q (ラベル lp, lq) の 16 Byte 分を s に足す。
+// 同じアドレスの p と q の値を 16bit で隣り合わせに並べ、pmaddwd で 2 サンプル分の積和を一度に求める。
+void accumulate_block(BlockSums& s, const std::uint8_t* p, const std::uint8_t* q, std::int16_t lp, std::int16_t lq) {
+    const Vec zero = _mm_setzero_si128();
+    const Vec one = _mm_set1_epi16(1);
+    const Vec l = _mm_set1_epi32(static_cast<std::uint16_t>(lp) | static_cast<std::uint32_t>(static_cast<std::uint16_t>(lq)) << 16);
+    const Vec x = load(p);
+    const Vec y = load(q);
+    const Vec pairs8[2] = { _mm_unpacklo_epi8(x, y), _mm_unpackhi_epi8(x, y) };
+    for(int h = 0; h < 2; ++h) {
+        const Vec pairs16[2] = { _mm_unpacklo_epi8(pairs8[h], zero), _mm_unpackhi_epi8(pairs8[h], zero) };
+        for(int j = 0; j < 2; ++j) {
+            const Vec w = pairs16[j];
+            Vec* const v = reinterpret_cast<Vec*>(s.v + 8 * h + 4 * j);
+            Vec* const vv = reinterpret_cast<Vec*>(s.vv + 8 * h + 4 * j);
+            Vec* const vl = reinterpret_cast<Vec*>(s.vl + 8 * h + 4 * j);
+            _mm_storeu_si128(v, _mm_add_epi32(_mm_loadu_si128(v), _mm_madd_epi16(w, one)));
+            _mm_storeu_si128(vv, _mm_add_epi32(_mm_loadu_si128(vv), _mm_madd_epi16(w, w)));
+            _mm_storeu_si128(vl, _mm_add_epi32(_mm_loadu_si128(vl), _mm_madd_epi16(w, l)));
+        }
+    }
+}
+
+#else
+
+template<class Keep>
+void filter_rows(std::uint8_t* alive, const std::uint8_t* v, const std::uint8_t* base, Keep keep) {
+    for(std::size_t i = 0; i < WIDTH; ++i) {
+        if(alive[i] && !keep(v[i], base[i])) alive[i] = 0;
+    }
+}
+
+void accumulate_block(BlockSums& s, const std::uint8_t* p, const std::uint8_t* q, std::int16_t lp, std::int16_t lq) {
+    for(int j = 0; j < 16; ++j) {
+        s.v[j] += p[j] + q[j];
+        s.vv[j] += p[j] * p[j] + q[j] * q[j];
+        s.vl[j] += p[j] * lp + q[j] * lq;
+    }
+}
+
+#endif
+
+// サンプル内の位置を CPU アドレスにする
+std::uint16_t index_addr(std::size_t i) {
+    return static_cast<std::uint16_t>(i < 0x800 ? i : 0x6000 + (i - 0x800));
+}
+
+} // anonymous namespace
+
+RamSearch::RamSearch() : alive_(WIDTH, 0xFF), count_(WIDTH) {}
+
+std::uint8_t* RamSearch::add() {
+    if(sample_count_ == chunks_.size() * CHUNK_ROWS)
+        chunks_.emplace_back(new std::uint8_t[CHUNK_ROWS * WIDTH]);
+    return const_cast<std::uint8_t*>(sample(sample_count_++));
+}
+
+void RamSearch::reset() {
+    std::fill(alive_.begin(), alive_.end(), 0xFF);
+    count_ = WIDTH;
+}
+
+void RamSearch::recount() {
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < WIDTH; ++i)
+        n += alive_[i] != 0;
+    count_ = n;
+}
+
+bool RamSearch::filter(const FceuxSearchPredicate* preds, std::size_t n) {
+    for(std::size_t i = 0; i < n; ++i) {
+        const int op = preds[i].op;
+        if(op < FCEUX_SEARCH_EQUAL || op > FCEUX_SEARCH_VALUE) return false;
+        if(preds[i].sample >= sample_count_) return false;
+        if(preds[i].op != FCEUX_SEARCH_VALUE && preds[i].baseline >= sample_count_) return false;
+    }
+
+    std::uint8_t* alive = alive_.data();
+    for(std::size_t i = 0; i < n; ++i) {
+        const FceuxSearchPredicate& p = preds[i];
+        const std::uint8_t* v = sample(p.sample);
+        const std::uint8_t* base = p.op == FCEUX_SEARCH_VALUE ? v : sample(p.baseline);
+#ifdef __SSE2__
+        const Vec k = splat(p.k);
+        switch(p.op) {
+        case FCEUX_SEARCH_EQUAL: filter_rows(alive, v, base, keep_equal); break;
+        case FCEUX_SEARCH_NOT_EQUAL: filter_rows(alive, v, base, keep_not_equal); break;
+        case FCEUX_SEARCH_GREATER: filter_rows(alive, v, base, keep_greater); break;
+        case FCEUX_SEARCH_LESS: filter_rows(alive, v, base, keep_less); break;
+        case FCEUX_SEARCH_CHANGED_BY: filter_rows(alive, v, base, [k](Vec x, Vec y) { return keep_changed_by(x, y, k); }); break;
+        case FCEUX_SEARCH_VALUE: filter_rows(alive, v, base, [k](Vec x, Vec) { return _mm_cmpeq_epi8(x, k); }); break;
+        }
+#else
+        const std::uint8_t k = static_cast<std::uint8_t>(p.k);
+        switch(p.op) {
+        case FCEUX_SEARCH_EQUAL: filter_rows(alive, v, base, [](std::uint8_t x, std::uint8_t y) { return x == y; }); break;
+        case FCEUX_SEARCH_NOT_EQUAL: filter_rows(alive, v, base, [](std::uint8_t x, std::uint8_t y) { return x != y; }); break;
+        case FCEUX_SEARCH_GREATER: filter_rows(alive, v, base, [](std::uint8_t x, std::uint8_t y) { return x > y; }); break;
+        case FCEUX_SEARCH_LESS: filter_rows(alive, v, base, [](std::uint8_t x, std::uint8_t y) { return x < y; }); break;
+        case FCEUX_SEARCH_CHANGED_BY: filter_rows(alive, v, base, [k](std::uint8_t x, std::uint8_t y) { return std::uint8_t(x - y) == k; }); break;
+        case FCEUX_SEARCH_VALUE: filter_rows(alive, v, base, [k](std::uint8_t x, std::uint8_t) { return x == k; }); break;
+        }
+#endif
+    }
+
+    recount();
+    return true;
+}
+
+bool RamSearch::correlate(const double* labels, double min_abs_r, float* r) {
+    const std::size_t n = sample_count_;
+    if(n < 2) return false;
+
+    // ラベルは中心化して量子化する (相関係数は定数倍によらない)
+    double mean = 0.0;
+    for(std::size_t i = 0; i < n; ++i)
+        mean += labels[i];
+    mean /= n;
+    double max_dev = 0.0;
+    for(std::size_t i = 0; i < n; ++i)
+        max_dev = std::max(max_dev, std::fabs(labels[i] - mean));
+    const double scale = max_dev > 0.0 ? LABEL_SCALE / max_dev : 0.0;
+    // サンプル数が奇数なら、値もラベルも 0 のサンプルを足して組にする
+    std::vector<std::int16_t> quantized(n + 1);
+    double sum_l = 0.0;
+    double sum_ll = 0.0;
+    for(std::size_t i = 0; i < n; ++i) {
+        quantized[i] = static_cast<std::int16_t>(std::lround((labels[i] - mean) * scale));
+        sum_l += quantized[i];
+        sum_ll += double(quantized[i]) * quantized[i];
+    }
+    static const std::uint8_t zero_row[WIDTH] {};
+
+    // 候補を含むブロックについてのみ和を求める
+    std::vector<std::uint32_t> blocks;
+    for(std::size_t i = 0; i < WIDTH; i += 16) {
+        if(std::any_of(alive_.begin() + i, alive_.begin() + i + 16, [](std::uint8_t a) { return a != 0; }))
+            blocks.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    std::vector<double> sum_v(WIDTH);
+    std::vector<double> sum_vv(WIDTH);
+    std::vector<double> sum_vl(WIDTH);
+    std::vector<BlockSums> acc(TILE_BLOCKS);
+    for(std::size_t t = 0; t < blocks.size(); t += TILE_BLOCKS) {
+        const std::size_t tile = std::min(TILE_BLOCKS, blocks.size() - t);
+        for(std::size_t g = 0; g < n; g += GROUP_ROWS) {
+            std::memset(acc.data(), 0, tile * sizeof(BlockSums));
+            const std::size_t g_end = std::min(n, g + GROUP_ROWS);
+            for(std::size_t i = g; i < g_end; i += 2) {
+                const std::uint8_t* p = sample(i);
+                const std::uint8_t* q = i + 1 < n ? sample(i + 1) : zero_row;
+                for(std::size_t b = 0; b < tile; ++b)
+                    accumulate_block(acc[b], p + blocks[t + b], q + blocks[t + b], quantized[i], quantized[i + 1]);
+            }
+            for(std::size_t b = 0; b < tile; ++b) {
+                const std::size_t base = blocks[t + b];
+                for(std::size_t j = 0; j < 16; ++j) {
+                    sum_v[base + j] += acc[b].v[j];
+                    sum_vv[base + j] += acc[b].vv[j];
+                    sum_vl[base + j] += acc[b].vl[j];
+                }
+            }
+        }
+    }
+
+    const double var_l = sum_ll - sum_l * sum_l / n;
+    if(r) std::fill(r, r + WIDTH, 0.0f);
+    for(std::size_t i = 0; i < WIDTH; ++i) {
+        if(!alive_[i]) continue;
+        const double var_v = sum_vv[i] - sum_v[i] * sum_v[i] / n;
+        const double cov = sum_vl[i] - sum_v[i] * sum_l / n;
+        const double rr = var_v > 0.0 && var_l > 0.0 ? cov / std::sqrt(var_v * var_l) : 0.0;
+        if(r) r[i] = static_cast<float>(rr);
+        if(!(std::fabs(rr) >= min_abs_r)) alive_[i] = 0;
+    }
+
+    recount();
+    return true;
+}
+
+std::size_t RamSearch::results(std::uint16_t* addrs, std::size_t capacity) const {
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < WIDTH; ++i) {
+        if(!alive_[i]) continue;
+        if(n < capacity) addrs[n] = index_addr(i);
+        ++n;
+    }
+    return n;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "fceux.h"
+
+// RAM サーチ。多数のサンプル (内蔵 RAM と $6000-$7FFF の内容) を保持し、アドレスの候補を条件で絞り込む。
+// サンプルは 1 つを WIDTH Byte の行として持ち、候補の判定は行どうしを 16 Byte 単位でまとめて比較して行う。
+struct RamSearch {
+    // 1 サンプルのサイズ。0x800 未満が内蔵 RAM、以降が $6000-$7FFF
+    static constexpr std::size_t WIDTH = FCEUX_SEARCH_WIDTH;
+
+    RamSearch();
+
+    RamSearch(const RamSearch&) = delete;
+    RamSearch& operator=(const RamSearch&) = delete;
+
+    // サンプルを 1 つ追加し、その行 (WIDTH Byte, 呼び出し側が埋める) を返す。
+    std::uint8_t* add();
+
+    std::size_t sample_count() const { return sample_count_; }
+    const std::uint8_t* sample(std::size_t i) const {
+        return chunks_[i / CHUNK_ROWS].get() + (i % CHUNK_ROWS) * WIDTH;
+    }
+
+    // 全アドレスを候補に戻す。
+    void reset();
+
+    std::size_t count() const { return count_; }
+
+    // preds (n 個) を全て満たす候補だけを残す。範囲外のサンプルを指す条件があれば何もせずに false を返す。
+    bool filter(const FceuxSearchPredicate* preds, std::size_t n);
+
+    // 各候補について、値と labels (サンプルごとに 1 つ) の相関係数を求め、絶対値が min_abs_r 未満のものを外す。
+    // r が null でなければ、候補だったアドレスの相関係数を書く (WIDTH 個。候補でなかったものは 0)。
+    // サンプルが 2 つ未満なら何もせずに false を返す。
+    bool correlate(const double* labels, double min_abs_r, float* r);
+
+    // 候補のアドレスを昇順に最大 capacity 個 addrs に書き、候補の総数を返す。
+    std::size_t results(std::uint16_t* addrs, std::size_t capacity) const;
+
+private:
+    static constexpr std::size_t CHUNK_ROWS = 256;
+
+    void recount();
+
+    std::vector<std::unique_ptr<std::uint8_t[]>> chunks_ {};
+    std::size_t sample_count_ {};
+
+    // 0xFF なら候補
+    std::vector<std::uint8_t> alive_;
+    std::size_t count_ {};
+};
@@ -1,133 +1,2352 @@
 #include <algorithm>
+#include <atomic>
+#include <bitset>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <iterator>
-
-#include <zlib.h>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "debug.h"
 #include "driver.h"
 #include "emufile.h"
 #include "fceu.h"
+#include "cart.h" // fceu.h の後に置く
+#include "ppu.h"
+#include "sound.h"
 #include "state.h"
 #include "x6502.h"
 
 #include "fceux.h"
+#include "lib-compress.hpp"
+#include "lib-cond.hpp"
+#include "lib-core.hpp"
 #include "lib-driver.hpp"
+#include "lib-fiber.hpp"
+#include "lib-pagestore.hpp"
+#include "lib-rewind.hpp"
+#include "lib-search.hpp"
 
 #define LIBFCEUX extern "C"
 
-namespace {
+static_assert(sizeof(FceuxRamWrite) == sizeof(X6502_WriteLogEntry), "FceuxRamWrite must match X6502_WriteLogEntry");
+static_assert(offsetof(FceuxRamWrite, addr) == offsetof(X6502_WriteLogEntry, addr), "FceuxRamWrite must match X6502_WriteLogEntry");
+static_assert(offsetof(FceuxRamWrite, new_value) == offsetof(X6502_WriteLogEntry, new_value), "FceuxRamWrite must match X6502_WriteLogEntry");
+static_assert(FCEUX_WRITE_BITS_SIZE == X6502_WRITE_BITS_SIZE, "FCEUX_WRITE_BITS_SIZE must match the core");
+
+// フレーム途中で行われた fceux_mem_write() の記録
+struct MidFrameWrite {
+    std::uint64_t pos; // 書き込んだ位置 (CPU サイクル)
+    std::uint32_t addr;
+    std::uint8_t value;
+    FceuxMemoryDomain domain;
+};
 
-bool initialized = false;
+// フレーム途中の位置。
+// フレーム先頭の状態から、同じ入力、同じ書き込みで pos まで実行し直せば再現できる。
+struct MidFrame {
+    std::uint32_t joypad_data {};
+    std::vector<MidFrameWrite> writes {};
+    std::uint64_t pos {};
+    // 描画を省略しているか (CPU から見える状態には影響しない)
+    bool skip_video {};
+};
 
-std::uint32_t joypad_data = 0;
+// フラット形式 (state.h 参照) の状態を置くバッファ。
+// フィールドが揃うよう先頭をキャッシュライン境界に合わせる。領域は縮めずに使い回す。
+class FlatState {
+public:
+    // 先頭をこの境界に合わせる
+    static constexpr std::size_t ALIGN = 64;
 
-} // anonymous namespace
+    FlatState() = default;
+
+    FlatState(const FlatState&) = delete;
+    FlatState& operator=(const FlatState&) = delete;
+
+    std::uint8_t* data() { return buf_; }
+    const std::uint8_t* data() const { return buf_; }
+    std::uint32_t size() const { return size_; }
+
+    // 自前で確保する代わりに、buf (ALIGN 境界から capacity Byte) を使う。owner は buf を含む領域で、
+    // これが使っている間は解放されないよう参照を持つ。capacity より大きくなれば自前で確保する。
+    void use_buffer(std::shared_ptr<std::uint8_t> owner, std::uint8_t* buf, std::uint32_t capacity) {
+        owner_ = std::move(owner);
+        buf_ = buf;
+        capacity_ = capacity;
+        size_ = 0;
+    }
+
+    // use_buffer() で渡された領域を使っているか
+    bool uses(const std::uint8_t* buf) const { return buf_ == buf && owner_; }
+
+    // コアの状態を保存する。backbuf が false なら映像のバックバッファを省く。
+    void save(bool backbuf) {
+        resize(FCEUSS_FlatSize(backbuf));
+        FCEUSS_SaveFlat(buf_, backbuf);
+    }
+
+    // load() が成功するか。失敗する場合はコアに何も書き込まずに失敗する。
+    bool valid() const {
+        return size_ != 0 && FCEUSS_CheckFlat(data(), size_);
+    }
+
+    // コアに状態をロードする。現在ロードされているゲームで保存したものでなければ失敗する。
+    bool load() const {
+        return size_ != 0 && FCEUSS_LoadFlat(data(), size_);
+    }
+
+    // load() と同じ結果になるが、コアの現在の状態と異なる部分のみを書き込む。
+    bool load_diff() const {
+        return size_ != 0 && FCEUSS_LoadFlatDiff(data(), size_);
+    }
+
+    void assign(const FlatState& other) {
+        resize(other.size_);
+        std::memcpy(buf_, other.data(), size_);
+    }
+
+    // サイズを変える。内容は保たれない。
+    void resize(std::uint32_t size) {
+        if(capacity_ < size) {
+            owner_.reset();
+            raw_.resize(size + ALIGN - 1);
+            const auto addr = reinterpret_cast<std::uintptr_t>(raw_.data());
+            buf_ = raw_.data() + (ALIGN - addr % ALIGN) % ALIGN;
+            capacity_ = size;
+        }
+        size_ = size;
+    }
+
+private:
+    std::vector<std::uint8_t> raw_ {};
+    std::shared_ptr<std::uint8_t> owner_ {};
+    std::uint8_t* buf_ {};
+    std::uint32_t capacity_ {};
+    std::uint32_t size_ {};
+};
+
+// ROM ファイルの内容 (zip などの展開と IPS パッチの適用後)。
+// 同じ内容の ROM を開いたコンテキストで共有し、コンテキストを切り替えるときはファイルではなくこれからロードする。
+struct RomImage {
+    std::string path;
+    std::vector<std::uint8_t> data;
+};
+
+struct Core;
+struct FlatNode;
+
+struct FceuxContext {
+    // 割り当てられたコア。このコアのスレッドでのみ操作する
+    Core* core {};
+
+    std::shared_ptr<const RomImage> rom {};
+
+    std::uint32_t joypad_data {};
+
+    FceuxHookBeforeExec hook {};
+    void* hook_userdata {};
+
+    int sound_freq {};
+
+    bool idle_skip {};
+    std::uint64_t idle_skipped_cycles {};
+
+    bool prg_direct = true;
+
+    // CPU による書き込みの記録。ビットマップはフレーム先頭で消去する。
+    bool write_track {};
+    X6502_WriteTracker write_tracker {};
+
+    // 差分保存で比較を省くための記録。書き込みの記録が有効な間のみ使う。
+    // clean_base の状態 (version が clean_version の時点) から変わったのは、内蔵 RAM では dirty_ram と
+    // 現在のフレームの write_tracker.bits (clean_fresh なら後者は含めない) のビットのバイトのみ、
+    // WRAM では dirty_wram (write_tracker.wram_bits) のビットのバイトのみ。
+    // フレーム境界でフラット形式のスナップショットを保存・ロードしたときに設定し、CPU の実行以外で状態を変えたら外す。
+    std::weak_ptr<const FlatNode> clean_base {};
+    std::uint64_t clean_version {};
+    bool clean_fresh {};
+    std::uint8_t dirty_ram[0x800 / 8] {};
+    std::vector<std::uint8_t> dirty_wram {};
+    // フラット形式の状態で内蔵 RAM と WRAM が置かれる位置 (含まれていなければ 0)
+    std::uint32_t ram_flat_offset {};
+    std::uint32_t wram_flat_offset {};
+
+    // fceux_run_frames() を止める条件。cond_watch.bits は即時評価する条件が読むバイト
+    StopConditions conds {};
+    X6502_WriteWatch cond_watch {};
+
+    // コアに載っていない間のエミュレーション状態
+    FlatState state {};
+
+    // フレーム途中で停止しているか。
+    // コアに載っている間は、そのフレームが fiber 上で実行途中になっている。
+    // コアに載っていない間は state を使わず、frame_start から frame.pos まで実行し直す。
+    bool midframe {};
+    FlatState frame_start {};
+    MidFrame frame {};
+
+    // fiber 上で実行したフレームの出力
+    std::uint8_t* frame_xbuf {};
+    std::int32_t* frame_soundbuf {};
+    std::int32_t frame_soundbuf_size {};
+
+    // コアに載っていない間のサウンド出力の状態 (前のフレームからの持ち越し分)。
+    // これがないと、他のコンテキストを挟んだ前後でサウンドがつながらない
+    FCEUSND_Output sound_output {};
+
+    explicit FceuxContext(std::shared_ptr<const RomImage> rom) : rom(std::move(rom)) {}
+};
+
+// フラット形式の状態を親との差分で表すときの単位 (Byte)
+constexpr std::uint32_t FLAT_PAGE_SIZE = 64;
+
+// スナップショットが持つフラット形式の状態。
+// parent が null なら state が状態全体で、そうでなければ parent の状態から pages のページを置き換えたものが状態となる。
+// 差分を持つスナップショットが親を参照するので、共有される間は書き換えない。
+struct FlatNode {
+    std::shared_ptr<const FlatNode> parent {};
+    FlatState state {};
+
+    // parent があるときのみ使う
+    std::uint32_t size {};
+    std::vector<std::uint32_t> pages {};
+    std::vector<std::uint8_t> page_data {}; // ページ数 * FLAT_PAGE_SIZE Byte
+
+    // 共有されていない間に書き換えるたびに増やす。flat_image() のキャッシュが古くなったことを知るのに使う
+    std::atomic<std::uint64_t> version {};
+
+    std::uint32_t image_size() const { return parent ? size : state.size(); }
+
+    // 差分の連鎖が長いと、parent を順に解放する再帰でスタックが溢れる。
+    // ここでしか参照されていない祖先は、先に parent を外してから解放する。
+    ~FlatNode() {
+        std::shared_ptr<const FlatNode> p = std::move(parent);
+        while(p && p.use_count() == 1) {
+            // 共有されていないので書き換えてよい (FlatNode は const でなく作られる)
+            std::shared_ptr<const FlatNode> next = std::move(const_cast<FlatNode&>(*p).parent);
+            p = std::move(next);
+        }
+    }
+};
+
+struct SnapshotPool;
 
 struct Snapshot {
+    // store があれば状態はフラット形式で store のページ store_pages に、
+    // そうでなく flat があれば flat に、どちらもなければ FCSX 形式で file にある。
     EMUFILE_MEMORY file {};
+    std::shared_ptr<FlatNode> flat {};
+    std::shared_ptr<PageStore> store {};
+    std::vector<std::uint32_t> store_pages {};
+    std::uint32_t store_size {};
+
+    // フレーム途中で保存した場合、状態はそのフレームの先頭のもの (常にフラット形式で親なし) で、frame が保存した位置を表す。
+    bool midframe {};
+    MidFrame frame {};
+
+    // プールから確保したものならそのプール。pool_in_use はプールから貸し出し中か。
+    // generation は貸し出すたびに変わるスロットの世代で、ハンドルに埋め込む (snapshot_handle() 参照)
+    SnapshotPool* pool {};
+    bool pool_in_use {};
+    std::atomic<std::uint16_t> generation {};
+
+    // プールのスロットなら、フラット形式の状態に使うスラブ内の領域。
+    // region_user はその領域を使っているノードで、差分の親として参照されて残っている間は新しいノードには使わせない
+    std::shared_ptr<std::uint8_t> slab {};
+    std::uint8_t* slab_region {};
+    std::uint32_t slab_region_size {};
+    std::weak_ptr<const FlatNode> region_user {};
 
     Snapshot() = default;
-};
+    ~Snapshot() { release_store(); }
 
-LIBFCEUX int fceux_init(const char* path_rom) {
-    if (!FCEUI_Initialize()) return 0;
+    void release_store() {
+        if(!store) return;
+        store->release(store_pages);
+        store.reset();
+    }
 
-    if (LoadGame(path_rom, true) == 0) return 0;
+    // 保存していない状態に戻す。確保済みの領域は解放せずに残す。
+    void clear() {
+        release_store();
+        if(flat && flat.use_count() == 1) {
+            ++flat->version;
+            flat->parent.reset();
+            flat->state.resize(0);
+            flat->pages.clear();
+            flat->page_data.clear();
+        }
+        else {
+            // 差分の親として参照されているので手放す
+            flat.reset();
+        }
+        file.fseek(0, SEEK_SET);
+        file.set_len(0);
+        midframe = false;
+        frame.joypad_data = 0;
+        frame.writes.clear();
+        frame.pos = 0;
+        frame.skip_video = false;
+    }
+};
 
-    // 標準コントローラーのみサポート
-    FCEUI_SetInput(0, SI_GAMEPAD, &joypad_data, 0);
-    FCEUI_SetInput(1, SI_GAMEPAD, &joypad_data, 0);
-    FCEUI_SetInputFC(SIFC_NONE, nullptr, 0);
-    FCEUI_SetInputFourscore(false);
+// プールのスナップショットのハンドル。
+// 64 ビット環境では、スロットのアドレスの上位 16 ビット (ユーザー空間のアドレスでは 0) にスロットの世代を入れて返す。
+// 返却のたびに世代が進むので、返却済みのハンドルが同じスロットを新たに貸し出した先と取り違えられることはない
+// (同じスロットを 65535 回貸し出して世代が一周した場合を除く)。上位ビットが 0 のハンドルはそのままのポインタ。
+constexpr int HANDLE_GENERATION_SHIFT = 48;
 
-    initialized = true;
+namespace {
 
-    return 1;
+Snapshot* snapshot_handle(Snapshot* snap) {
+    const std::uint64_t generation = snap->generation.load(std::memory_order_relaxed);
+    return reinterpret_cast<Snapshot*>(static_cast<std::uintptr_t>(
+        reinterpret_cast<std::uintptr_t>(snap) | generation << HANDLE_GENERATION_SHIFT));
 }
 
-LIBFCEUX int fceux_was_init() {
-    return initialized ? 1 : 0;
-}
+// ハンドルが指すスロットと、埋め込まれた世代 (なければ 0)。
+struct SnapshotRef {
+    Snapshot* snap;
+    std::uint16_t generation;
+};
 
-LIBFCEUX void fceux_power() {
-    FCEUI_PowerNES();
+SnapshotRef split_handle(const Snapshot* handle) {
+    const std::uint64_t v = reinterpret_cast<std::uintptr_t>(handle);
+    const auto generation = static_cast<std::uint16_t>(v >> HANDLE_GENERATION_SHIFT);
+    const std::uint64_t addr = v & ((std::uint64_t(1) << HANDLE_GENERATION_SHIFT) - 1);
+    return { reinterpret_cast<Snapshot*>(static_cast<std::uintptr_t>(addr)), generation };
 }
 
-LIBFCEUX void fceux_reset() {
-    ResetNES();
+// ハンドルからスナップショットを得る。返却済みのプールのハンドルなら null を返す。
+Snapshot* snapshot_of(const Snapshot* handle) {
+    const SnapshotRef ref = split_handle(handle);
+    if(ref.generation != 0 && ref.generation != ref.snap->generation.load(std::memory_order_relaxed))
+        return nullptr;
+    return ref.snap;
 }
 
-LIBFCEUX void fceux_run_frame(
-    std::uint8_t joy1, std::uint8_t joy2,
-    std::uint8_t** xbuf, std::int32_t** soundbuf, std::int32_t* soundbuf_size)
-{
-    joypad_data = joy1 | (joy2<<8);
+} // anonymous namespace
+
+// 同じゲーム・同じ形式のスナップショットを大量に作っては捨てる用途向けに、
+// スナップショットと状態の領域をスラブ単位でまとめて確保しておき、破棄されたら領域を解放せずに再利用する。
+// フラット形式の状態の領域は、スラブごとに 1 つ確保した領域から切り出す。
+// FCSX 形式は EMUFILE_MEMORY が自前のベクタに保存するので、スロットごとに確保する。
+struct SnapshotPool {
+    std::uint32_t flags;
+    // スロットごとに確保する状態のサイズ
+    std::uint32_t state_size;
+    std::size_t slab_size;
+    // ハンドルに世代を埋め込むか。32 ビット環境やアドレスの上位ビットが空いていなければ埋め込まない
+    bool tagged = sizeof(void*) >= 8;
+
+    std::mutex mutex {};
+    std::vector<std::unique_ptr<Snapshot[]>> slabs {};
+    std::vector<Snapshot*> free {};
+    std::size_t in_use {};
+    std::size_t peak_in_use {};
+
+    SnapshotPool(std::uint32_t flags, std::uint32_t state_size, std::size_t slab_size)
+        : flags(flags), state_size(state_size), slab_size(slab_size) {}
+
+    // mutex を取った状態で呼ぶ。
+    void add_slab() {
+        std::unique_ptr<Snapshot[]> slab(new Snapshot[slab_size]);
+        const bool flat = (flags & FCEUX_SNAPSHOT_FLAT) != 0;
+
+        // 状態の領域。一度書いてページを確保させておく。以降は使い回すだけで 0 埋めはしない
+        const std::size_t stride = (state_size + FlatState::ALIGN - 1) / FlatState::ALIGN * FlatState::ALIGN;
+        std::shared_ptr<std::uint8_t> region;
+        std::uint8_t* base = nullptr;
+        if(flat) {
+            const std::size_t bytes = stride * slab_size + FlatState::ALIGN - 1;
+            region.reset(new std::uint8_t[bytes], std::default_delete<std::uint8_t[]>());
+            std::memset(region.get(), 0, bytes);
+            const auto addr = reinterpret_cast<std::uintptr_t>(region.get());
+            base = region.get() + (FlatState::ALIGN - addr % FlatState::ALIGN) % FlatState::ALIGN;
+        }
+
+        for(std::size_t i = 0; i < slab_size; ++i) {
+            Snapshot& snap = slab[i];
+            snap.pool = this;
+            snap.generation = 1;
+            if(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(&snap)) >> HANDLE_GENERATION_SHIFT)
+                tagged = false;
+            if(flat) {
+                snap.slab = region;
+                snap.slab_region = base + i * stride;
+                snap.slab_region_size = state_size;
+                snap.flat = std::make_shared<FlatNode>();
+                snap.flat->state.use_buffer(region, snap.slab_region, state_size);
+                snap.region_user = snap.flat;
+            }
+            else {
+                snap.file.get_vec()->resize(state_size);
+            }
+        }
+        // 後ろから取り出すので、スラブの先頭から順に貸し出されるよう逆順に積む
+        for(std::size_t i = slab_size; i-- > 0;)
+            free.push_back(&slab[i]);
+        slabs.push_back(std::move(slab));
+    }
+
+    // 貸し出して、そのハンドルを返す。
+    Snapshot* alloc() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(free.empty()) add_slab();
+        Snapshot* snap = free.back();
+        free.pop_back();
+        snap->pool_in_use = true;
+        peak_in_use = std::max(peak_in_use, ++in_use);
+        return tagged ? snapshot_handle(snap) : snap;
+    }
+
+    // generation が 0 でなければ、スロットの世代と一致する場合のみ返却する。
+    void release(Snapshot* snap, std::uint16_t generation) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // release_all() で返却済みのもの (古いハンドル) なら何もしない
+            if(!snap->pool_in_use) return;
+            if(generation != 0 && generation != snap->generation) return;
+            snap->pool_in_use = false;
+            next_generation(*snap);
+            --in_use;
+        }
+
+        // 差分の親を手放すなどの後始末はロックの外で済ませる
+        snap->clear();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        free.push_back(snap);
+    }
+
+    void release_all() {
+        std::vector<Snapshot*> returned;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto& slab : slabs) {
+                for(std::size_t i = 0; i < slab_size; ++i) {
+                    Snapshot& snap = slab[i];
+                    if(!snap.pool_in_use) continue;
+                    snap.pool_in_use = false;
+                    next_generation(snap);
+                    returned.push_back(&snap);
+                }
+            }
+            in_use = 0;
+        }
+
+        // release() と同じく、後始末はロックの外で済ませてから空きに戻す
+        for(Snapshot* snap : returned)
+            snap->clear();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        free.insert(free.end(), returned.begin(), returned.end());
+    }
+
+private:
+    // 貸し出していたハンドルを古くする。0 は世代なしを表すので飛ばす
+    static void next_generation(Snapshot& snap) {
+        std::uint16_t g = snap.generation.load(std::memory_order_relaxed) + 1;
+        if(g == 0) g = 1;
+        snap.generation.store(g, std::memory_order_relaxed);
+    }
+};
+
+struct SnapStore {
+    // スナップショットはストアが破棄された後もページを参照するので共有する
+    std::shared_ptr<PageStore> pages;
+};
+
+struct Compressor {
+    CompressPool pool;
+};
 
-    FCEUI_Emulate(xbuf, soundbuf, soundbuf_size, 0);
+struct CompressJob {
+    std::shared_ptr<CompressTask> task;
+    // ジョブが完了するまでは破棄されない (fceux_compressor_destroy() は全ジョブの完了を待つ)
+    Compressor* comp;
+};
+
+// コンテキストを動かすコア。コアの状態はスレッドごとにあるので、コアごとに専用のスレッドを持つ。
+// コンテキストは作成時にいずれかのコアに割り当てられ、そのコアのスレッドでのみ操作される。
+// 同じコアのコンテキストは従来どおり状態を退避・復元しながら 1 つずつ動く。
+// FCEU_TLS_CORE を定義しないビルドではコアは 1 つだけで、呼び出し元のスレッドで操作される (lib-core.hpp)。
+struct Core {
+    CoreThread thread {};
+    // 割り当てられているコンテキストの数 (cores_mutex で保護する)
+    std::size_t contexts {};
+};
+
+namespace {
+
+std::mutex cores_mutex;
+std::vector<std::unique_ptr<Core>> cores {};
+// コア数の上限 (0 なら CPU のスレッド数)
+unsigned core_limit = 0;
+
+// いずれかのコンテキストが使っている ROM。同じ内容の ROM を開いたら共有する (コアをまたいで共有する)
+std::mutex rom_images_mutex;
+std::vector<std::weak_ptr<const RomImage>> rom_images {};
+
+// 以下はコアごとの状態で、コアの状態と同じく FCEU_TLS を付け、コアのスレッドからのみ触る。
+
+FCEU_TLS bool core_initialized = false;
+
+// 現在コアに状態が載っているコンテキスト
+FCEU_TLS FceuxContext* resident = nullptr;
+
+// コアにロードされている ROM
+FCEU_TLS std::shared_ptr<const RomImage> core_rom {};
+FCEU_TLS int core_sound_freq = 0;
+
+// resident のフレームをフレーム途中で止めるための fiber
+FCEU_TLS Fiber frame_fiber;
+
+// フレーム途中で止める条件
+struct BreakCondition {
+    // この位置 (CPU サイクル) 以降に始まる命令の前で止まる
+    std::uint64_t pos_limit = std::numeric_limits<std::uint64_t>::max();
+
+    // これらのアドレスの命令の前で止まる
+    bool use_pcs = false;
+    std::bitset<0x10000> pcs {};
+
+    // scanline がこの値に変わった直後の命令の前で止まる (負なら使わない)
+    int scanline = -1;
+    int scanline_prev = -1;
+
+    // 退避されたフレーム途中の状態を再現中
+    bool replaying = false;
+    std::size_t replay_next = 0;
+
+    // PC の条件で止まったか
+    bool hit_pc = false;
+
+    // 即時評価する停止条件。cond_dirty は条件が読むバイトへの書き込みがあったか
+    const StopConditions* conds = nullptr;
+    bool cond_dirty = false;
+    // 停止条件で止まったならその id
+    int cond_hit = -1;
+};
+FCEU_TLS BreakCondition break_cond {};
+
+// 領域 domain のサイズ。ロードしている ROM にない領域なら 0。
+std::size_t domain_size(FceuxMemoryDomain domain) {
+    switch(domain) {
+    case FCEUX_MEMORY_CPU: return 0x10000;
+    case FCEUX_MEMORY_RAM: return 0x800;
+    case FCEUX_MEMORY_PRG_RAM: return PRGptr[0x10] ? PRGsize[0x10] : 0;
+    case FCEUX_MEMORY_PRG_ROM: return PRGptr[0] ? PRGsize[0] : 0;
+    case FCEUX_MEMORY_CHR: return CHRptr[0] ? CHRsize[0] : 0;
+    case FCEUX_MEMORY_NAMETABLE: return 0x1000;
+    case FCEUX_MEMORY_OAM: return sizeof(SPRAM);
+    case FCEUX_MEMORY_PALETTE: return sizeof(PALRAM);
+    case FCEUX_MEMORY_PPU_REG: return 8;
+    case FCEUX_MEMORY_APU_REG: return 0x18;
+    }
+    return 0;
+}
+
+// 領域 domain が単純な配列ならその先頭。そうでなければ null。
+std::uint8_t* domain_array(FceuxMemoryDomain domain) {
+    switch(domain) {
+    case FCEUX_MEMORY_RAM: return RAM;
+    case FCEUX_MEMORY_PRG_RAM: return PRGptr[0x10];
+    case FCEUX_MEMORY_PRG_ROM: return PRGptr[0];
+    case FCEUX_MEMORY_CHR: return CHRptr[0];
+    case FCEUX_MEMORY_OAM: return SPRAM;
+    case FCEUX_MEMORY_PALETTE: return PALRAM;
+    default: return nullptr;
+    }
 }
 
-LIBFCEUX std::uint8_t fceux_reg_p() {
-    return X.P;
+// ROM はスナップショットに含まれず、同じ ROM のコンテキスト間で共有されるので書き換えさせない。
+bool domain_writable(FceuxMemoryDomain domain) {
+    switch(domain) {
+    case FCEUX_MEMORY_PRG_ROM:
+    case FCEUX_MEMORY_PPU_REG:
+    case FCEUX_MEMORY_APU_REG:
+        return false;
+    case FCEUX_MEMORY_CHR: return CHRram[0] != 0;
+    default: return true;
+    }
 }
 
-LIBFCEUX std::uint8_t fceux_mem_read(std::uint16_t addr, enum FceuxMemoryDomain domain) {
+// addr は domain_size() 未満であること。
+std::uint8_t domain_read(FceuxMemoryDomain domain, std::uint32_t addr) {
     switch(domain) {
-    case FCEUX_MEMORY_CPU:
-        return GetMem(addr);
-    default: assert(false);
+    case FCEUX_MEMORY_CPU: return GetMem(addr);
+    case FCEUX_MEMORY_NAMETABLE: return vnapage[addr >> 10][addr & 0x3FF];
+    case FCEUX_MEMORY_PPU_REG: return GetMem(0x2000 + addr);
+    case FCEUX_MEMORY_APU_REG: return GetMem(0x4000 + addr);
+    default: return domain_array(domain)[addr];
     }
 }
 
-LIBFCEUX void fceux_mem_write(std::uint16_t addr, std::uint8_t value, enum FceuxMemoryDomain domain) {
+// addr は domain_size() 未満で、domain は書き込み可能であること。
+void domain_write(FceuxMemoryDomain domain, std::uint32_t addr, std::uint8_t value) {
     switch(domain) {
-    case FCEUX_MEMORY_CPU:
-        BWrite[addr](addr, value);
-        break;
-    default: assert(false);
+    case FCEUX_MEMORY_CPU: BWrite[addr](addr, value); break;
+    case FCEUX_MEMORY_NAMETABLE: vnapage[addr >> 10][addr & 0x3FF] = value; break;
+    default: domain_array(domain)[addr] = value; break;
     }
 }
 
-LIBFCEUX struct Snapshot* fceux_snapshot_create() {
-    return new Snapshot;
+// コアの内蔵 RAM と $6000-$7FFF を、RAM サーチのサンプルとして out (RamSearch::WIDTH Byte) に読む。
+void read_search_row(std::uint8_t* out) {
+    std::memcpy(out, RAM, 0x800);
+    for(std::uint32_t a = 0x6000; a < 0x8000; a += 0x800) {
+        std::uint8_t* dst = out + 0x800 + (a - 0x6000);
+        if(PRGDirect[a >> 11] && Page[a >> 11]) {
+            std::memcpy(dst, Page[a >> 11] + a, 0x800);
+        }
+        else {
+            for(std::uint32_t i = 0; i < 0x800; ++i)
+                dst[i] = GetMem(a + i);
+        }
+    }
 }
 
-LIBFCEUX void fceux_snapshot_destroy(struct Snapshot* snap) {
-    delete snap;
+// 停止条件の評価に使う。副作用なしで読む
+std::uint8_t cond_read(std::uint16_t addr) {
+    if(addr < 0x2000) return RAM[addr & 0x7FF];
+    return GetMem(addr);
 }
 
-LIBFCEUX int fceux_snapshot_load(struct Snapshot* snap) {
-    snap->file.fseek(0, SEEK_SET);
+// 即時評価する停止条件が読むバイトに CPU が書き込んだ。評価は次の命令の前で行う
+void cond_watch(void*, std::uint32_t) {
+    if(break_cond.conds)
+        break_cond.cond_dirty = true;
+}
+
+// 現在の位置 (電源投入からの CPU サイクル数)
+std::uint64_t cpu_pos() {
+    return timestampbase + timestamp;
+}
 
-    return FCEUSS_LoadFP(&snap->file, SSLOADPARAM_NOBACKUP) ? 1 : 0;
+// コアの状態を file に保存する。file の領域は先頭から上書きして使い回す。
+// backbuf が false なら映像のバックバッファ (クライアントからは見えない) を省く。
+bool save_state(EMUFILE_MEMORY& file, bool backbuf) {
+    file.fseek(0, SEEK_SET);
+    const bool ok = FCEUSS_SaveDirect(&file, backbuf);
+    file.set_len(file.ftell());
+    return ok;
 }
 
-LIBFCEUX int fceux_snapshot_save(struct Snapshot* snap) {
-    snap->file.truncate(0);
+// 差分を持つ FlatNode の状態全体を最後に組み立てたもの (その時点の flat_cache_node の version が flat_cache_version)。
+// スナップショットはどのスレッドからも読めるので、スレッドごとに持つ。
+thread_local FlatState flat_cache;
+thread_local std::weak_ptr<const FlatNode> flat_cache_node {};
+thread_local std::uint64_t flat_cache_version = 0;
+
+// 差分の計算用
+thread_local FlatState flat_scratch;
+
+// node の状態全体を返す。
+// 差分を持つ場合は flat_cache に組み立てる。flat_cache が祖先のものなら、そこからの差分だけを適用する。
+// 返した参照は、次に flat_image() を呼ぶか node を書き換えるまで有効。
+const FlatState& flat_image(const std::shared_ptr<const FlatNode>& node) {
+    if(!node->parent) return node->state;
+
+    auto cached = flat_cache_node.lock();
+    if(cached && cached->version != flat_cache_version) cached.reset();
+    std::vector<const FlatNode*> chain;
+    const FlatNode* p = node.get();
+    for(; p->parent && p != cached.get(); p = p->parent.get())
+        chain.push_back(p);
+    if(p != cached.get()) flat_cache.assign(p->state);
+
+    std::uint8_t* data = flat_cache.data();
+    const std::uint32_t size = flat_cache.size();
+    for(auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        const FlatNode& delta = **it;
+        for(std::size_t i = 0; i < delta.pages.size(); ++i) {
+            const std::uint32_t offset = delta.pages[i] * FLAT_PAGE_SIZE;
+            std::memcpy(data + offset, delta.page_data.data() + i * FLAT_PAGE_SIZE, std::min(FLAT_PAGE_SIZE, size - offset));
+        }
+    }
 
-    return FCEUSS_SaveMS(&snap->file, Z_NO_COMPRESSION) ? 1 : 0;
+    flat_cache_node = node;
+    flat_cache_version = node->version;
+    return flat_cache;
 }
 
-LIBFCEUX void fceux_hook_before_exec(FceuxHookBeforeExec hook, void* userdata) {
-    hook_before_exec = hook;
-    hook_before_exec_userdata = userdata;
+// snap の FlatNode を上書き用に用意する。
+// 他から参照されていなければ領域を使い回し、参照されていれば新しく作る。
+// プールのスロットなら、スラブ内の領域を使っているノードが残っていなければ新しいノードにそれを使わせる。
+FlatNode& flat_node_for_write(Snapshot* snap) {
+    snap->release_store();
+
+    if(snap->flat && snap->flat.use_count() == 1) {
+        // 他のスレッドの flat_image() のキャッシュも無効になる
+        ++snap->flat->version;
+    }
+    else {
+        snap->flat = std::make_shared<FlatNode>();
+        if(snap->slab_region) {
+            const auto user = snap->region_user.lock();
+            if(!user || !user->state.uses(snap->slab_region)) {
+                snap->flat->state.use_buffer(snap->slab, snap->slab_region, snap->slab_region_size);
+                snap->region_user = snap->flat;
+            }
+        }
+    }
+    return *snap->flat;
 }
 
-LIBFCEUX void fceux_video_get_palette(std::uint8_t idx, std::uint8_t* r, std::uint8_t* g, std::uint8_t* b) {
-    FCEUD_GetPalette(idx, r, g, b);
+// 内蔵 RAM について、現在のフレームの書き込みを clean_base からの書き込みに加える。
+void collect_dirty_ram(FceuxContext* ctx) {
+    if(!ctx->clean_fresh) {
+        for(std::size_t i = 0; i < sizeof(ctx->dirty_ram); ++i)
+            ctx->dirty_ram[i] |= ctx->write_tracker.bits[i];
+    }
+    ctx->clean_fresh = false;
 }
 
-LIBFCEUX int fceux_sound_set_freq(int freq) {
-    using std::begin;
-    using std::end;
+// ctx の状態が node の状態と同じになった。以降の書き込みを node からの差分保存に使う。
+void set_clean_base(FceuxContext* ctx, const std::shared_ptr<const FlatNode>& node) {
+    ctx->clean_base.reset();
+    if(!ctx->write_track) return;
 
-    constexpr int FREQS_VALID[] { 0, 44100, 48000, 96000 };
-    if(std::find(begin(FREQS_VALID), end(FREQS_VALID), freq) == end(FREQS_VALID))
-        return 0;
+    ctx->clean_base = node;
+    ctx->clean_version = node->version;
+    ctx->clean_fresh = true;
+    std::memset(ctx->dirty_ram, 0, sizeof(ctx->dirty_ram));
+    std::fill(ctx->dirty_wram.begin(), ctx->dirty_wram.end(), 0);
+    ctx->write_tracker.wram_unknown = 0;
+}
 
-    FCEUI_Sound(freq);
+// 差分保存で比較を省くための記録 (FceuxContext の clean_base 以下) の退避先。
+// 状態を一時的に差し替えてから同じ状態に戻す間の保存・ロードで、記録が変わらないようにする。
+struct CleanRecord {
+    std::weak_ptr<const FlatNode> base;
+    std::uint64_t version;
+    bool fresh;
+    std::uint8_t dirty_ram[0x800 / 8];
+    std::vector<std::uint8_t> dirty_wram;
+    std::uint8_t wram_unknown;
+    std::uint8_t bits[X6502_WRITE_BITS_SIZE];
+};
 
-    return 1;
+void save_clean(const FceuxContext* ctx, CleanRecord& out) {
+    out.base = ctx->clean_base;
+    out.version = ctx->clean_version;
+    out.fresh = ctx->clean_fresh;
+    std::memcpy(out.dirty_ram, ctx->dirty_ram, sizeof(out.dirty_ram));
+    out.dirty_wram = ctx->dirty_wram;
+    out.wram_unknown = ctx->write_tracker.wram_unknown;
+    std::memcpy(out.bits, ctx->write_tracker.bits, sizeof(out.bits));
+}
+
+void restore_clean(FceuxContext* ctx, const CleanRecord& in) {
+    ctx->clean_base = in.base;
+    ctx->clean_version = in.version;
+    ctx->clean_fresh = in.fresh;
+    std::memcpy(ctx->dirty_ram, in.dirty_ram, sizeof(ctx->dirty_ram));
+    // write_tracker.wram_bits が指しているので、確保し直さずに書き戻す
+    std::copy(in.dirty_wram.begin(), in.dirty_wram.end(), ctx->dirty_wram.begin());
+    ctx->write_tracker.wram_unknown = in.wram_unknown;
+    std::memcpy(ctx->write_tracker.bits, in.bits, sizeof(in.bits));
+}
+
+// 差分保存で parent と比較しなくてよいページ。ページ番号で引き、1 なら parent と同じ
+thread_local std::vector<std::uint8_t> flat_clean;
+
+// 状態の offset から size Byte に保存されるメモリについて、dirty (1 Byte につき 1 ビット) のビットが
+// 立っていないページを flat_clean に記す。offset が 0 ならメモリが状態に含まれていない。
+void mark_clean_pages(std::uint32_t offset, std::uint32_t size, const std::uint8_t* dirty) {
+    if(offset == 0) return;
+
+    // フィールドは 8 Byte 境界に置かれるので、ページはビットマップのちょうど 8 Byte に当たる
+    static_assert(FLAT_PAGE_SIZE / 8 == sizeof(std::uint64_t), "a page must be one word of the bitmap");
+    assert(offset % 8 == 0);
+    for(std::uint32_t page = (offset + FLAT_PAGE_SIZE - 1) / FLAT_PAGE_SIZE; (page + 1) * FLAT_PAGE_SIZE <= offset + size; ++page) {
+        std::uint64_t bits;
+        std::memcpy(&bits, dirty + (page * FLAT_PAGE_SIZE - offset) / 8, sizeof(bits));
+        if(bits == 0) flat_clean[page] = 1;
+    }
+}
+
+// ctx の clean_base が parent なら、内蔵 RAM と WRAM のうち parent から書き込みのなかったページを
+// flat_clean に記して true を返す。size は保存する状態のサイズ。
+bool find_clean_pages(FceuxContext* ctx, const FlatNode* parent, std::uint32_t size) {
+    const auto base = ctx->clean_base.lock();
+    if(!ctx->write_track || !base || base.get() != parent || base->version != ctx->clean_version) return false;
+
+    collect_dirty_ram(ctx);
+    flat_clean.assign(size / FLAT_PAGE_SIZE + 1, 0);
+    mark_clean_pages(ctx->ram_flat_offset, 0x800, ctx->dirty_ram);
+    const X6502_WriteTracker& t = ctx->write_tracker;
+    if(t.wram_bits && !t.wram_unknown)
+        mark_clean_pages(ctx->wram_flat_offset, t.wram_size, t.wram_bits);
+    return true;
+}
+
+// ctx の状態を、parent の状態からの差分として snap に保存する。
+// parent とサイズが異なる場合は状態全体を保存する。
+// parent が ctx の clean_base なら、内蔵 RAM と WRAM の書き込みのなかったページは比較しない。
+void save_flat_delta(FceuxContext* ctx, Snapshot* snap, const std::shared_ptr<const FlatNode>& parent, bool backbuf) {
+    flat_scratch.save(backbuf);
+    const FlatState& base = flat_image(parent);
+    const bool clean = find_clean_pages(ctx, parent.get(), flat_scratch.size());
+
+    FlatNode& node = flat_node_for_write(snap);
+    if(base.size() != flat_scratch.size()) {
+        node.parent.reset();
+        node.state.assign(flat_scratch);
+        set_clean_base(ctx, snap->flat);
+        return;
+    }
+
+    node.parent = parent;
+    node.size = flat_scratch.size();
+    node.pages.clear();
+    node.page_data.clear();
+    for(std::uint32_t offset = 0; offset < node.size; offset += FLAT_PAGE_SIZE) {
+        if(clean && flat_clean[offset / FLAT_PAGE_SIZE]) continue;
+        const std::uint32_t len = std::min(FLAT_PAGE_SIZE, node.size - offset);
+        const std::uint8_t* page = flat_scratch.data() + offset;
+        if(std::memcmp(page, base.data() + offset, len) == 0) continue;
+        node.pages.push_back(offset / FLAT_PAGE_SIZE);
+        node.page_data.insert(node.page_data.end(), page, page + len);
+        node.page_data.resize(node.pages.size() * FLAT_PAGE_SIZE);
+    }
+    set_clean_base(ctx, snap->flat);
+}
+
+// フレーム途中での停止。命令実行前に毎回呼ばれる。
+void break_check(std::uint16_t addr) {
+    FceuxContext* ctx = resident;
+    const std::uint64_t pos = cpu_pos();
+
+    if(break_cond.replaying) {
+        // フックはこの時点で一度呼ばれているので、書き込みも同じ位置で行う
+        const auto& writes = ctx->frame.writes;
+        while(break_cond.replay_next < writes.size() && writes[break_cond.replay_next].pos <= pos) {
+            const auto& w = writes[break_cond.replay_next++];
+            // 直列化されたものから復元した記録もあるので検査する
+            if(domain_writable(w.domain) && w.addr < domain_size(w.domain))
+                domain_write(w.domain, w.addr, w.value);
+        }
+        if(pos != ctx->frame.pos) return;
+    }
+    else {
+        bool hit = pos >= break_cond.pos_limit;
+        if(break_cond.use_pcs && break_cond.pcs[addr]) {
+            hit = true;
+            break_cond.hit_pc = true;
+        }
+        if(break_cond.scanline >= 0) {
+            if(scanline == break_cond.scanline && break_cond.scanline_prev != scanline) hit = true;
+            break_cond.scanline_prev = scanline;
+        }
+        if(break_cond.cond_dirty) {
+            break_cond.cond_dirty = false;
+            const int id = break_cond.conds->check(cond_read, true);
+            if(id >= 0) {
+                hit = true;
+                break_cond.cond_hit = id;
+            }
+        }
+        if(!hit) return;
+    }
+
+    ctx->frame.pos = pos;
+    frame_fiber.suspend();
+}
+
+// フレームを開始する直前に呼ぶ。
+void begin_frame(FceuxContext* ctx) {
+    if(ctx->write_track) {
+        collect_dirty_ram(ctx);
+        std::memset(ctx->write_tracker.bits, 0, sizeof(ctx->write_tracker.bits));
+    }
+}
+
+// fiber 上でフレームを 1 つ実行する。
+void frame_entry(void* arg) {
+    auto ctx = static_cast<FceuxContext*>(arg);
+
+    begin_frame(ctx);
+    FCEUI_Emulate(&ctx->frame_xbuf, &ctx->frame_soundbuf, &ctx->frame_soundbuf_size, ctx->frame.skip_video ? 1 : 0);
+
+    ctx->midframe = false;
+    ctx->frame.writes.clear();
+    break_before_exec = nullptr;
+}
+
+// 実行途中のフレームを捨てる。呼び出し側はこの後に必ず状態をロードすること。
+void abandon_fiber() {
+    frame_fiber.abandon();
+    break_before_exec = nullptr;
+    X6502_AbandonRun();
+    FCEUPPU_AbandonFrame();
+    FCEUSND_AbandonFrame();
+}
+
+// コアに載っている ctx のフレームを fiber 上で開始する (まだ実行はしない)。
+void start_frame(FceuxContext* ctx) {
+    ctx->midframe = true;
+    break_before_exec = break_check;
+    frame_fiber.start(frame_entry, ctx);
+}
+
+// ctx がフレーム途中なら、実行途中のフレームを捨てる。コアの状態はそのまま。
+void abandon_frame(FceuxContext* ctx) {
+    if(!ctx->midframe) return;
+
+    if(resident == ctx)
+        abandon_fiber();
+    ctx->midframe = false;
+    ctx->frame.writes.clear();
+}
+
+// ctx がフレーム途中なら、そのフレームの先頭の状態に戻す。
+void rewind_frame(FceuxContext* ctx) {
+    if(!ctx->midframe) return;
+
+    abandon_frame(ctx);
+
+    const bool ok = ctx->frame_start.load();
+    assert(ok); (void)ok;
+}
+
+// コアに載せたフレーム先頭の状態から、ctx->frame.pos まで実行し直す。
+void replay_frame(FceuxContext* ctx) {
+    ctx->joypad_data = ctx->frame.joypad_data;
+
+    // フックは既に一度呼ばれているので、再実行中は呼ばない。
+    // 書き込みのログも記録済みなので、ビットマップだけ作り直す
+    hook_before_exec = nullptr;
+    X6502_WriteLogEntry* const write_log = ctx->write_tracker.log;
+    ctx->write_tracker.log = nullptr;
+
+    break_cond = BreakCondition {};
+    break_cond.replaying = true;
+    start_frame(ctx);
+    frame_fiber.resume();
+    assert(ctx->midframe);
+    break_cond.replaying = false;
+
+    hook_before_exec = ctx->hook;
+    ctx->write_tracker.log = write_log;
+}
+
+// フレーム境界にいる ctx について、現在の入力で新しいフレームを fiber 上で開始する (まだ実行はしない)。
+void start_new_frame(FceuxContext* ctx, bool skip_video) {
+    ctx->frame_start.save(false);
+    ctx->frame.joypad_data = ctx->joypad_data;
+    ctx->frame.writes.clear();
+    ctx->frame.skip_video = skip_video;
+    start_frame(ctx);
+}
+
+// break_cond の条件を満たすまで実行する。フレーム境界を越えてもよい。
+void run_until_break(FceuxContext* ctx) {
+    do {
+        if(!ctx->midframe)
+            start_new_frame(ctx, false);
+        frame_fiber.resume();
+    } while(!ctx->midframe);
+}
+
+// フレーム途中の ctx について、そのフレームの残りを実行する。
+void finish_frame(FceuxContext* ctx) {
+    break_cond = BreakCondition {};
+    frame_fiber.resume();
+    assert(!ctx->midframe);
+}
+
+// コンテキスト固有の入力、フック、サウンド設定をコアに反映する。
+void bind(FceuxContext* ctx) {
+    // 標準コントローラーのみサポート
+    FCEUI_SetInput(0, SI_GAMEPAD, &ctx->joypad_data, 0);
+    FCEUI_SetInput(1, SI_GAMEPAD, &ctx->joypad_data, 0);
+    FCEUI_SetInputFC(SIFC_NONE, nullptr, 0);
+    FCEUI_SetInputFourscore(false);
+
+    hook_before_exec = ctx->hook;
+    hook_before_exec_userdata = ctx->hook_userdata;
+
+    X6502_IdleSkip = ctx->idle_skip;
+    X6502_IdleCyclesSkipped = ctx->idle_skipped_cycles;
+    FCEU_SetPRGDirect(ctx->prg_direct);
+
+    // WRAM の領域とフラット形式の状態の並びは ROM をロードし直すと変わりうる
+    X6502_WriteTracker& t = ctx->write_tracker;
+    t.wram = PRGptr[0x10];
+    t.wram_size = PRGptr[0x10] ? PRGsize[0x10] : 0;
+    ctx->dirty_wram.resize((t.wram_size + 7) / 8);
+    t.wram_bits = t.wram_size ? ctx->dirty_wram.data() : nullptr;
+    ctx->ram_flat_offset = FCEUSS_FlatOffsetOf(RAM, 0x800);
+    ctx->wram_flat_offset = t.wram_size ? FCEUSS_FlatOffsetOf(t.wram, t.wram_size) : 0;
+    X6502_WriteTrack = ctx->write_track ? &ctx->write_tracker : nullptr;
+
+    if(ctx->sound_freq != core_sound_freq) {
+        FCEUI_Sound(ctx->sound_freq);
+        core_sound_freq = ctx->sound_freq;
+    }
+}
+
+// 現在コアに載っているコンテキストの状態を退避する。
+void evict() {
+    if(!resident) return;
+
+    if(resident->midframe) {
+        // 実行途中のフレームは捨て、次に載せるときに frame_start から再現する
+        abandon_fiber();
+    }
+    else {
+        resident->state.save(false);
+    }
+    FCEUSND_SaveOutput(&resident->sound_output);
+
+    resident->idle_skipped_cycles = X6502_IdleCyclesSkipped;
+
+    resident = nullptr;
+}
+
+// ctx の状態をコアに載せる。ROM または状態をロードできなければ false を返す (何も載っていない状態になる)。
+bool activate(FceuxContext* ctx) {
+    if(resident == ctx) return true;
+
+    evict();
+
+    if(ctx->rom != core_rom) {
+        // 失敗した場合のコアの中身は当てにならないので、次は必ずロードし直させる
+        core_rom.reset();
+        if(!LoadGame(ctx->rom->path.c_str(), ctx->rom->data, true)) return false;
+        core_rom = ctx->rom;
+    }
+
+    if(!(ctx->midframe ? ctx->frame_start : ctx->state).load()) {
+        core_rom.reset();
+        return false;
+    }
+
+    bind(ctx);
+    FCEUSND_LoadOutput(&ctx->sound_output);
+    resident = ctx;
+
+    if(ctx->midframe)
+        replay_frame(ctx);
+
+    return true;
+}
+
+// ctx のコアのスレッド上で f() を実行し、その戻り値を返す。コアの状態を触る処理は全てこれを通す。
+// f() の中で activate(ctx) を呼んで ctx をコアに載せること。
+template<class F>
+auto on_core(FceuxContext* ctx, F f) -> decltype(f()) {
+#ifdef FCEU_TLS_CORE
+    return ctx->core->thread.call(f);
+#else
+    return ctx->core->thread.call([&] {
+        // 呼び出し元のスレッドが変わると、実行途中のフレームの fiber は続きを実行できない。
+        // 状態を退避させて fiber を捨て、次に載せるときにフレームの先頭から再現する
+        if(frame_fiber.active() && !frame_fiber.resumable_here())
+            evict();
+        return f();
+    });
+#endif
+}
+
+// 新しいコンテキストを割り当てるコアを選ぶ。
+// コンテキストが最も少ないコアを選ぶが、全コアにコンテキストがあり、コア数が上限未満なら新しいコアを作る。
+Core* acquire_core() {
+    std::lock_guard<std::mutex> lock(cores_mutex);
+
+    Core* best = nullptr;
+    for(const auto& core : cores) {
+        if(!best || core->contexts < best->contexts) best = core.get();
+    }
+
+#ifdef FCEU_TLS_CORE
+    const unsigned limit = core_limit != 0 ? core_limit : std::max(std::thread::hardware_concurrency(), 1U);
+#else
+    const unsigned limit = 1;
+#endif
+    if(!best || (best->contexts != 0 && cores.size() < limit)) {
+        cores.push_back(std::make_unique<Core>());
+        best = cores.back().get();
+    }
+
+    ++best->contexts;
+    return best;
+}
+
+// acquire_core() で割り当てたコアを返す。コアのスレッドは次のコンテキストのために残しておく。
+void release_core(Core* core) {
+    std::lock_guard<std::mutex> lock(cores_mutex);
+    --core->contexts;
+}
+
+// fceux_run_frames() でフレーム i (0-based, 全 n フレーム) の出力が必要か。
+bool frame_wanted(const FceuxFrameResult* out, std::size_t i, std::size_t n) {
+    if(!out) return false;
+
+    switch(out->output) {
+    case FCEUX_FRAME_OUTPUT_NONE: return false;
+    case FCEUX_FRAME_OUTPUT_LAST: return i+1 == n;
+    case FCEUX_FRAME_OUTPUT_EVERY: return out->interval != 0 && (i+1) % out->interval == 0;
+    default: assert(false); return false;
+    }
+}
+
+// 1 フレーム分の出力を out に追記する。
+void frame_output(FceuxFrameResult* out, const std::uint8_t* xbuf, const std::int32_t* soundbuf, std::int32_t soundbuf_size) {
+    constexpr std::size_t VIDEO_SIZE = 256 * 240;
+
+    if(out->video)
+        std::memcpy(out->video + VIDEO_SIZE*out->frame_count, xbuf, VIDEO_SIZE);
+
+    if(out->sound) {
+        const std::size_t n = std::min<std::size_t>(soundbuf_size, out->sound_capacity - out->sound_size);
+        std::copy_n(soundbuf, n, out->sound + out->sound_size);
+        out->sound_size += n;
+    }
+
+    if(out->sound_sizes)
+        out->sound_sizes[out->frame_count] = soundbuf_size;
+
+    ++out->frame_count;
+}
+
+// fceux_snapshot_serialize() の形式。
+// ヘッダ、状態 (state_size Byte)、フレーム途中の書き込み (write_count 個) の順に並ぶ。数値はホストのバイトオーダー。
+constexpr char SERIAL_MAGIC[4] = { 'F', 'X', 'S', 'N' };
+constexpr std::uint32_t SERIAL_VERSION = 2;
+
+enum SerialKind : std::uint32_t {
+    SERIAL_FCSX = 0,
+    SERIAL_FLAT = 1,
+};
+
+struct SerialHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t kind;
+    std::uint32_t state_size;
+    std::uint32_t midframe;
+    std::uint32_t joypad_data;
+    std::uint64_t pos;
+    std::uint32_t write_count;
+    // 状態がバッファの先頭と同じ境界に揃うよう埋める
+    std::uint8_t reserved[28];
+};
+static_assert(sizeof(SerialHeader) == 64, "SerialHeader must be 64 bytes");
+
+struct SerialWrite {
+    std::uint64_t pos;
+    std::uint32_t addr;
+    std::uint8_t value;
+    std::uint8_t domain;
+    std::uint8_t reserved[2];
+};
+static_assert(sizeof(SerialWrite) == 16, "SerialWrite must be 16 bytes");
+
+// バージョン 1 の書き込みの記録 (CPU のアドレス空間のみ)
+struct SerialWriteV1 {
+    std::uint64_t pos;
+    std::uint16_t addr;
+    std::uint8_t value;
+    std::uint8_t reserved[5];
+};
+static_assert(sizeof(SerialWriteV1) == sizeof(SerialWrite), "SerialWriteV1 must be the same size as SerialWrite");
+
+// 直列化されたスナップショット。state と writes は元のバッファを指す。
+struct SerialView {
+    SerialHeader header;
+    const std::uint8_t* state;
+    const std::uint8_t* writes;
+};
+
+// FCSX 形式の状態 (size Byte) のヘッダを検査する。
+// コアはヘッダのサイズをそのまま信じて読むので、ここで状態の大きさと合っていることを確かめる。
+bool check_fcsx(const std::uint8_t* state, std::uint32_t size) {
+    constexpr std::uint32_t HEADER_SIZE = 16;
+    // zlib の圧縮率の上限
+    constexpr std::uint64_t MAX_RATIO = 1032;
+
+    if(size < HEADER_SIZE || std::memcmp(state, "FCSX", 4) != 0) return false;
+
+    const auto le32 = [](const std::uint8_t* p) {
+        return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+    };
+    const std::uint32_t total = le32(state + 4);
+    const std::uint32_t comprlen = le32(state + 12);
+    if(total > std::uint32_t(std::numeric_limits<std::int32_t>::max())) return false;
+    // 圧縮されていなければ comprlen は -1
+    if(comprlen == 0xFFFFFFFF) return std::uint64_t(total) + HEADER_SIZE == size;
+    return std::uint64_t(comprlen) + HEADER_SIZE == size && total <= MAX_RATIO * comprlen;
+}
+
+// フラット形式の状態 (size Byte) のヘッダを検査する。
+// レイアウトが合っているかはロード時に検査する (コアのスレッドでしか分からない)。
+bool check_flat(const std::uint8_t* state, std::uint32_t size) {
+    if(size < FCEUSS_FLAT_HEADER_SIZE || std::memcmp(state, "FCSF", 4) != 0) return false;
+
+    std::uint32_t header_size;
+    std::memcpy(&header_size, state + 4, sizeof(header_size));
+    return header_size == size;
+}
+
+// buf (size Byte) を検査して view に設定する。不正なら false を返す。
+bool parse_serialized(const void* buf, std::size_t size, SerialView& view) {
+    if(size < sizeof(SerialHeader)) return false;
+
+    SerialHeader& h = view.header;
+    std::memcpy(&h, buf, sizeof(h));
+    if(std::memcmp(h.magic, SERIAL_MAGIC, 4) != 0 || h.version < 1 || h.version > SERIAL_VERSION) return false;
+    if(h.kind != SERIAL_FCSX && h.kind != SERIAL_FLAT) return false;
+    // フレーム途中の状態は常にフラット形式
+    if(h.midframe && h.kind != SERIAL_FLAT) return false;
+
+    const std::uint64_t need = sizeof(h) + std::uint64_t(h.state_size) + std::uint64_t(h.write_count) * sizeof(SerialWrite);
+    if(size < need) return false;
+
+    view.state = static_cast<const std::uint8_t*>(buf) + sizeof(h);
+    view.writes = view.state + h.state_size;
+    return h.kind == SERIAL_FLAT ? check_flat(view.state, h.state_size) : check_fcsx(view.state, h.state_size);
+}
+
+// view が表すフレーム途中の位置
+MidFrame serial_frame(const SerialView& view) {
+    MidFrame frame {};
+    if(!view.header.midframe) return frame;
+
+    frame.joypad_data = view.header.joypad_data;
+    frame.pos = view.header.pos;
+    frame.writes.resize(view.header.write_count);
+    for(std::size_t i = 0; i < frame.writes.size(); ++i) {
+        if(view.header.version == 1) {
+            SerialWriteV1 w;
+            std::memcpy(&w, view.writes + i * sizeof(w), sizeof(w));
+            frame.writes[i] = MidFrameWrite { w.pos, w.addr, w.value, FCEUX_MEMORY_CPU };
+        }
+        else {
+            SerialWrite w;
+            std::memcpy(&w, view.writes + i * sizeof(w), sizeof(w));
+            frame.writes[i] = MidFrameWrite { w.pos, w.addr, w.value, static_cast<FceuxMemoryDomain>(w.domain) };
+        }
+    }
+    return frame;
+}
+
+// path の ROM ファイルを読む。既に使われている ROM と内容が同じならそれを返す。
+std::shared_ptr<const RomImage> open_rom(const char* path) {
+    auto rom = std::make_shared<RomImage>();
+    rom->path = path;
+    if(!FCEUI_ReadGame(path, rom->data, true)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(rom_images_mutex);
+    rom_images.erase(
+        std::remove_if(rom_images.begin(), rom_images.end(), [](const auto& p) { return p.expired(); }),
+        rom_images.end());
+    for(const auto& p : rom_images) {
+        auto other = p.lock();
+        if(other && other->path == rom->path && other->data == rom->data) return other;
+    }
+
+    rom_images.push_back(rom);
+    return rom;
+}
+
+} // anonymous namespace
+
+LIBFCEUX struct FceuxContext* fceux_create(const char* path_rom) {
+    Core* core = acquire_core();
+
+    FceuxContext* ctx = core->thread.call([&]() -> FceuxContext* {
+        if(!core_initialized) {
+            if (!FCEUI_Initialize()) return nullptr;
+            core_initialized = true;
+        }
+
+        evict();
+
+        auto rom = open_rom(path_rom);
+        if(!rom) return nullptr;
+
+        // 同じ ROM でも電源投入直後の状態を得るためにロードし直す
+        core_rom.reset();
+        if (LoadGame(rom->path.c_str(), rom->data, true) == 0) return nullptr;
+        core_rom = rom;
+
+        auto ctx = new FceuxContext(std::move(rom));
+        ctx->core = core;
+        ctx->cond_watch.fn = cond_watch;
+        bind(ctx);
+        FCEUSND_ResetOutput();
+        resident = ctx;
+
+        return ctx;
+    });
+
+    if(!ctx) release_core(core);
+    return ctx;
+}
+
+LIBFCEUX void fceux_destroy(struct FceuxContext* ctx) {
+    if(!ctx) return;
+
+    Core* core = ctx->core;
+
+    on_core(ctx, [&] {
+        if(resident == ctx) {
+            abandon_frame(ctx);
+            hook_before_exec = nullptr;
+            hook_before_exec_userdata = nullptr;
+            X6502_WriteTrack = nullptr;
+            resident = nullptr;
+        }
+
+        delete ctx;
+    });
+
+    release_core(core);
+}
+
+LIBFCEUX void fceux_set_core_limit(unsigned n) {
+    std::lock_guard<std::mutex> lock(cores_mutex);
+    core_limit = n;
+}
+
+LIBFCEUX void fceux_call_on_core(struct FceuxContext* ctx, void (*fn)(void*), void* userdata) {
+    on_core(ctx, [&] { fn(userdata); });
+}
+
+LIBFCEUX void fceux_power(struct FceuxContext* ctx) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        ctx->clean_base.reset();
+        rewind_frame(ctx);
+        FCEUI_PowerNES();
+    });
+}
+
+LIBFCEUX void fceux_reset(struct FceuxContext* ctx) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        ctx->clean_base.reset();
+        rewind_frame(ctx);
+        ResetNES();
+    });
+}
+
+LIBFCEUX void fceux_run_frame(
+    struct FceuxContext* ctx,
+    std::uint8_t joy1, std::uint8_t joy2,
+    std::uint8_t** xbuf, std::int32_t** soundbuf, std::int32_t* soundbuf_size)
+{
+    on_core(ctx, [&] {
+        if(!activate(ctx)) {
+            *xbuf = nullptr;
+            *soundbuf = nullptr;
+            *soundbuf_size = 0;
+            return;
+        }
+
+        if(ctx->midframe) {
+            // 入力はフレーム先頭で読み込み済み
+            finish_frame(ctx);
+            *xbuf = ctx->frame_xbuf;
+            *soundbuf = ctx->frame_soundbuf;
+            *soundbuf_size = ctx->frame_soundbuf_size;
+            return;
+        }
+
+        ctx->joypad_data = joy1 | (joy2<<8);
+
+        begin_frame(ctx);
+        FCEUI_Emulate(xbuf, soundbuf, soundbuf_size, 0);
+    });
+}
+
+LIBFCEUX std::size_t fceux_run_frames(
+    struct FceuxContext* ctx, const std::uint16_t* inputs, std::size_t n, struct FceuxFrameResult* out)
+{
+    if(out) {
+        out->frame_count = 0;
+        out->sound_size = 0;
+        if(out->write_bits)
+            std::memset(out->write_bits, 0, FCEUX_WRITE_BITS_SIZE);
+        out->stop_cond = -1;
+        out->stop_frame = 0;
+    }
+
+    return on_core(ctx, [&]() -> std::size_t {
+        if(!activate(ctx)) return 0;
+
+        const bool use_conds = !ctx->conds.empty();
+        if(use_conds)
+            ctx->conds.update(cond_read);
+
+        // 即時評価する条件があれば、全フレームを fiber 上で命令ごとに検査しながら実行する
+        const bool immediate = ctx->conds.has_immediate();
+        if(immediate)
+            X6502_WatchWrites = &ctx->cond_watch;
+
+        for(std::size_t i = 0; i < n; ++i) {
+            const bool wanted = frame_wanted(out, i, n);
+            const bool skip = out && out->skip_video && !(wanted && out->video);
+
+            std::uint8_t* xbuf;
+            std::int32_t* soundbuf;
+            std::int32_t soundbuf_size;
+            if(immediate) {
+                if(!ctx->midframe) {
+                    ctx->joypad_data = inputs[i];
+                    start_new_frame(ctx, skip);
+                }
+                break_cond = BreakCondition {};
+                break_cond.conds = &ctx->conds;
+                frame_fiber.resume();
+
+                if(ctx->midframe) {
+                    X6502_WatchWrites = nullptr;
+                    if(out) {
+                        out->stop_cond = break_cond.cond_hit;
+                        out->stop_frame = i;
+                    }
+                    return i;
+                }
+                xbuf = ctx->frame_xbuf;
+                soundbuf = ctx->frame_soundbuf;
+                soundbuf_size = ctx->frame_soundbuf_size;
+            }
+            else if(ctx->midframe) {
+                // 入力はフレーム先頭で読み込み済み
+                finish_frame(ctx);
+                xbuf = ctx->frame_xbuf;
+                soundbuf = ctx->frame_soundbuf;
+                soundbuf_size = ctx->frame_soundbuf_size;
+            }
+            else {
+                ctx->joypad_data = inputs[i];
+                begin_frame(ctx);
+                FCEUI_Emulate(&xbuf, &soundbuf, &soundbuf_size, skip ? 1 : 0);
+            }
+
+            if(wanted)
+                frame_output(out, xbuf, soundbuf, soundbuf_size);
+            if(out && out->write_bits && ctx->write_track) {
+                for(std::size_t k = 0; k < FCEUX_WRITE_BITS_SIZE; ++k)
+                    out->write_bits[k] |= ctx->write_tracker.bits[k];
+            }
+
+            if(use_conds) {
+                const int id = ctx->conds.check(cond_read, false);
+                if(id >= 0) {
+                    X6502_WatchWrites = nullptr;
+                    if(out) {
+                        out->stop_cond = id;
+                        out->stop_frame = i;
+                    }
+                    return i+1;
+                }
+                ctx->conds.update(cond_read);
+            }
+        }
+
+        X6502_WatchWrites = nullptr;
+        return n;
+    });
+}
+
+LIBFCEUX int fceux_cond_add(
+    struct FceuxContext* ctx, const struct FceuxCondTerm* terms, size_t n, enum FceuxCondCombine combine, std::uint32_t flags)
+{
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return -1;
+
+        const int id = ctx->conds.add(terms, n, combine, flags);
+        if(id >= 0)
+            ctx->conds.watch_bits(ctx->cond_watch.bits);
+        return id;
+    });
+}
+
+LIBFCEUX int fceux_cond_remove(struct FceuxContext* ctx, int id) {
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        if(!ctx->conds.remove(id)) return 0;
+        ctx->conds.watch_bits(ctx->cond_watch.bits);
+        return 1;
+    });
+}
+
+LIBFCEUX void fceux_cond_clear(struct FceuxContext* ctx) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        ctx->conds.clear();
+        ctx->conds.watch_bits(ctx->cond_watch.bits);
+    });
+}
+
+LIBFCEUX std::uint64_t fceux_run_cycles(struct FceuxContext* ctx, std::uint64_t n) {
+    return on_core(ctx, [&]() -> std::uint64_t {
+        if(!activate(ctx)) return 0;
+
+        if(n == 0) return 0;
+
+        const std::uint64_t begin = cpu_pos();
+
+        break_cond = BreakCondition {};
+        break_cond.pos_limit = begin + std::min(n, std::numeric_limits<std::uint64_t>::max() - begin);
+        run_until_break(ctx);
+
+        return cpu_pos() - begin;
+    });
+}
+
+LIBFCEUX int fceux_run_until_pc(
+    struct FceuxContext* ctx, const std::uint16_t* addrs, std::size_t addr_count, std::uint64_t max_cycles)
+{
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        if(max_cycles == 0) return 0;
+
+        const std::uint64_t begin = cpu_pos();
+
+        break_cond = BreakCondition {};
+        break_cond.pos_limit = begin + std::min(max_cycles, std::numeric_limits<std::uint64_t>::max() - begin);
+        break_cond.use_pcs = true;
+        for(std::size_t i = 0; i < addr_count; ++i)
+            break_cond.pcs[addrs[i]] = true;
+        run_until_break(ctx);
+
+        return break_cond.hit_pc ? 1 : 0;
+    });
+}
+
+LIBFCEUX int fceux_run_until_scanline(struct FceuxContext* ctx, int sl) {
+    if(sl < 0 || sl >= 240) return 0;
+
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        break_cond = BreakCondition {};
+        break_cond.scanline = sl;
+        break_cond.scanline_prev = scanline;
+        run_until_break(ctx);
+
+        return 1;
+    });
+}
+
+LIBFCEUX int fceux_midframe(struct FceuxContext* ctx) {
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        return ctx->midframe ? 1 : 0;
+    });
+}
+
+LIBFCEUX std::uint8_t fceux_reg_p(struct FceuxContext* ctx) {
+    return on_core(ctx, [&]() -> std::uint8_t {
+        if(!activate(ctx)) return 0;
+
+        return X.P;
+    });
+}
+
+LIBFCEUX void fceux_cpu_regs(struct FceuxContext* ctx, struct FceuxCpuRegs* regs) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) {
+            *regs = FceuxCpuRegs {};
+            return;
+        }
+
+        regs->pc = X.PC;
+        regs->a = X.A;
+        regs->x = X.X;
+        regs->y = X.Y;
+        regs->s = X.S;
+        regs->p = X.P;
+        regs->cycles = cpu_pos();
+    });
+}
+
+LIBFCEUX std::uint8_t fceux_mem_read(struct FceuxContext* ctx, std::uint16_t addr, enum FceuxMemoryDomain domain) {
+    return on_core(ctx, [&]() -> std::uint8_t {
+        if(!activate(ctx)) return 0;
+
+        if(addr >= domain_size(domain)) return 0;
+        return domain_read(domain, addr);
+    });
+}
+
+LIBFCEUX void fceux_mem_write(struct FceuxContext* ctx, std::uint16_t addr, std::uint8_t value, enum FceuxMemoryDomain domain) {
+    fceux_mem_write_range(ctx, domain, addr, &value, 1);
+}
+
+LIBFCEUX size_t fceux_mem_domain_size(struct FceuxContext* ctx, enum FceuxMemoryDomain domain) {
+    return on_core(ctx, [&]() -> size_t {
+        if(!activate(ctx)) return 0;
+
+        return domain_size(domain);
+    });
+}
+
+LIBFCEUX size_t fceux_mem_read_range(struct FceuxContext* ctx, enum FceuxMemoryDomain domain, size_t addr, void* buf, size_t size) {
+    return on_core(ctx, [&]() -> size_t {
+        if(!activate(ctx)) return 0;
+
+        const std::size_t total = domain_size(domain);
+        if(addr >= total) return 0;
+        size = std::min(size, total - addr);
+
+        auto out = static_cast<std::uint8_t*>(buf);
+        if(const std::uint8_t* p = domain_array(domain)) {
+            std::memcpy(out, p + addr, size);
+        }
+        else if(domain == FCEUX_MEMORY_NAMETABLE) {
+            for(std::size_t i = 0; i < size; ) {
+                const std::size_t a = addr + i;
+                const std::size_t len = std::min<std::size_t>(size - i, 0x400 - (a & 0x3FF));
+                std::memcpy(out + i, vnapage[a >> 10] + (a & 0x3FF), len);
+                i += len;
+            }
+        }
+        else {
+            for(std::size_t i = 0; i < size; ++i) {
+                const std::size_t a = addr + i;
+                // 内蔵 RAM とそのミラーは GetMem() を経由せずに読む
+                out[i] = domain == FCEUX_MEMORY_CPU && a < 0x2000 ? RAM[a & 0x7FF] : domain_read(domain, static_cast<std::uint32_t>(a));
+            }
+        }
+
+        return size;
+    });
+}
+
+LIBFCEUX size_t fceux_mem_write_range(struct FceuxContext* ctx, enum FceuxMemoryDomain domain, size_t addr, const void* buf, size_t size) {
+    return on_core(ctx, [&]() -> size_t {
+        if(!activate(ctx)) return 0;
+
+        const std::size_t total = domain_size(domain);
+        if(!domain_writable(domain) || addr >= total) return 0;
+        size = std::min(size, total - addr);
+
+        // CPU による書き込みではないので、差分保存で比較を省けなくなる
+        ctx->clean_base.reset();
+
+        const auto in = static_cast<const std::uint8_t*>(buf);
+        if(ctx->midframe) {
+            const std::uint64_t pos = cpu_pos();
+            for(std::size_t i = 0; i < size; ++i)
+                ctx->frame.writes.push_back({ pos, static_cast<std::uint32_t>(addr + i), in[i], domain });
+        }
+
+        if(std::uint8_t* p = domain_array(domain)) {
+            std::memcpy(p + addr, in, size);
+        }
+        else {
+            for(std::size_t i = 0; i < size; ++i)
+                domain_write(domain, static_cast<std::uint32_t>(addr + i), in[i]);
+        }
+
+        return size;
+    });
+}
+
+LIBFCEUX const std::uint8_t* fceux_mem_domain_view(struct FceuxContext* ctx, enum FceuxMemoryDomain domain, size_t* size) {
+    return on_core(ctx, [&]() -> const std::uint8_t* {
+        if(!activate(ctx)) {
+            if(size) *size = 0;
+            return nullptr;
+        }
+
+        const std::uint8_t* p = domain_array(domain);
+        if(size) *size = p ? domain_size(domain) : 0;
+        return p;
+    });
+}
+
+LIBFCEUX struct Snapshot* fceux_snapshot_create() {
+    return new Snapshot;
+}
+
+LIBFCEUX void fceux_snapshot_destroy(struct Snapshot* snap) {
+    if(!snap) return;
+
+    const SnapshotRef ref = split_handle(snap);
+    if(ref.snap->pool)
+        ref.snap->pool->release(ref.snap, ref.generation);
+    else
+        delete ref.snap;
+}
+
+LIBFCEUX struct SnapshotPool* fceux_snapshot_pool_create(struct FceuxContext* ctx, std::uint32_t flags, size_t slab_size) {
+    // 0 なら失敗
+    const std::uint32_t state_size = on_core(ctx, [&]() -> std::uint32_t {
+        if(!activate(ctx)) return 0;
+
+        const bool backbuf = !(flags & FCEUX_SNAPSHOT_SKIP_VIDEO);
+        if(flags & FCEUX_SNAPSHOT_FLAT)
+            return FCEUSS_FlatSize(backbuf);
+
+        // FCSX 形式のサイズは実際に保存してみないと分からない
+        EMUFILE_MEMORY file;
+        if(!save_state(file, backbuf)) return 0;
+        return static_cast<std::uint32_t>(file.size());
+    });
+    if(state_size == 0) return nullptr;
+
+    auto pool = new SnapshotPool(flags, state_size, slab_size == 0 ? 64 : slab_size);
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->add_slab();
+    return pool;
+}
+
+LIBFCEUX void fceux_snapshot_pool_destroy(struct SnapshotPool* pool) {
+    delete pool;
+}
+
+LIBFCEUX struct Snapshot* fceux_snapshot_pool_alloc(struct SnapshotPool* pool) {
+    return pool->alloc();
+}
+
+LIBFCEUX void fceux_snapshot_pool_release_all(struct SnapshotPool* pool) {
+    pool->release_all();
+}
+
+LIBFCEUX void fceux_snapshot_pool_stats(struct SnapshotPool* pool, struct FceuxSnapshotPoolStats* stats) {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+
+    stats->state_size = pool->state_size;
+    stats->slab_count = pool->slabs.size();
+    stats->capacity = pool->slabs.size() * pool->slab_size;
+    stats->in_use = pool->in_use;
+    stats->peak_in_use = pool->peak_in_use;
+    stats->reserved_bytes = stats->capacity * (sizeof(Snapshot) + pool->state_size);
+}
+
+namespace {
+
+// FCSX 形式の状態をロードする。これは途中まで書き込んでから失敗しうるので、
+// 失敗したら ctx を呼び出し前の状態 (フレーム途中ならその位置) に戻す。
+bool load_fcsx(FceuxContext* ctx, EMUFILE* file) {
+    ctx->clean_base.reset();
+
+    const bool midframe = ctx->midframe;
+    const MidFrame frame = midframe ? ctx->frame : MidFrame {};
+    if(!midframe) flat_scratch.save(true);
+
+    abandon_frame(ctx);
+    if(FCEUSS_LoadFP(file, SSLOADPARAM_NOBACKUP)) return true;
+
+    if(midframe) {
+        const bool ok = ctx->frame_start.load();
+        assert(ok); (void)ok;
+        ctx->frame = frame;
+        replay_frame(ctx);
+    }
+    else {
+        const bool ok = flat_scratch.load();
+        assert(ok); (void)ok;
+    }
+    return false;
+}
+
+// ctx のコアのスレッド上で呼ぶ。
+int load_snapshot(FceuxContext* ctx, Snapshot* snap, bool diff) {
+    if(!activate(ctx)) return 0;
+
+    // フラット形式は検査を通ればロードに失敗しないので、検査してからフレームを捨てる
+    if(snap->store) {
+        flat_scratch.resize(snap->store_size);
+        snap->store->load(snap->store_pages, flat_scratch.data(), snap->store_size);
+        if(!flat_scratch.valid()) return 0;
+        abandon_frame(ctx);
+        diff ? flat_scratch.load_diff() : flat_scratch.load();
+    }
+    else if(snap->flat) {
+        const FlatState& state = flat_image(snap->flat);
+        if(!state.valid()) return 0;
+        abandon_frame(ctx);
+        diff ? state.load_diff() : state.load();
+    }
+    else {
+        // スナップショットは複数のコアから同時にロードされうるので、読み込み位置を共有しない
+        EMUFILE_MEMORY_VIEW file(snap->file.get_vec()->data(), snap->file.size());
+        if(!load_fcsx(ctx, &file)) return 0;
+    }
+
+    if(snap->midframe) {
+        ctx->frame_start.assign(snap->store ? flat_scratch : snap->flat->state);
+        ctx->frame = snap->frame;
+        replay_frame(ctx);
+    }
+
+    if(snap->flat && !snap->midframe)
+        set_clean_base(ctx, snap->flat);
+    else
+        ctx->clean_base.reset();
+    return 1;
+}
+
+} // anonymous namespace
+
+LIBFCEUX int fceux_snapshot_load(struct FceuxContext* ctx, struct Snapshot* snap) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    return on_core(ctx, [&] { return load_snapshot(ctx, snap, false); });
+}
+
+LIBFCEUX int fceux_snapshot_load_diff(struct FceuxContext* ctx, struct Snapshot* snap) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    return on_core(ctx, [&] { return load_snapshot(ctx, snap, true); });
+}
+
+LIBFCEUX int fceux_snapshot_save(struct FceuxContext* ctx, struct Snapshot* snap) {
+    return fceux_snapshot_save_ex(ctx, snap, 0);
+}
+
+LIBFCEUX int fceux_snapshot_save_ex(struct FceuxContext* ctx, struct Snapshot* snap, std::uint32_t flags) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        if(ctx->midframe) {
+            // フレーム先頭の状態は常にバックバッファなしで保存している
+            FlatNode& node = flat_node_for_write(snap);
+            node.parent.reset();
+            node.state.assign(ctx->frame_start);
+            snap->midframe = true;
+            snap->frame = ctx->frame;
+            return 1;
+        }
+
+        snap->midframe = false;
+        snap->frame = MidFrame {};
+
+        const bool backbuf = !(flags & FCEUX_SNAPSHOT_SKIP_VIDEO);
+        if(flags & FCEUX_SNAPSHOT_FLAT) {
+            FlatNode& node = flat_node_for_write(snap);
+            node.parent.reset();
+            node.state.save(backbuf);
+            set_clean_base(ctx, snap->flat);
+            return 1;
+        }
+
+        snap->release_store();
+        snap->flat.reset();
+        return save_state(snap->file, backbuf) ? 1 : 0;
+    });
+}
+
+LIBFCEUX int fceux_snapshot_save_delta(struct FceuxContext* ctx, struct Snapshot* snap, const struct Snapshot* parent, std::uint32_t flags) {
+    if(!(snap = snapshot_of(snap)) || !(parent = snapshot_of(parent))) return 0;
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        if(ctx->midframe || !parent->flat || parent->midframe)
+            return fceux_snapshot_save_ex(ctx, snap, flags | FCEUX_SNAPSHOT_FLAT);
+
+        // snap と parent が同じでも、書き込む前に親を確保しておけば壊れない
+        const std::shared_ptr<const FlatNode> base = parent->flat;
+
+        snap->midframe = false;
+        snap->frame = MidFrame {};
+
+        save_flat_delta(ctx, snap, base, !(flags & FCEUX_SNAPSHOT_SKIP_VIDEO));
+        return 1;
+    });
+}
+
+LIBFCEUX size_t fceux_snapshot_size(struct Snapshot* snap) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    if(snap->store) return snap->store_pages.size() * sizeof(snap->store_pages[0]);
+    if(!snap->flat) return snap->file.size();
+
+    const FlatNode& node = *snap->flat;
+    if(!node.parent) return node.state.size();
+    return node.page_data.size() + node.pages.size() * sizeof(node.pages[0]);
+}
+
+LIBFCEUX size_t fceux_snapshot_serialize(struct Snapshot* snap, void* buf, size_t capacity) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    const bool flat = snap->store || snap->flat;
+    const std::uint32_t state_size = snap->store ? snap->store_size : snap->flat ? snap->flat->image_size() : snap->file.size();
+    const std::size_t write_count = snap->midframe ? snap->frame.writes.size() : 0;
+    const std::size_t total = sizeof(SerialHeader) + state_size + write_count * sizeof(SerialWrite);
+    if(!buf || capacity < total) return total;
+
+    auto out = static_cast<std::uint8_t*>(buf);
+
+    SerialHeader h {};
+    std::memcpy(h.magic, SERIAL_MAGIC, 4);
+    h.version = SERIAL_VERSION;
+    h.kind = flat ? SERIAL_FLAT : SERIAL_FCSX;
+    h.state_size = state_size;
+    h.midframe = snap->midframe;
+    h.joypad_data = snap->frame.joypad_data;
+    h.pos = snap->frame.pos;
+    h.write_count = static_cast<std::uint32_t>(write_count);
+    std::memcpy(out, &h, sizeof(h));
+    out += sizeof(h);
+
+    if(snap->store)
+        snap->store->load(snap->store_pages, out, state_size);
+    else if(snap->flat)
+        std::memcpy(out, flat_image(snap->flat).data(), state_size);
+    else
+        std::memcpy(out, snap->file.buf(), state_size);
+    out += state_size;
+
+    for(std::size_t i = 0; i < write_count; ++i) {
+        const MidFrameWrite& mw = snap->frame.writes[i];
+        SerialWrite w {};
+        w.pos = mw.pos;
+        w.addr = mw.addr;
+        w.value = mw.value;
+        w.domain = static_cast<std::uint8_t>(mw.domain);
+        std::memcpy(out + i * sizeof(w), &w, sizeof(w));
+    }
+
+    return total;
+}
+
+LIBFCEUX int fceux_snapshot_deserialize(struct Snapshot* snap, const void* buf, size_t size) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    SerialView view;
+    if(!parse_serialized(buf, size, view)) return 0;
+
+    if(view.header.kind == SERIAL_FLAT) {
+        FlatNode& node = flat_node_for_write(snap);
+        node.parent.reset();
+        node.state.resize(view.header.state_size);
+        std::memcpy(node.state.data(), view.state, view.header.state_size);
+    }
+    else {
+        snap->release_store();
+        snap->flat.reset();
+        snap->file.fseek(0, SEEK_SET);
+        snap->file.fwrite(view.state, view.header.state_size);
+        snap->file.set_len(view.header.state_size);
+    }
+
+    snap->midframe = view.header.midframe != 0;
+    snap->frame = serial_frame(view);
+    return 1;
+}
+
+LIBFCEUX int fceux_snapshot_load_serialized(struct FceuxContext* ctx, const void* buf, size_t size) {
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        SerialView view;
+        if(!parse_serialized(buf, size, view)) return 0;
+
+        if(view.header.kind == SERIAL_FLAT) {
+            if(!FCEUSS_CheckFlat(view.state, view.header.state_size)) return 0;
+            ctx->clean_base.reset();
+            abandon_frame(ctx);
+            FCEUSS_LoadFlat(view.state, view.header.state_size);
+        }
+        else {
+            EMUFILE_MEMORY_VIEW file(view.state, view.header.state_size);
+            if(!load_fcsx(ctx, &file)) return 0;
+        }
+
+        if(view.header.midframe) {
+            ctx->frame_start.resize(view.header.state_size);
+            std::memcpy(ctx->frame_start.data(), view.state, view.header.state_size);
+            ctx->frame = serial_frame(view);
+            replay_frame(ctx);
+        }
+
+        return 1;
+    });
+}
+
+LIBFCEUX void fceux_state_hash128(struct FceuxContext* ctx, std::uint32_t flags, std::uint64_t* out) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) {
+            out[0] = out[1] = 0;
+            return;
+        }
+
+        int skip = 0;
+        if(flags & FCEUX_STATE_HASH_SKIP_COUNTERS) skip |= FCEUSS_HASH_SKIP_COUNTERS;
+        if(flags & FCEUX_STATE_HASH_SKIP_SOUND) skip |= FCEUSS_HASH_SKIP_SOUND;
+
+        FCEUSS_HashState(out, skip);
+    });
+}
+
+LIBFCEUX std::uint64_t fceux_state_hash(struct FceuxContext* ctx, std::uint32_t flags) {
+    std::uint64_t h[2];
+    fceux_state_hash128(ctx, flags, h);
+    return h[0];
+}
+
+LIBFCEUX struct SnapStore* fceux_snapstore_create(size_t page_size) {
+    if(page_size == 0) page_size = 256;
+    if(page_size % 8 != 0 || page_size > (1 << 16)) return nullptr;
+
+    return new SnapStore { std::make_shared<PageStore>(static_cast<std::uint32_t>(page_size)) };
+}
+
+LIBFCEUX void fceux_snapstore_destroy(struct SnapStore* store) {
+    delete store;
+}
+
+LIBFCEUX int fceux_snapstore_save(struct SnapStore* store, struct FceuxContext* ctx, struct Snapshot* snap, std::uint32_t flags) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        // 新しい参照を取ってから古い参照を解放する (同じ内容で保存し直してもページを作り直さない)
+        std::vector<std::uint32_t> old_pages;
+        old_pages.swap(snap->store_pages);
+        const auto old_store = std::move(snap->store);
+
+        if(ctx->midframe) {
+            // フレーム先頭の状態は常にバックバッファなしで保存している
+            store->pages->store(ctx->frame_start.data(), ctx->frame_start.size(), snap->store_pages);
+            snap->store_size = ctx->frame_start.size();
+            snap->midframe = true;
+            snap->frame = ctx->frame;
+        }
+        else {
+            flat_scratch.save(!(flags & FCEUX_SNAPSHOT_SKIP_VIDEO));
+            store->pages->store(flat_scratch.data(), flat_scratch.size(), snap->store_pages);
+            snap->store_size = flat_scratch.size();
+            snap->midframe = false;
+            snap->frame = MidFrame {};
+        }
+        snap->store = store->pages;
+        snap->flat.reset();
+
+        if(old_store) old_store->release(old_pages);
+        return 1;
+    });
+}
+
+LIBFCEUX void fceux_snapstore_stats(struct SnapStore* store, struct FceuxSnapStoreStats* stats) {
+    const PageStore::Stats st = store->pages->stats();
+
+    stats->page_size = store->pages->page_size();
+    stats->snapshot_count = st.lists;
+    stats->page_count = st.pages;
+    stats->page_ref_count = st.page_refs;
+    stats->page_bytes = st.page_bytes;
+    stats->index_bytes = st.page_refs * sizeof(std::uint32_t);
+}
+
+LIBFCEUX struct RewindBuffer* fceux_rewind_create(size_t budget, std::uint32_t keyframe_interval) {
+    return new RewindBuffer(budget, keyframe_interval);
+}
+
+LIBFCEUX void fceux_rewind_destroy(struct RewindBuffer* rw) {
+    delete rw;
+}
+
+LIBFCEUX int fceux_rewind_push(struct RewindBuffer* rw, struct FceuxContext* ctx) {
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        if(ctx->midframe) return 0;
+
+        // クライアントからは見えないので映像のバックバッファは省く
+        flat_scratch.save(false);
+        rw->push(flat_scratch.data(), flat_scratch.size());
+        return 1;
+    });
+}
+
+LIBFCEUX int fceux_rewind_back(struct RewindBuffer* rw, struct FceuxContext* ctx, size_t k) {
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        const std::vector<std::uint8_t>* state = rw->peek(k);
+        if(!state) return 0;
+        const auto size = static_cast<std::uint32_t>(state->size());
+        if(!FCEUSS_CheckFlat(state->data(), size)) return 0;
+
+        ctx->clean_base.reset();
+        abandon_frame(ctx);
+        FCEUSS_LoadFlat(state->data(), size);
+        rw->rewind(k);
+
+        return 1;
+    });
+}
+
+LIBFCEUX size_t fceux_rewind_count(struct RewindBuffer* rw) {
+    return rw->count();
+}
+
+LIBFCEUX size_t fceux_rewind_bytes(struct RewindBuffer* rw) {
+    return rw->bytes();
+}
+
+LIBFCEUX struct RamSearch* fceux_search_create() {
+    return new RamSearch;
+}
+
+LIBFCEUX void fceux_search_destroy(struct RamSearch* search) {
+    delete search;
+}
+
+LIBFCEUX int fceux_search_add(struct RamSearch* search, struct FceuxContext* ctx) {
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        read_search_row(search->add());
+        return 1;
+    });
+}
+
+LIBFCEUX int fceux_search_add_snapshot(struct RamSearch* search, struct FceuxContext* ctx, struct Snapshot* snap) {
+    if(!(snap = snapshot_of(snap))) return 0;
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        // ctx の状態を退避してから snap をロードし、サンプルを読んだら元に戻す。
+        // 戻した状態は呼び出し前と同じなので、差分保存のための記録も退避したものがそのまま使える
+        CleanRecord clean;
+        save_clean(ctx, clean);
+        const std::uint32_t joypad_data = ctx->joypad_data;
+        Snapshot saved;
+        if(!fceux_snapshot_save_ex(ctx, &saved, FCEUX_SNAPSHOT_FLAT)) return 0;
+
+        const bool loaded = load_snapshot(ctx, snap, true) != 0;
+        if(loaded) {
+            read_search_row(search->add());
+            const bool ok = load_snapshot(ctx, &saved, true) != 0;
+            assert(ok); (void)ok;
+        }
+
+        ctx->joypad_data = joypad_data;
+        restore_clean(ctx, clean);
+        return loaded ? 1 : 0;
+    });
+}
+
+LIBFCEUX size_t fceux_search_sample_count(struct RamSearch* search) {
+    return search->sample_count();
+}
+
+LIBFCEUX const std::uint8_t* fceux_search_sample(struct RamSearch* search, size_t i) {
+    return search->sample(i);
+}
+
+LIBFCEUX void fceux_search_reset(struct RamSearch* search) {
+    search->reset();
+}
+
+LIBFCEUX int fceux_search_filter(struct RamSearch* search, const struct FceuxSearchPredicate* preds, size_t n) {
+    return search->filter(preds, n) ? 1 : 0;
+}
+
+LIBFCEUX int fceux_search_correlate(struct RamSearch* search, const double* labels, double min_abs_r, float* r) {
+    return search->correlate(labels, min_abs_r, r) ? 1 : 0;
+}
+
+LIBFCEUX size_t fceux_search_count(struct RamSearch* search) {
+    return search->count();
+}
+
+LIBFCEUX size_t fceux_search_results(struct RamSearch* search, std::uint16_t* addrs, size_t capacity) {
+    return search->results(addrs, capacity);
+}
+
+LIBFCEUX struct Compressor* fceux_compressor_create(unsigned threads, size_t max_queue, int level, const char* archive_path) {
+    if(level < -1 || level > 9) return nullptr;
+
+    if(threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1U);
+    if(max_queue == 0) max_queue = 2 * threads;
+
+    std::FILE* archive = nullptr;
+    if(archive_path) {
+        archive = std::fopen(archive_path, "ab");
+        if(!archive) return nullptr;
+    }
+
+    return new Compressor { { threads, max_queue, level, archive } };
+}
+
+LIBFCEUX void fceux_compressor_destroy(struct Compressor* comp) {
+    delete comp;
+}
+
+LIBFCEUX struct CompressJob* fceux_compressor_submit(struct Compressor* comp, struct Snapshot* snap) {
+    // 直列化 (コピー) だけはこのスレッドで行う
+    std::vector<std::uint8_t> data(fceux_snapshot_serialize(snap, nullptr, 0));
+    if(data.empty() || fceux_snapshot_serialize(snap, data.data(), data.size()) != data.size()) return nullptr;
+
+    return new CompressJob { comp->pool.submit(std::move(data)), comp };
+}
+
+LIBFCEUX void fceux_compressor_flush(struct Compressor* comp) {
+    comp->pool.flush();
+}
+
+LIBFCEUX int fceux_compress_job_done(struct CompressJob* job) {
+    return job->task->done.load(std::memory_order_acquire) ? 1 : 0;
+}
+
+LIBFCEUX int fceux_compress_job_wait(struct CompressJob* job) {
+    if(!job->task->done.load(std::memory_order_acquire))
+        job->comp->pool.wait(*job->task);
+
+    return job->task->ok ? 1 : 0;
+}
+
+LIBFCEUX size_t fceux_compress_job_result(struct CompressJob* job, void* buf, size_t capacity) {
+    fceux_compress_job_wait(job);
+
+    const std::vector<std::uint8_t>& data = job->task->data;
+    if(!job->task->ok) return 0;
+    if(buf && capacity >= data.size())
+        std::memcpy(buf, data.data(), data.size());
+    return data.size();
+}
+
+LIBFCEUX std::uint64_t fceux_compress_job_archive_offset(struct CompressJob* job) {
+    fceux_compress_job_wait(job);
+
+    return job->task->archive_offset;
+}
+
+LIBFCEUX void fceux_compress_job_release(struct CompressJob* job) {
+    delete job;
+}
+
+LIBFCEUX size_t fceux_compressed_size(const void* buf, size_t size) {
+    return compress_record_size(buf, size);
+}
+
+LIBFCEUX int fceux_snapshot_decompress(struct Snapshot* snap, const void* buf, size_t size) {
+    std::vector<std::uint8_t> data;
+    if(!decompress_record(buf, size, data)) return 0;
+
+    return fceux_snapshot_deserialize(snap, data.data(), data.size());
+}
+
+LIBFCEUX void fceux_hook_before_exec(struct FceuxContext* ctx, FceuxHookBeforeExec hook, void* userdata) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        ctx->hook = hook;
+        ctx->hook_userdata = userdata;
+
+        hook_before_exec = hook;
+        hook_before_exec_userdata = userdata;
+    });
+}
+
+LIBFCEUX void fceux_idle_skip(struct FceuxContext* ctx, int enable) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        ctx->idle_skip = enable != 0;
+        X6502_IdleSkip = ctx->idle_skip;
+    });
+}
+
+LIBFCEUX void fceux_prg_direct(struct FceuxContext* ctx, int enable) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        ctx->prg_direct = enable != 0;
+        FCEU_SetPRGDirect(ctx->prg_direct);
+    });
+}
+
+LIBFCEUX std::uint64_t fceux_idle_skipped_cycles(struct FceuxContext* ctx) {
+    return on_core(ctx, [&]() -> std::uint64_t {
+        if(!activate(ctx)) return ctx->idle_skipped_cycles;
+
+        return X6502_IdleCyclesSkipped;
+    });
+}
+
+LIBFCEUX void fceux_write_track(struct FceuxContext* ctx, int enable) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        if(enable && !ctx->write_track)
+            std::memset(ctx->write_tracker.bits, 0, sizeof(ctx->write_tracker.bits));
+        if((enable != 0) != ctx->write_track)
+            ctx->clean_base.reset();
+        ctx->write_track = enable != 0;
+        X6502_WriteTrack = ctx->write_track ? &ctx->write_tracker : nullptr;
+    });
+}
+
+LIBFCEUX const std::uint8_t* fceux_write_bits(struct FceuxContext* ctx) {
+    return on_core(ctx, [&]() -> const std::uint8_t* {
+        if(!activate(ctx)) return nullptr;
+
+        return ctx->write_track ? ctx->write_tracker.bits : nullptr;
+    });
+}
+
+LIBFCEUX void fceux_write_log_attach(struct FceuxContext* ctx, struct FceuxRamWrite* buf, size_t capacity) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) return;
+
+        capacity = std::min<std::size_t>(capacity, std::numeric_limits<std::uint32_t>::max());
+        X6502_WriteTracker& t = ctx->write_tracker;
+        t.log = buf && capacity ? reinterpret_cast<X6502_WriteLogEntry*>(buf) : nullptr;
+        t.log_capacity = t.log ? static_cast<std::uint32_t>(capacity) : 0;
+        t.log_head = 0;
+        t.log_count = 0;
+    });
+}
+
+LIBFCEUX std::uint64_t fceux_write_log_count(struct FceuxContext* ctx) {
+    return on_core(ctx, [&]() -> std::uint64_t {
+        if(!activate(ctx)) return ctx->write_tracker.log_count;
+
+        return ctx->write_tracker.log_count;
+    });
+}
+
+LIBFCEUX void fceux_video_get_palette(struct FceuxContext* ctx, std::uint8_t idx, std::uint8_t* r, std::uint8_t* g, std::uint8_t* b) {
+    on_core(ctx, [&] {
+        if(!activate(ctx)) {
+            *r = *g = *b = 0;
+            return;
+        }
+
+        FCEUD_GetPalette(idx, r, g, b);
+    });
+}
+
+LIBFCEUX int fceux_sound_set_freq(struct FceuxContext* ctx, int freq) {
+    using std::begin;
+    using std::end;
+
+    constexpr int FREQS_VALID[] { 0, 44100, 48000, 96000 };
+    if(std::find(begin(FREQS_VALID), end(FREQS_VALID), freq) == end(FREQS_VALID))
+        return 0;
+
+    return on_core(ctx, [&]() -> int {
+        if(!activate(ctx)) return 0;
+
+        rewind_frame(ctx);
+
+        ctx->sound_freq = freq;
+        bind(ctx);
+
+        return 1;
+    });
 }
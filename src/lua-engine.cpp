@@ -36,7 +36,7 @@
 #include "utils/crc32.h"
 #include "fceulua.h"
 
-extern char FileBase[];
+extern FCEU_TLS char FileBase[];
 
 #ifdef WIN32
 #include "drivers/win/common.h"
@@ -148,8 +148,8 @@ extern "C"
 extern void AddRecentLuaFile(const char *filename);
 #endif
 
-extern bool turbo;
-extern int32 fps_scale;
+extern FCEU_TLS bool turbo;
+extern FCEU_TLS int32 fps_scale;
 
 struct LuaSaveState {
 	std::string filename;
@@ -182,10 +182,10 @@ struct LuaSaveState {
 	}
 };
 
-static void(*info_print)(intptr_t uid, const char* str);
-static void(*info_onstart)(intptr_t uid);
-static void(*info_onstop)(intptr_t uid);
-static intptr_t info_uid;
+static FCEU_TLS void(*info_print)(intptr_t uid, const char* str);
+static FCEU_TLS void(*info_onstart)(intptr_t uid);
+static FCEU_TLS void(*info_onstop)(intptr_t uid);
+static FCEU_TLS intptr_t info_uid;
 #ifdef WIN32
 extern HWND LuaConsoleHWnd;
 extern INT_PTR CALLBACK DlgLuaScriptDialog(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -205,64 +205,64 @@ extern void PrintToWindowConsole(intptr_t hDlgAsInt, const char* str);
 extern void WinLuaOnStart(intptr_t hDlgAsInt);
 extern void WinLuaOnStop(intptr_t hDlgAsInt);
 
-static lua_State *L;
+static FCEU_TLS lua_State *L;
 
-static int luaexiterrorcount = 8;
+static FCEU_TLS int luaexiterrorcount = 8;
 
 // Are we running any code right now?
-static char *luaScriptName = NULL;
+static FCEU_TLS char *luaScriptName = NULL;
 
 // Are we running any code right now?
-int luaRunning = FALSE;
+FCEU_TLS int luaRunning = FALSE;
 
 // True at the frame boundary, false otherwise.
-static int frameBoundary = FALSE;
+static FCEU_TLS int frameBoundary = FALSE;
 
 // The execution speed we're running at.
-static enum {SPEED_NORMAL, SPEED_NOTHROTTLE, SPEED_TURBO, SPEED_MAXIMUM} speedmode = SPEED_NORMAL;
+static FCEU_TLS enum {SPEED_NORMAL, SPEED_NOTHROTTLE, SPEED_TURBO, SPEED_MAXIMUM} speedmode = SPEED_NORMAL;
 
 // Rerecord count skip mode
-static int skipRerecords = FALSE;
+static FCEU_TLS int skipRerecords = FALSE;
 
 // Used by the registry to find our functions
-static const char *frameAdvanceThread = "FCEU.FrameAdvance";
-static const char *guiCallbackTable = "FCEU.GUI";
+static FCEU_TLS const char *frameAdvanceThread = "FCEU.FrameAdvance";
+static FCEU_TLS const char *guiCallbackTable = "FCEU.GUI";
 
 // True if there's a thread waiting to run after a run of frame-advance.
-static int frameAdvanceWaiting = FALSE;
+static FCEU_TLS int frameAdvanceWaiting = FALSE;
 
 // We save our pause status in the case of a natural death.
-static int wasPaused = FALSE;
+static FCEU_TLS int wasPaused = FALSE;
 
 // Transparency strength. 255=opaque, 0=so transparent it's invisible
-static int transparencyModifier = 255;
+static FCEU_TLS int transparencyModifier = 255;
 
 // Our zapper.
-static int luazapperx = -1;
-static int luazappery = -1;
-static int luazapperfire = -1;
+static FCEU_TLS int luazapperx = -1;
+static FCEU_TLS int luazappery = -1;
+static FCEU_TLS int luazapperfire = -1;
 
 // Our joypads.
-static uint8 luajoypads1[4]= { 0xFF, 0xFF, 0xFF, 0xFF }; //x1
-static uint8 luajoypads2[4]= { 0x00, 0x00, 0x00, 0x00 }; //0x
+static FCEU_TLS uint8 luajoypads1[4]= { 0xFF, 0xFF, 0xFF, 0xFF }; //x1
+static FCEU_TLS uint8 luajoypads2[4]= { 0x00, 0x00, 0x00, 0x00 }; //0x
 /* Crazy logic stuff.
 	11 - true		01 - pass-through (default)
 	00 - false		10 - invert					*/
 
-static enum { GUI_USED_SINCE_LAST_DISPLAY, GUI_USED_SINCE_LAST_FRAME, GUI_CLEAR } gui_used = GUI_CLEAR;
-static uint8 *gui_data = NULL;
-static int gui_saw_current_palette = FALSE;
+static FCEU_TLS enum { GUI_USED_SINCE_LAST_DISPLAY, GUI_USED_SINCE_LAST_FRAME, GUI_CLEAR } gui_used = GUI_CLEAR;
+static FCEU_TLS uint8 *gui_data = NULL;
+static FCEU_TLS int gui_saw_current_palette = FALSE;
 
 // Protects Lua calls from going nuts.
 // We set this to a big number like 1000 and decrement it
 // over time. The script gets knifed once this reaches zero.
-static int numTries;
+static FCEU_TLS int numTries;
 
 // number of registered memory functions (1 per hooked byte)
-static unsigned int numMemHooks;
+static FCEU_TLS unsigned int numMemHooks;
 
 // Look in fceu.h for macros named like JOY_UP to determine the order.
-static const char *button_mappings[] = {
+static FCEU_TLS const char *button_mappings[] = {
 	"A", "B", "select", "start", "up", "down", "left", "right"
 };
 
@@ -274,7 +274,7 @@ static const char *button_mappings[] = {
 	#define strnicmp strncasecmp
 #endif
 
-static const char* luaCallIDStrings [] =
+static FCEU_TLS const char* luaCallIDStrings [] =
 {
 	"CALL_BEFOREEMULATION",
 	"CALL_AFTEREMULATION",
@@ -289,7 +289,7 @@ static const char* luaCallIDStrings [] =
 //make sure we have the right number of strings
 CTASSERT(sizeof(luaCallIDStrings)/sizeof(*luaCallIDStrings) == LUACALL_COUNT)
 
-static const char* luaMemHookTypeStrings [] =
+static FCEU_TLS const char* luaMemHookTypeStrings [] =
 {
 	"MEMHOOK_WRITE",
 	"MEMHOOK_READ",
@@ -837,8 +837,8 @@ static void PushNils(std::vector<unsigned char>& output, int& nilcount)
 	}
 }
 
-static std::vector<const void*> s_tableAddressStack; // prevents infinite recursion of a table within a table (when cycle is found, print something like table:parent)
-static std::vector<const void*> s_metacallStack; // prevents infinite recursion if something's __tostring returns another table that contains that something (when cycle is found, print the inner result without using __tostring)
+static FCEU_TLS std::vector<const void*> s_tableAddressStack; // prevents infinite recursion of a table within a table (when cycle is found, print something like table:parent)
+static FCEU_TLS std::vector<const void*> s_metacallStack; // prevents infinite recursion if something's __tostring returns another table that contains that something (when cycle is found, print the inner result without using __tostring)
 
 static void LuaStackToBinaryConverter(lua_State* L, int i, std::vector<unsigned char>& output)
 {
@@ -1737,7 +1737,7 @@ defcase:default: APPENDPRINT "%s:%p",luaL_typename(L,i),lua_topointer(L,i) END b
 }
 
 static const int s_tempStrMaxLen = 64 * 1024;
-static char s_tempStr [s_tempStrMaxLen];
+static FCEU_TLS char s_tempStr [s_tempStrMaxLen];
 
 static char* rawToCString(lua_State* L, int idx)
 {
@@ -1924,7 +1924,7 @@ struct registerPointerMap
 
 #define RPM_ENTRY(name,var) {name, (unsigned int*)&var, sizeof(var)},
 
-registerPointerMap regPointerMap [] = {
+FCEU_TLS registerPointerMap regPointerMap [] = {
 	RPM_ENTRY("pc", _PC)
 	RPM_ENTRY("a", _A)
 	RPM_ENTRY("x", _X)
@@ -1934,7 +1934,7 @@ registerPointerMap regPointerMap [] = {
 	{}
 };
 
-struct cpuToRegisterMap
+FCEU_TLS struct cpuToRegisterMap
 {
 	const char* cpuName;
 	registerPointerMap* rpmap;
@@ -2146,7 +2146,7 @@ struct TieredRegion
 			   narrow.Contains(address,size);
 	}
 };
-TieredRegion hookedRegions [LUAMEMHOOK_COUNT];
+FCEU_TLS TieredRegion hookedRegions [LUAMEMHOOK_COUNT];
 
 
 static void CalculateMemHookRegions(LuaMemHookType hookType)
@@ -2248,6 +2248,11 @@ void CallRegisteredLuaMemHook(unsigned int address, int size, unsigned int value
 			CallRegisteredLuaMemHook_LuaMatch(address, size, value, hookType); // something has hooked this specific address
 	}
 }
+// lets the cpu core leave the hook calls out of its loop entirely while nothing is hooked
+bool AnyRegisteredLuaMemHook(LuaMemHookType hookType)
+{
+	return hookedRegions[hookType].NotEmpty();
+}
 
 void CallRegisteredLuaFunctions(LuaCallID calltype)
 {
@@ -2691,7 +2696,7 @@ static int joy_get_internal(lua_State *L, bool reportUp, bool reportDown) {
 	}
 
 	// Use the OS-specific code to do the reading.
-	extern SFORMAT FCEUCTRL_STATEINFO[];
+	extern FCEU_TLS SFORMAT FCEUCTRL_STATEINFO[];
 	uint8 buttons = ((uint8 *) FCEUCTRL_STATEINFO[1].v)[which - 1];
 
 	lua_newtable(L);
@@ -3571,7 +3576,7 @@ enum
  * ourselves.
  */
 static uint8 gui_colour_rgb(uint8 r, uint8 g, uint8 b) {
-	static uint8 index_lookup[1 << (3+3+3)];
+	static FCEU_TLS uint8 index_lookup[1 << (3+3+3)];
 	int k;
 
 	if (!gui_saw_current_palette)
@@ -4313,7 +4318,7 @@ static void LuaDisplayString (const char *string, int y, int x, uint32 color, ui
 }
 
 
-static uint8 FCEUFont[792] =
+static FCEU_TLS uint8 FCEUFont[792] =
 {
 	6,  0,  0,  0,  0,  0,  0,  0,	// 0x20 - Spacebar
 	3, 64, 64, 64, 64, 64,  0, 64,
@@ -4501,7 +4506,7 @@ void LuaDrawTextTransWH(const char *str, size_t l, int &x, int y, uint32 color,
 //  main HUD.
 static int gui_text(lua_State *L) {
 
-	extern int font_height;
+	extern FCEU_TLS int font_height;
 	const char *msg;
 	int x, y;
 	size_t l;
@@ -4709,19 +4714,19 @@ static int gui_register(lua_State *L) {
 // table sound.get()
 static int sound_get(lua_State *L)
 {
-	extern ENVUNIT EnvUnits[3];
+	extern FCEU_TLS ENVUNIT EnvUnits[3];
 	extern int CheckFreq(uint32 cf, uint8 sr);
-	extern int32 curfreq[2];
-	extern uint8 PSG[0x10];
-	extern int32 lengthcount[4];
-	extern uint8 TriCount;
+	extern FCEU_TLS int32 curfreq[2];
+	extern FCEU_TLS uint8 PSG[0x10];
+	extern FCEU_TLS int32 lengthcount[4];
+	extern FCEU_TLS uint8 TriCount;
 	extern const uint32 NoiseFreqTableNTSC[0x10];
 	extern const uint32 NoiseFreqTablePAL[0x10];
-	extern int32 DMCPeriod;
-	extern uint8 DMCAddressLatch, DMCSizeLatch;
-	extern uint8 DMCFormat;
-	extern char DMCHaveSample;
-	extern uint8 InitialRawDALatch;
+	extern FCEU_TLS int32 DMCPeriod;
+	extern FCEU_TLS uint8 DMCAddressLatch, DMCSizeLatch;
+	extern FCEU_TLS uint8 DMCFormat;
+	extern FCEU_TLS char DMCHaveSample;
+	extern FCEU_TLS uint8 InitialRawDALatch;
 
 	int freqReg;
 	double freq;
@@ -35,8 +35,8 @@ extern void AddRecentMovieFile(const char *filename);
 extern bool mustEngageTaseditor;
 #endif
 
-extern int RAMInitOption;
-extern int RAMInitSeed;
+extern FCEU_TLS int RAMInitOption;
+extern FCEU_TLS int RAMInitSeed;
 
 #include <cstdio>
 #include <cstdlib>
@@ -52,18 +52,18 @@ using namespace std;
 
 #define MOVIE_VERSION           3
 
-extern char FileBase[];
-extern bool AutoSS;		//Declared in fceu.cpp, keeps track if a auto-savestate has been made
+extern FCEU_TLS char FileBase[];
+extern FCEU_TLS bool AutoSS;		//Declared in fceu.cpp, keeps track if a auto-savestate has been made
 
-std::vector<int> subtitleFrames;		//Frame numbers for subtitle messages
-std::vector<string> subtitleMessages;	//Messages of subtitles
+FCEU_TLS std::vector<int> subtitleFrames;		//Frame numbers for subtitle messages
+FCEU_TLS std::vector<string> subtitleMessages;	//Messages of subtitles
 
-bool subtitlesOnAVI = false;
-bool autoMovieBackup = false; //Toggle that determines if movies should be backed up automatically before altering them
-bool freshMovie = false;	  //True when a movie loads, false when movie is altered.  Used to determine if a movie has been altered since opening
-bool movieFromPoweron = true;
+FCEU_TLS bool subtitlesOnAVI = false;
+FCEU_TLS bool autoMovieBackup = false; //Toggle that determines if movies should be backed up automatically before altering them
+FCEU_TLS bool freshMovie = false;	  //True when a movie loads, false when movie is altered.  Used to determine if a movie has been altered since opening
+FCEU_TLS bool movieFromPoweron = true;
 
-static int _currCommand = 0;
+static FCEU_TLS int _currCommand = 0;
 
 // Function declarations------------------------
 
@@ -81,36 +81,36 @@ static int _currCommand = 0;
 //that would be faster than several reads, perhaps.
 
 //sometimes we accidentally produce movie stop signals while we're trying to do other things with movies..
-bool suppressMovieStop=false;
+FCEU_TLS bool suppressMovieStop=false;
 
 //----movie engine main state
-EMOVIEMODE movieMode = MOVIEMODE_INACTIVE;
+FCEU_TLS EMOVIEMODE movieMode = MOVIEMODE_INACTIVE;
 
 //this should not be set unless we are in MOVIEMODE_RECORD!
 //FILE* fpRecordingMovie = 0;
-EMUFILE* osRecordingMovie = NULL;
-
-int currFrameCounter;
-uint32 cur_input_display = 0;
-int pauseframe = -1;
-bool movie_readonly = true;
-int input_display = 0;
-int frame_display = 0;
-int rerecord_display = 0;
-bool fullSaveStateLoads = false;	//Option for loading a savestates full contents in read+write mode instead of up to the frame count in the savestate (useful as a recovery option)
-int movieRecordMode = 0;			//Option for various movie recording modes such as TRUNCATE (normal), OVERWRITE etc.
-
-SFORMAT FCEUMOV_STATEINFO[]={
+FCEU_TLS EMUFILE* osRecordingMovie = NULL;
+
+FCEU_TLS int currFrameCounter;
+FCEU_TLS uint32 cur_input_display = 0;
+FCEU_TLS int pauseframe = -1;
+FCEU_TLS bool movie_readonly = true;
+FCEU_TLS int input_display = 0;
+FCEU_TLS int frame_display = 0;
+FCEU_TLS int rerecord_display = 0;
+FCEU_TLS bool fullSaveStateLoads = false;	//Option for loading a savestates full contents in read+write mode instead of up to the frame count in the savestate (useful as a recovery option)
+FCEU_TLS int movieRecordMode = 0;			//Option for various movie recording modes such as TRUNCATE (normal), OVERWRITE etc.
+
+FCEU_TLS SFORMAT FCEUMOV_STATEINFO[]={
 	{ &currFrameCounter, 4|FCEUSTATE_RLSB, "FCNT"},
 	{ 0 }
 };
 
-char curMovieFilename[512] = {0};
-MovieData currMovieData;
-MovieData defaultMovieData;
-int currRerecordCount; // Keep the global value
+FCEU_TLS char curMovieFilename[512] = {0};
+FCEU_TLS MovieData currMovieData;
+FCEU_TLS MovieData defaultMovieData;
+FCEU_TLS int currRerecordCount; // Keep the global value
 
-char lagcounterbuf[32] = {0};
+FCEU_TLS char lagcounterbuf[32] = {0};
 
 void MovieData::clearRecordRange(int start, int len)
 {
@@ -838,7 +838,7 @@ static void FinishPlayback()
 {
 	assert(movieMode != MOVIEMODE_RECORD);
 
-	extern int closeFinishedMovie;
+	extern FCEU_TLS int closeFinishedMovie;
 	if (closeFinishedMovie)
 		StopPlayback();
 	else
@@ -871,7 +871,7 @@ static void OnMovieClosed()
 #endif
 }
 
-bool bogorf;
+FCEU_TLS bool bogorf;
 
 void FCEUI_StopMovie()
 {
@@ -909,7 +909,7 @@ void poweron(bool shouldDisableBatteryLoading)
 	//if(shouldDisableBatteryLoading) disableBatteryLoading=0;
 	//suppressAddPowerCommand=0;
 
-	extern int disableBatteryLoading;
+	extern FCEU_TLS int disableBatteryLoading;
 	if(!bogorf) disableBatteryLoading = 1;
 	PowerNES();
 	if(!bogorf) disableBatteryLoading = 0;
@@ -1291,7 +1291,7 @@ void FCEUMOV_AddInputState()
 
 	currFrameCounter++;
 
-	extern uint8 joy[4];
+	extern FCEU_TLS uint8 joy[4];
 	memcpy(&cur_input_display,joy,4);
 }
 
@@ -1400,7 +1400,7 @@ int CheckTimelines(MovieData& stateMovie, MovieData& currMovie)
 }
 
 
-static bool load_successful;
+static FCEU_TLS bool load_successful;
 
 bool FCEUMOV_ReadState(EMUFILE* is, uint32 size)
 {
@@ -1432,7 +1432,7 @@ bool FCEUMOV_ReadState(EMUFILE* is, uint32 size)
 	std::ios::pos_type curr = is->ftell();
 	if(!LoadFM2(tempMovieData, is, size, false)) {
 		is->fseek((uint32)curr+size,SEEK_SET);
-		extern bool FCEU_state_loading_old_format;
+		extern FCEU_TLS bool FCEU_state_loading_old_format;
 		if(FCEU_state_loading_old_format) {
 			if(movieMode == MOVIEMODE_PLAY || movieMode == MOVIEMODE_RECORD || movieMode == MOVIEMODE_FINISHED) {
 				//FCEUI_StopMovie();  //No reason to stop the movie, nothing destructive has happened yet.
@@ -1744,7 +1744,7 @@ void FCEUI_MovieToggleRecording()
 		RedumpWholeMovieFile(true);
 		if (currFrameCounter >= (int)currMovieData.records.size())
 		{
-			extern int closeFinishedMovie;
+			extern FCEU_TLS int closeFinishedMovie;
 			if (closeFinishedMovie)
 			{
 				movieMode = MOVIEMODE_INACTIVE;
@@ -1807,7 +1807,7 @@ void FCEUI_MovieDeleteFrame()
 
 		if (movieMode != MOVIEMODE_RECORD && currFrameCounter >= (int)currMovieData.records.size())
 		{
-			extern int closeFinishedMovie;
+			extern FCEU_TLS int closeFinishedMovie;
 			if (closeFinishedMovie)
 			{
 				movieMode = MOVIEMODE_INACTIVE;
@@ -1844,7 +1844,7 @@ void FCEUI_MovieTruncate()
 
 		if (movieMode != MOVIEMODE_RECORD)
 		{
-			extern int closeFinishedMovie;
+			extern FCEU_TLS int closeFinishedMovie;
 			if (closeFinishedMovie)
 			{
 				movieMode = MOVIEMODE_INACTIVE;
@@ -1965,7 +1965,7 @@ void LoadSubtitles(MovieData &moviedata)
 {
 	subtitleFrames.resize(0);
 	subtitleMessages.resize(0);
-	extern std::vector<string> subtitles;
+	extern FCEU_TLS std::vector<string> subtitles;
 	for(uint32 i=0; i < moviedata.subtitles.size() ; i++)
 	{
 		std::string& subtitle = moviedata.subtitles[i];
@@ -269,15 +269,15 @@ private:
 	}
 };
 
-extern MovieData currMovieData;
-extern int currFrameCounter;
-extern char curMovieFilename[512];
-extern bool subtitlesOnAVI;
-extern bool freshMovie;
-extern bool movie_readonly;
-extern bool autoMovieBackup;
-extern bool fullSaveStateLoads;
-extern int movieRecordMode;
+extern FCEU_TLS MovieData currMovieData;
+extern FCEU_TLS int currFrameCounter;
+extern FCEU_TLS char curMovieFilename[512];
+extern FCEU_TLS bool subtitlesOnAVI;
+extern FCEU_TLS bool freshMovie;
+extern FCEU_TLS bool movie_readonly;
+extern FCEU_TLS bool autoMovieBackup;
+extern FCEU_TLS bool fullSaveStateLoads;
+extern FCEU_TLS int movieRecordMode;
 
 //--------------------------------------------------
 void FCEUI_MakeBackupMovie(bool dispMessage);
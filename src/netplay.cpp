@@ -39,12 +39,12 @@
 
 #include <zlib.h>
 
-int FCEUnetplay=0;
+FCEU_TLS int FCEUnetplay=0;
 
-static uint8 netjoy[4]; // Controller cache.
-static int numlocal;
-static int netdivisor;
-static int netdcount;
+static FCEU_TLS uint8 netjoy[4]; // Controller cache.
+static FCEU_TLS int numlocal;
+static FCEU_TLS int netdivisor;
+static FCEU_TLS int netdcount;
 
 //NetError should only be called after a FCEUD_*Data function returned 0, in the function
 //that called FCEUD_*Data, to prevent it from being called twice.
@@ -197,8 +197,8 @@ static FILE *FetchFile(uint32 remlen)
 
 void NetplayUpdate(uint8 *joyp)
 {
-	static uint8 buf[5];  /* 4 play states, + command/extra byte */
-	static uint8 joypb[4];
+	static FCEU_TLS uint8 buf[5];  /* 4 play states, + command/extra byte */
+	static FCEU_TLS uint8 joypb[4];
 
 	memcpy(joypb,joyp,4);
 
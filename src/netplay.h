@@ -1,6 +1,6 @@
 int InitNetplay(void);
 void NetplayUpdate(uint8 *joyp);
-extern int FCEUnetplay;
+extern FCEU_TLS int FCEUnetplay;
 
 
 #define FCEUNPCMD_RESET   0x01
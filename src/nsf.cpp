@@ -50,13 +50,13 @@
 
 static const int FIXED_EXWRAM_SIZE = 32768+8192;
 
-static uint8 SongReload;
-static int32 CurrentSong;
+static FCEU_TLS uint8 SongReload;
+static FCEU_TLS int32 CurrentSong;
 
 static DECLFW(NSF_write);
 static DECLFR(NSF_read);
 
-static int vismode=1; //we cant consider this state, because the UI may be controlling it and wouldnt know we loadstated it
+static FCEU_TLS int vismode=1; //we cant consider this state, because the UI may be controlling it and wouldnt know we loadstated it
 
 //mbg 7/31/06 todo - no reason this couldnt be assembled on the fly from actual asm source code. thatd be less obscure.
 //here it is disassembled, for reference
@@ -79,7 +79,7 @@ static int vismode=1; //we cant consider this state, because the UI may be contr
 00:8023:18        CLC
 00:8024:90 FE     BCC $8024
 */
-static uint8 NSFROM[0x30+6]=
+static FCEU_TLS uint8 NSFROM[0x30+6]=
 {
 	/* 0x00 - NMI */
 	0x8D,0xF4,0x3F,       /* Stop play routine NMIs. */
@@ -110,25 +110,25 @@ static DECLFR(NSFROMRead)
 	return (NSFROM-0x3800)[A];
 }
 
-static uint8 doreset=0; //state
-static uint8 NSFNMIFlags; //state
-uint8 *NSFDATA=0; //configration, loaded from rom?
-int NSFMaxBank; //configuration
+static FCEU_TLS uint8 doreset=0; //state
+static FCEU_TLS uint8 NSFNMIFlags; //state
+FCEU_TLS uint8 *NSFDATA=0; //configration, loaded from rom?
+FCEU_TLS int NSFMaxBank; //configuration
 
-static int32 NSFSize; //configuration
-static uint8 BSon; //configuration
-static uint8 BankCounter; //configuration
+static FCEU_TLS int32 NSFSize; //configuration
+static FCEU_TLS uint8 BSon; //configuration
+static FCEU_TLS uint8 BankCounter; //configuration
 
-static uint16 PlayAddr; //configuration
-static uint16 InitAddr; //configuration
-static uint16 LoadAddr; //configuration
+static FCEU_TLS uint16 PlayAddr; //configuration
+static FCEU_TLS uint16 InitAddr; //configuration
+static FCEU_TLS uint16 LoadAddr; //configuration
 
-extern char LoadedRomFName[2048];
+extern FCEU_TLS char LoadedRomFName[2048];
 
-NSF_HEADER NSFHeader; //mbg merge 6/29/06 - needs to be global
+FCEU_TLS NSF_HEADER NSFHeader; //mbg merge 6/29/06 - needs to be global
 
 void NSFMMC5_Close(void);
-static uint8 *ExWRAM=0;
+static FCEU_TLS uint8 *ExWRAM=0;
 
 void NSFGI(GI h)
 {
@@ -262,7 +262,7 @@ int NSFLoad(const char *name, FCEUFILE *fp)
 	FCEU_printf(" Name:       %s\n Artist:     %s\n Copyright:  %s\n\n",NSFHeader.SongName,NSFHeader.Artist,NSFHeader.Copyright);
 	if(NSFHeader.SoundChip)
 	{
-		static const char *tab[6]={"Konami VRCVI","Konami VRCVII","Nintendo FDS","Nintendo MMC5","Namco 106","Sunsoft FME-07"};
+		static FCEU_TLS const char *tab[6]={"Konami VRCVI","Konami VRCVII","Nintendo FDS","Nintendo MMC5","Namco 106","Sunsoft FME-07"};
 
 		for(x=0;x<6;x++)
 			if(NSFHeader.SoundChip&(1<<x))
@@ -312,7 +312,7 @@ void NSFN106_Init(void);
 void NSFAY_Init(void);
 
 //zero 17-apr-2013 - added
-static SFORMAT StateRegs[] = {
+static FCEU_TLS SFORMAT StateRegs[] = {
 	{&SongReload, 1, "SREL"},
 	{&CurrentSong, 4 | FCEUSTATE_RLSB, "CURS"},
 	{&doreset, 1, "DORE"},
@@ -472,7 +472,7 @@ static DECLFR(NSF_read)
 
 uint8 FCEU_GetJoyJoy(void);
 
-static int special=0;
+static FCEU_TLS int special=0;
 
 void DrawNSF(uint8 *XBuf)
 {
@@ -523,7 +523,7 @@ void DrawNSF(uint8 *XBuf)
 		}
 		else if(special==2)
 		{
-			static double theta=0;
+			static FCEU_TLS double theta=0;
 			if(FSettings.SoundVolume)
 				mul=8192*240/(16384*FSettings.SoundVolume/50);
 			for(x=0;x<128;x++)
@@ -578,7 +578,7 @@ void DrawNSF(uint8 *XBuf)
 	DrawTextTrans(XBuf+82*256+4+(((31-strlen(snbuf))<<2)), 256, (uint8*)snbuf, kFgColor);
 
 	{
-		static uint8 last=0;
+		static FCEU_TLS uint8 last=0;
 		uint8 tmp;
 		tmp=FCEU_GetJoyJoy();
 		if((tmp&JOY_RIGHT) && !(last&JOY_RIGHT))
@@ -45,9 +45,9 @@ typedef struct {
         } NSF_HEADER;
 void NSF_init(void);
 void DrawNSF(uint8 *XBuf);
-extern NSF_HEADER NSFHeader; //mbg merge 6/29/06
-extern uint8 *NSFDATA;
-extern int NSFMaxBank;
+extern FCEU_TLS NSF_HEADER NSFHeader; //mbg merge 6/29/06
+extern FCEU_TLS uint8 *NSFDATA;
+extern FCEU_TLS int NSFMaxBank;
 void NSFDealloc(void);
 void NSFDodo(void);
 void DoNSFFrame(void);
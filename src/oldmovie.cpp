@@ -44,18 +44,18 @@ using namespace std;
 //};
 //-------
 
-static uint8 joop[4];
-static uint8 joopcmd;
-static uint32 framets = 0;
-static uint32 frameptr = 0;
-static uint8* moviedata = NULL;
-static uint32 moviedatasize = 0;
-static uint32 firstframeoffset = 0;
-static uint32 savestate_offset = 0;
+static FCEU_TLS uint8 joop[4];
+static FCEU_TLS uint8 joopcmd;
+static FCEU_TLS uint32 framets = 0;
+static FCEU_TLS uint32 frameptr = 0;
+static FCEU_TLS uint8* moviedata = NULL;
+static FCEU_TLS uint32 moviedatasize = 0;
+static FCEU_TLS uint32 firstframeoffset = 0;
+static FCEU_TLS uint32 savestate_offset = 0;
 
 //Cache variables used for playback.
-static uint32 nextts = 0;
-static int32 nextd = 0;
+static FCEU_TLS uint32 nextts = 0;
+static FCEU_TLS int32 nextd = 0;
 
  // turn old ucs2 metadata into utf8
 void convert_metadata(char* metadata, int metadata_size, uint8* tmp, int metadata_length)
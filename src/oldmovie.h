@@ -14,7 +14,7 @@ enum EFCM_CONVERTRESULT
 
 inline const char * EFCM_CONVERTRESULT_message(EFCM_CONVERTRESULT e)
 {
-	static const char * errmsg[] = {
+	static FCEU_TLS const char * errmsg[] = {
 		"Success",
 		"Failed to open input file",
 		"This is a 'version 1' movie file. These are not supported yet.",
@@ -40,25 +40,25 @@
 #include <cmath>
 #include <cstring>
 
-bool force_grayscale = false;
+FCEU_TLS bool force_grayscale = false;
 
-pal palette_game[64*8]; //custom palette for an individual game. (formerly palettei)
-pal palette_user[64*8]; //user's overridden palette (formerly palettec)
-pal palette_ntsc[64*8]; //mathematically generated NTSC palette (formerly paletten)
+FCEU_TLS pal palette_game[64*8]; //custom palette for an individual game. (formerly palettei)
+FCEU_TLS pal palette_user[64*8]; //user's overridden palette (formerly palettec)
+FCEU_TLS pal palette_ntsc[64*8]; //mathematically generated NTSC palette (formerly paletten)
 
-static bool palette_game_available=false; //whether palette_game is available
-static bool palette_user_available=false; //whether palette_user is available
+static FCEU_TLS bool palette_game_available=false; //whether palette_game is available
+static FCEU_TLS bool palette_user_available=false; //whether palette_user is available
 
 //ntsc parameters:
-bool ntsccol_enable = false; //whether NTSC palette is selected
-static int ntsctint = 46+10;
-static int ntschue = 72;
+FCEU_TLS bool ntsccol_enable = false; //whether NTSC palette is selected
+static FCEU_TLS int ntsctint = 46+10;
+static FCEU_TLS int ntschue = 72;
 
 //the default basic palette
-int default_palette_selection = 0;
+FCEU_TLS int default_palette_selection = 0;
 
 //library of default palettes
-static pal *default_palette[8]=
+static FCEU_TLS pal *default_palette[8]=
 {
 	palette,
 	rp2c04001,
@@ -72,7 +72,7 @@ static void ChoosePalette(void);
 static void WritePalette(void);
 
 //points to the actually selected current palette
-pal *palo = NULL;
+FCEU_TLS pal *palo = NULL;
 
 #define RGB_TO_YIQ( r, g, b, y, i ) (\
 	(y = (r) * 0.299f + (g) * 0.587f + (b) * 0.114f),\
@@ -344,10 +344,10 @@ void FCEUI_SetNTSCTH(bool en, int tint, int hue)
 
 //this prepares the 'deemph' palette which was a horrible idea to jam a single deemph palette into 0xC0-0xFF of the 8bpp palette.
 //its needed for GUI and lua and stuff, so we're leaving it, despite having a newer codepath for applying deemph
-static uint8 lastd=0;
+static FCEU_TLS uint8 lastd=0;
 void SetNESDeemph_OldHacky(uint8 d, int force)
 {
-	static uint16 rtmul[]={
+	static FCEU_TLS uint16 rtmul[]={
         static_cast<uint16>(32768*1.239),
         static_cast<uint16>(32768*.794),
         static_cast<uint16>(32768*1.019),
@@ -356,7 +356,7 @@ void SetNESDeemph_OldHacky(uint8 d, int force)
         static_cast<uint16>(32768*.741),
         static_cast<uint16>(32768*.75)
     };
-	static uint16 gtmul[]={
+	static FCEU_TLS uint16 gtmul[]={
         static_cast<uint16>(32768*.915),
         static_cast<uint16>(32768*1.086),
         static_cast<uint16>(32768*.98),
@@ -365,7 +365,7 @@ void SetNESDeemph_OldHacky(uint8 d, int force)
         static_cast<uint16>(32768*.987),
         static_cast<uint16>(32768*.75)
     };
-	static uint16 btmul[]={
+	static FCEU_TLS uint16 btmul[]={
         static_cast<uint16>(32768*.743),
         static_cast<uint16>(32768*.882),
         static_cast<uint16>(32768*.653),
@@ -450,10 +450,10 @@ static void CalculatePalette(void)
 	int x,z;
 	int r,g,b;
 	double s,luma,theta;
-	static uint8 cols[16]={0,24,21,18,15,12,9,6,3,0,33,30,27,0,0,0};
-	static uint8 br1[4]={6,9,12,12};
-	static double br2[4]={.29,.45,.73,.9};
-	static double br3[4]={0,.24,.47,.77};
+	static FCEU_TLS uint8 cols[16]={0,24,21,18,15,12,9,6,3,0,33,30,27,0,0,0};
+	static FCEU_TLS uint8 br1[4]={6,9,12,12};
+	static FCEU_TLS double br2[4]={.29,.45,.73,.9};
+	static FCEU_TLS double br3[4]={0,.24,.47,.77};
 
 	for(x=0;x<=3;x++)
 		for(z=0;z<16;z++)
@@ -558,8 +558,8 @@ void FCEUI_GetNTSCTH(int *tint, int *hue)
 	*hue = ntschue;
 }
 
-static int controlselect=0;
-static int controllength=0;
+static FCEU_TLS int controlselect=0;
+static FCEU_TLS int controllength=0;
 
 void FCEUI_NTSCDEC(void)
 {
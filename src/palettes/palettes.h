@@ -4,27 +4,27 @@
 #define EMPTY_PALETTE_64 EMPTY_PALETTE_16 EMPTY_PALETTE_16 EMPTY_PALETTE_16 EMPTY_PALETTE_16
 #define EMPTY_PALETTE_DEEMPH_X_7 EMPTY_PALETTE_64 EMPTY_PALETTE_64 EMPTY_PALETTE_64 EMPTY_PALETTE_64 EMPTY_PALETTE_64 EMPTY_PALETTE_64 EMPTY_PALETTE_64
 
-pal rp2c04001[512] = {
+FCEU_TLS pal rp2c04001[512] = {
  #include "rp2c04001.h"
 	EMPTY_PALETTE_DEEMPH_X_7
 };
 
-pal rp2c04002[512] = {
+FCEU_TLS pal rp2c04002[512] = {
  #include "rp2c04002.h"
 	EMPTY_PALETTE_DEEMPH_X_7
 };
 
-pal rp2c04003[512] = {
+FCEU_TLS pal rp2c04003[512] = {
  #include "rp2c04003.h"
 	EMPTY_PALETTE_DEEMPH_X_7
 };
-pal rp2c05004[512] = {
+FCEU_TLS pal rp2c05004[512] = {
  #include "rp2c05004.h"
 	EMPTY_PALETTE_DEEMPH_X_7
 };
 
 // Fixed palette entries used by the GUI
-pal palette_unvarying[] = {
+FCEU_TLS pal palette_unvarying[] = {
 { 0x00<<2,0x00<<2,0x00<<2}, //  0 = Black
 { 0x3F<<2,0x3F<<2,0x34<<2}, //  1 = White
 { 0x00<<2,0x00<<2,0x00<<2}, //  2 = Black
@@ -53,7 +53,7 @@ pal palette_unvarying[] = {
 
 
 // Default palette 
-pal palette[512] = {
+FCEU_TLS pal palette[512] = {
 
         { 0x1D<<2, 0x1D<<2, 0x1D<<2 }, /* Value 0 */
         { 0x09<<2, 0x06<<2, 0x23<<2 }, /* Value 1 */
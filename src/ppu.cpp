@@ -66,13 +66,13 @@ static void RefreshSprites(void);
 static void CopySprites(uint8 *target);
 
 static void Fixit1(void);
-static uint32 ppulut1[256];
-static uint32 ppulut2[256];
-static uint32 ppulut3[128];
+static FCEU_TLS uint32 ppulut1[256];
+static FCEU_TLS uint32 ppulut2[256];
+static FCEU_TLS uint32 ppulut3[128];
 
-static bool new_ppu_reset = false;
+static FCEU_TLS bool new_ppu_reset = false;
 
-int test = 0;
+FCEU_TLS int test = 0;
 
 template<typename T, int BITS>
 struct BITREVLUT {
@@ -101,7 +101,7 @@ struct BITREVLUT {
 		return lut[index];
 	}
 };
-BITREVLUT<uint8, 8> bitrevlut;
+FCEU_TLS BITREVLUT<uint8, 8> bitrevlut;
 
 struct PPUSTATUS {
 	int32 sl;
@@ -137,16 +137,16 @@ struct SPRITE_READ {
 };
 
 //doesn't need to be savestated as it is just a reflection of the current position in the ppu loop
-PPUPHASE ppuphase;
+FCEU_TLS PPUPHASE ppuphase;
 
 //this needs to be savestated since a game may be trying to read from this across vblanks
-SPRITE_READ spr_read;
+FCEU_TLS SPRITE_READ spr_read;
 
 //definitely needs to be savestated
-uint8 idleSynch = 1;
+FCEU_TLS uint8 idleSynch = 1;
 
 //uses the internal counters concept at http://nesdev.icequake.net/PPU%20addressing.txt
-struct PPUREGS {
+FCEU_TLS struct PPUREGS {
 	//normal clocked regs. as the game can interfere with these at any time, they need to be savestated
 	uint32 fv;	//3
 	uint32 v;	//1
@@ -321,60 +321,60 @@ static void makeppulut(void) {
 	}
 }
 
-static int ppudead = 1;
-static int kook = 0;
-int fceuindbg = 0;
+static FCEU_TLS int ppudead = 1;
+static FCEU_TLS int kook = 0;
+FCEU_TLS int fceuindbg = 0;
 
 //mbg 6/23/08
 //make the no-bg fill color configurable
 //0xFF shall indicate to use palette[0]
-uint8 gNoBGFillColor = 0xFF;
+FCEU_TLS uint8 gNoBGFillColor = 0xFF;
 
-int MMC5Hack = 0;
-uint32 MMC5HackVROMMask = 0;
-uint8 *MMC5HackExNTARAMPtr = 0;
-uint8 *MMC5HackVROMPTR = 0;
-uint8 MMC5HackCHRMode = 0;
-uint8 MMC5HackSPMode = 0;
-uint8 MMC50x5130 = 0;
-uint8 MMC5HackSPScroll = 0;
-uint8 MMC5HackSPPage = 0;
+FCEU_TLS int MMC5Hack = 0;
+FCEU_TLS uint32 MMC5HackVROMMask = 0;
+FCEU_TLS uint8 *MMC5HackExNTARAMPtr = 0;
+FCEU_TLS uint8 *MMC5HackVROMPTR = 0;
+FCEU_TLS uint8 MMC5HackCHRMode = 0;
+FCEU_TLS uint8 MMC5HackSPMode = 0;
+FCEU_TLS uint8 MMC50x5130 = 0;
+FCEU_TLS uint8 MMC5HackSPScroll = 0;
+FCEU_TLS uint8 MMC5HackSPPage = 0;
 
-int PEC586Hack = 0;
+FCEU_TLS int PEC586Hack = 0;
 
-int QTAIHack = 0;
-uint8 QTAINTRAM[2048];
-uint8 qtaintramreg;
+FCEU_TLS int QTAIHack = 0;
+FCEU_TLS uint8 QTAINTRAM[2048];
+FCEU_TLS uint8 qtaintramreg;
 
-uint8 VRAMBuffer = 0, PPUGenLatch = 0;
-uint8 *vnapage[4];
-uint8 PPUNTARAM = 0;
-uint8 PPUCHRRAM = 0;
+FCEU_TLS uint8 VRAMBuffer = 0, PPUGenLatch = 0;
+FCEU_TLS uint8 *vnapage[4];
+FCEU_TLS uint8 PPUNTARAM = 0;
+FCEU_TLS uint8 PPUCHRRAM = 0;
 
 //Color deemphasis emulation.  Joy...
-static uint8 deemp = 0;
-static int deempcnt[8];
+static FCEU_TLS uint8 deemp = 0;
+static FCEU_TLS int deempcnt[8];
 
-void (*GameHBIRQHook)(void), (*GameHBIRQHook2)(void);
-void (*PPU_hook)(uint32 A);
+FCEU_TLS void (*GameHBIRQHook)(void), (*GameHBIRQHook2)(void);
+FCEU_TLS void (*PPU_hook)(uint32 A);
 
-uint8 vtoggle = 0;
-uint8 XOffset = 0;
-uint8 SpriteDMA = 0; // $4014 / Writing $xx copies 256 bytes by reading from $xx00-$xxFF and writing to $2004 (OAM data)
+FCEU_TLS uint8 vtoggle = 0;
+FCEU_TLS uint8 XOffset = 0;
+FCEU_TLS uint8 SpriteDMA = 0; // $4014 / Writing $xx copies 256 bytes by reading from $xx00-$xxFF and writing to $2004 (OAM data)
 
-uint32 TempAddr = 0, RefreshAddr = 0, DummyRead = 0, NTRefreshAddr = 0;
+FCEU_TLS uint32 TempAddr = 0, RefreshAddr = 0, DummyRead = 0, NTRefreshAddr = 0;
 
-static int maxsprites = 8;
+static FCEU_TLS int maxsprites = 8;
 
 //scanline is equal to the current visible scanline we're on.
-int scanline;
-int g_rasterpos;
-static uint32 scanlines_per_frame;
-
-uint8 PPU[4];
-uint8 PPUSPL;
-uint8 NTARAM[0x800], PALRAM[0x20], SPRAM[0x100], SPRBUF[0x100];
-uint8 UPALRAM[0x03];//for 0x4/0x8/0xC addresses in palette, the ones in
+FCEU_TLS int scanline;
+FCEU_TLS int g_rasterpos;
+static FCEU_TLS uint32 scanlines_per_frame;
+
+FCEU_TLS uint8 PPU[4];
+FCEU_TLS uint8 PPUSPL;
+FCEU_TLS uint8 NTARAM[0x800], PALRAM[0x20], SPRAM[0x100], SPRBUF[0x100];
+FCEU_TLS uint8 UPALRAM[0x03];//for 0x4/0x8/0xC addresses in palette, the ones in
 					//0x20 are 0 to not break fceu rendering.
 
 #define MMC5SPRVRAMADR(V)   &MMC5SPRVPage[(V) >> 10][(V)]
@@ -451,9 +451,9 @@ inline void FFCEUX_PPUWrite_Default(uint32 A, uint8 V) {
 	}
 }
 
-volatile int rendercount, vromreadcount, undefinedvromcount, LogAddress = -1;
-unsigned char *cdloggervdata = NULL;
-unsigned int cdloggerVideoDataSize = 0;
+FCEU_TLS volatile int rendercount, vromreadcount, undefinedvromcount, LogAddress = -1;
+FCEU_TLS unsigned char *cdloggervdata = NULL;
+FCEU_TLS unsigned int cdloggerVideoDataSize = 0;
 
 int GetCHRAddress(int A) {
 	if (cdloggerVideoDataSize) {
@@ -536,15 +536,15 @@ uint8 FASTCALL FFCEUX_PPURead_Default(uint32 A) {
 }
 
 
-uint8 (FASTCALL *FFCEUX_PPURead)(uint32 A) = 0;
-void (*FFCEUX_PPUWrite)(uint32 A, uint8 V) = 0;
+FCEU_TLS uint8 (FASTCALL *FFCEUX_PPURead)(uint32 A) = 0;
+FCEU_TLS void (*FFCEUX_PPUWrite)(uint32 A, uint8 V) = 0;
 
 #define CALL_PPUREAD(A) (FFCEUX_PPURead(A))
 
 #define CALL_PPUWRITE(A, V) (FFCEUX_PPUWrite ? FFCEUX_PPUWrite(A, V) : FFCEUX_PPUWrite_Default(A, V))
 
 //whether to use the new ppu
-int newppu = 0;
+FCEU_TLS int newppu = 0;
 
 void ppu_getScroll(int &xpos, int &ypos) {
 	if (newppu) {
@@ -1002,10 +1002,10 @@ static DECLFW(B4014) {
 
 #define GETLASTPIXEL    (PAL ? ((timestamp * 48 - linestartts) / 15) : ((timestamp * 48 - linestartts) >> 4))
 
-static uint8 *Pline, *Plinef;
-static int firsttile;
-int linestartts;	//no longer static so the debugger can see it
-static int tofix = 0;
+static FCEU_TLS uint8 *Pline, *Plinef;
+static FCEU_TLS int firsttile;
+FCEU_TLS int linestartts;	//no longer static so the debugger can see it
+static FCEU_TLS int tofix = 0;
 
 static void ResetRL(uint8 *target) {
 	memset(target, 0xFF, 256);
@@ -1019,7 +1019,7 @@ static void ResetRL(uint8 *target) {
 	tofix = 1;
 }
 
-static uint8 sprlinebuf[256 + 8];
+static FCEU_TLS uint8 sprlinebuf[256 + 8];
 
 void FCEUPPU_LineUpdate(void) {
 	if (newppu)
@@ -1034,7 +1034,11 @@ void FCEUPPU_LineUpdate(void) {
 	}
 }
 
-static bool rendersprites = true, renderbg = true;
+static FCEU_TLS bool rendersprites = true, renderbg = true;
+
+//Set while FCEUPPU_Loop() emulates a frame whose picture nobody will look at.
+//Only work that can't affect the CPU-visible state is skipped.
+static FCEU_TLS bool skiprender = false;
 
 void FCEUI_SetRenderPlanes(bool sprites, bool bg) {
 	rendersprites = sprites;
@@ -1056,8 +1060,8 @@ static void EndRL(void) {
 	Pline = 0;
 }
 
-static int32 sphitx;
-static uint8 sphitdata;
+static FCEU_TLS int32 sphitx;
+static FCEU_TLS uint8 sphitdata;
 
 static void CheckSpriteHit(int p) {
 	int l = p - 16;
@@ -1076,12 +1080,12 @@ static void CheckSpriteHit(int p) {
 
 //spork the world.  Any sprites on this line? Then this will be set to 1.
 //Needed for zapper emulation and *gasp* sprite emulation.
-static int spork = 0;
+static FCEU_TLS int spork = 0;
 
 // lasttile is really "second to last tile."
 static void RefreshLine(int lastpixel) {
-	static uint32 pshift[2];
-	static uint32 atlatch;
+	static FCEU_TLS uint32 pshift[2];
+	static FCEU_TLS uint32 atlatch;
 	uint32 smorkus = RefreshAddr;
 
 	#define RefreshAddr smorkus
@@ -1091,7 +1095,7 @@ static void RefreshLine(int lastpixel) {
 	register uint8 *P = Pline;
 	int lasttile = lastpixel >> 3;
 	int numtiles;
-	static int norecurse = 0;	// Yeah, recursion would be bad.
+	static FCEU_TLS int norecurse = 0;	// Yeah, recursion would be bad.
 								// PPU_hook() functions can call
 								// mirroring/chr bank switching functions,
 								// which call FCEUPPU_LineUpdate, which call this
@@ -1203,6 +1207,16 @@ static void RefreshLine(int lastpixel) {
 		}
 		#undef PPUT_HOOK
 		norecurse = 0;
+	} else if (skiprender && sphitx == 0x100 && !PEC586Hack && !QTAIHack && !InputScanlineHookUsed()) {
+		//Nothing will look at these pixels: just walk the fetch address like pputile.inc does.
+		for (X1 = firsttile; X1 < lasttile; X1++) {
+			if (X1 >= 2)
+				P += 8;
+			if ((RefreshAddr & 0x1f) == 0x1f)
+				RefreshAddr ^= 0x41F;
+			else
+				RefreshAddr++;
+		}
 	} else {
 		if (PEC586Hack) {
 			#define PPU_BGFETCH
@@ -1316,6 +1330,11 @@ static void DoLine(void) {
 	X6502_Run(256);
 	EndRL();
 
+	if (skiprender) {
+		spork = 0;	//Normally consumed by CopySprites().
+		goto skipped;
+	}
+
 	if (!renderbg) {// User asked to not display background data.
 		uint32 tem;
 		uint8 col;
@@ -1354,6 +1373,7 @@ static void DoLine(void) {
 	for (x = 63; x >= 0; x--)
 		*(uint32*)&dtarget[x << 2] = ((PPU[1]>>5)<<0)|((PPU[1]>>5)<<8)|((PPU[1]>>5)<<16)|((PPU[1]>>5)<<24);
 
+skipped:
 	sphitx = 0x100;
 
 	if (ScreenON || SpriteON)
@@ -1404,7 +1424,7 @@ void FCEUI_DisableSpriteLimitation(int a) {
 	maxsprites = a ? 64 : 8;
 }
 
-static uint8 numsprites, SpriteBlurp;
+static FCEU_TLS uint8 numsprites, SpriteBlurp;
 static void FetchSpriteData(void) {
 	uint8 ns, sb;
 	SPR *spr;
@@ -1544,6 +1564,20 @@ static void FetchSpriteData(void) {
 	SpriteBlurp = sb;
 }
 
+static uint8 SpriteHitData(uint8 J, uint8 atr) {
+	if (!(atr & H_FLIP))
+		return J;
+
+	return ((J << 7) & 0x80) |
+		((J << 5) & 0x40) |
+		((J << 3) & 0x20) |
+		((J << 1) & 0x10) |
+		((J >> 1) & 0x08) |
+		((J >> 3) & 0x04) |
+		((J >> 5) & 0x02) |
+		((J >> 7) & 0x01);
+}
+
 static void RefreshSprites(void) {
 	int n;
 	SPRB *spr;
@@ -1551,8 +1585,22 @@ static void RefreshSprites(void) {
 	spork = 0;
 	if (!numsprites) return;
 
-	FCEU_dwmemset(sprlinebuf, 0x80808080, 256);
 	numsprites--;
+
+	if (skiprender && !InputScanlineHookUsed()) {
+		//The line buffer isn't needed, only sprite 0 hit detection.
+		spr = (SPRB*)SPRBUF;
+		uint8 J = spr->ca[0] | spr->ca[1];
+		if (J && SpriteBlurp && !(PPU_status & 0x40)) {
+			sphitx = spr->x;
+			sphitdata = SpriteHitData(J, spr->atr);
+		}
+		SpriteBlurp = 0;
+		spork = 1;
+		return;
+	}
+
+	FCEU_dwmemset(sprlinebuf, 0x80808080, 256);
 	spr = (SPRB*)SPRBUF + numsprites;
 
 	for (n = numsprites; n >= 0; n--, spr--) {
@@ -1570,16 +1618,7 @@ static void RefreshSprites(void) {
 		if (J) {
 			if (n == 0 && SpriteBlurp && !(PPU_status & 0x40)) {
 				sphitx = x;
-				sphitdata = J;
-				if (atr & H_FLIP)
-					sphitdata = ((J << 7) & 0x80) |
-								((J << 5) & 0x40) |
-								((J << 3) & 0x20) |
-								((J << 1) & 0x10) |
-								((J >> 1) & 0x08) |
-								((J >> 3) & 0x04) |
-								((J >> 5) & 0x02) |
-								((J >> 7) & 0x01);
+				sphitdata = SpriteHitData(J, atr);
 			}
 
 			C = sprlinebuf + x;
@@ -1719,6 +1758,13 @@ void FCEUPPU_Reset(void) {
 	new_ppu_reset = true; // delay reset of ppur/spr_read until it's ready to start a new frame
 }
 
+//a frame thrown away halfway through leaves the loop's per-frame state behind.
+//put back what the end of a frame leaves; the rest comes from the state loaded next.
+void FCEUPPU_AbandonFrame(void) {
+	scanline = totalscanlines;
+	sphitx = 0x100;
+}
+
 void FCEUPPU_Power(void) {
 	int x;
 
@@ -1727,6 +1773,10 @@ void FCEUPPU_Power(void) {
 	memset(UPALRAM, 0x00, 0x03);
 	memset(SPRAM, 0x00, 0x100);
 	FCEUPPU_Reset();
+	XOffset = 0;
+	//the old ppu never gets to the delayed reset, and both save these
+	ppur.reset();
+	spr_read.reset();
 
 	for (x = 0x2000; x < 0x4000; x += 8) {
 		ARead[x] = A200x;
@@ -1755,6 +1805,8 @@ int FCEUPPU_Loop(int skip) {
 		return FCEUX_PPU_Loop(skip);
 	}
 
+	skiprender = skip != 0;
+
 	//Needed for Knight Rider, possibly others.
 	if (ppudead) {
 		memset(XBuf, 0x80, 256 * 240);
@@ -1816,30 +1868,6 @@ int FCEUPPU_Loop(int skip) {
 		}
 		if (GameInfo->type == GIT_NSF)
 			X6502_Run((256 + 85) * normalscanlines);
-		#ifdef FRAMESKIP
-		else if (skip) {
-			int y;
-
-			y = SPRAM[0];
-			y++;
-
-			PPU_status |= 0x20;	// Fixes "Bee 52".  Does it break anything?
-			if (GameHBIRQHook) {
-				X6502_Run(256);
-				for (scanline = 0; scanline < 240; scanline++) {
-					if (ScreenON || SpriteON)
-						GameHBIRQHook();
-					if (scanline == y && SpriteON) PPU_status |= 0x40;
-					X6502_Run((scanline == 239) ? 85 : (256 + 85));
-				}
-			} else if (y < 240) {
-				X6502_Run((256 + 85) * y);
-				if (SpriteON) PPU_status |= 0x40;	// Quick and very dirty hack.
-				X6502_Run((256 + 85) * (240 - y));
-			} else
-				X6502_Run((256 + 85) * 240);
-		}
-		#endif
 		else {
 			deemp = PPU[1] >> 5;
 
@@ -1882,27 +1910,21 @@ int FCEUPPU_Loop(int skip) {
 		}
 	}	//else... to if(ppudead)
 
-	#ifdef FRAMESKIP
-	if (skip) {
-		FCEU_PutImageDummy();
-		return(0);
-	} else
-	#endif
-	{
-		return(1);
-	}
+	skiprender = false;
+
+	return(1);
 }
 
-int (*PPU_MASTER)(int skip) = FCEUPPU_Loop;
+FCEU_TLS int (*PPU_MASTER)(int skip) = FCEUPPU_Loop;
 
-static uint16 TempAddrT, RefreshAddrT;
+static FCEU_TLS uint16 TempAddrT, RefreshAddrT;
 
 void FCEUPPU_LoadState(int version) {
 	TempAddr = TempAddrT;
 	RefreshAddr = RefreshAddrT;
 }
 
-SFORMAT FCEUPPU_STATEINFO[] = {
+FCEU_TLS SFORMAT FCEUPPU_STATEINFO[] = {
 	{ NTARAM, 0x800, "NTAR" },
 	{ PALRAM, 0x20, "PRAM" },
 	{ SPRAM, 0x100, "SPRA" },
@@ -1919,7 +1941,7 @@ SFORMAT FCEUPPU_STATEINFO[] = {
 	{ 0 }
 };
 
-SFORMAT FCEU_NEWPPU_STATEINFO[] = {
+FCEU_TLS SFORMAT FCEU_NEWPPU_STATEINFO[] = {
 	{ &idleSynch, 1, "IDLS" },
 	{ &spr_read.num, 4 | FCEUSTATE_RLSB, "SR_0" },
 	{ &spr_read.count, 4 | FCEUSTATE_RLSB, "SR_1" },
@@ -1970,8 +1992,8 @@ uint32 FCEUPPU_PeekAddress()
 }
 
 //---------------------
-int pputime = 0;
-int totpputime = 0;
+FCEU_TLS int pputime = 0;
+FCEU_TLS int totpputime = 0;
 const int kLineTime = 341;
 const int kFetchTime = 2;
 
@@ -1984,7 +2006,7 @@ void runppu(int x) {
 }
 
 //todo - consider making this a 3 or 4 slot fifo to keep from touching so much memory
-struct BGData {
+FCEU_TLS struct BGData {
 	struct Record {
 		uint8 nt, pecnt, at, pt[2], qtnt;
 
@@ -2057,7 +2079,7 @@ static inline int PaletteAdjustPixel(int pixel) {
 		return (pixel & 0x3F) | 0x80;
 }
 
-int framectr = 0;
+FCEU_TLS int framectr = 0;
 int FCEUX_PPU_Loop(int skip) {
 
 	if (new_ppu_reset) // first frame since reset, time to initialize
@@ -2126,10 +2148,10 @@ int FCEUX_PPU_Loop(int skip) {
 		//if(PPUON)
 		//	ppur.install_latches();
 
-		static uint8 oams[2][64][8];//[7] turned to [8] for faster indexing
-		static int oamcounts[2] = { 0, 0 };
-		static int oamslot = 0;
-		static int oamcount;
+		static FCEU_TLS uint8 oams[2][64][8];//[7] turned to [8] for faster indexing
+		static FCEU_TLS int oamcounts[2] = { 0, 0 };
+		static FCEU_TLS int oamslot = 0;
+		static FCEU_TLS int oamcount;
 
 		//capture the initial xscroll
 		//int xscroll = ppur.fh;
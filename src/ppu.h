@@ -1,22 +1,23 @@
 void FCEUPPU_Init(void);
 void FCEUPPU_Reset(void);
 void FCEUPPU_Power(void);
+void FCEUPPU_AbandonFrame(void);
 int FCEUPPU_Loop(int skip);
 
 void FCEUPPU_LineUpdate();
 void FCEUPPU_SetVideoSystem(int w);
 
-extern void (*PPU_hook)(uint32 A);
-extern void (*GameHBIRQHook)(void), (*GameHBIRQHook2)(void);
+extern FCEU_TLS void (*PPU_hook)(uint32 A);
+extern FCEU_TLS void (*GameHBIRQHook)(void), (*GameHBIRQHook2)(void);
 
 int newppu_get_scanline();
 int newppu_get_dot();
 void newppu_hacky_emergency_reset();
 
 /* For cart.c and banksw.h, mostly */
-extern uint8 NTARAM[0x800], *vnapage[4];
-extern uint8 PPUNTARAM;
-extern uint8 PPUCHRRAM;
+extern FCEU_TLS uint8 NTARAM[0x800], *vnapage[4];
+extern FCEU_TLS uint8 PPUNTARAM;
+extern FCEU_TLS uint8 PPUCHRRAM;
 
 void FCEUPPU_SaveState(void);
 void FCEUPPU_LoadState(int version);
@@ -33,22 +34,22 @@ void ppu_getScroll(int &xpos, int &ypos);
 #endif
 
 void PPU_ResetHooks();
-extern uint8 (FASTCALL *FFCEUX_PPURead)(uint32 A);
-extern void (*FFCEUX_PPUWrite)(uint32 A, uint8 V);
+extern FCEU_TLS uint8 (FASTCALL *FFCEUX_PPURead)(uint32 A);
+extern FCEU_TLS void (*FFCEUX_PPUWrite)(uint32 A, uint8 V);
 extern uint8 FASTCALL FFCEUX_PPURead_Default(uint32 A);
 void FFCEUX_PPUWrite_Default(uint32 A, uint8 V);
 
-extern int g_rasterpos;
-extern uint8 PPU[4];
-extern bool DMC_7bit;
-extern bool paldeemphswap;
+extern FCEU_TLS int g_rasterpos;
+extern FCEU_TLS uint8 PPU[4];
+extern FCEU_TLS bool DMC_7bit;
+extern FCEU_TLS bool paldeemphswap;
 
 enum PPUPHASE {
 	PPUPHASE_VBL, PPUPHASE_BG, PPUPHASE_OBJ
 };
 
-extern PPUPHASE ppuphase;
+extern FCEU_TLS PPUPHASE ppuphase;
 
-extern unsigned char *cdloggervdata;
-extern unsigned int cdloggerVideoDataSize;
-extern volatile int rendercount, vromreadcount, undefinedvromcount;
+extern FCEU_TLS unsigned char *cdloggervdata;
+extern FCEU_TLS unsigned int cdloggerVideoDataSize;
+extern FCEU_TLS volatile int rendercount, vromreadcount, undefinedvromcount;
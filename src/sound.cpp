@@ -31,60 +31,61 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 
-static uint32 wlookup1[32];
-static uint32 wlookup2[203];
+static FCEU_TLS uint32 wlookup1[32];
+static FCEU_TLS uint32 wlookup2[203];
 
-int32 Wave[2048+512];
-int32 WaveHi[40000];
-int32 WaveFinal[2048+512];
+FCEU_TLS int32 Wave[2048+512];
+FCEU_TLS int32 WaveHi[40000];
+FCEU_TLS int32 WaveFinal[2048+512];
 
-EXPSOUND GameExpSound={0,0,0};
+FCEU_TLS EXPSOUND GameExpSound={0,0,0};
 
-/*static*/ uint8 TriCount=0;
-static uint8 TriMode=0;
+/*static*/ FCEU_TLS uint8 TriCount=0;
+static FCEU_TLS uint8 TriMode=0;
 
-static int32 tristep=0;
+static FCEU_TLS int32 tristep=0;
 
-static int32 wlcount[4]={0,0,0,0};	// Wave length counters.
+static FCEU_TLS int32 wlcount[4]={0,0,0,0};	// Wave length counters.
 
 // APU registers:
-uint8 PSG[0x10];			// $4000-$400F / Channels 1-4
-uint8 DMCFormat=0;			// $4010 / Play mode and frequency
-uint8 RawDALatch=0;			// $4011 / 7-bit DAC / 0xxxxxxx
-uint8 DMCAddressLatch=0;	// $4012 / Start of DMC waveform is at address $C000 + $40*$xx
-uint8 DMCSizeLatch=0;		// $4013 / Length of DMC waveform is $10*$xx + 1 bytes (128*$xx + 8 samples)
-uint8 EnabledChannels=0;	// $4015 / Sound channels enable and status
-uint8 IRQFrameMode=0;		// $4017 / Frame counter control / xx000000
-
-uint8 InitialRawDALatch=0; // used only for lua
-bool DMC_7bit = 0; // used to skip overclocking
-ENVUNIT EnvUnits[3];
+FCEU_TLS uint8 PSG[0x10];			// $4000-$400F / Channels 1-4
+FCEU_TLS uint8 DMCFormat=0;			// $4010 / Play mode and frequency
+FCEU_TLS uint8 RawDALatch=0;			// $4011 / 7-bit DAC / 0xxxxxxx
+FCEU_TLS uint8 DMCAddressLatch=0;	// $4012 / Start of DMC waveform is at address $C000 + $40*$xx
+FCEU_TLS uint8 DMCSizeLatch=0;		// $4013 / Length of DMC waveform is $10*$xx + 1 bytes (128*$xx + 8 samples)
+FCEU_TLS uint8 EnabledChannels=0;	// $4015 / Sound channels enable and status
+FCEU_TLS uint8 IRQFrameMode=0;		// $4017 / Frame counter control / xx000000
+
+FCEU_TLS uint8 InitialRawDALatch=0; // used only for lua
+FCEU_TLS bool DMC_7bit = 0; // used to skip overclocking
+FCEU_TLS ENVUNIT EnvUnits[3];
 
 static const int RectDuties[4]={1,2,4,6};
 
-static int32 RectDutyCount[2];
-static uint8 sweepon[2];
-/*static*/ int32 curfreq[2];
-static uint8 SweepCount[2];
-static uint8 SweepReload[2];
+static FCEU_TLS int32 RectDutyCount[2];
+static FCEU_TLS uint8 sweepon[2];
+/*static*/ FCEU_TLS int32 curfreq[2];
+static FCEU_TLS uint8 SweepCount[2];
+static FCEU_TLS uint8 SweepReload[2];
 
-static uint16 nreg=0;
+static FCEU_TLS uint16 nreg=0;
 
-static uint8 fcnt=0;
-static int32 fhcnt=0;
-static int32 fhinc=0;
+static FCEU_TLS uint8 fcnt=0;
+static FCEU_TLS int32 fhcnt=0;
+static FCEU_TLS int32 fhinc=0;
 
-uint32 soundtsoffs=0;
+FCEU_TLS uint32 soundtsoffs=0;
 
 /* Variables exclusively for low-quality sound. */
-int32 nesincsize=0;
-uint32 soundtsinc=0;
-uint32 soundtsi=0;
-static int32 sqacc[2];
+FCEU_TLS int32 nesincsize=0;
+FCEU_TLS uint32 soundtsinc=0;
+FCEU_TLS uint32 soundtsi=0;
+static FCEU_TLS int32 sqacc[2];
 /* LQ variables segment ends. */
 
-/*static*/ int32 lengthcount[4];
+/*static*/ FCEU_TLS int32 lengthcount[4];
 static const uint8 lengthtable[0x20]=
 {
 	10,254, 20,  2, 40,  4, 80,  6, 160,  8, 60, 10, 14, 12, 26, 14,
@@ -123,35 +124,35 @@ static const uint32 PALDMCTable[0x10]=
 	176, 148, 132, 118,  98,  78,  66,  50
 };
 
-/*static*/ int32 DMCacc=1;
-/*static*/ int32 DMCPeriod=0;
-/*static*/ uint8 DMCBitCount=0;
+/*static*/ FCEU_TLS int32 DMCacc=1;
+/*static*/ FCEU_TLS int32 DMCPeriod=0;
+/*static*/ FCEU_TLS uint8 DMCBitCount=0;
 
-static uint32 DMCAddress=0;
-static int32 DMCSize=0;
-static uint8 DMCShift=0;
-static uint8 SIRQStat=0;
+static FCEU_TLS uint32 DMCAddress=0;
+static FCEU_TLS int32 DMCSize=0;
+static FCEU_TLS uint8 DMCShift=0;
+static FCEU_TLS uint8 SIRQStat=0;
 
-static char DMCHaveDMA=0;
-static uint8 DMCDMABuf=0;
-/*static*/ char DMCHaveSample=0;
+static FCEU_TLS char DMCHaveDMA=0;
+static FCEU_TLS uint8 DMCDMABuf=0;
+/*static*/ FCEU_TLS char DMCHaveSample=0;
 
 static void Dummyfunc(void) {};
-static void (*DoNoise)(void)=Dummyfunc;
-static void (*DoTriangle)(void)=Dummyfunc;
-static void (*DoPCM)(void)=Dummyfunc;
-static void (*DoSQ1)(void)=Dummyfunc;
-static void (*DoSQ2)(void)=Dummyfunc;
+static FCEU_TLS void (*DoNoise)(void)=Dummyfunc;
+static FCEU_TLS void (*DoTriangle)(void)=Dummyfunc;
+static FCEU_TLS void (*DoPCM)(void)=Dummyfunc;
+static FCEU_TLS void (*DoSQ1)(void)=Dummyfunc;
+static FCEU_TLS void (*DoSQ2)(void)=Dummyfunc;
 
-static uint32 ChannelBC[5];
+static FCEU_TLS uint32 ChannelBC[5];
 
 //savestate sync hack stuff
-int movieSyncHackOn=0,resetDMCacc=0,movieConvertOffset1,movieConvertOffset2;
+FCEU_TLS int movieSyncHackOn=0,resetDMCacc=0,movieConvertOffset1,movieConvertOffset2;
 
 #ifdef WIN32
 extern volatile int datacount, undefinedcount;
-extern int debug_loggingCD;
-extern unsigned char *cdloggerdata;
+extern FCEU_TLS int debug_loggingCD;
+extern FCEU_TLS unsigned char *cdloggerdata;
 #endif
 
 static void LoadDMCPeriod(uint8 V)
@@ -351,6 +352,8 @@ static DECLFW(StatusWrite)
 {
 	int x;
 
+	X6502_SyncHooks();
+
     DoSQ1();
     DoSQ2();
     DoTriangle();
@@ -580,6 +583,21 @@ void FCEU_SoundCPUHook(int cycles)
  }
 }
 
+//how many cycles FCEU_SoundCPUHook() can be handed at once without skipping past
+//a frame counter step or a DMC bit
+int32 FCEU_SoundCPUHookBudget(void)
+{
+ int32 budget;
+
+ if(DMCSize && !DMCHaveDMA)
+  return 0;
+
+ budget=(fhcnt+47)/48;
+ if(DMCacc<budget)
+  budget=DMCacc;
+ return budget;
+}
+
 void RDoPCM(void)
 {
  uint32 V; //mbg merge 7/17/06 made uint32
@@ -799,12 +817,12 @@ static void RDoTriangle(void)
  ChannelBC[2]=SOUNDTS;
 }
 
+static FCEU_TLS uint32 tricout=0;
+static FCEU_TLS int32 triacc=0;
+static FCEU_TLS int32 noiseacc=0;
+
 static void RDoTriangleNoisePCMLQ(void)
 {
-   static uint32 tcout=0;
-   static int32 triacc=0;
-   static int32 noiseacc=0;
-
    int32 V;
    int32 start,end;
    int32 freq[2];
@@ -851,7 +869,7 @@ static void RDoTriangleNoisePCMLQ(void)
     nshift=13;
 
 
-   totalout = wlookup2[tcout+noiseout+RawDALatch];
+   totalout = wlookup2[tricout+noiseout+RawDALatch];
 
    if(inie[0] && inie[1])
    {
@@ -868,10 +886,10 @@ static void RDoTriangleNoisePCMLQ(void)
      triacc+=freq[0]; //t;
      tristep=(tristep+1)&0x1F;
      if(triacc<=0) goto rea;
-     tcout=(tristep&0xF);
-     if(!(tristep&0x10)) tcout^=0xF;
-     tcout=tcout*3;
-      totalout = wlookup2[tcout+noiseout+RawDALatch];
+     tricout=(tristep&0xF);
+     if(!(tristep&0x10)) tricout^=0xF;
+     tricout=tricout*3;
+      totalout = wlookup2[tricout+noiseout+RawDALatch];
     }
 
     if(noiseacc<=0)
@@ -887,7 +905,7 @@ static void RDoTriangleNoisePCMLQ(void)
      nreg&=0x7fff;
      noiseout=amptab[(nreg>>0xe)&1];
      if(noiseacc<=0) goto rea2;
-      totalout = wlookup2[tcout+noiseout+RawDALatch];
+      totalout = wlookup2[tricout+noiseout+RawDALatch];
     } /* noiseacc<=0 */
   } /* for(V=... */
 }
@@ -905,10 +923,10 @@ static void RDoTriangleNoisePCMLQ(void)
       triacc+=freq[0]; //t;
       tristep=(tristep+1)&0x1F;
       if(triacc<=0) goto area;
-      tcout=(tristep&0xF);
-      if(!(tristep&0x10)) tcout^=0xF;
-      tcout=tcout*3;
-      totalout = wlookup2[tcout+noiseout+RawDALatch];
+      tricout=(tristep&0xF);
+      if(!(tristep&0x10)) tricout^=0xF;
+      tricout=tricout*3;
+      totalout = wlookup2[tricout+noiseout+RawDALatch];
      }
     }
   }
@@ -931,7 +949,7 @@ static void RDoTriangleNoisePCMLQ(void)
       nreg&=0x7fff;
       noiseout=amptab[(nreg>>0xe)&1];
       if(noiseacc<=0) goto area2;
-      totalout = wlookup2[tcout+noiseout+RawDALatch];
+      totalout = wlookup2[tricout+noiseout+RawDALatch];
      } /* noiseacc<=0 */
     }
   }
@@ -1010,6 +1028,7 @@ static void RDoNoise(void)
 
 DECLFW(Write_IRQFM)
 {
+ X6502_SyncHooks();
  V=(V&0xC0)>>6;
  fcnt=0;
  if(V&0x2)
@@ -1031,7 +1050,84 @@ void SetNESSoundMap(void)
   SetReadHandler(0x4015,0x4015,StatusRead);
 }
 
-static int32 inbuf=0;
+static FCEU_TLS FCEUSND_Flushed flushed;
+
+static void MarkFlushed(void)
+{
+ flushed.bc=ChannelBC[0];
+ flushed.carry=Wave[0];
+ memcpy(flushed.sqacc,sqacc,sizeof(sqacc));
+ memcpy(flushed.dutycount,RectDutyCount,sizeof(RectDutyCount));
+ memcpy(flushed.wlcount,wlcount,sizeof(wlcount));
+ flushed.tristep=tristep;
+ flushed.tricout=tricout;
+ flushed.triacc=triacc;
+ flushed.noiseacc=noiseacc;
+}
+
+//a frame thrown away halfway through has already mixed part of itself into the buffers.
+//put back what the last flush left so it doesn't leak into the next frame.
+void FCEUSND_AbandonFrame(void)
+{
+ int x;
+
+ if(FSettings.soundq>=1)
+  memset(WaveHi+soundtsoffs,0,sizeof(WaveHi)-soundtsoffs*sizeof(uint32));
+ else
+ {
+  memset(Wave,0,sizeof(Wave));
+  Wave[0]=flushed.carry;
+ }
+ for(x=0;x<5;x++)
+  ChannelBC[x]=flushed.bc;
+ if(GameExpSound.HiSync) GameExpSound.HiSync(flushed.bc);
+
+ memcpy(sqacc,flushed.sqacc,sizeof(sqacc));
+ memcpy(RectDutyCount,flushed.dutycount,sizeof(RectDutyCount));
+ memcpy(wlcount,flushed.wlcount,sizeof(wlcount));
+ tristep=flushed.tristep;
+ tricout=flushed.tricout;
+ triacc=flushed.triacc;
+ noiseacc=flushed.noiseacc;
+}
+
+void FCEUSND_SaveOutput(FCEUSND_Output *out)
+{
+ out->flushed=flushed;
+ out->tsoffs=soundtsoffs;
+ memset(out->left,0,sizeof(out->left));
+ if(FSettings.soundq>=1)
+  memcpy(out->left,WaveHi,std::min<uint32>(soundtsoffs,FCEUSND_MAXLEFTOVER)*sizeof(int32));
+ GetFilterState(&out->filter);
+}
+
+void FCEUSND_LoadOutput(const FCEUSND_Output *out)
+{
+ flushed=out->flushed;
+ soundtsoffs=out->tsoffs;
+ memcpy(WaveHi,out->left,sizeof(out->left));
+ SetFilterState(&out->filter);
+ FCEUSND_AbandonFrame();
+}
+
+void FCEUSND_ResetOutput(void)
+{
+ memset(Wave,0,sizeof(Wave));
+ memset(WaveHi,0,sizeof(WaveHi));
+ memset(ChannelBC,0,sizeof(ChannelBC));
+ soundtsoffs=0;
+ memset(sqacc,0,sizeof(sqacc));
+ memset(RectDutyCount,0,sizeof(RectDutyCount));
+ memset(wlcount,0,sizeof(wlcount));
+ tristep=0;
+ tricout=0;
+ triacc=0;
+ noiseacc=0;
+ ResetFilterState();
+ MarkFlushed();
+}
+
+static FCEU_TLS int32 inbuf=0;
 int FlushEmulateSound(void)
 {
   int x;
@@ -1101,6 +1197,7 @@ int FlushEmulateSound(void)
    end>>=4;
   }
   inbuf=end;
+  MarkFlushed();
 
   FCEU_WriteWaveData(WaveFinal, end); /* This function will just return
 				    if sound recording is off. */
@@ -1198,6 +1295,8 @@ void FCEUSND_Power(void)
 
         SetNESSoundMap();
         memset(PSG,0x00,sizeof(PSG));
+        memset(SweepCount,0,sizeof(SweepCount));
+        DMCDMABuf=0;
 	FCEUSND_Reset();
 
 	memset(Wave,0,sizeof(Wave));
@@ -1208,6 +1307,7 @@ void FCEUSND_Power(void)
          ChannelBC[x]=0;
         soundtsoffs=0;
         LoadDMCPeriod(DMCFormat&0xF);
+        MarkFlushed();
 }
 
 
@@ -1264,6 +1364,7 @@ void SetSoundVariables(void)
   nesincsize=(int64)(((int64)1<<17)*(double)(PAL?PAL_CPU:NTSC_CPU)/(FSettings.SndRate * 16));
   memset(sqacc,0,sizeof(sqacc));
   memset(ChannelBC,0,sizeof(ChannelBC));
+  MarkFlushed();
 
   LoadDMCPeriod(DMCFormat&0xF);  // For changing from PAL to NTSC
 
@@ -1317,7 +1418,7 @@ void FCEUI_SetPCMVolume(uint32 volume)
 	FSettings.PCMVolume=volume;
 }
 
-SFORMAT FCEUSND_STATEINFO[]={
+FCEU_TLS SFORMAT FCEUSND_STATEINFO[]={
 
  { &fhcnt, 4|FCEUSTATE_RLSB,"FHCN"},
  { &fcnt, 1, "FCNT"},
@@ -1344,6 +1445,10 @@ SFORMAT FCEUSND_STATEINFO[]={
  { &EnvUnits[1].decvolume, 1, "E1DV"},
  { &EnvUnits[2].decvolume, 1, "E2DV"},
 
+ { &EnvUnits[0].reloaddec, 4|FCEUSTATE_RLSB, "E0RD"},
+ { &EnvUnits[1].reloaddec, 4|FCEUSTATE_RLSB, "E1RD"},
+ { &EnvUnits[2].reloaddec, 4|FCEUSTATE_RLSB, "E2RD"},
+
  { &lengthcount[0], 4|FCEUSTATE_RLSB, "LEN0"},
  { &lengthcount[1], 4|FCEUSTATE_RLSB, "LEN1"},
  { &lengthcount[2], 4|FCEUSTATE_RLSB, "LEN2"},
@@ -1352,6 +1457,7 @@ SFORMAT FCEUSND_STATEINFO[]={
  { &curfreq[0], 4|FCEUSTATE_RLSB,"CRF1"},
  { &curfreq[1], 4|FCEUSTATE_RLSB,"CRF2"},
  { SweepCount, 2,"SWCT"},
+ { SweepReload, 2,"SWRL"},
 
  { &SIRQStat, 1, "SIRQ"},
 
@@ -1360,6 +1466,7 @@ SFORMAT FCEUSND_STATEINFO[]={
  { &DMCAddress, 4|FCEUSTATE_RLSB, "5ADD"},
  { &DMCSize, 4|FCEUSTATE_RLSB, "5SIZ"},
  { &DMCShift, 1, "5SHF"},
+ { &DMCDMABuf, 1, "5DMB"},
 
  { &DMCHaveDMA, 1, "5HVDM"},
  { &DMCHaveSample, 1, "5HVSP"},
@@ -21,6 +21,8 @@
 #ifndef _SOUND_H_
 #define _SOUND_H_
 
+#include "filter.h"
+
 typedef struct {
 	   void (*Fill)(int Count);	/* Low quality ext sound. */
 
@@ -38,27 +40,27 @@ typedef struct {
 	   void (*Kill)(void);
 } EXPSOUND;
 
-extern EXPSOUND GameExpSound;
+extern FCEU_TLS EXPSOUND GameExpSound;
 
-extern int32 nesincsize;
+extern FCEU_TLS int32 nesincsize;
 
 void SetSoundVariables(void);
 
 int GetSoundBuffer(int32 **W);
 int FlushEmulateSound(void);
-extern int32 Wave[2048+512];
-extern int32 WaveFinal[2048+512];
-extern int32 WaveHi[];
-extern uint32 soundtsinc;
+extern FCEU_TLS int32 Wave[2048+512];
+extern FCEU_TLS int32 WaveFinal[2048+512];
+extern FCEU_TLS int32 WaveHi[];
+extern FCEU_TLS uint32 soundtsinc;
 
 #ifdef WIN32
 extern volatile int datacount, undefinedcount;
-extern int debug_loggingCD;
-extern unsigned char *cdloggerdata;
+extern FCEU_TLS int debug_loggingCD;
+extern FCEU_TLS unsigned char *cdloggerdata;
 #endif
 
-extern uint32 soundtsoffs;
-extern bool swapDuty;
+extern FCEU_TLS uint32 soundtsoffs;
+extern FCEU_TLS bool swapDuty;
 #define SOUNDTS (soundtimestamp + soundtsoffs)
 
 void SetNESSoundMap(void);
@@ -66,10 +68,47 @@ void FrameSoundUpdate(void);
 
 void FCEUSND_Power(void);
 void FCEUSND_Reset(void);
+void FCEUSND_AbandonFrame(void);
+
+//what the last flush left for the next frame: the carried-over samples' position
+//and the channels' rendering counters. none of it is in savestates.
+struct FCEUSND_Flushed
+{
+ uint32 bc;
+ int32 carry;
+ int32 sqacc[2];
+ int32 dutycount[2];
+ int32 wlcount[4];
+ int32 tristep;
+ uint32 tricout;
+ int32 triacc,noiseacc;
+};
+
+//the most samples a flush carries over to the next one (see NeoFilterSound)
+#define FCEUSND_MAXLEFTOVER 1025
+
+//everything the sound output stream carries from one frame to the next, outside of savestates.
+//lets several emulated consoles take turns on the one sound core without mixing their streams.
+//expansion sound chips are not covered.
+struct FCEUSND_Output
+{
+ FCEUSND_Flushed flushed;
+ uint32 tsoffs;
+ int32 left[FCEUSND_MAXLEFTOVER];
+ FilterState filter;
+};
+
+//as of the last flush (a frame in progress is not included)
+void FCEUSND_SaveOutput(FCEUSND_Output *out);
+//drops any frame in progress
+void FCEUSND_LoadOutput(const FCEUSND_Output *out);
+//as if nothing had been played yet
+void FCEUSND_ResetOutput(void);
 void FCEUSND_SaveState(void);
 void FCEUSND_LoadState(int version);
 
 void FCEU_SoundCPUHook(int);
+int32 FCEU_SoundCPUHookBudget(void);
 void Write_IRQFM (uint32 A, uint8 V); //mbg merge 7/17/06 brought over from latest mmbuild
 
 void LogDPCM(int romaddress, int dpcmsize);
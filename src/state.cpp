@@ -61,49 +61,49 @@
 
 using namespace std;
 
-static void (*SPreSave)(void);
-static void (*SPostSave)(void);
+static FCEU_TLS void (*SPreSave)(void);
+static FCEU_TLS void (*SPostSave)(void);
 
-static int SaveStateStatus[10];
-static int StateShow;
+static FCEU_TLS int SaveStateStatus[10];
+static FCEU_TLS int StateShow;
 
 //tells the save system innards that we're loading the old format
-bool FCEU_state_loading_old_format;
+FCEU_TLS bool FCEU_state_loading_old_format;
 
-char lastSavestateMade[2048]; //Stores the filename of the last savestate made (needed for UndoSavestate)
-bool undoSS = false;		  //This will be true if there is lastSavestateMade, it was made since ROM was loaded, a backup state for lastSavestateMade exists
-bool redoSS = false;		  //This will be true if UndoSaveState is run, will turn false when a new savestate is made
+FCEU_TLS char lastSavestateMade[2048]; //Stores the filename of the last savestate made (needed for UndoSavestate)
+FCEU_TLS bool undoSS = false;		  //This will be true if there is lastSavestateMade, it was made since ROM was loaded, a backup state for lastSavestateMade exists
+FCEU_TLS bool redoSS = false;		  //This will be true if UndoSaveState is run, will turn false when a new savestate is made
 
-char lastLoadstateMade[2048]; //Stores the filename of the last state loaded (needed for Undo/Redo loadstate)
-bool undoLS = false;		  //This will be true if a backupstate was made and it was made since ROM was loaded
-bool redoLS = false;		  //This will be true if a backupstate was loaded, meaning redoLoadState can be run
+FCEU_TLS char lastLoadstateMade[2048]; //Stores the filename of the last state loaded (needed for Undo/Redo loadstate)
+FCEU_TLS bool undoLS = false;		  //This will be true if a backupstate was made and it was made since ROM was loaded
+FCEU_TLS bool redoLS = false;		  //This will be true if a backupstate was loaded, meaning redoLoadState can be run
 
-bool internalSaveLoad = false;
+FCEU_TLS bool internalSaveLoad = false;
 
-bool backupSavestates = true;
-bool compressSavestates = true;  //By default FCEUX compresses savestates when a movie is inactive.
+FCEU_TLS bool backupSavestates = true;
+FCEU_TLS bool compressSavestates = true;  //By default FCEUX compresses savestates when a movie is inactive.
 
 // a temp memory stream. We'll be dumping some data here and then compress
-EMUFILE_MEMORY memory_savestate;
+FCEU_TLS EMUFILE_MEMORY memory_savestate;
 // temporary buffer for compressed data of a savestate
-std::vector<uint8> compressed_buf;
+FCEU_TLS std::vector<uint8> compressed_buf;
 
 #define SFMDATA_SIZE (64)
-static SFORMAT SFMDATA[SFMDATA_SIZE];
-static int SFEXINDEX;
+static FCEU_TLS SFORMAT SFMDATA[SFMDATA_SIZE];
+static FCEU_TLS int SFEXINDEX;
 
 #define RLSB 		FCEUSTATE_RLSB	//0x80000000
 
 
-extern SFORMAT FCEUPPU_STATEINFO[];
-extern SFORMAT FCEU_NEWPPU_STATEINFO[];
-extern SFORMAT FCEUSND_STATEINFO[];
-extern SFORMAT FCEUCTRL_STATEINFO[];
-extern SFORMAT FCEUMOV_STATEINFO[];
+extern FCEU_TLS SFORMAT FCEUPPU_STATEINFO[];
+extern FCEU_TLS SFORMAT FCEU_NEWPPU_STATEINFO[];
+extern FCEU_TLS SFORMAT FCEUSND_STATEINFO[];
+extern FCEU_TLS SFORMAT FCEUCTRL_STATEINFO[];
+extern FCEU_TLS SFORMAT FCEUMOV_STATEINFO[];
 
 //why two separate CPU structs?? who knows
 
-SFORMAT SFCPU[]={
+FCEU_TLS SFORMAT SFCPU[]={
 	{ &X.PC, 2|RLSB, "PC\0"},
 	{ &X.A, 1, "A\0\0"},
 	{ &X.X, 1, "X\0\0"},
@@ -115,7 +115,7 @@ SFORMAT SFCPU[]={
 	{ 0 }
 };
 
-SFORMAT SFCPUC[]={
+FCEU_TLS SFORMAT SFCPUC[]={
 	{ &X.jammed, 1, "JAMM"},
 	{ &X.IRQlow, 4|RLSB, "IQLB"},
 	{ &X.tcount, 4|RLSB, "ICoa"},
@@ -177,10 +177,18 @@ static int SubWrite(EMUFILE* os, SFORMAT *sf)
 static int WriteStateChunk(EMUFILE* os, int type, SFORMAT *sf)
 {
 	os->fputc(type);
-	int bsize = SubWrite((EMUFILE*)0,sf);
+	//the size is only known once the chunk is written; come back for it
+	//instead of walking the list a second time
+	int sizepos = os->ftell();
+	write32le(0,os);
+
+	int bsize = SubWrite(os,sf);
+	int endpos = os->ftell();
+	os->fseek(sizepos,SEEK_SET);
 	write32le(bsize,os);
+	os->fseek(endpos,SEEK_SET);
 
-	if(!SubWrite(os,sf))
+	if(!bsize)
 	{
 		return 5;
 	}
@@ -242,7 +250,7 @@ static bool ReadStateChunk(EMUFILE* is, SFORMAT *sf, int size)
 	return true;
 }
 
-static int read_sfcpuc=0, read_snd=0;
+static FCEU_TLS int read_sfcpuc=0, read_snd=0;
 
 void FCEUD_BlitScreen(uint8 *XBuf); //mbg merge 7/17/06 YUCKY had to add
 void UpdateFCEUWindow(void);  //mbg merge 7/17/06 YUCKY had to add
@@ -306,7 +314,7 @@ static bool ReadStateChunks(EMUFILE* is, int32 totalsize)
 		case 8:
 			// load back buffer
 			{
-				extern uint8 *XBackBuf;
+				extern FCEU_TLS uint8 *XBackBuf;
 				if(is->fread((char*)XBackBuf,size) != size)
 					ret = false;
 
@@ -351,7 +359,7 @@ static bool ReadStateChunks(EMUFILE* is, int32 totalsize)
 	//   X.mooPI=X.P; // "Quick and dirty hack." //begone
 	// }
 
-	extern int resetDMCacc;
+	extern FCEU_TLS int resetDMCacc;
 	if(read_snd)
 		resetDMCacc=0;
 	else
@@ -360,19 +368,14 @@ static bool ReadStateChunks(EMUFILE* is, int32 totalsize)
 	return ret;
 }
 
-int CurrentState=0;
-extern int geniestage;
+FCEU_TLS int CurrentState=0;
+extern FCEU_TLS int geniestage;
 
 
-bool FCEUSS_SaveMS(EMUFILE* outstream, int compressionLevel)
+//writes every chunk to os and returns their total size.
+//the back buffer is left out unless backbuf is set.
+static uint32 WriteStateChunks(EMUFILE* os, bool backbuf)
 {
-	// reinit memory_savestate
-	// memory_savestate is global variable which already has its vector of bytes, so no need to allocate memory every time we use save/loadstate
-	memory_savestate.set_len(0);	// this also seeks to the beginning
-	memory_savestate.unfail();
-
-	EMUFILE* os = &memory_savestate;
-
 	uint32 totalsize = 0;
 
 	FCEUPPU_SaveState();
@@ -402,8 +405,9 @@ bool FCEUSS_SaveMS(EMUFILE* outstream, int compressionLevel)
 		}
 	}
 	// save back buffer
+	if(backbuf)
 	{
-		extern uint8 *XBackBuf;
+		extern FCEU_TLS uint8 *XBackBuf;
 		uint32 size = 256 * 256 + 8;
 		os->fputc(8);
 		write32le(size, os);
@@ -415,6 +419,18 @@ bool FCEUSS_SaveMS(EMUFILE* outstream, int compressionLevel)
 	totalsize+=WriteStateChunk(os,0x10,SFMDATA);
 	if(SPreSave) SPostSave();
 
+	return totalsize;
+}
+
+bool FCEUSS_SaveMS(EMUFILE* outstream, int compressionLevel)
+{
+	// reinit memory_savestate
+	// memory_savestate is global variable which already has its vector of bytes, so no need to allocate memory every time we use save/loadstate
+	memory_savestate.set_len(0);	// this also seeks to the beginning
+	memory_savestate.unfail();
+
+	uint32 totalsize = WriteStateChunks(&memory_savestate, true);
+
 	//save the length of the file
 	int len = memory_savestate.size();
 
@@ -451,6 +467,420 @@ bool FCEUSS_SaveMS(EMUFILE* outstream, int compressionLevel)
 	return error == Z_OK;
 }
 
+bool FCEUSS_SaveDirect(EMUFILE* outstream, bool backbuf)
+{
+	outstream->unfail();
+	int start = outstream->ftell();
+
+	//the header needs the total size, so leave room for it and fill it in last
+	uint8 header[16]="FCSX";
+	outstream->fwrite((char*)header,16);
+
+	uint32 totalsize = WriteStateChunks(outstream, backbuf);
+
+	FCEU_en32lsb(header+4, totalsize);
+	FCEU_en32lsb(header+8, FCEU_VERSION_NUMERIC);
+	FCEU_en32lsb(header+12, (uint32)-1); //not compressed
+
+	int end = outstream->ftell();
+	outstream->fseek(start,SEEK_SET);
+	outstream->fwrite((char*)header,16);
+	outstream->fseek(end,SEEK_SET);
+
+	return !outstream->fail() && (uint32)(end - start - 16) == totalsize;
+}
+
+//flat states hold the same fields as the chunks above, but each at an offset worked out once
+//per set of registered fields, so that saving and loading is just one memcpy per field.
+//the mapper fields change with the loaded game, so a flat state is only good for the process
+//and the game that made it; the signature catches a mismatched layout.
+//movie state is not included.
+
+#define FLAT_ALIGN 8
+#define FLAT_BACKBUF_SIZE (256 * 256 + 8)
+
+struct FLATHEADER
+{
+	char magic[4];
+	uint32 size;
+	uint64 signature;
+	uint32 backbuf;
+	uint8 pad[FCEUSS_FLAT_HEADER_SIZE - 20];
+};
+
+struct FLATFIELD
+{
+	void *v;
+	uint32 size;
+	bool indirect;
+	uint32 offset;
+	int group;		//FCEUSS_HASH_SKIP_* the field falls under
+	int fixup;		//FLAT_FIXUP_* to run after loading a changed value
+};
+
+//what has to be redone after the fields of a table change under it
+#define FLAT_FIXUP_PPU 1
+#define FLAT_FIXUP_SOUND 2
+#define FLAT_FIXUP_MAPPER 4
+
+static FCEU_TLS std::vector<FLATFIELD> flatfields;
+static FCEU_TLS uint32 flatsize;     //header and fields, without the back buffer
+static FCEU_TLS uint64 flatsig;
+static FCEU_TLS bool flatvalid = false;
+
+//fields that only count time, whatever the game is doing
+static bool IsCounterField(const char *desc)
+{
+	static FCEU_TLS const char *counters[] = { "TSBS", "LAGC", "FRAM" };
+	if(!desc) return false;
+	for(int i=0;i<3;i++)
+		if(!memcmp(desc,counters[i],4))
+			return true;
+	return false;
+}
+
+//mapper memory that the banking only points into, so its contents never need a restore
+static bool IsMapperMemoryField(const char *desc)
+{
+	return desc && (!memcmp(desc,"WRAM",4) || !memcmp(desc,"CHRR",4));
+}
+
+static void AddFlatFields(SFORMAT *sf, int group, int fixup)
+{
+	for(;sf->v;sf++)
+	{
+		if(sf->s==~0)		//Link to another struct
+		{
+			AddFlatFields((SFORMAT *)sf->v, group, fixup);
+			continue;
+		}
+
+		FLATFIELD f;
+		f.v = sf->v;
+		f.size = sf->s&(~FCEUSTATE_FLAGS);
+		f.indirect = (sf->s&FCEUSTATE_INDIRECT) != 0;
+		f.offset = flatsize;
+		f.group = group | (IsCounterField(sf->desc) ? FCEUSS_HASH_SKIP_COUNTERS : 0);
+		f.fixup = (fixup == FLAT_FIXUP_MAPPER && IsMapperMemoryField(sf->desc)) ? 0 : fixup;
+		flatfields.push_back(f);
+		flatsize += (f.size + FLAT_ALIGN - 1) & ~(FLAT_ALIGN - 1);
+
+		//fnv-1a over the names and sizes
+		uint8 key[8] = {0};
+		if(sf->desc) memcpy(key,sf->desc,4);
+		FCEU_en32lsb(key+4,f.size);
+		for(int i=0;i<8;i++)
+		{
+			flatsig ^= key[i];
+			flatsig *= 0x100000001b3ULL;
+		}
+	}
+}
+
+static void UpdateFlatLayout(void)
+{
+	if(flatvalid) return;
+
+	flatfields.clear();
+	flatsize = FCEUSS_FLAT_HEADER_SIZE;
+	flatsig = 0xcbf29ce484222325ULL;
+
+	//same order as the chunks
+	AddFlatFields(SFCPU, 0, 0);
+	AddFlatFields(SFCPUC, 0, 0);
+	AddFlatFields(FCEUPPU_STATEINFO, 0, FLAT_FIXUP_PPU);
+	AddFlatFields(FCEU_NEWPPU_STATEINFO, 0, 0);
+	AddFlatFields(FCEUCTRL_STATEINFO, 0, 0);
+	AddFlatFields(FCEUSND_STATEINFO, FCEUSS_HASH_SKIP_SOUND, FLAT_FIXUP_SOUND);
+	AddFlatFields(SFMDATA, 0, FLAT_FIXUP_MAPPER);
+
+	flatvalid = true;
+}
+
+uint32 FCEUSS_FlatSize(bool backbuf)
+{
+	UpdateFlatLayout();
+	return flatsize + (backbuf ? FLAT_BACKBUF_SIZE : 0);
+}
+
+void FCEUSS_SaveFlat(uint8 *buf, bool backbuf)
+{
+	UpdateFlatLayout();
+
+	FLATHEADER *header = (FLATHEADER *)buf;
+	memcpy(header->magic,"FCSF",4);
+	header->size = FCEUSS_FlatSize(backbuf);
+	header->signature = flatsig;
+	header->backbuf = backbuf;
+
+	FCEUPPU_SaveState();
+	FCEUSND_SaveState();
+	if(SPreSave) SPreSave();
+
+	for(size_t i=0;i<flatfields.size();i++)
+	{
+		const FLATFIELD &f = flatfields[i];
+		memcpy(buf + f.offset, f.indirect ? *(void **)f.v : f.v, f.size);
+	}
+
+	if(SPostSave) SPostSave();
+
+	if(backbuf)
+	{
+		extern FCEU_TLS uint8 *XBackBuf;
+		memcpy(buf + flatsize, XBackBuf, FLAT_BACKBUF_SIZE);
+	}
+}
+
+uint32 FCEUSS_FlatOffsetOf(const void *p, uint32 size)
+{
+	UpdateFlatLayout();
+
+	const uint8 *q = (const uint8 *)p;
+	for(size_t i=0;i<flatfields.size();i++)
+	{
+		const FLATFIELD &f = flatfields[i];
+		const uint8 *v = (const uint8 *)(f.indirect ? *(void **)f.v : f.v);
+		if(q >= v && q + size <= v + f.size)
+			return f.offset + (uint32)(q - v);
+	}
+	return 0;
+}
+
+bool FCEUSS_CheckFlat(const uint8 *buf, uint32 size)
+{
+	UpdateFlatLayout();
+
+	const FLATHEADER *header = (const FLATHEADER *)buf;
+	if(size < FCEUSS_FLAT_HEADER_SIZE || memcmp(header->magic,"FCSF",4) || header->size != size)
+		return false;
+	return header->signature == flatsig && size == FCEUSS_FlatSize(header->backbuf != 0);
+}
+
+bool FCEUSS_LoadFlat(const uint8 *buf, uint32 size)
+{
+	if(!FCEUSS_CheckFlat(buf,size))
+		return false;
+
+	const FLATHEADER *header = (const FLATHEADER *)buf;
+	FCEUMOV_PreLoad();
+
+	for(size_t i=0;i<flatfields.size();i++)
+	{
+		const FLATFIELD &f = flatfields[i];
+		memcpy(f.indirect ? *(void **)f.v : f.v, buf + f.offset, f.size);
+	}
+
+	if(header->backbuf)
+	{
+		extern FCEU_TLS uint8 *XBackBuf;
+		memcpy(XBackBuf, buf + flatsize, FLAT_BACKBUF_SIZE);
+	}
+
+	//what ReadStateChunks and FCEUSS_LoadFP do after reading every chunk
+	extern FCEU_TLS int resetDMCacc;
+	resetDMCacc=0;
+	if(GameStateRestore)
+		GameStateRestore(FCEU_VERSION_NUMERIC);
+	FCEUPPU_LoadState(FCEU_VERSION_NUMERIC);
+	FCEUSND_LoadState(FCEU_VERSION_NUMERIC);
+	return FCEUMOV_PostLoad();
+}
+
+template<typename T>
+static inline bool DiffCopyWord(uint8 *dst, const uint8 *src)
+{
+	T a, b;
+	memcpy(&a,dst,sizeof(T));
+	memcpy(&b,src,sizeof(T));
+	if(a == b) return false;
+	memcpy(dst,&b,sizeof(T));
+	return true;
+}
+
+//copies the 64 byte blocks of src that differ from dst. returns whether any did.
+//most fields are single registers, so those are compared inline rather than through memcmp
+static inline bool DiffCopy(uint8 *dst, const uint8 *src, uint32 size)
+{
+	switch(size)
+	{
+	case 1: return DiffCopyWord<uint8>(dst,src);
+	case 2: return DiffCopyWord<uint16>(dst,src);
+	case 4: return DiffCopyWord<uint32>(dst,src);
+	case 8: return DiffCopyWord<uint64>(dst,src);
+	}
+
+	//memcmp is much faster than a word loop over the big memories, which mostly match
+	if(!memcmp(dst,src,size))
+		return false;
+	if(size <= 256)
+	{
+		memcpy(dst,src,size);
+		return true;
+	}
+	for(uint32 span=0;span<size;span+=1024)
+	{
+		uint32 end = size-span < 1024 ? size : span+1024;
+		if(!memcmp(dst+span,src+span,end-span))
+			continue;
+		for(uint32 pos=span;pos<end;pos+=64)
+		{
+			uint32 n = end-pos < 64 ? end-pos : 64;
+			if(memcmp(dst+pos,src+pos,n))
+				memcpy(dst+pos,src+pos,n);
+		}
+	}
+	return true;
+}
+
+bool FCEUSS_LoadFlatDiff(const uint8 *buf, uint32 size)
+{
+	if(!FCEUSS_CheckFlat(buf,size))
+		return false;
+
+	//a mapper that converts its state around saving can't be compared in place
+	if(SPreSave)
+		return FCEUSS_LoadFlat(buf,size);
+
+	const FLATHEADER *header = (const FLATHEADER *)buf;
+	FCEUMOV_PreLoad();
+
+	//bring the save-side copies up to date so they compare against the live values
+	FCEUPPU_SaveState();
+	FCEUSND_SaveState();
+
+	int fixups = 0;
+	for(size_t i=0;i<flatfields.size();i++)
+	{
+		const FLATFIELD &f = flatfields[i];
+		if(DiffCopy((uint8 *)(f.indirect ? *(void **)f.v : f.v), buf + f.offset, f.size))
+			fixups |= f.fixup;
+	}
+
+	if(header->backbuf)
+	{
+		extern FCEU_TLS uint8 *XBackBuf;
+		DiffCopy(XBackBuf, buf + flatsize, FLAT_BACKBUF_SIZE);
+	}
+
+	extern FCEU_TLS int resetDMCacc;
+	resetDMCacc=0;
+	if((fixups & FLAT_FIXUP_MAPPER) && GameStateRestore)
+		GameStateRestore(FCEU_VERSION_NUMERIC);
+	if(fixups & FLAT_FIXUP_PPU)
+		FCEUPPU_LoadState(FCEU_VERSION_NUMERIC);
+	if(fixups & FLAT_FIXUP_SOUND)
+		FCEUSND_LoadState(FCEU_VERSION_NUMERIC);
+	return FCEUMOV_PostLoad();
+}
+
+#define HASH_K0 0x9E3779B97F4A7C15ULL
+#define HASH_K1 0xC2B2AE3D27D4EB4FULL
+
+static inline uint64 HashMix(uint64 h, uint64 w, uint64 k)
+{
+	h = (h ^ w) * k;
+	return h ^ (h >> 29);
+}
+
+//the fields are hashed as one stream, 32 bytes at a time over four independent lanes
+//so that the multiplies of the big fields overlap. the layout is fixed by the signature,
+//so the field boundaries need not be marked.
+struct HASHSTATE
+{
+	uint64 lane[4];
+	uint8 buf[32];
+	uint32 n;
+};
+
+static inline void HashBlock(HASHSTATE *hs, const uint8 *p)
+{
+	uint64 w[4];
+	memcpy(w,p,32);
+	hs->lane[0] = HashMix(hs->lane[0],w[0],HASH_K0);
+	hs->lane[1] = HashMix(hs->lane[1],w[1],HASH_K0);
+	hs->lane[2] = HashMix(hs->lane[2],w[2],HASH_K1);
+	hs->lane[3] = HashMix(hs->lane[3],w[3],HASH_K1);
+}
+
+static void HashFeed(HASHSTATE *hs, const uint8 *p, uint32 size)
+{
+	if(hs->n)
+	{
+		uint32 take = std::min<uint32>(32 - hs->n, size);
+		memcpy(hs->buf + hs->n, p, take);
+		hs->n += take;
+		p += take;
+		size -= take;
+		if(hs->n < 32) return;
+		HashBlock(hs, hs->buf);
+		hs->n = 0;
+	}
+	//the lanes are kept in locals here: stored through hs they could alias p
+	uint64 a=hs->lane[0], b=hs->lane[1], c=hs->lane[2], d=hs->lane[3];
+	for(;size>=32;p+=32,size-=32)
+	{
+		uint64 w[4];
+		memcpy(w,p,32);
+		a = HashMix(a,w[0],HASH_K0);
+		b = HashMix(b,w[1],HASH_K0);
+		c = HashMix(c,w[2],HASH_K1);
+		d = HashMix(d,w[3],HASH_K1);
+	}
+	hs->lane[0]=a; hs->lane[1]=b; hs->lane[2]=c; hs->lane[3]=d;
+	memcpy(hs->buf, p, size);
+	hs->n = size;
+}
+
+void FCEUSS_HashState(uint64 out[2], int skip)
+{
+	UpdateFlatLayout();
+
+	HASHSTATE hs;
+	hs.lane[0] = flatsig;
+	hs.lane[1] = ~flatsig;
+	hs.lane[2] = flatsig ^ HASH_K0;
+	hs.lane[3] = flatsig ^ HASH_K1;
+	hs.n = 0;
+
+	FCEUPPU_SaveState();
+	FCEUSND_SaveState();
+	if(SPreSave) SPreSave();
+
+	for(size_t i=0;i<flatfields.size();i++)
+	{
+		const FLATFIELD &f = flatfields[i];
+		if(f.group & skip) continue;
+		HashFeed(&hs, (const uint8 *)(f.indirect ? *(void **)f.v : f.v), f.size);
+	}
+
+	if(SPostSave) SPostSave();
+
+	//timestamp is 0 at every frame boundary, where scanline is not kept track of.
+	//past it, both tell apart states taken mid-frame
+	if(timestamp)
+	{
+		uint8 pos[8];
+		FCEU_en32lsb(pos, timestamp);
+		FCEU_en32lsb(pos+4, scanline);
+		HashFeed(&hs, pos, 8);
+	}
+
+	//the skipped groups change what a stream of the same length means
+	uint8 tail[8] = {0};
+	FCEU_en32lsb(tail, skip);
+	HashFeed(&hs, tail, 8);
+	if(hs.n)
+	{
+		memset(hs.buf + hs.n, 0, 32 - hs.n);
+		HashBlock(&hs, hs.buf);
+	}
+
+	out[0] = HashMix(HashMix(hs.lane[0], hs.lane[1], HASH_K0), hs.lane[2] ^ hs.lane[3], HASH_K0);
+	out[1] = HashMix(HashMix(hs.lane[2], hs.lane[3], HASH_K1), hs.lane[0] ^ out[0], HASH_K1);
+}
+
+
 
 void FCEUSS_Save(const char *fname, bool display_message)
 {
@@ -800,7 +1230,7 @@ bool FCEUSS_Load(const char *fname, bool display_message)
 #endif
 
 		//Update input display if movie is loaded
-		extern uint32 cur_input_display;
+		extern FCEU_TLS uint32 cur_input_display;
 		extern uint8 FCEU_GetJoyJoy(void);
 
 		cur_input_display = FCEU_GetJoyJoy(); //Input display should show the last buttons pressed (stored in the savestate)
@@ -852,16 +1282,25 @@ void ResetExState(void (*PreSave)(void), void (*PostSave)(void))
 	}
 	// adelikat, 3/14/09:  had to add this to clear out the size parameter.  NROM(mapper 0) games were having savestate crashes if loaded after a non NROM game	because the size variable was carrying over and causing savestates to save too much data
 	SFMDATA[0].s = 0;
+	//and the end marker: the entries after it still point into the previous game
+	SFMDATA[0].v = 0;
 
 	SPreSave = PreSave;
 	SPostSave = PostSave;
 	SFEXINDEX=0;
+	flatvalid = false;
 }
 
 void AddExState(void *v, uint32 s, int type, const char *desc)
 {
 	if(s==~0)
 	{
+		//the expansion sound init functions run again on every sound rate change
+		//and would keep adding the same table
+		for(int x=0;x<SFEXINDEX;x++)
+			if(SFMDATA[x].v==v && SFMDATA[x].s==~0)
+				return;
+
 		SFORMAT* sf = (SFORMAT*)v;
 		std::map<std::string,bool> names;
 		while(sf->v)
@@ -897,7 +1336,7 @@ void AddExState(void *v, uint32 s, int type, const char *desc)
 		SFEXINDEX++;
 	else
 	{
-		static int once=1;
+		static FCEU_TLS int once=1;
 		if(once)
 		{
 			once=0;
@@ -905,6 +1344,7 @@ void AddExState(void *v, uint32 s, int type, const char *desc)
 		}
 	}
 	SFMDATA[SFEXINDEX].v=0;		// End marker.
+	flatvalid = false;
 }
 
 void FCEUI_SelectStateNext(int n)
@@ -940,7 +1380,7 @@ void FCEUI_SaveState(const char *fname, bool display_message)
 	FCEUSS_Save(fname, display_message);
 }
 
-int loadStateFailed = 0; // hack, this function should return a value instead
+FCEU_TLS int loadStateFailed = 0; // hack, this function should return a value instead
 
 bool file_exists(const char * filename)
 {
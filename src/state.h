@@ -30,9 +30,41 @@ bool FCEUSS_Load(const char *, bool display_message=true);
  //zlib values: 0 (none) through 9 (max) or -1 (default)
 bool FCEUSS_SaveMS(EMUFILE* outstream, int compressionLevel);
 
+//writes an uncompressed state straight into outstream, which must be seekable,
+//without staging it in memory first. the back buffer is only saved if backbuf is set;
+//loading a state without it leaves the back buffer as it is.
+bool FCEUSS_SaveDirect(EMUFILE* outstream, bool backbuf);
+
+//flat states: the same fields at fixed offsets, saved and loaded with plain memcpys.
+//only good for the process and the loaded game that made them (see state.cpp).
+//buf must be FCEUSS_FlatSize(backbuf) bytes; the fields start FCEUSS_FLAT_HEADER_SIZE bytes in,
+//so a buffer aligned to a cache line keeps them aligned too.
+#define FCEUSS_FLAT_HEADER_SIZE 64
+uint32 FCEUSS_FlatSize(bool backbuf);
+void FCEUSS_SaveFlat(uint8 *buf, bool backbuf);
+bool FCEUSS_LoadFlat(const uint8 *buf, uint32 size);
+//true if FCEUSS_LoadFlat would accept buf; it fails only when this does, before changing anything.
+bool FCEUSS_CheckFlat(const uint8 *buf, uint32 size);
+
+//loads a flat state like FCEUSS_LoadFlat, but only writes the blocks that differ from the
+//live state, and only redoes the mapper banking and ppu/apu fixups for tables that changed.
+//the live state must be one the core reached by itself or by loading, so that its banking
+//matches its mapper registers.
+bool FCEUSS_LoadFlatDiff(const uint8 *buf, uint32 size);
+
+//the offset in a flat state where the size bytes at p are saved, or 0 if no one field holds them all.
+uint32 FCEUSS_FlatOffsetOf(const void *p, uint32 size);
+
+//a 128-bit hash of the fields a flat state holds, read in place.
+//skip leaves out groups of fields: the ones that only count time (timestampbase, lag and frame
+//counters) and the APU table.
+#define FCEUSS_HASH_SKIP_COUNTERS 1
+#define FCEUSS_HASH_SKIP_SOUND 2
+void FCEUSS_HashState(uint64 out[2], int skip);
+
 bool FCEUSS_LoadFP(EMUFILE* is, ENUM_SSLOADPARAMS params);
 
-extern int CurrentState;
+extern FCEU_TLS int CurrentState;
 void FCEUSS_CheckStates(void);
 
 struct SFORMAT
@@ -67,13 +99,13 @@ void LoadBackup();					 //Loads the backupsavestate
 void RedoLoadState();				 //reloads a loadstate if backupsavestate was run
 void SwapSaveState();				 //Swaps a savestate with its backup state
 
-extern char lastSavestateMade[2048]; //Filename of last savestate used
-extern bool undoSS;					 //undo savestate flag
-extern bool redoSS;					 //redo savestate flag
-extern char lastLoadstateMade[2048]; //Filename of last state loaded
-extern bool undoLS;					 //undo loadstate flag
-extern bool redoLS;					 //redo savestate flag
-extern bool backupSavestates;		 //Whether or not to make backups, true by default
+extern FCEU_TLS char lastSavestateMade[2048]; //Filename of last savestate used
+extern FCEU_TLS bool undoSS;					 //undo savestate flag
+extern FCEU_TLS bool redoSS;					 //redo savestate flag
+extern FCEU_TLS char lastLoadstateMade[2048]; //Filename of last state loaded
+extern FCEU_TLS bool undoLS;					 //undo loadstate flag
+extern FCEU_TLS bool redoLS;					 //redo savestate flag
+extern FCEU_TLS bool backupSavestates;		 //Whether or not to make backups, true by default
 bool CheckBackupSaveStateExist();	 //Checks if backupsavestate exists
 
-extern bool compressSavestates;		//Whether or not to compress non-movie savestates (by default, yes)
+extern FCEU_TLS bool compressSavestates;		//Whether or not to compress non-movie savestates (by default, yes)
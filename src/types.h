@@ -46,6 +46,21 @@ typedef uint64_t uint64;
 #define DEBUG(X)
 #endif
 
+///marks a global that is part of the emulation state. the library build defines FCEU_TLS_CORE so that
+///every thread gets a core of its own and independent consoles can run in parallel (see lib.cpp).
+///the frontends read core state from their gui threads, so there it stays an ordinary global.
+#ifdef FCEU_TLS_CORE
+ #if defined(__cplusplus)
+  #define FCEU_TLS thread_local
+ #elif defined(_MSC_VER)
+  #define FCEU_TLS __declspec(thread)
+ #else
+  #define FCEU_TLS _Thread_local
+ #endif
+#else
+ #define FCEU_TLS
+#endif
+
 #ifdef MSVC
 #define dup _dup
 #define stat _stat
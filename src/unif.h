@@ -161,5 +161,5 @@ void BMCHPxx_Init(CartInfo *info);
 void MINDKIDS_Init(CartInfo *info);
 void FNS_Init(CartInfo *info);
 
-extern uint8 *UNIFchrrama;	// Meh.  So I can stop CHR RAM
+extern FCEU_TLS uint8 *UNIFchrrama;	// Meh.  So I can stop CHR RAM
 							// bank switcherooing with certain boards...
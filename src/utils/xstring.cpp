@@ -444,7 +444,7 @@ void splitpath(const char* path, char* drv, char* dir, char* name, char* ext)
 //for the curious, I tested U16ToHexStr and it was 10x faster than printf.
 //so the author of these dedicated functions is not insane, and I will leave them.
 
-static char TempArray[11];
+static FCEU_TLS char TempArray[11];
 
 uint16 FastStrToU16(char* s, bool& valid)
 {
@@ -62,25 +62,25 @@
 //64-127 is the most-used emphasis setting per frame
 //128-195 is the palette with no emphasis
 //196-255 is the palette with all emphasis bits on
-u8 *XBuf=NULL; //used for current display
-u8 *XBackBuf=NULL; //ppu output is stashed here before drawing happens
-u8 *XDBuf=NULL; //corresponding to XBuf but with deemph bits
-u8 *XDBackBuf=NULL; //corresponding to XBackBuf but with deemph bits
-int ClipSidesOffset=0;	//Used to move displayed messages when Clips left and right sides is checked
-static u8 *xbsave=NULL;
+FCEU_TLS u8 *XBuf=NULL; //used for current display
+FCEU_TLS u8 *XBackBuf=NULL; //ppu output is stashed here before drawing happens
+FCEU_TLS u8 *XDBuf=NULL; //corresponding to XBuf but with deemph bits
+FCEU_TLS u8 *XDBackBuf=NULL; //corresponding to XBackBuf but with deemph bits
+FCEU_TLS int ClipSidesOffset=0;	//Used to move displayed messages when Clips left and right sides is checked
+static FCEU_TLS u8 *xbsave=NULL;
 
-GUIMESSAGE guiMessage;
-GUIMESSAGE subtitleMessage;
+FCEU_TLS GUIMESSAGE guiMessage;
+FCEU_TLS GUIMESSAGE subtitleMessage;
 
 //for input display
-extern int input_display;
-extern uint32 cur_input_display;
+extern FCEU_TLS int input_display;
+extern FCEU_TLS uint32 cur_input_display;
 
-bool oldInputDisplay = false;
+FCEU_TLS bool oldInputDisplay = false;
 
-unsigned int lastu = 0;
+FCEU_TLS unsigned int lastu = 0;
 
-std::string AsSnapshotName ="";			//adelikat:this will set the snapshot name when for s savesnapshot as function
+FCEU_TLS std::string AsSnapshotName ="";			//adelikat:this will set the snapshot name when for s savesnapshot as function
 
 void FCEUI_SetSnapshotAsName(std::string name) { AsSnapshotName = name; }
 std::string FCEUI_GetSnapshotAsName() { return AsSnapshotName; }
@@ -158,7 +158,7 @@ void FCEU_PutImageDummy(void)
 }
 #endif
 
-static int dosnapsave=0;
+static FCEU_TLS int dosnapsave=0;
 void FCEUI_SaveSnapshot(void)
 {
 	dosnapsave=1;
@@ -271,7 +271,7 @@ void FCEU_PutImage(void)
 	//Fancy input display code
 	if(input_display)
 	{
-		extern uint32 JSAutoHeld;
+		extern FCEU_TLS uint32 JSAutoHeld;
 		int i, j;
 		uint8 *t = XBuf+(FSettings.LastSLine-9)*256 + 20;		//mbg merge 7/17/06 changed t to uint8*
 		if(input_display > 4) input_display = 4;
@@ -635,7 +635,7 @@ int SaveSnapshot(char fileName[512])
 	}
 
 	{
-		static uint8 header[8]={137,80,78,71,13,10,26,10};
+		static FCEU_TLS uint8 header[8]={137,80,78,71,13,10,26,10};
 		if(fwrite(header,8,1,pp)!=1)
 			goto PNGerr;
 	}
@@ -716,7 +716,7 @@ void ResetScreenshotsCounter()
 
 uint64 FCEUD_GetTime(void);
 uint64 FCEUD_GetTimeFreq(void);
-bool Show_FPS = false;
+FCEU_TLS bool Show_FPS = false;
 // Control whether the frames per second of the emulation is rendered.
 bool FCEUI_ShowFPS()
 {
@@ -731,8 +731,8 @@ void FCEUI_ToggleShowFPS()
 	Show_FPS ^= 1;
 }
 
-static uint64 boop[60];
-static int boopcount = 0;
+static FCEU_TLS uint64 boop[60];
+static FCEU_TLS int boopcount = 0;
 
 void ShowFPS(void)
 {
@@ -7,12 +7,12 @@ int SaveSnapshot(char[]);
 void ResetScreenshotsCounter();
 uint32 GetScreenPixel(int x, int y, bool usebackup);
 int GetScreenPixelPalette(int x, int y, bool usebackup);
-extern uint8 *XBuf;
-extern uint8 *XBackBuf;
-extern uint8 *XDBuf;
-extern uint8 *XDBackBuf;
-extern int ClipSidesOffset;
-extern struct GUIMESSAGE
+extern FCEU_TLS uint8 *XBuf;
+extern FCEU_TLS uint8 *XBackBuf;
+extern FCEU_TLS uint8 *XDBuf;
+extern FCEU_TLS uint8 *XDBackBuf;
+extern FCEU_TLS int ClipSidesOffset;
+extern FCEU_TLS struct GUIMESSAGE
 {
 	//countdown for gui messages
 	int howlong;
@@ -28,7 +28,7 @@ extern struct GUIMESSAGE
 
 } guiMessage;
 
-extern GUIMESSAGE subtitleMessage;
+extern FCEU_TLS GUIMESSAGE subtitleMessage;
 
 void FCEU_DrawNumberRow(uint8 *XBuf, int *nstatus, int cur);
 
@@ -44,10 +44,10 @@ typedef struct {
 	int predip;
 } VSUNIENTRY;
 
-VSUNIENTRY *curvs;
+FCEU_TLS VSUNIENTRY *curvs;
 
-static uint8 DIPS = 0;
-uint8 vsdip = 0;
+static FCEU_TLS uint8 DIPS = 0;
+FCEU_TLS uint8 vsdip = 0;
 
 void FCEUI_VSUniToggleDIPView(void) {
 	DIPS = !DIPS;
@@ -66,7 +66,7 @@ uint8 FCEUI_VSUniGetDIPs(void) {
 	return(vsdip);
 }
 
-static uint8 secdata[2][32] =
+static FCEU_TLS uint8 secdata[2][32] =
 {
 	{
 		0xff, 0xbf, 0xb7, 0x97, 0x97, 0x17, 0x57, 0x4f,
@@ -82,9 +82,9 @@ static uint8 secdata[2][32] =
 	}
 };
 
-static uint8 *secptr;
+static FCEU_TLS uint8 *secptr;
 
-static uint8 VSindex;
+static FCEU_TLS uint8 VSindex;
 
 static DECLFR(VSSecRead) {
 	switch (A) {
@@ -93,14 +93,14 @@ static DECLFR(VSSecRead) {
 	}
 	return(0x00);
 }
-uint8 coinon = 0;
+FCEU_TLS uint8 coinon = 0;
 
 void FCEU_VSUniCoin(void) {
 	coinon = 6;
 }
 
-static int curppu;
-static int64 curmd5;
+static FCEU_TLS int curppu;
+static FCEU_TLS int64 curmd5;
 
 #define RP2C04_001      1
 #define RP2C04_002      2
@@ -112,8 +112,8 @@ static int64 curmd5;
 #define RC2C05_03       8
 #define RC2C05_04       9
 
-static readfunc OldReadPPU;
-static writefunc OldWritePPU[2];
+static FCEU_TLS readfunc OldReadPPU;
+static FCEU_TLS writefunc OldWritePPU[2];
 
 static DECLFR(A2002_Gumshoe) {
 	return((OldReadPPU(A) & ~0x3F) | 0x1C);
@@ -130,7 +130,7 @@ static DECLFR(A2002_MBJ) { // Mighty Bomb Jack
 static DECLFW(B2000_2001_2C05) {
 	OldWritePPU[(A & 1) ^ 1](A ^ 1, V);
 }
-static uint8 xevselect = 0;
+static FCEU_TLS uint8 xevselect = 0;
 static DECLFR(XevRead) {
 	if (A == 0x54FF) {
 		return(0x5);
@@ -250,7 +250,7 @@ RC2C05-04:
 - Top Gun
 */
 
-VSUNIENTRY VSUniGames[] =
+FCEU_TLS VSUNIENTRY VSUniGames[] =
 {
 	{ "Baseball", 0x691d4200ea42be45ULL, 99, 2, RP2C04_001, 0 },
 	{ "Battle City", 0x8540949d74c4d0ebULL, 99, 2, RP2C04_001, 0 },
@@ -313,7 +313,7 @@ void FCEU_VSUniCheck(uint64 md5partial, int *MapperNo, uint8 *Mirroring) {
 			secptr = 0;
 
 			{
-				static int64 tko = 0x6e1ee06171d8ce3aULL, rbi = 0x6a02d345812938afULL;
+				static FCEU_TLS int64 tko = 0x6e1ee06171d8ce3aULL, rbi = 0x6a02d345812938afULL;
 				if (md5partial == tko)
 					secptr = secdata[0];
 				if (md5partial == rbi)
@@ -368,7 +368,7 @@ void FCEU_VSUniDraw(uint8 *XBuf) {
 }
 
 
-SFORMAT FCEUVSUNI_STATEINFO[] = {
+FCEU_TLS SFORMAT FCEUVSUNI_STATEINFO[] = {
 	{ &vsdip, 1, "vsdp" },
 	{ &coinon, 1, "vscn" },
 	{ &VSindex, 1, "vsin" },
@@ -28,14 +28,27 @@
 #endif
 
 #include "driver.h"
+#include "cart.h"
 
 #include "x6502abbrev.h"
 
 #include <cstring>
-X6502 X;
-uint32 timestamp;
-uint32 soundtimestamp;
-void (*MapIRQHook)(int a);
+FCEU_TLS X6502 X;
+FCEU_TLS uint32 timestamp;
+FCEU_TLS uint32 soundtimestamp;
+FCEU_TLS void (*MapIRQHook)(int a);
+FCEU_TLS int32 (*MapIRQHookBudget)(void);
+
+//cycles owed to MapIRQHook and FCEU_SoundCPUHook, and how many may be owed before they must be paid
+static FCEU_TLS int32 hookcycles;
+static FCEU_TLS int32 hookbudget;
+static FCEU_TLS uint32 hookruns;
+
+FCEU_TLS bool X6502_IdleSkip;
+FCEU_TLS uint64 X6502_IdleCyclesSkipped;
+
+FCEU_TLS X6502_WriteTracker *X6502_WriteTrack;
+FCEU_TLS X6502_WriteWatch *X6502_WatchWrites;
 
 #define ADDCYC(x) \
 {                 \
@@ -49,30 +62,114 @@ void (*MapIRQHook)(int a);
 //normal memory read
 static INLINE uint8 RdMem(unsigned int A)
 {
+ if(A<0x2000 && RAMDirect)
+  return(_DB=RAM[A&0x7FF]);
+ if(PRGDirect[A>>11])
+  return(_DB=Page[A>>11][A]);
  return(_DB=ARead[A](A));
 }
 
+//the byte a tracked write at A may change, as far as it can be seen without side effects:
+//internal ram, or a ram page the cart maps from $6000 up. null for anything else
+static INLINE uint8 *TrackByte(unsigned int A)
+{
+ if(A<0x2000)
+  return &RAM[A&0x7FF];
+ if(A>=0x6000 && PRGIsRAM[A>>11] && Page[A>>11])
+  return &Page[A>>11][A];
+ return 0;
+}
+
+//called after the write to A. p is TrackByte(A) and old what it held, both from before the write
+static void TrackWrite(unsigned int A, uint8 *p, uint8 old)
+{
+ X6502_WriteTracker *t=X6502_WriteTrack;
+ X6502_WriteWatch *w=X6502_WatchWrites;
+ uint32 bit;
+
+ //tracking may have been turned off while this loop was suspended in a hook
+ if(!t && !w)
+  return;
+ if(t && t->wram_bits && A>=0x6000)
+ {
+  if(p>=t->wram && p<t->wram+t->wram_size)
+  {
+   uint32 n=(uint32)(p-t->wram);
+   t->wram_bits[n>>3]|=1<<(n&7);
+  }
+  else if(!p && A<0x8000)
+   t->wram_unknown=1;
+ }
+ //the bitmap and the log only cover $6000-$7FFF of the cart's ram pages
+ if(!p || A>=0x8000)
+  return;
+ //every store in range counts, whatever the handler did with it (it may have gated the ram).
+ //old and new are only the log's payload
+ if(A<0x2000)
+  bit=A&0x7FF;
+ else
+  bit=0x800+(A-0x6000);
+
+ if(t)
+ {
+  t->bits[bit>>3]|=1<<(bit&7);
+  if(t->log)
+  {
+   X6502_WriteLogEntry &e=t->log[t->log_head];
+   e.cycle=timestampbase+timestamp;
+   e.addr=A<0x2000 ? (A&0x7FF) : A;
+   e.old_value=old;
+   e.new_value=*p;
+   e.reserved=0;
+   if(++t->log_head==t->log_capacity)
+    t->log_head=0;
+   t->log_count++;
+  }
+ }
+ if(w && (w->bits[bit>>3]>>(bit&7)&1))
+  w->fn(w->data,A);
+}
+
 //normal memory write
+template<bool LuaHooks, bool WriteTrack>
 static INLINE void WrMem(unsigned int A, uint8 V)
 {
-	BWrite[A](A,V);
+	uint8 *p=0, old=0;
+	if(WriteTrack && (p=TrackByte(A)))
+		old=*p;
+	if(A<0x2000 && RAMDirect)
+		RAM[A&0x7FF]=V;
+	else
+		BWrite[A](A,V);
+	if(WriteTrack)
+		TrackWrite(A,p,old);
 	#ifdef _S9XLUA_H
-	CallRegisteredLuaMemHook(A, 1, V, LUAMEMHOOK_WRITE);
+	if(LuaHooks)
+		CallRegisteredLuaMemHook(A, 1, V, LUAMEMHOOK_WRITE);
 	#endif
 }
 
 static INLINE uint8 RdRAM(unsigned int A)
 {
   //bbit edited: this was changed so cheat substituion would work
+  //(the handler is only needed while something has actually hooked ram)
+  if(RAMDirect)
+   return(_DB=RAM[A]);
   return(_DB=ARead[A](A));
-  // return(_DB=RAM[A]);
 }
 
+template<bool LuaHooks, bool WriteTrack>
 static INLINE void WrRAM(unsigned int A, uint8 V)
 {
+	uint8 old=0;
+	if(WriteTrack)
+		old=RAM[A];
 	RAM[A]=V;
+	if(WriteTrack)
+		TrackWrite(A,&RAM[A],old);
 	#ifdef _S9XLUA_H
-	CallRegisteredLuaMemHook(A, 1, V, LUAMEMHOOK_WRITE);
+	if(LuaHooks)
+		CallRegisteredLuaMemHook(A, 1, V, LUAMEMHOOK_WRITE);
 	#endif
 }
 
@@ -85,7 +182,14 @@ uint8 X6502_DMR(uint32 A)
 void X6502_DMW(uint32 A, uint8 V)
 {
  ADDCYC(1);
- BWrite[A](A,V);
+ if(X6502_WriteTrack || X6502_WatchWrites)
+ {
+  uint8 *p=TrackByte(A), old=p ? *p : 0;
+  BWrite[A](A,V);
+  TrackWrite(A,p,old);
+ }
+ else
+  BWrite[A](A,V);
  #ifdef _S9XLUA_H
  CallRegisteredLuaMemHook(A, 1, V, LUAMEMHOOK_WRITE);
  #endif
@@ -94,13 +198,13 @@ void X6502_DMW(uint32 A, uint8 V)
 #define PUSH(V) \
 {       \
  uint8 VTMP=V;  \
- WrRAM(0x100+_S,VTMP);  \
+ WrRAM<LuaHooks,WriteTrack>(0x100+_S,VTMP);  \
  _S--;  \
 }
 
 #define POP() RdRAM(0x100+(++_S))
 
-static uint8 ZNTable[256];
+static FCEU_TLS uint8 ZNTable[256];
 /* Some of these operations will only make sense if you know what the flag
    constants are. */
 
@@ -120,6 +224,8 @@ static uint8 ZNTable[256];
   _PC+=disp;  \
   if((tmp^_PC)&0x100)  \
   ADDCYC(1);  \
+  if(IdleSkip && disp<0)  \
+   instructions+=IdleBranch(tmp-2,instructions);  \
  }  \
  else _PC++;  \
 }
@@ -301,43 +407,99 @@ static uint8 ZNTable[256];
  RdMem((target&0x00FF)|(rt&0xFF00));  \
 }
 
+//everything done between leaving one opcode and entering the next, unless an
+//interrupt or the end of the timeslice needs the top of the loop first
+#ifdef _S9XLUA_H
+#define LUAEXECHOOK() if(LuaHooks) CallRegisteredLuaMemHook(_PC, 1, 0, LUAMEMHOOK_EXEC)
+#else
+#define LUAEXECHOOK()
+#endif
+
+//(DebugCycle will probably cause a major speed decrease on low-end systems)
+#define FETCH()  \
+{  \
+ if(Debugger)  \
+  DEBUG( DebugCycle() );  \
+ if(Debugger || LuaHooks)  \
+  IncrementInstructionsCounters();  \
+ else  \
+  instructions++;  \
+ _PI=_P;  \
+ b1=RdMem(_PC);  \
+ ADDCYC(CycTable[b1]);  \
+ temp=_tcount;  \
+ _tcount=0;  \
+ hookcycles+=temp;  \
+ if(hookcycles>=hookbudget)  \
+  RunHooks();  \
+ LUAEXECHOOK();  \
+ if(ClientHook)  \
+  FCEUD_CallHookBeforeExec(_PC);  \
+ _PC++;  \
+}
+
+//ops.inc labels each opcode with OP() and leaves it with NEXT.
+//the threaded build jumps from the end of each opcode straight into the next
+//one through OpLabels, so every opcode gets its own indirect branch to predict
+//instead of all of them sharing the one in the switch.
+#ifdef FCEU_THREADED_DISPATCH
+#define OP(n) case n: op_##n:
+#define NEXT  \
+{  \
+ if(_count>0 && !_IRQlow)  \
+ {  \
+  FETCH();  \
+  goto *OpLabels[b1];  \
+ }  \
+ break;  \
+}
+#define OPL(h)  \
+ &&op_0x##h##0, &&op_0x##h##1, &&op_0x##h##2, &&op_0x##h##3,  \
+ &&op_0x##h##4, &&op_0x##h##5, &&op_0x##h##6, &&op_0x##h##7,  \
+ &&op_0x##h##8, &&op_0x##h##9, &&op_0x##h##A, &&op_0x##h##B,  \
+ &&op_0x##h##C, &&op_0x##h##D, &&op_0x##h##E, &&op_0x##h##F
+#else
+#define OP(n) case n:
+#define NEXT break
+#endif
+
 /* Now come the macros to wrap up all of the above stuff addressing mode functions
    and operation macros.  Note that operation macros will always operate(redundant
    redundant) on the variable "x".
 */
 
-#define RMW_A(op) {uint8 x=_A; op; _A=x; break; } /* Meh... */
-#define RMW_AB(op) {unsigned int A; uint8 x; GetAB(A); x=RdMem(A); WrMem(A,x); op; WrMem(A,x); break; }
-#define RMW_ABI(reg,op) {unsigned int A; uint8 x; GetABIWR(A,reg); x=RdMem(A); WrMem(A,x); op; WrMem(A,x); break; }
+#define RMW_A(op) {uint8 x=_A; op; _A=x; NEXT; } /* Meh... */
+#define RMW_AB(op) {unsigned int A; uint8 x; GetAB(A); x=RdMem(A); WrMem<LuaHooks,WriteTrack>(A,x); op; WrMem<LuaHooks,WriteTrack>(A,x); NEXT; }
+#define RMW_ABI(reg,op) {unsigned int A; uint8 x; GetABIWR(A,reg); x=RdMem(A); WrMem<LuaHooks,WriteTrack>(A,x); op; WrMem<LuaHooks,WriteTrack>(A,x); NEXT; }
 #define RMW_ABX(op)  RMW_ABI(_X,op)
 #define RMW_ABY(op)  RMW_ABI(_Y,op)
-#define RMW_IX(op)  {unsigned int A; uint8 x; GetIX(A); x=RdMem(A); WrMem(A,x); op; WrMem(A,x); break; }
-#define RMW_IY(op)  {unsigned int A; uint8 x; GetIYWR(A); x=RdMem(A); WrMem(A,x); op; WrMem(A,x); break; }
-#define RMW_ZP(op)  {uint8 A; uint8 x; GetZP(A); x=RdRAM(A); op; WrRAM(A,x); break; }
-#define RMW_ZPX(op) {uint8 A; uint8 x; GetZPI(A,_X); x=RdRAM(A); op; WrRAM(A,x); break;}
-
-#define LD_IM(op)  {uint8 x; x=RdMem(_PC); _PC++; op; break;}
-#define LD_ZP(op)  {uint8 A; uint8 x; GetZP(A); x=RdRAM(A); op; break;}
-#define LD_ZPX(op)  {uint8 A; uint8 x; GetZPI(A,_X); x=RdRAM(A); op; break;}
-#define LD_ZPY(op)  {uint8 A; uint8 x; GetZPI(A,_Y); x=RdRAM(A); op; break;}
-#define LD_AB(op)  {unsigned int A; uint8 x; GetAB(A); x=RdMem(A); op; break; }
-#define LD_ABI(reg,op)  {unsigned int A; uint8 x; GetABIRD(A,reg); x=RdMem(A); op; break;}
+#define RMW_IX(op)  {unsigned int A; uint8 x; GetIX(A); x=RdMem(A); WrMem<LuaHooks,WriteTrack>(A,x); op; WrMem<LuaHooks,WriteTrack>(A,x); NEXT; }
+#define RMW_IY(op)  {unsigned int A; uint8 x; GetIYWR(A); x=RdMem(A); WrMem<LuaHooks,WriteTrack>(A,x); op; WrMem<LuaHooks,WriteTrack>(A,x); NEXT; }
+#define RMW_ZP(op)  {uint8 A; uint8 x; GetZP(A); x=RdRAM(A); op; WrRAM<LuaHooks,WriteTrack>(A,x); NEXT; }
+#define RMW_ZPX(op) {uint8 A; uint8 x; GetZPI(A,_X); x=RdRAM(A); op; WrRAM<LuaHooks,WriteTrack>(A,x); NEXT;}
+
+#define LD_IM(op)  {uint8 x; x=RdMem(_PC); _PC++; op; NEXT;}
+#define LD_ZP(op)  {uint8 A; uint8 x; GetZP(A); x=RdRAM(A); op; NEXT;}
+#define LD_ZPX(op)  {uint8 A; uint8 x; GetZPI(A,_X); x=RdRAM(A); op; NEXT;}
+#define LD_ZPY(op)  {uint8 A; uint8 x; GetZPI(A,_Y); x=RdRAM(A); op; NEXT;}
+#define LD_AB(op)  {unsigned int A; uint8 x; GetAB(A); x=RdMem(A); op; NEXT; }
+#define LD_ABI(reg,op)  {unsigned int A; uint8 x; GetABIRD(A,reg); x=RdMem(A); op; NEXT;}
 #define LD_ABX(op)  LD_ABI(_X,op)
 #define LD_ABY(op)  LD_ABI(_Y,op)
-#define LD_IX(op)  {unsigned int A; uint8 x; GetIX(A); x=RdMem(A); op; break;}
-#define LD_IY(op)  {unsigned int A; uint8 x; GetIYRD(A); x=RdMem(A); op; break;}
-
-#define ST_ZP(r)  {uint8 A; GetZP(A); WrRAM(A,r); break;}
-#define ST_ZPX(r)  {uint8 A; GetZPI(A,_X); WrRAM(A,r); break;}
-#define ST_ZPY(r)  {uint8 A; GetZPI(A,_Y); WrRAM(A,r); break;}
-#define ST_AB(r)  {unsigned int A; GetAB(A); WrMem(A,r); break;}
-#define ST_ABI(reg,r)  {unsigned int A; GetABIWR(A,reg); WrMem(A,r); break; }
+#define LD_IX(op)  {unsigned int A; uint8 x; GetIX(A); x=RdMem(A); op; NEXT;}
+#define LD_IY(op)  {unsigned int A; uint8 x; GetIYRD(A); x=RdMem(A); op; NEXT;}
+
+#define ST_ZP(r)  {uint8 A; GetZP(A); WrRAM<LuaHooks,WriteTrack>(A,r); NEXT;}
+#define ST_ZPX(r)  {uint8 A; GetZPI(A,_X); WrRAM<LuaHooks,WriteTrack>(A,r); NEXT;}
+#define ST_ZPY(r)  {uint8 A; GetZPI(A,_Y); WrRAM<LuaHooks,WriteTrack>(A,r); NEXT;}
+#define ST_AB(r)  {unsigned int A; GetAB(A); WrMem<LuaHooks,WriteTrack>(A,r); NEXT;}
+#define ST_ABI(reg,r)  {unsigned int A; GetABIWR(A,reg); WrMem<LuaHooks,WriteTrack>(A,r); NEXT; }
 #define ST_ABX(r)  ST_ABI(_X,r)
 #define ST_ABY(r)  ST_ABI(_Y,r)
-#define ST_IX(r)  {unsigned int A; GetIX(A); WrMem(A,r); break; }
-#define ST_IY(r)  {unsigned int A; GetIYWR(A); WrMem(A,r); break; }
+#define ST_IX(r)  {unsigned int A; GetIX(A); WrMem<LuaHooks,WriteTrack>(A,r); NEXT; }
+#define ST_IY(r)  {unsigned int A; GetIYWR(A); WrMem<LuaHooks,WriteTrack>(A,r); NEXT; }
 
-static uint8 CycTable[256] =
+static FCEU_TLS uint8 CycTable[256] =
 {
 /*0x00*/ 7,6,2,8,3,3,5,5,3,2,2,2,4,4,6,6,
 /*0x10*/ 2,5,2,8,4,4,6,6,2,4,2,7,4,4,7,7,
@@ -408,7 +570,7 @@ void X6502_Init(void)
 	}
 }
 
-extern int StackAddrBackup;
+extern FCEU_TLS int StackAddrBackup;
 void X6502_Power(void)
 {
  _count=_tcount=_IRQlow=_PC=_A=_X=_Y=_P=_PI=_DB=_jammed=0;
@@ -418,15 +580,202 @@ void X6502_Power(void)
  StackAddrBackup = -1;
 }
 
-void X6502_Run(int32 cycles)
+static void RunHooks(void)
 {
-  if(PAL)
-   cycles*=15;    // 15*4=60
-  else
-   cycles*=16;    // 16*4=64
+ int32 cycles=hookcycles;
+ hookcycles=0;
+ hookruns++;
+
+ if(MapIRQHook) MapIRQHook(cycles);
+ if(!overclocking) FCEU_SoundCPUHook(cycles);
+
+ hookbudget=0x7FFFFFFF;
+ if(MapIRQHook)
+  hookbudget=MapIRQHookBudget?MapIRQHookBudget():0;
+ if(!overclocking)
+ {
+  int32 b=FCEU_SoundCPUHookBudget();
+  if(b<hookbudget) hookbudget=b;
+ }
+}
+
+void X6502_SyncHooks(void)
+{
+ if(hookcycles)
+  RunHooks();
+ //the caller is about to change what the budget was computed from
+ hookbudget=0;
+}
+
+void X6502_AbandonRun(void)
+{
+ hookcycles=0;
+ hookbudget=0;
+ timestamp=soundtimestamp=0;
+}
+
+//idle loop fast-forward.
+//a loop is a straight run of instructions ending in a branch or jump back to its start.
+//when it only reads internal ram and comes back to its start with the cpu in exactly the
+//state it had on the previous pass, every further pass is the same pass again: nothing it
+//reads can change until an interrupt, a hook or the end of this X6502_Run. so whole passes
+//are skipped up to one pass short of the nearest of those.
+static FCEU_TLS struct
+{
+ int32 head, tail;  //-1 when no loop is being watched
+ bool idle;         //the loop body qualifies
+ uint32 length;     //instructions per pass, including the branch
+ uint8 A, X, Y, S, P, DB;
+ int32 tcount;
+ uint32 timestamp;
+ uint32 hookruns;
+ uint64 instructions;
+} idleloop;
+
+//whether the instruction at A reads nothing but its operand bytes and internal ram, and writes nothing.
+//internal ram only counts while RAMDirect says $0000-$1FFF still has the stock handlers:
+//a cheat or board read handler there may return something other than RAM on every pass.
+static bool IdleInstruction(uint16 A, uint8 op, uint16 &size)
+{
+ uint16 addr;
+
+ switch(op)
+ {
+  //implied
+  case 0xAA: case 0x8A: case 0xA8: case 0x98: case 0xBA: case 0x9A:
+  case 0x18: case 0x38: case 0xB8: case 0xEA:
+  case 0xE8: case 0xCA: case 0xC8: case 0x88:
+  case 0x0A: case 0x4A: case 0x2A: case 0x6A:
+   size=1; return true;
+  //immediate
+  case 0xA9: case 0xA2: case 0xA0: case 0x29: case 0x09: case 0x49:
+  case 0xC9: case 0xE0: case 0xC0: case 0x69: case 0xE9:
+   size=2; return true;
+  //zero page, zero page indexed: always internal ram
+  case 0xA5: case 0xA6: case 0xA4: case 0x25: case 0x05: case 0x45:
+  case 0xC5: case 0xE4: case 0xC4: case 0x24: case 0x65: case 0xE5:
+  case 0xB5: case 0xB4: case 0x35: case 0x15: case 0x55: case 0xD5: case 0x75: case 0xF5:
+  case 0xB6:
+   size=2; return RAMDirect;
+  //absolute
+  case 0xAD: case 0xAE: case 0xAC: case 0x2D: case 0x0D: case 0x4D:
+  case 0xCD: case 0xEC: case 0xCC: case 0x2C: case 0x6D: case 0xED:
+   size=3;
+   addr=GetMem(A+1)|(GetMem(A+2)<<8);
+   return RAMDirect && addr<0x2000;
+  //absolute indexed: allow any index
+  case 0xBD: case 0xBC: case 0x3D: case 0x1D: case 0x5D: case 0xDD: case 0x7D: case 0xFD:
+  case 0xB9: case 0xBE: case 0x39: case 0x19: case 0x59: case 0xD9: case 0x79: case 0xF9:
+   size=3;
+   addr=GetMem(A+1)|(GetMem(A+2)<<8);
+   return RAMDirect && addr+0xFF<0x2000;
+ }
+ return false;
+}
+
+static bool IdleLoopBody(uint16 head, uint16 tail, uint32 &length)
+{
+ uint32 A=head;
+
+ if(tail-head>32)
+  return false;
+
+ length=1;
+ while(A<tail)
+ {
+  uint16 size;
+  if(A>=0x10000 || !IdleInstruction(A,GetMem(A),size))
+   return false;
+  A+=size;
+  length++;
+ }
+ if(A!=tail)
+  return false;
+
+ //every code byte must be plain ram or plain cartridge memory, so fetching it does nothing else
+ for(A=head;A<=tail+2 && A<0x10000;A++)
+  if(A>=0x2000 && ARead[A]!=CartBR)
+   return false;
+
+ return true;
+}
+
+static void IdleLoopRecord(uint64 instructions)
+{
+ idleloop.A=_A; idleloop.X=_X; idleloop.Y=_Y; idleloop.S=_S; idleloop.P=_P; idleloop.DB=_DB;
+ idleloop.tcount=_tcount;
+ idleloop.timestamp=timestamp;
+ idleloop.hookruns=hookruns;
+ idleloop.instructions=instructions;
+}
+
+//called when a branch or jump at tail has gone back to _PC. returns the number of instructions skipped.
+static uint64 IdleBranch(uint16 tail, uint64 instructions)
+{
+ int32 pass, passes, n;
+ uint64 skipped;
+
+ if(idleloop.head!=_PC || idleloop.tail!=tail)
+ {
+  idleloop.head=_PC;
+  idleloop.tail=tail;
+  idleloop.idle=IdleLoopBody(_PC,tail,idleloop.length);
+  IdleLoopRecord(instructions);
+  return 0;
+ }
+ if(!idleloop.idle)
+  return 0;
+
+ //the body has no way out but the final branch, so this pass ran straight through
+ //iff exactly one pass worth of instructions was counted since the last one
+ if(instructions-idleloop.instructions!=idleloop.length
+    || hookruns!=idleloop.hookruns || _IRQlow
+    || idleloop.A!=_A || idleloop.X!=_X || idleloop.Y!=_Y || idleloop.S!=_S || idleloop.P!=_P || idleloop.DB!=_DB
+    || idleloop.tcount!=_tcount)
+ {
+  IdleLoopRecord(instructions);
+  return 0;
+ }
+
+ pass=timestamp-idleloop.timestamp;
+
+ //keep one whole pass between the skip and whatever ends it, and let that run normally
+ passes=(_count-1)/(pass*48)-1;
+ n=(hookbudget-hookcycles-_tcount-1)/pass-1;
+ if(n<passes) passes=n;
+ if(passes<1)
+ {
+  IdleLoopRecord(instructions);
+  return 0;
+ }
+
+ timestamp+=passes*pass;
+ if(!overclocking) soundtimestamp+=passes*pass;
+ _count-=passes*pass*48;
+ hookcycles+=passes*pass;
+ X6502_IdleCyclesSkipped+=passes*pass;
+
+ skipped=(uint64)passes*idleloop.length;
+ IdleLoopRecord(instructions+skipped);
+ return skipped;
+}
+
+//the cpu loop proper. it is instantiated once for each combination of
+//per-instruction hooks, so a run with nothing attached pays for none of them.
+template<bool Debugger, bool LuaHooks, bool ClientHook, bool IdleSkip, bool WriteTrack>
+static void X6502_RunLoop(void)
+{
+  //instructions are counted here and flushed on exit unless the debugger or lua can observe the counters mid-run
+  uint64 instructions=0;
+
+  #ifdef FCEU_THREADED_DISPATCH
+  static const void* const OpLabels[256] =
+  {
+   OPL(0), OPL(1), OPL(2), OPL(3), OPL(4), OPL(5), OPL(6), OPL(7),
+   OPL(8), OPL(9), OPL(A), OPL(B), OPL(C), OPL(D), OPL(E), OPL(F),
+  };
+  #endif
 
-  _count+=cycles;
-extern int test; test++;
   while(_count>0)
   {
    int32 temp;
@@ -436,7 +785,7 @@ extern int test; test++;
    {
     if(_IRQlow&FCEU_IQRESET)
     {
-	 DEBUG( if(debug_loggingCD) LogCDVectors(0xFFFC); )
+	 DEBUG( if(Debugger && debug_loggingCD) LogCDVectors(0xFFFC); )
      _PC=RdMem(0xFFFC);
      _PC|=RdMem(0xFFFD)<<8;
      _jammed=0;
@@ -457,7 +806,7 @@ extern int test; test++;
       PUSH(_PC);
       PUSH((_P&~B_FLAG)|(U_FLAG));
       _P|=I_FLAG;
-	  DEBUG( if(debug_loggingCD) LogCDVectors(0xFFFA) );
+	  DEBUG( if(Debugger && debug_loggingCD) LogCDVectors(0xFFFA) );
       _PC=RdMem(0xFFFA);
       _PC|=RdMem(0xFFFB)<<8;
       _IRQlow&=~FCEU_IQNMI;
@@ -472,7 +821,7 @@ extern int test; test++;
       PUSH(_PC);
       PUSH((_P&~B_FLAG)|(U_FLAG));
       _P|=I_FLAG;
-	  DEBUG( if(debug_loggingCD) LogCDVectors(0xFFFE) );
+	  DEBUG( if(Debugger && debug_loggingCD) LogCDVectors(0xFFFE) );
       _PC=RdMem(0xFFFE);
       _PC|=RdMem(0xFFFF)<<8;
      }
@@ -481,37 +830,88 @@ extern int test; test++;
     if(_count<=0)
     {
      _PI=_P;
-     return;
+     break;
      } //Should increase accuracy without a
               //major speed hit.
    }
 
-	//will probably cause a major speed decrease on low-end systems
-   DEBUG( DebugCycle() );
-
-   IncrementInstructionsCounters();
-
-   _PI=_P;
-   b1=RdMem(_PC);
-
-   ADDCYC(CycTable[b1]);
-
-   temp=_tcount;
-   _tcount=0;
-   if(MapIRQHook) MapIRQHook(temp);
-   
-   if (!overclocking)
-    FCEU_SoundCPUHook(temp);
-   #ifdef _S9XLUA_H
-   CallRegisteredLuaMemHook(_PC, 1, 0, LUAMEMHOOK_EXEC);
-   #endif
-   FCEUD_CallHookBeforeExec(_PC);
-   _PC++;
+   FETCH();
    switch(b1)
    {
     #include "ops.inc"
    }
   }
+
+  //nothing outside the cpu loop should see the hooks lagging behind
+  if(hookcycles)
+   RunHooks();
+
+  total_instructions+=instructions;
+  delta_instructions+=instructions;
+}
+
+typedef void (*X6502_RunLoopFn)(void);
+
+//indexed by WriteTrack<<3 | Debugger<<2 | LuaHooks<<1 | ClientHook
+static const X6502_RunLoopFn RunLoops[16] =
+{
+ X6502_RunLoop<false,false,false,false,false>,
+ X6502_RunLoop<false,false,true,false,false>,
+ X6502_RunLoop<false,true,false,false,false>,
+ X6502_RunLoop<false,true,true,false,false>,
+ X6502_RunLoop<true,false,false,false,false>,
+ X6502_RunLoop<true,false,true,false,false>,
+ X6502_RunLoop<true,true,false,false,false>,
+ X6502_RunLoop<true,true,true,false,false>,
+ X6502_RunLoop<false,false,false,false,true>,
+ X6502_RunLoop<false,false,true,false,true>,
+ X6502_RunLoop<false,true,false,false,true>,
+ X6502_RunLoop<false,true,true,false,true>,
+ X6502_RunLoop<true,false,false,false,true>,
+ X6502_RunLoop<true,false,true,false,true>,
+ X6502_RunLoop<true,true,false,false,true>,
+ X6502_RunLoop<true,true,true,false,true>,
+};
+
+void X6502_Run(int32 cycles)
+{
+  if(PAL)
+   cycles*=15;    // 15*4=60
+  else
+   cycles*=16;    // 16*4=64
+
+  _count+=cycles;
+extern FCEU_TLS int test; test++;
+
+  //the loop is chosen once per call. a hook attached while the cpu is running
+  //takes effect from the next call, which is at most a scanline away.
+  //detaching is always immediate since every hook still checks itself.
+  int loop=0;
+  #ifdef FCEUDEF_DEBUGGER
+  if(DebugCycleActive()) loop|=4;
+  #endif
+  #ifdef _S9XLUA_H
+  if(AnyRegisteredLuaMemHook(LUAMEMHOOK_EXEC) || AnyRegisteredLuaMemHook(LUAMEMHOOK_WRITE)) loop|=2;
+  #endif
+  if(FCEUD_HookBeforeExecActive()) loop|=1;
+  if(X6502_WriteTrack || X6502_WatchWrites) loop|=8;
+
+  //state may have been changed from outside since the last call, so ask again on the first instruction
+  hookbudget=0;
+
+  idleloop.head=idleloop.tail=-1;
+
+  //skipping idle loops would hide instructions from every kind of hook, so it only happens without them
+  //(the skipped passes write nothing, so write tracking can stay)
+  if(!(loop&7) && X6502_IdleSkip)
+  {
+   if(loop&8)
+    X6502_RunLoop<false,false,false,true,true>();
+   else
+    X6502_RunLoop<false,false,false,true,false>();
+  }
+  else
+   RunLoops[loop]();
 }
 
 //--------------------------
@@ -22,7 +22,7 @@
 
 #include "x6502struct.h"
 
-extern X6502 X;
+extern FCEU_TLS X6502 X;
 
 
 //the opsize table is used to quickly grab the instruction sizes (in bytes)
@@ -49,9 +49,9 @@ void X6502_RunDebug(int32 cycles);
 #define X6502_Run(x) X6502_RunDebug(x)
 //------------
 
-extern uint32 timestamp;
-extern uint32 soundtimestamp;
-extern int scanline;
+extern FCEU_TLS uint32 timestamp;
+extern FCEU_TLS uint32 soundtimestamp;
+extern FCEU_TLS int scanline;
 
 #define N_FLAG  0x80
 #define V_FLAG  0x40
@@ -62,7 +62,75 @@ extern int scanline;
 #define Z_FLAG  0x02
 #define C_FLAG  0x01
 
-extern void (*MapIRQHook)(int a);
+extern FCEU_TLS void (*MapIRQHook)(int a);
+
+//MapIRQHook and FCEU_SoundCPUHook are not called on every instruction. the cpu asks
+//each of them how many cycles may pass before it has something to do, runs that far
+//and then hands over all the cycles at once.
+//a board that sets MapIRQHook may also set MapIRQHookBudget to say how far away its
+//next event is; without it, MapIRQHook is called on every instruction as before.
+//anything that reads or changes the state these hooks count with must call
+//X6502_SyncHooks() first.
+extern FCEU_TLS int32 (*MapIRQHookBudget)(void);
+void X6502_SyncHooks(void);
+//for a frame that is thrown away halfway through: drops the cycles the hooks
+//have not seen yet and puts the timestamps back to where a frame starts.
+//a state must be loaded afterwards.
+void X6502_AbandonRun(void);
+
+//when set, loops that only wait for an interrupt are fast-forwarded with the same outcome as running them.
+//only done while no debugger, lua or client hook is watching instructions.
+extern FCEU_TLS bool X6502_IdleSkip;
+//cycles fast-forwarded that way since the game was loaded
+extern FCEU_TLS uint64 X6502_IdleCyclesSkipped;
+
+//one cpu write to tracked memory. old and new are what the memory held before and after it.
+struct X6502_WriteLogEntry
+{
+ uint64 cycle;  //timestampbase+timestamp of the writing instruction
+ uint16 addr;   //$0000-$07FF for internal ram (mirrors folded), $6000-$7FFF as is
+ uint8 old_value;
+ uint8 new_value;
+ uint32 reserved;
+};
+
+#define X6502_WRITE_BITS_SIZE ((0x800 + 0x2000) / 8)
+
+struct X6502_WriteTracker
+{
+ //bit n (lsb first) is set when internal ram $n is written, bit 0x800+n when $6000+n is
+ uint8 bits[X6502_WRITE_BITS_SIZE];
+ //optional ring buffer. entry i of the whole run goes to log[i % log_capacity]
+ X6502_WriteLogEntry *log;
+ uint32 log_capacity;
+ uint32 log_head;
+ uint64 log_count;
+ //optional. bit n of wram_bits is set when the cpu writes byte n of the wram_size bytes at wram,
+ //through whichever page it is mapped at, $8000 up included. wram_unknown is set by a write to
+ //$6000-$7FFF where no ram page is mapped, which a board's handler might still store into wram.
+ //neither is ever cleared here
+ uint8 *wram;
+ uint32 wram_size;
+ uint8 *wram_bits;
+ uint8 wram_unknown;
+};
+
+//when set, every write the cpu makes to internal ram or to a page at $6000-$7FFF the cart maps ram to is recorded here,
+//whether or not the board's handler let it change the byte.
+//the loop is chosen per X6502_Run call like the other hooks, so runs without it pay nothing.
+//writes made from outside the cpu (debugger pokes, state loads) are not recorded.
+extern FCEU_TLS X6502_WriteTracker *X6502_WriteTrack;
+
+//calls fn after every cpu write to a byte whose bit (same layout as X6502_WriteTracker::bits) is set in bits.
+//shares the tracking loop with X6502_WriteTrack, so either one being set selects it.
+struct X6502_WriteWatch
+{
+ uint8 bits[X6502_WRITE_BITS_SIZE];
+ void (*fn)(void *data, uint32 A);
+ void *data;
+};
+
+extern FCEU_TLS X6502_WriteWatch *X6502_WatchWrites;
 
 #define NTSC_CPU (dendy ? 1773447.467 : 1789772.7272727272727272)
 #define PAL_CPU  1662607.125
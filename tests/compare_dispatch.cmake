@@ -0,0 +1,45 @@
+# dispatch_trace を switch 版と computed goto 版の両方で実行し、出力が一致することを確かめる。
+# cmake -DSWITCH=<dispatch_trace> -DTHREADED=<dispatch_trace_threaded> -P compare_dispatch.cmake
+# ROM のファイル名が重ならないよう、それぞれ別のディレクトリで実行する。
+
+foreach(var SWITCH THREADED)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "${var} is not set")
+  endif()
+
+  string(TOLOWER ${var} dir)
+  file(MAKE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/dispatch_${dir})
+  execute_process(
+    COMMAND ${${var}}
+    WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/dispatch_${dir}
+    OUTPUT_VARIABLE out_${var}
+    RESULT_VARIABLE result
+  )
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${${var}} failed: ${result}")
+  endif()
+endforeach()
+
+string(STRIP "${out_SWITCH}" out_SWITCH)
+string(STRIP "${out_THREADED}" out_THREADED)
+string(REPLACE "\n" ";" lines_switch "${out_SWITCH}")
+string(REPLACE "\n" ";" lines_threaded "${out_THREADED}")
+list(LENGTH lines_switch n_switch)
+list(LENGTH lines_threaded n_threaded)
+if(n_switch EQUAL 0 OR NOT n_switch EQUAL n_threaded)
+  message(FATAL_ERROR "the traces have ${n_switch} and ${n_threaded} lines")
+endif()
+
+if(NOT out_SWITCH STREQUAL out_THREADED)
+  # 最初に異なる行を示す
+  math(EXPR last "${n_switch} - 1")
+  foreach(i RANGE ${last})
+    list(GET lines_switch ${i} a)
+    list(GET lines_threaded ${i} b)
+    if(NOT a STREQUAL b)
+      message(FATAL_ERROR "the dispatch builds differ:\n  switch:   ${a}\n  threaded: ${b}")
+    endif()
+  endforeach()
+endif()
+
+message(STATUS "dispatch builds agree on ${n_switch} frames")
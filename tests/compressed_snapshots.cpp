@@ -0,0 +1,189 @@
+// バックグラウンドで圧縮したスナップショットが、展開すると元の状態に戻ることを確かめる。
+// FCSX 形式・フラット形式・フレーム途中のスナップショットを混ぜてワーカーに投入し、
+// ジョブの結果とアーカイブの各レコードのどちらから展開してロードしても、保存した時点のハッシュ値になることを確かめる。
+// 既存のアーカイブに追記するとレコードが続けて並ぶこと、不正な引数や壊れたレコードが拒否されることも確かめる。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int SNAPSHOTS = 150;
+const char* const ARCHIVE = "compressed.fxsz";
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+struct Submitted {
+    CompressJob* job;
+    std::uint64_t hash;
+};
+
+std::vector<std::uint8_t> read_file(const char* path) {
+    std::FILE* fp = std::fopen(path, "rb");
+    CHECK(fp);
+    std::vector<std::uint8_t> buf;
+    std::uint8_t chunk[4096];
+    for(std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), fp)) > 0;)
+        buf.insert(buf.end(), chunk, chunk + n);
+    std::fclose(fp);
+    return buf;
+}
+
+// レコードを展開して ctx にロードし、ハッシュ値を返す
+std::uint64_t load_record(FceuxContext* ctx, const std::uint8_t* record, std::size_t size) {
+    Snapshot* snap = fceux_snapshot_create();
+    CHECK(fceux_snapshot_decompress(snap, record, size));
+    CHECK(fceux_snapshot_load(ctx, snap));
+    fceux_snapshot_destroy(snap);
+    return fceux_state_hash(ctx, 0);
+}
+
+// ctx を進めながら n 個のスナップショットを投入する
+std::vector<Submitted> submit(Compressor* comp, FceuxContext* ctx, Rng& rng, int n) {
+    std::vector<Submitted> jobs;
+    Snapshot* snap = fceux_snapshot_create();
+    for(int i = 0; i < n; ++i) {
+        const std::uint16_t in = static_cast<std::uint16_t>(rng(0x10000));
+        CHECK(fceux_run_frames(ctx, &in, 1 + rng(3), nullptr) >= 1);
+        if(i % 5 == 4) {
+            CHECK(fceux_run_cycles(ctx, 1000 + rng(25000)) > 0);
+            CHECK(fceux_midframe(ctx));
+        }
+        CHECK(fceux_snapshot_save_ex(ctx, snap, i % 2 ? FCEUX_SNAPSHOT_FLAT : 0));
+
+        CompressJob* job = fceux_compressor_submit(comp, snap);
+        CHECK(job);
+        jobs.push_back(Submitted { job, fceux_state_hash(ctx, 0) });
+    }
+    fceux_snapshot_destroy(snap);
+    return jobs;
+}
+
+// アーカイブを先頭からたどり、位置ごとのレコードのサイズを返す
+std::map<std::uint64_t, std::size_t> walk(const std::vector<std::uint8_t>& archive) {
+    std::map<std::uint64_t, std::size_t> records;
+    for(std::size_t pos = 0; pos < archive.size();) {
+        const std::size_t size = fceux_compressed_size(archive.data() + pos, archive.size() - pos);
+        CHECK(size > 0);
+        records[pos] = size;
+        pos += size;
+    }
+    return records;
+}
+
+// ジョブの結果とアーカイブの該当レコードが、投入した時点の状態に戻ることを確かめる
+void check_jobs(const std::vector<Submitted>& jobs, const std::vector<std::uint8_t>& archive, FceuxContext* check) {
+    const std::map<std::uint64_t, std::size_t> records = walk(archive);
+    for(std::size_t i = 0; i < jobs.size(); ++i) {
+        CHECK(fceux_compress_job_wait(jobs[i].job));
+        CHECK(fceux_compress_job_done(jobs[i].job));
+        std::vector<std::uint8_t> result(fceux_compress_job_result(jobs[i].job, nullptr, 0));
+        CHECK(!result.empty());
+        CHECK(fceux_compress_job_result(jobs[i].job, result.data(), result.size()) == result.size());
+        CHECK(fceux_compressed_size(result.data(), result.size()) == result.size());
+        if(load_record(check, result.data(), result.size()) != jobs[i].hash) {
+            std::fprintf(stderr, "job %zu does not decompress to the state it was submitted from\n", i);
+            std::exit(EXIT_FAILURE);
+        }
+
+        const std::uint64_t offset = fceux_compress_job_archive_offset(jobs[i].job);
+        const auto it = records.find(offset);
+        CHECK(it != records.end() && it->second == result.size());
+        CHECK(std::vector<std::uint8_t>(archive.begin() + offset, archive.begin() + offset + result.size()) == result);
+        CHECK(load_record(check, archive.data() + offset, result.size()) == jobs[i].hash);
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    write_rom("compressed.nes", 4);
+    std::remove(ARCHIVE);
+
+    CHECK(!fceux_compressor_create(1, 0, 10, nullptr));
+    CHECK(!fceux_compressor_create(1, 0, -2, nullptr));
+    CHECK(!fceux_compressor_create(1, 0, 6, "no_such_directory/compressed.fxsz"));
+
+    FceuxContext* ctx = fceux_create("compressed.nes");
+    FceuxContext* check = fceux_create("compressed.nes");
+    CHECK(ctx && check);
+    Rng rng { 1 };
+
+    // 待てるジョブ数を小さくして、投入が空きを待つようにする
+    Compressor* comp = fceux_compressor_create(2, 3, 6, ARCHIVE);
+    CHECK(comp);
+    const std::vector<Submitted> first = submit(comp, ctx, rng, SNAPSHOTS);
+    // 破棄は全てのジョブの完了を待つ。ハンドルは破棄後も使える
+    fceux_compressor_destroy(comp);
+    std::vector<std::uint8_t> archive = read_file(ARCHIVE);
+    CHECK(walk(archive).size() == SNAPSHOTS);
+    check_jobs(first, archive, check);
+
+    // 追記したものは既存のレコードの後に並ぶ
+    const std::size_t appended_from = archive.size();
+    comp = fceux_compressor_create(0, 0, 1, ARCHIVE);
+    CHECK(comp);
+    const std::vector<Submitted> second = submit(comp, ctx, rng, SNAPSHOTS / 3);
+    fceux_compressor_flush(comp);
+    for(const Submitted& s : second) {
+        CHECK(fceux_compress_job_done(s.job));
+        CHECK(fceux_compress_job_archive_offset(s.job) >= appended_from);
+    }
+    archive = read_file(ARCHIVE);
+    CHECK(walk(archive).size() == SNAPSHOTS + SNAPSHOTS / 3);
+    check_jobs(first, archive, check);
+    check_jobs(second, archive, check);
+    fceux_compressor_destroy(comp);
+
+    // アーカイブなし
+    comp = fceux_compressor_create(1, 0, -1, nullptr);
+    CHECK(comp);
+    Snapshot* snap = fceux_snapshot_create();
+    CHECK(fceux_snapshot_save(ctx, snap));
+    CompressJob* job = fceux_compressor_submit(comp, snap);
+    CHECK(job);
+    CHECK(fceux_compress_job_wait(job));
+    CHECK(fceux_compress_job_archive_offset(job) == UINT64_MAX);
+    std::vector<std::uint8_t> record(fceux_compress_job_result(job, nullptr, 0));
+    CHECK(fceux_compress_job_result(job, record.data(), record.size()) == record.size());
+    CHECK(load_record(check, record.data(), record.size()) == fceux_state_hash(ctx, 0));
+    fceux_compress_job_release(job);
+    fceux_compressor_destroy(comp);
+
+    // 途中で切れたものと、圧縮データを壊したものは拒否され、snap は変わらない
+    const std::uint64_t hash = fceux_state_hash(ctx, 0);
+    CHECK(fceux_compressed_size(record.data(), record.size() - 1) == 0);
+    CHECK(!fceux_snapshot_decompress(snap, record.data(), record.size() - 1));
+    std::vector<std::uint8_t> broken = record;
+    for(std::size_t i = 16; i < broken.size(); i += 7) broken[i] ^= 0x5A;
+    CHECK(!fceux_snapshot_decompress(snap, broken.data(), broken.size()));
+    broken = record;
+    broken[0] = 'X';
+    CHECK(fceux_compressed_size(broken.data(), broken.size()) == 0);
+    CHECK(!fceux_snapshot_decompress(snap, broken.data(), broken.size()));
+    CHECK(fceux_snapshot_load(check, snap));
+    CHECK(fceux_state_hash(check, 0) == hash);
+    fceux_snapshot_destroy(snap);
+
+    for(const Submitted& s : first) fceux_compress_job_release(s.job);
+    for(const Submitted& s : second) fceux_compress_job_release(s.job);
+    fceux_destroy(check);
+    fceux_destroy(ctx);
+
+    std::puts("compressed_snapshots: ok");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+// ブレークポイントの条件式をバイトコードにコンパイルして評価した結果が、構文木をたどって評価した結果と一致することを確かめる。
+// ランダムな条件式を generateCondition() で作り、RAM・WRAM・CPU レジスタ・直前のアクセスをランダムにしたコアの上で
+// evaluate() (コンパイル済みならバイトコードを実行する) と、コンパイル結果を外して木をたどらせた evaluate() を比べる。
+// 右辺がレジスタやフラグのときに値ではなく型で getValue() を引く木の評価の癖や、|| と && の短絡評価も
+// 固定の式で確かめる。NROM と MMC3 の ROM で行う。
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+#include "types.h"
+#include "x6502.h"
+#include "debug.h"
+
+namespace {
+
+constexpr int CONDITIONS = 20000;
+// 同じ条件式を評価し直す回数 (そのたびにメモリとレジスタを変える)
+constexpr int STATES = 4;
+
+// 評価の癖が出る式。いずれもコンパイルされること
+const char* const FIXED[] = {
+    // 右辺のレジスタとフラグは getValue(type2) で引かれ、常に 0 となる
+    "#1 + A", "#5 == A", "A == A", "#7 - C", "X * Y",
+    // || と && は 0 か 1 になり、左辺で決まれば右辺を評価しない
+    "#0 || $10", "#3 || $[#10 + X]", "#3 && #0", "#0 && $[A]", "$10 || #0",
+    "(A || X) + #2", "(#4 && Y) * #3",
+    // 定数だけの部分式、定数アドレスの間接参照
+    "#2 * #3 + #4 == #A", "$[#10 + #5] == $15", "$[$[#20]] != #0",
+    "K == T", "R + W", "#10 / #0", "$6000 + $FFFC",
+};
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+std::string hex(std::uint32_t v) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%X", v);
+    return buf;
+}
+
+// 読んでも副作用のないアドレス
+std::uint32_t random_addr(Rng& rng) {
+    switch(rng(4)) {
+    case 0: return rng(0x100);
+    case 1: return rng(0x800);
+    case 2: return 0x6000 + rng(0x2000);
+    default: return 0x8000 + rng(0x8000);
+    }
+}
+
+std::string random_expr(Rng& rng, int depth);
+
+std::string random_primitive(Rng& rng, int depth) {
+    static const char* const REGS[] = { "A", "X", "Y", "P", "S", "N", "V", "U", "B", "D", "I", "Z", "C", "K", "T", "R", "W" };
+
+    switch(depth > 0 ? rng(8) : rng(5)) {
+    case 0: case 1: return "#" + hex(rng(3) == 0 ? rng(0x10000) : rng(0x10));
+    case 2: return "$" + hex(random_addr(rng));
+    case 3: case 4: return REGS[rng(sizeof(REGS) / sizeof(REGS[0]))];
+    case 5: case 6: return "(" + random_expr(rng, depth - 1) + ")";
+    default: return "$[" + random_expr(rng, depth - 1) + "]";
+    }
+}
+
+std::string random_expr(Rng& rng, int depth) {
+    static const char* const OPS[] = { "==", "!=", "<=", ">=", "<", ">", "+", "-", "*", "/", "||", "&&" };
+
+    std::string s = random_primitive(rng, depth);
+    for(std::uint32_t n = rng(4); n > 0; --n)
+        s += std::string(" ") + OPS[rng(sizeof(OPS) / sizeof(OPS[0]))] + " " + random_primitive(rng, depth);
+    return s;
+}
+
+// コアのスレッド上で行うので、失敗してもその場で終了せずに ok を外して戻る
+struct Check {
+    FceuxContext* ctx;
+    Rng rng;
+    int compiled;
+    bool ok;
+};
+
+// メモリとレジスタ、直前のアクセスをランダムにする。ctx がコアに載った状態で呼ぶ
+void randomize(Check& c) {
+    for(std::uint32_t a = 0; a < 0x100; ++a)
+        fceux_mem_write(c.ctx, static_cast<std::uint16_t>(a), static_cast<std::uint8_t>(c.rng(0x100)), FCEUX_MEMORY_RAM);
+    for(int i = 0; i < 64; ++i) {
+        fceux_mem_write(c.ctx, static_cast<std::uint16_t>(c.rng(0x800)), static_cast<std::uint8_t>(c.rng(0x100)), FCEUX_MEMORY_RAM);
+        fceux_mem_write(c.ctx, static_cast<std::uint16_t>(0x6000 + c.rng(0x2000)), static_cast<std::uint8_t>(c.rng(0x100)), FCEUX_MEMORY_CPU);
+    }
+
+    X.A = static_cast<std::uint8_t>(c.rng(0x100));
+    X.X = static_cast<std::uint8_t>(c.rng(0x100));
+    X.Y = static_cast<std::uint8_t>(c.rng(0x100));
+    X.S = static_cast<std::uint8_t>(c.rng(0x100));
+    X.P = static_cast<std::uint8_t>(c.rng(0x100));
+    X.PC = static_cast<std::uint16_t>(0x8000 + c.rng(0x8000));
+    debugLastAddress = static_cast<std::uint16_t>(random_addr(c.rng));
+    debugLastOpcode = static_cast<std::uint8_t>(c.rng(0x100));
+}
+
+// str の 2 通りの評価を STATES 回比べる。構文が誤っていれば false を返す
+bool check(Check& c, const char* str) {
+    Condition* cond = generateCondition(str);
+    if(!cond) return false;
+    if(cond->code) ++c.compiled;
+
+    for(int k = 0; k < STATES; ++k) {
+        randomize(c);
+        const int compiled = evaluate(cond);
+
+        int* const code = cond->code;
+        cond->code = nullptr;
+        const int walked = evaluate(cond);
+        cond->code = code;
+
+        if(compiled != walked) {
+            std::fprintf(stderr, "\"%s\": compiled %d, tree %d\n", str, compiled, walked);
+            c.ok = false;
+            break;
+        }
+    }
+    freeTree(cond);
+    return true;
+}
+
+void run(void* userdata) {
+    auto& c = *static_cast<Check*>(userdata);
+
+    for(const char* str : FIXED) {
+        if(!check(c, str)) {
+            std::fprintf(stderr, "\"%s\": does not parse\n", str);
+            c.ok = false;
+        }
+    }
+    if(c.compiled != static_cast<int>(sizeof(FIXED) / sizeof(FIXED[0]))) {
+        std::fprintf(stderr, "some of the fixed conditions were not compiled\n");
+        c.ok = false;
+    }
+
+    int parsed = 0;
+    c.compiled = 0;
+    for(int i = 0; i < CONDITIONS && c.ok; ++i) {
+        const std::string str = random_expr(c.rng, static_cast<int>(c.rng(4)));
+        if(check(c, str.c_str())) ++parsed;
+    }
+    // ほとんどは COND_STACK_SIZE に収まってコンパイルされる
+    if(c.ok && (parsed <= CONDITIONS * 9 / 10 || c.compiled <= parsed * 9 / 10)) {
+        std::fprintf(stderr, "%d of %d conditions parsed, %d compiled\n", parsed, CONDITIONS, c.compiled);
+        c.ok = false;
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    const char* const paths[2] = { "condition_nrom.nes", "condition_mmc3.nes" };
+    write_rom(paths[0], 0);
+    write_rom(paths[1], 4);
+
+    for(int r = 0; r < 2; ++r) {
+        FceuxContext* ctx = fceux_create(paths[r]);
+        CHECK(ctx);
+        for(int i = 0; i < 10; ++i) {
+            const std::uint16_t in = static_cast<std::uint16_t>(i * 37);
+            CHECK(fceux_run_frames(ctx, &in, 1, nullptr) == 1);
+        }
+
+        Check c { ctx, Rng { static_cast<std::uint32_t>(r + 1) }, 0, true };
+        fceux_call_on_core(ctx, run, &c);
+        fceux_destroy(ctx);
+        if(!c.ok) {
+            std::fprintf(stderr, "%s: the compiled conditions differ from the tree\n", paths[r]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::puts("condition_compile: ok");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+// fceux_snapshot_save_delta() で保存した差分が、保存した時点の状態を正しく表すことを確かめる。
+// 書き込みの記録を有効にしたコンテキストで、実行・ロード・RAM の書き換え・フレーム途中での停止などを
+// ランダムに混ぜながら差分を保存し、それを別のコンテキストにロードした結果と元のハッシュ値を比べる。
+// 親が直前に保存したものなら、CPU が書き込まなかった RAM と WRAM のページは比較を省いて保存される。
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int STEPS = 3000;
+
+} // anonymous namespace
+
+int main() {
+    // MMC3 の ROM は毎フレーム WRAM の $6000 に書き込む
+    write_rom("delta.nes", 4);
+
+    FceuxContext* ctx = fceux_create("delta.nes");
+    FceuxContext* check = fceux_create("delta.nes");
+    CHECK(ctx && check);
+    fceux_write_track(ctx, 1);
+
+    std::vector<Snapshot*> snaps { fceux_snapshot_create() };
+    CHECK(fceux_snapshot_save_ex(ctx, snaps[0], FCEUX_SNAPSHOT_FLAT));
+
+    std::uint32_t rng = 1;
+    const auto next = [&rng](std::uint32_t n) {
+        rng = rng * 1103515245 + 12345;
+        return (rng >> 8) % n;
+    };
+
+    for(int i = 0; i < STEPS; ++i) {
+        switch(next(16)) {
+        case 0: CHECK(fceux_snapshot_load(ctx, snaps[next(snaps.size())])); break;
+        case 1: CHECK(fceux_snapshot_load_diff(ctx, snaps[next(snaps.size())])); break;
+        case 2: fceux_mem_write(ctx, static_cast<std::uint16_t>(next(0x800)), 7, FCEUX_MEMORY_RAM); break;
+        case 3: fceux_mem_write(ctx, static_cast<std::uint16_t>(0x6000 + next(0x2000)), 9, FCEUX_MEMORY_CPU); break;
+        case 4: fceux_run_cycles(ctx, 5000); break;
+        case 5: fceux_reset(ctx); break;
+        case 6: fceux_write_track(ctx, 0); fceux_write_track(ctx, 1); break;
+        default: break;
+        }
+
+        const std::uint16_t in = static_cast<std::uint16_t>(next(0x10000));
+        const std::size_t frames = 1 + next(3);
+        std::vector<std::uint16_t> inputs(frames, in);
+        CHECK(fceux_run_frames(ctx, inputs.data(), frames, nullptr) == frames);
+
+        // 多くは直前に保存したものを親にし、時々それより前のものを親にする
+        Snapshot* parent = next(3) == 0 ? snaps[next(snaps.size())] : snaps.back();
+        Snapshot* snap = fceux_snapshot_create();
+        CHECK(fceux_snapshot_save_delta(ctx, snap, parent, 0));
+        snaps.push_back(snap);
+
+        CHECK(fceux_snapshot_load(check, snap));
+        if(fceux_state_hash(check, 0) != fceux_state_hash(ctx, 0)) {
+            std::fprintf(stderr, "step %d: the delta does not load as the state it was saved from\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for(Snapshot* snap : snaps)
+        fceux_snapshot_destroy(snap);
+    fceux_destroy(check);
+    fceux_destroy(ctx);
+
+    std::puts("delta_snapshots: ok");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+// CPU の命令ディスパッチ (switch と computed goto) でエミュレーション結果が変わらないことを確かめるため、
+// フレームごとの状態を標準出力に書き出す。
+// fceux_static と fceux_static_threaded にそれぞれリンクした 2 つの実行ファイルを作り、
+// compare_dispatch.cmake が両方を実行して出力を行ごとに比較する。
+// NROM と MMC3 の ROM を、アイドルループの早送りの有無を変えて実行し、ときどきフレーム途中で一度止める。
+// 各行はフレームごとの RAM, WRAM, CPU レジスタ, CPU サイクル数, 映像のハッシュ値。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int FRAMES = 300;
+// この間隔でフレーム途中で止めてから残りを実行する
+constexpr int STOP_INTERVAL = 7;
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+// FNV-1a
+std::uint64_t hash(const std::vector<std::uint8_t>& buf) {
+    std::uint64_t h = 14695981039346656037ULL;
+    for(std::uint8_t b : buf) {
+        h ^= b;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void trace(const char* path, bool idle_skip, std::uint32_t seed) {
+    FceuxContext* ctx = fceux_create(path);
+    CHECK(ctx);
+    fceux_idle_skip(ctx, idle_skip);
+
+    Rng rng { seed };
+    std::vector<std::uint8_t> video(256 * 240);
+    for(int i = 0; i < FRAMES; ++i) {
+        const std::uint16_t in = static_cast<std::uint16_t>(rng(0x10000));
+        if(i % STOP_INTERVAL == STOP_INTERVAL - 1) {
+            CHECK(fceux_run_cycles(ctx, 1000 + rng(25000)) > 0);
+            CHECK(fceux_midframe(ctx));
+        }
+        FceuxFrameResult out {};
+        out.output = FCEUX_FRAME_OUTPUT_LAST;
+        out.video = video.data();
+        CHECK(fceux_run_frames(ctx, &in, 1, &out) == 1);
+
+        const Cpu c = cpu(ctx);
+        std::printf("%s idle_skip=%d frame %d: ram %016llx wram %016llx pc %04X a %02X x %02X y %02X s %02X p %02X "
+                    "cycles %llu video %016llx\n",
+            path, idle_skip ? 1 : 0, i,
+            static_cast<unsigned long long>(hash(memory(ctx, FCEUX_MEMORY_RAM))),
+            static_cast<unsigned long long>(hash(memory(ctx, FCEUX_MEMORY_PRG_RAM))),
+            c.pc, c.a, c.x, c.y, c.s, c.p, static_cast<unsigned long long>(c.cycles),
+            static_cast<unsigned long long>(hash(video)));
+    }
+
+    fceux_destroy(ctx);
+}
+
+} // anonymous namespace
+
+int main() {
+    const char* const paths[2] = { "dispatch_nrom.nes", "dispatch_mmc3.nes" };
+    write_rom(paths[0], 0);
+    write_rom(paths[1], 4);
+
+    for(int r = 0; r < 2; ++r) {
+        for(bool idle_skip : { false, true })
+            trace(paths[r], idle_skip, static_cast<std::uint32_t>(r + 1));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+// フラット形式 (FCEUX_SNAPSHOT_FLAT) のスナップショットが、FCSX 形式のものと同じ状態を表すことを確かめる。
+// 同じ時点で両方の形式で保存して別々のコンテキストにロードし、状態のハッシュ値と、そこから FCSX 形式で
+// 保存し直した内容と、その後のフレームの映像とハッシュ値が一致することを確かめる。
+// フレーム途中で保存したもの (常にフラット形式) は、保存元のコンテキストとその後のフレームを比べる。
+// 別のマッパーの ROM をロードしたコンテキストには、フラット形式のものはロードできないことも確かめる。
+// NROM と MMC3 の ROM で行う。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int ROUNDS = 80;
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+std::vector<std::uint8_t> serialize(Snapshot* snap) {
+    std::vector<std::uint8_t> buf(fceux_snapshot_serialize(snap, nullptr, 0));
+    CHECK(fceux_snapshot_serialize(snap, buf.data(), buf.size()) == buf.size());
+    return buf;
+}
+
+// ctx の状態を FCSX 形式で直列化したもの
+std::vector<std::uint8_t> fcsx_bytes(FceuxContext* ctx) {
+    Snapshot* snap = fceux_snapshot_create();
+    CHECK(fceux_snapshot_save(ctx, snap));
+    std::vector<std::uint8_t> buf = serialize(snap);
+    fceux_snapshot_destroy(snap);
+    return buf;
+}
+
+// inputs の各フレームを実行し、最終フレームの映像を返す
+std::vector<std::uint8_t> run(FceuxContext* ctx, const std::vector<std::uint16_t>& inputs) {
+    std::vector<std::uint8_t> video(256 * 240);
+    FceuxFrameResult out {};
+    out.output = FCEUX_FRAME_OUTPUT_LAST;
+    out.video = video.data();
+    CHECK(fceux_run_frames(ctx, inputs.data(), inputs.size(), &out) == inputs.size());
+    return video;
+}
+
+// a と b を同じ入力で進め、映像とハッシュ値を比べる
+void check_following(FceuxContext* a, FceuxContext* b, Rng& rng, const char* path, int round) {
+    std::vector<std::uint16_t> inputs(1 + rng(3));
+    for(auto& in : inputs) in = static_cast<std::uint16_t>(rng(0x10000));
+    if(run(a, inputs) != run(b, inputs) || fceux_state_hash(a, 0) != fceux_state_hash(b, 0)) {
+        std::fprintf(stderr, "%s: round %d: the frames after the loads differ\n", path, round);
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// 最後に保存したフラット形式のスナップショットを返す
+Snapshot* check(const char* path, std::uint32_t seed) {
+    FceuxContext* src = fceux_create(path);
+    FceuxContext* a = fceux_create(path);
+    FceuxContext* b = fceux_create(path);
+    CHECK(src && a && b);
+
+    Rng rng { seed };
+    Snapshot* fcsx = fceux_snapshot_create();
+    Snapshot* flat = fceux_snapshot_create();
+    int midframe = 0;
+    for(int round = 0; round < ROUNDS; ++round) {
+        std::vector<std::uint16_t> inputs(1 + rng(4));
+        for(auto& in : inputs) in = static_cast<std::uint16_t>(rng(0x10000));
+        run(src, inputs);
+
+        if(round % 4 == 3) {
+            // フレーム途中
+            CHECK(fceux_run_cycles(src, 1000 + rng(25000)) > 0);
+            CHECK(fceux_midframe(src));
+            CHECK(fceux_snapshot_save(src, flat));
+            CHECK(fceux_snapshot_load(b, flat));
+            CHECK(fceux_midframe(b));
+            CHECK(fceux_state_hash(b, 0) == fceux_state_hash(src, 0));
+            check_following(src, b, rng, path, round);
+            ++midframe;
+            continue;
+        }
+
+        CHECK(fceux_snapshot_save(src, fcsx));
+        CHECK(fceux_snapshot_save_ex(src, flat, round % 2 ? FCEUX_SNAPSHOT_FLAT : FCEUX_SNAPSHOT_FLAT | FCEUX_SNAPSHOT_SKIP_VIDEO));
+        CHECK(fceux_snapshot_size(flat) > 0);
+        CHECK(fceux_snapshot_load(a, fcsx));
+        CHECK(fceux_snapshot_load(b, flat));
+
+        const std::uint64_t hash = fceux_state_hash(src, 0);
+        CHECK(fceux_state_hash(a, 0) == hash && fceux_state_hash(b, 0) == hash);
+        if(fcsx_bytes(a) != fcsx_bytes(b)) {
+            std::fprintf(stderr, "%s: round %d: the FCSX and flat loads save different FCSX states\n", path, round);
+            std::exit(EXIT_FAILURE);
+        }
+        check_following(a, b, rng, path, round);
+    }
+    CHECK(midframe == ROUNDS / 4);
+
+    fceux_snapshot_destroy(fcsx);
+    fceux_destroy(src);
+    fceux_destroy(a);
+    fceux_destroy(b);
+    return flat;
+}
+
+} // anonymous namespace
+
+int main() {
+    const char* const paths[2] = { "flat_nrom.nes", "flat_mmc3.nes" };
+    write_rom(paths[0], 0);
+    write_rom(paths[1], 4);
+
+    Snapshot* flats[2];
+    for(int r = 0; r < 2; ++r)
+        flats[r] = check(paths[r], static_cast<std::uint32_t>(r + 1));
+
+    // フィールドの並びが異なるので、別のマッパーのものはロードできず、コンテキストも変わらない
+    for(int r = 0; r < 2; ++r) {
+        FceuxContext* other = fceux_create(paths[1 - r]);
+        CHECK(other);
+        const std::uint16_t in = 0;
+        CHECK(fceux_run_frames(other, &in, 1, nullptr) == 1);
+        const std::uint64_t hash = fceux_state_hash(other, 0);
+        CHECK(!fceux_snapshot_load(other, flats[r]));
+        CHECK(fceux_state_hash(other, 0) == hash);
+        fceux_destroy(other);
+        fceux_snapshot_destroy(flats[r]);
+    }
+
+    std::puts("flat_snapshots: ok");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+// 即時評価する停止条件で fceux_run_frames() がフレーム途中に止まったときの扱いを確かめる。
+// 条件なしで実行した参照の各フレーム境界のハッシュ値を記録しておき、条件を登録したコンテキストで
+// 止まるたびに続きのフレームの入力 (inputs + 実行したフレーム数) から呼び直して最後まで実行する。
+// - フレーム途中で止まったら戻り値と stop_frame が等しく、条件が成り立っていること
+// - フレーム境界で止まったら戻り値が stop_frame + 1 で、状態が参照のそのフレームのものと一致すること
+// - 戻り値の合計がフレーム数と一致し (止まったフレームを二重に数えない)、最後の状態が参照と一致すること
+// - 値が条件を満たすフレームでは必ず止まること
+// - フレーム途中で止まった状態のスナップショットを別のコンテキストにロードしてフレームの残りを実行すると、参照と一致すること
+// NROM と MMC3 の ROM で行う。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr std::size_t FRAMES = 150;
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+std::uint8_t peek(FceuxContext* ctx, std::uint16_t addr) {
+    return fceux_mem_read(ctx, addr, FCEUX_MEMORY_CPU);
+}
+
+// 条件なしで実行したときの各フレーム境界の状態
+struct Reference {
+    std::vector<std::uint64_t> hashes;
+    std::vector<std::uint8_t> counter; // $11 (メインループが毎フレーム増やす)
+    std::vector<std::uint8_t> sum;     // $15 = $10 + $11
+};
+
+Reference run_reference(const char* path, const std::vector<std::uint16_t>& inputs) {
+    FceuxContext* ctx = fceux_create(path);
+    CHECK(ctx);
+    Reference ref;
+    for(std::size_t i = 0; i < FRAMES; ++i) {
+        CHECK(fceux_run_frames(ctx, &inputs[i], 1, nullptr) == 1);
+        ref.hashes.push_back(fceux_state_hash(ctx, 0));
+        ref.counter.push_back(peek(ctx, 0x11));
+        ref.sum.push_back(peek(ctx, 0x15));
+    }
+    fceux_destroy(ctx);
+    return ref;
+}
+
+void run(const char* path, std::uint32_t seed) {
+    Rng rng { seed };
+    std::vector<std::uint16_t> inputs(FRAMES);
+    for(auto& in : inputs) in = static_cast<std::uint16_t>(rng(0x10000));
+    const Reference ref = run_reference(path, inputs);
+
+    FceuxContext* ctx = fceux_create(path);
+    FceuxContext* replay = fceux_create(path);
+    CHECK(ctx && replay);
+
+    // $15 が参照に現れる値になったら止める条件と、$11 が変わったら止める条件
+    const std::uint8_t target = ref.sum[FRAMES / 2 + rng(FRAMES / 2)];
+    const FceuxCondTerm sum_term { 0x15, FCEUX_COND_BYTE, 1, FCEUX_COND_EQ, target, 0 };
+    const FceuxCondTerm counter_term { 0x11, FCEUX_COND_BYTE, 1, FCEUX_COND_CHANGED, 0, 0 };
+    const int sum_id = fceux_cond_add(ctx, &sum_term, 1, FCEUX_COND_ALL, FCEUX_COND_IMMEDIATE);
+    CHECK(sum_id >= 0);
+    int counter_id = -1;
+
+    std::set<std::size_t> stopped;
+    std::size_t pos = 0; // 完了したフレーム数
+    int midframe_stops = 0;
+    Snapshot* snap = fceux_snapshot_create();
+    while(pos < FRAMES) {
+        // FRAMES / 3 フレーム目からは $11 の条件も加える。以降は毎フレームのフレーム途中で止まる
+        if(counter_id < 0 && pos == FRAMES / 3 && !fceux_midframe(ctx)) {
+            counter_id = fceux_cond_add(ctx, &counter_term, 1, FCEUX_COND_ALL, FCEUX_COND_IMMEDIATE);
+            CHECK(counter_id >= 0);
+        }
+        const std::size_t limit = counter_id < 0 && pos < FRAMES / 3 ? FRAMES / 3 : FRAMES;
+
+        FceuxFrameResult out {};
+        const std::size_t n = fceux_run_frames(ctx, &inputs[pos], limit - pos, &out);
+        CHECK(n <= limit - pos);
+
+        if(out.stop_cond < 0) {
+            CHECK(n == limit - pos && !fceux_midframe(ctx));
+            CHECK(fceux_state_hash(ctx, 0) == ref.hashes[limit - 1]);
+            pos += n;
+            continue;
+        }
+
+        const std::size_t frame = pos + out.stop_frame;
+        stopped.insert(frame);
+        if(fceux_midframe(ctx)) {
+            // フレーム frame は途中まで。次の呼び出しの 1 フレーム目がその残りになる
+            CHECK(n == out.stop_frame);
+            ++midframe_stops;
+            if(out.stop_cond == sum_id) {
+                CHECK(peek(ctx, 0x15) == target);
+            }
+            else {
+                // 前回の値は直前のフレーム境界での値
+                CHECK(out.stop_cond == counter_id);
+                CHECK(frame == 0 || peek(ctx, 0x11) != ref.counter[frame - 1]);
+            }
+
+            // 止まった状態を別のコンテキストで再現し、フレームの残りを実行する
+            CHECK(fceux_snapshot_save(ctx, snap));
+            CHECK(fceux_snapshot_load(replay, snap));
+            CHECK(fceux_state_hash(replay, 0) == fceux_state_hash(ctx, 0));
+            CHECK(fceux_midframe(replay));
+            CHECK(fceux_run_frames(replay, &inputs[frame], 1, nullptr) == 1);
+            if(fceux_state_hash(replay, 0) != ref.hashes[frame]) {
+                std::fprintf(stderr, "%s: frame %zu does not finish as the reference after the stop\n", path, frame);
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            CHECK(n == out.stop_frame + 1);
+            CHECK(fceux_state_hash(ctx, 0) == ref.hashes[frame]);
+        }
+        pos += n;
+    }
+
+    CHECK(pos == FRAMES);
+    if(fceux_state_hash(ctx, 0) != ref.hashes[FRAMES - 1]) {
+        std::fprintf(stderr, "%s: resuming after the stops does not reach the reference\n", path);
+        std::exit(EXIT_FAILURE);
+    }
+    for(std::size_t i = 0; i < FRAMES; ++i)
+        CHECK(ref.sum[i] != target || stopped.count(i));
+    CHECK(midframe_stops >= static_cast<int>(FRAMES / 2));
+
+    fceux_snapshot_destroy(snap);
+    fceux_destroy(replay);
+    fceux_destroy(ctx);
+}
+
+} // anonymous namespace
+
+int main() {
+    const char* const paths[2] = { "immediate_nrom.nes", "immediate_mmc3.nes" };
+    write_rom(paths[0], 0);
+    write_rom(paths[1], 4);
+
+    for(int r = 0; r < 2; ++r)
+        run(paths[r], static_cast<std::uint32_t>(r + 1));
+
+    std::puts("immediate_stop: ok");
+    return EXIT_SUCCESS;
+}
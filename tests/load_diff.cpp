@@ -0,0 +1,111 @@
+// fceux_snapshot_load_diff() が fceux_snapshot_load() と同じ状態にすることを確かめる。
+// フラット形式・差分・ストア・FCSX 形式のスナップショットをフレーム途中のものも混ぜて保存しておき、
+// 一方のコンテキストには fceux_snapshot_load() で、もう一方には直前の状態から fceux_snapshot_load_diff() で
+// ランダムな順にロードする。そのたびに状態のハッシュ値と CPU から見た PRG のバンク配置を比べ、
+// その後のフレームも比べる。NROM と MMC3 の ROM で行う。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int SNAPSHOTS = 120;
+constexpr int LOADS = 300;
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+// CPU から見た $8000-$FFFF
+std::vector<std::uint8_t> prg_mapping(FceuxContext* ctx) {
+    std::vector<std::uint8_t> buf(0x8000);
+    CHECK(fceux_mem_read_range(ctx, FCEUX_MEMORY_CPU, 0x8000, buf.data(), buf.size()) == buf.size());
+    return buf;
+}
+
+void compare(FceuxContext* load, FceuxContext* diff, const char* path, int i, const char* what) {
+    if(fceux_state_hash(load, 0) != fceux_state_hash(diff, 0) || fceux_midframe(load) != fceux_midframe(diff) ||
+       !(cpu(load) == cpu(diff)) || prg_mapping(load) != prg_mapping(diff)) {
+        std::fprintf(stderr, "%s: load %d: load_diff differs from load %s\n", path, i, what);
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+void run(const char* path, std::uint32_t seed) {
+    FceuxContext* src = fceux_create(path);
+    FceuxContext* load = fceux_create(path);
+    FceuxContext* diff = fceux_create(path);
+    CHECK(src && load && diff);
+    SnapStore* store = fceux_snapstore_create(0);
+    CHECK(store);
+
+    Rng rng { seed };
+    std::vector<Snapshot*> snaps;
+    for(int i = 0; i < SNAPSHOTS; ++i) {
+        const std::uint16_t in = static_cast<std::uint16_t>(rng(0x10000));
+        CHECK(fceux_run_frames(src, &in, 1 + rng(2), nullptr) >= 1);
+        if(rng(4) == 0) {
+            CHECK(fceux_run_cycles(src, 1000 + rng(25000)) > 0);
+            CHECK(fceux_midframe(src));
+        }
+
+        Snapshot* snap = fceux_snapshot_create();
+        switch(i % 4) {
+        case 0: CHECK(fceux_snapshot_save_ex(src, snap, FCEUX_SNAPSHOT_FLAT)); break;
+        case 1: CHECK(fceux_snapshot_save_delta(src, snap, snaps.back(), 0)); break;
+        case 2: CHECK(fceux_snapshot_save(src, snap)); break; // フレーム途中ならフラット形式になる
+        default: CHECK(fceux_snapstore_save(store, src, snap, 0)); break;
+        }
+        snaps.push_back(snap);
+    }
+
+    for(int i = 0; i < LOADS; ++i) {
+        // 近い状態どうしの移動が多くなるよう、直前のものの近くを選ぶことが多い
+        const std::size_t k = rng(3) == 0 ? rng(SNAPSHOTS) : (i * 7 + rng(5)) % SNAPSHOTS;
+        CHECK(fceux_snapshot_load(load, snaps[k]));
+        CHECK(fceux_snapshot_load_diff(diff, snaps[k]));
+        compare(load, diff, path, i, "after the load");
+
+        // 同じ状態へのロードはほとんど何も書かないが、状態は変わらない
+        if(i % 10 == 0) {
+            CHECK(fceux_snapshot_load_diff(diff, snaps[k]));
+            compare(load, diff, path, i, "after loading the same state again");
+        }
+
+        for(std::uint32_t n = rng(3); n > 0; --n) {
+            const std::uint16_t in = static_cast<std::uint16_t>(rng(0x10000));
+            CHECK(fceux_run_frames(load, &in, 1, nullptr) == 1);
+            CHECK(fceux_run_frames(diff, &in, 1, nullptr) == 1);
+            compare(load, diff, path, i, "in the following frames");
+        }
+    }
+
+    for(Snapshot* snap : snaps) fceux_snapshot_destroy(snap);
+    fceux_snapstore_destroy(store);
+    for(FceuxContext* ctx : { src, load, diff }) fceux_destroy(ctx);
+}
+
+} // anonymous namespace
+
+int main() {
+    const char* const paths[2] = { "load_diff_nrom.nes", "load_diff_mmc3.nes" };
+    write_rom(paths[0], 0);
+    write_rom(paths[1], 4);
+
+    for(int r = 0; r < 2; ++r)
+        run(paths[r], static_cast<std::uint32_t>(r + 1));
+
+    std::puts("load_diff: ok");
+    return EXIT_SUCCESS;
+}
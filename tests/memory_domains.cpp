@@ -0,0 +1,178 @@
+// メモリ領域の範囲での読み書きを、1 Byte ずつの読み書きと比べる。
+// 各領域について、ランダムな位置と長さ (末尾をまたぐものを含む) の範囲読み込みが fceux_mem_read() を並べたものと一致し、
+// 配列として見られる領域では fceux_mem_domain_view() の内容とも一致することを確かめる。
+// 範囲書き込みは、同じ状態の別のコンテキストに 1 Byte ずつ書いたものと状態のハッシュ値が一致することを確かめる。
+// フレーム境界とフレーム途中の両方で、NROM と MMC3 の ROM で行う。
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int ROUNDS = 40;
+
+const FceuxMemoryDomain DOMAINS[] = {
+    FCEUX_MEMORY_CPU, FCEUX_MEMORY_RAM, FCEUX_MEMORY_PRG_RAM, FCEUX_MEMORY_PRG_ROM, FCEUX_MEMORY_CHR,
+    FCEUX_MEMORY_NAMETABLE, FCEUX_MEMORY_OAM, FCEUX_MEMORY_PALETTE, FCEUX_MEMORY_PPU_REG, FCEUX_MEMORY_APU_REG,
+};
+
+// 範囲で書き込める領域
+const FceuxMemoryDomain WRITABLE[] = {
+    FCEUX_MEMORY_RAM, FCEUX_MEMORY_PRG_RAM, FCEUX_MEMORY_NAMETABLE, FCEUX_MEMORY_OAM, FCEUX_MEMORY_PALETTE,
+};
+
+bool has_view(FceuxMemoryDomain domain) {
+    switch(domain) {
+    case FCEUX_MEMORY_RAM: case FCEUX_MEMORY_PRG_RAM: case FCEUX_MEMORY_PRG_ROM:
+    case FCEUX_MEMORY_CHR: case FCEUX_MEMORY_OAM: case FCEUX_MEMORY_PALETTE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+// 1 Byte ずつの読み込みが多いので、コアのスレッド上で行う。
+// その場で終了するとコアのスレッドを止められないので、失敗したら ok を外して戻る
+struct ReadCheck {
+    FceuxContext* ctx;
+    Rng* rng;
+    bool ok;
+};
+
+#define EXPECT(cond) \
+    do { \
+        if(!(cond)) { \
+            std::fprintf(stderr, "%s:%d: EXPECT failed: %s\n", __FILE__, __LINE__, #cond); \
+            c.ok = false; \
+            return; \
+        } \
+    } while(0)
+
+void check_reads(void* userdata) {
+    ReadCheck& c = *static_cast<ReadCheck*>(userdata);
+    FceuxContext* const ctx = c.ctx;
+    Rng& rng = *c.rng;
+
+    for(FceuxMemoryDomain domain : DOMAINS) {
+        const std::size_t size = fceux_mem_domain_size(ctx, domain);
+        if(size == 0) continue;
+
+        // 全体
+        std::vector<std::uint8_t> all(size);
+        EXPECT(fceux_mem_read_range(ctx, domain, 0, all.data(), size) == size);
+        for(std::size_t a = 0; a < size; ++a) {
+            if(all[a] == fceux_mem_read(ctx, static_cast<std::uint16_t>(a), domain)) continue;
+            std::fprintf(stderr, "domain %d: the range read differs from the byte read at %zx\n", domain, a);
+            c.ok = false;
+            return;
+        }
+        if(has_view(domain)) {
+            std::size_t view_size = 0;
+            const std::uint8_t* view = fceux_mem_domain_view(ctx, domain, &view_size);
+            EXPECT(view && view_size == size);
+            EXPECT(std::vector<std::uint8_t>(view, view + size) == all);
+        }
+        else {
+            EXPECT(!fceux_mem_domain_view(ctx, domain, nullptr));
+        }
+
+        // 一部。末尾をまたぐものは打ち切られる
+        for(int i = 0; i < 8; ++i) {
+            const std::size_t addr = rng(static_cast<std::uint32_t>(size));
+            const std::size_t len = 1 + rng(i % 2 ? 0x40 : 0x400);
+            std::vector<std::uint8_t> buf(len, 0xCC);
+            const std::size_t n = fceux_mem_read_range(ctx, domain, addr, buf.data(), len);
+            EXPECT(n == std::min(len, size - addr));
+            EXPECT(std::equal(buf.begin(), buf.begin() + n, all.begin() + addr));
+            EXPECT(std::all_of(buf.begin() + n, buf.end(), [](std::uint8_t v) { return v == 0xCC; }));
+        }
+        std::uint8_t b = 0xCC;
+        EXPECT(fceux_mem_read_range(ctx, domain, size, &b, 1) == 0 && b == 0xCC);
+    }
+}
+
+// a に範囲で、b に 1 Byte ずつ同じ内容を書く
+void check_writes(FceuxContext* a, FceuxContext* b, Rng& rng) {
+    for(FceuxMemoryDomain domain : WRITABLE) {
+        const std::size_t size = fceux_mem_domain_size(a, domain);
+        if(size == 0) continue;
+
+        const std::size_t addr = rng(static_cast<std::uint32_t>(size));
+        std::vector<std::uint8_t> buf(1 + rng(0x100));
+        for(auto& v : buf) v = static_cast<std::uint8_t>(rng(0x100));
+
+        const std::size_t n = fceux_mem_write_range(a, domain, addr, buf.data(), buf.size());
+        CHECK(n == std::min(buf.size(), size - addr));
+        for(std::size_t i = 0; i < n; ++i)
+            fceux_mem_write(b, static_cast<std::uint16_t>(addr + i), buf[i], domain);
+    }
+
+    // ROM は書き込めない
+    for(FceuxMemoryDomain domain : { FCEUX_MEMORY_PRG_ROM, FCEUX_MEMORY_PPU_REG, FCEUX_MEMORY_APU_REG }) {
+        const std::uint8_t v = 0x5A;
+        CHECK(fceux_mem_write_range(a, domain, 0, &v, 1) == 0);
+    }
+
+    if(fceux_state_hash(a, 0) != fceux_state_hash(b, 0)) {
+        std::fprintf(stderr, "range writes and byte writes leave different states\n");
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    const char* const paths[2] = { "domains_nrom.nes", "domains_mmc3.nes" };
+    write_rom(paths[0], 0);
+    write_rom(paths[1], 4);
+
+    for(int r = 0; r < 2; ++r) {
+        FceuxContext* a = fceux_create(paths[r]);
+        FceuxContext* b = fceux_create(paths[r]);
+        CHECK(a && b);
+        CHECK(fceux_mem_domain_size(a, FCEUX_MEMORY_CPU) == 0x10000);
+        CHECK(fceux_mem_domain_size(a, FCEUX_MEMORY_RAM) == 0x800);
+
+        Rng rng { static_cast<std::uint32_t>(r + 1) };
+        for(int i = 0; i < ROUNDS; ++i) {
+            const std::uint16_t in = static_cast<std::uint16_t>(i * 37);
+            if(i % 3 == 1) {
+                // フレーム途中
+                const std::uint64_t cycles = 1000 + rng(20000);
+                CHECK(fceux_run_cycles(a, cycles) == fceux_run_cycles(b, cycles));
+                CHECK(fceux_midframe(a));
+            }
+            else {
+                CHECK(fceux_run_frames(a, &in, 1, nullptr) == 1);
+                CHECK(fceux_run_frames(b, &in, 1, nullptr) == 1);
+            }
+
+            ReadCheck c { a, &rng, true };
+            fceux_call_on_core(a, check_reads, &c);
+            CHECK(c.ok);
+            check_writes(a, b, rng);
+        }
+
+        fceux_destroy(a);
+        fceux_destroy(b);
+    }
+
+    std::puts("memory_domains: ok");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+// フレーム途中での停止 (fceux_run_until_scanline(), fceux_run_cycles()) と、
+// 止まっている間の退避・スナップショットがエミュレーション結果を変えないことを確かめる。
+// フレーム単位で実行するだけの基準のコンテキストと同じ入力で並べて、以下を行う。
+// - フレーム途中で止めてから残りを実行する。止まっている間に別の ROM のコンテキストを操作して退避させる
+// - フレーム途中で保存したスナップショットを別のコンテキストにロードし、少し進めてからロードし直して
+//   (実行中のフレームを捨ててやり直させて) 残りを実行する。シリアライズしたものからも同様にロードする
+// フレームの終わりごとに状態のハッシュ値, RAM, CPU レジスタ, CPU サイクル数, 映像, サウンドを基準と比較する。
+// ただしスナップショットはサウンド出力の持ち越し分を含まない (ロード後もロード先のサウンドが続く) ので、
+// スナップショットをロードしたものはサウンドを比較しない。
+// また、同じスナップショットを fceux_snapshot_load() と fceux_snapshot_load_diff() でロードしたものどうしを比較する。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int FRAMES = 300;
+constexpr int SOUND_FREQ = 48000;
+constexpr std::size_t SOUND_CAPACITY = 4096;
+
+// 入力は 3 フレームごとに変える。
+// フレーム途中から始めたフレームは直前に指定した入力を使い続けるので、変えるのはフレーム境界から実行する時だけにする。
+std::uint16_t input(int frame) {
+    const int i = frame / 3;
+    return static_cast<std::uint16_t>((i * 37) ^ (i >> 2));
+}
+
+// 止めるフレーム。入力を変えるフレームでは止めない
+bool stepped(int frame) {
+    return frame >= 4 && frame % 3 != 0;
+}
+
+struct Frame {
+    std::uint64_t hash;
+    Cpu cpu;
+    std::vector<std::uint8_t> ram;
+    std::vector<std::uint8_t> wram;
+    std::vector<std::uint8_t> video;
+    std::vector<std::int32_t> sound;
+};
+
+FceuxContext* create(const char* path) {
+    FceuxContext* ctx = fceux_create(path);
+    CHECK(ctx);
+    CHECK(fceux_sound_set_freq(ctx, SOUND_FREQ));
+    return ctx;
+}
+
+// フレームの残り (フレーム境界にいれば 1 フレーム) を実行する
+Frame finish(FceuxContext* ctx, std::uint16_t in) {
+    Frame f;
+    f.video.assign(256 * 240, 0);
+    f.sound.assign(SOUND_CAPACITY, 0);
+    FceuxFrameResult out {};
+    out.output = FCEUX_FRAME_OUTPUT_LAST;
+    out.video = f.video.data();
+    out.sound = f.sound.data();
+    out.sound_capacity = SOUND_CAPACITY;
+    CHECK(fceux_run_frames(ctx, &in, 1, &out) == 1);
+    CHECK(!fceux_midframe(ctx));
+    f.sound.resize(out.sound_size);
+    f.hash = fceux_state_hash(ctx, 0);
+    f.cpu = cpu(ctx);
+    f.ram = memory(ctx, FCEUX_MEMORY_RAM);
+    f.wram = memory(ctx, FCEUX_MEMORY_PRG_RAM);
+    return f;
+}
+
+void compare(const Frame& expected, const Frame& actual, int mapper, int frame, const char* what, bool sound) {
+    const bool ok_hash = actual.hash == expected.hash;
+    const bool ok_cpu = actual.cpu == expected.cpu;
+    const bool ok_ram = actual.ram == expected.ram && actual.wram == expected.wram;
+    const bool ok_video = actual.video == expected.video;
+    const bool ok_sound = !sound || actual.sound == expected.sound;
+    if(!(ok_hash && ok_cpu && ok_ram && ok_video && ok_sound)) {
+        std::fprintf(stderr, "mapper %d, frame %d: %s differs (hash %d, cpu %d, ram %d, video %d, sound %d)\n",
+            mapper, frame, what, ok_hash, ok_cpu, ok_ram, ok_video, ok_sound);
+        std::exit(1);
+    }
+}
+
+std::vector<std::uint8_t> serialize(Snapshot* snap) {
+    std::vector<std::uint8_t> buf(fceux_snapshot_serialize(snap, nullptr, 0));
+    CHECK(fceux_snapshot_serialize(snap, buf.data(), buf.size()) == buf.size());
+    return buf;
+}
+
+void run(const char* path, const char* other_path, int mapper) {
+    FceuxContext* ref = create(path);      // フレーム単位で実行するだけ
+    FceuxContext* step = create(path);     // フレーム途中で止める
+    FceuxContext* copy = create(path);     // step のスナップショットをロードして続きを実行する
+    FceuxContext* load = create(path);     // 以下の 2 つは同じスナップショットを異なる方法でロードする
+    FceuxContext* diff = create(path);
+    FceuxContext* other = create(other_path); // step を退避させるために操作する
+
+    std::vector<Snapshot*> snaps;
+    Snapshot* mid = fceux_snapshot_create();
+    int evicted = 0, replayed = 0, diffed = 0;
+    for(int i = 0; i < FRAMES; ++i) {
+        const std::uint16_t in = input(i);
+        bool restored = false;
+        Frame restored_frame, serialized_frame;
+
+        if(stepped(i)) {
+            CHECK(fceux_run_until_scanline(step, (i * 7) % 200) == 1);
+            CHECK(fceux_midframe(step));
+            const std::uint64_t n = 100 + i;
+            CHECK(fceux_run_cycles(step, n) >= n);
+            CHECK(fceux_midframe(step));
+
+            if(i % 5 == 0) {
+                finish(other, in);
+                ++evicted;
+            }
+
+            if(i % 4 == 1) {
+                CHECK(fceux_snapshot_save(step, mid));
+                const std::vector<std::uint8_t> blob = serialize(mid);
+
+                CHECK(fceux_snapshot_load(copy, mid));
+                CHECK(fceux_midframe(copy));
+                CHECK(memory(copy, FCEUX_MEMORY_RAM) == memory(step, FCEUX_MEMORY_RAM));
+                CHECK(cpu(copy) == cpu(step));
+                // 途中まで進めたフレームを捨ててロードし直す (フレーム境界を越えることもある)
+                fceux_run_cycles(copy, 3000 + i * 97);
+                CHECK(fceux_snapshot_load(copy, mid));
+                restored_frame = finish(copy, in);
+
+                fceux_run_cycles(copy, 5000 + i * 31);
+                CHECK(fceux_snapshot_load_serialized(copy, blob.data(), blob.size()));
+                CHECK(fceux_midframe(copy));
+                serialized_frame = finish(copy, in);
+
+                restored = true;
+                ++replayed;
+            }
+        }
+
+        // 後で load と load_diff で比べるスナップショット。フレーム途中のものも混ぜる
+        if(i % 6 == 2) {
+            Snapshot* snap = fceux_snapshot_create();
+            if(snaps.empty() || fceux_midframe(step))
+                CHECK(fceux_snapshot_save_ex(step, snap, FCEUX_SNAPSHOT_FLAT));
+            else
+                CHECK(fceux_snapshot_save_delta(step, snap, snaps.back(), 0));
+            snaps.push_back(snap);
+        }
+
+        const Frame expected = finish(ref, in);
+        compare(expected, finish(step, in), mapper, i, "stepped", true);
+        if(restored) {
+            compare(expected, restored_frame, mapper, i, "mid-frame snapshot", false);
+            compare(expected, serialized_frame, mapper, i, "serialized mid-frame snapshot", false);
+        }
+
+        // diff は直前にロードした状態から数フレーム進んだ状態にあり、そこから別のスナップショットへ移る
+        if(i % 7 == 3 && !snaps.empty()) {
+            Snapshot* snap = snaps[(i * 5) % snaps.size()];
+            CHECK(fceux_snapshot_load(load, snap));
+            CHECK(fceux_snapshot_load_diff(diff, snap));
+            CHECK(fceux_midframe(load) == fceux_midframe(diff));
+            CHECK(memory(load, FCEUX_MEMORY_RAM) == memory(diff, FCEUX_MEMORY_RAM));
+            CHECK(cpu(load) == cpu(diff));
+            for(int k = 0; k < 3; ++k)
+                compare(finish(load, input(i + k)), finish(diff, input(i + k)), mapper, i, "load_diff", false);
+            ++diffed;
+        }
+    }
+
+    // 比較したものが実際にその経路を通っていること
+    CHECK(evicted > 0 && replayed > 0 && diffed > 0);
+    std::printf("mapper %d: %d frames, %d evictions, %d mid-frame reloads, %d load_diff\n",
+        mapper, FRAMES, evicted, replayed, diffed);
+
+    for(Snapshot* snap : snaps) fceux_snapshot_destroy(snap);
+    fceux_snapshot_destroy(mid);
+    for(FceuxContext* ctx : { ref, step, copy, load, diff, other }) fceux_destroy(ctx);
+}
+
+} // anonymous namespace
+
+int main() {
+    const char* nrom = "midframe_equivalence_nrom.nes";
+    const char* mmc3 = "midframe_equivalence_mmc3.nes";
+    write_rom(nrom, 0);
+    write_rom(mmc3, 4);
+    run(nrom, mmc3, 0);
+    run(mmc3, nrom, 4);
+    std::remove(nrom);
+    std::remove(mmc3);
+    return 0;
+}
@@ -0,0 +1,122 @@
+// ページ単位で重複排除するスナップショットのストアを検査する。
+// ストアに保存したスナップショットがそれぞれ保存した時点の状態にロードできることと、
+// 同じ状態を保存し直してもページが増えないこと、スナップショットを破棄・上書きするとページの参照が解放されること、
+// ストアを破棄しても残っているスナップショットはロードできることを確かめる。フレーム途中で保存したものも混ぜる。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int SNAPSHOTS = 200;
+
+FceuxSnapStoreStats stats(SnapStore* store) {
+    FceuxSnapStoreStats s;
+    fceux_snapstore_stats(store, &s);
+    return s;
+}
+
+} // anonymous namespace
+
+int main() {
+    write_rom("pagestore.nes", 4);
+
+    CHECK(!fceux_snapstore_create(12));
+
+    FceuxContext* ctx = fceux_create("pagestore.nes");
+    CHECK(ctx);
+    SnapStore* store = fceux_snapstore_create(0);
+    CHECK(store);
+    CHECK(stats(store).page_size == 256);
+
+    std::vector<Snapshot*> snaps;
+    std::vector<std::uint64_t> hashes;
+    for(int i = 0; i < SNAPSHOTS; ++i) {
+        const std::uint16_t in = static_cast<std::uint16_t>((i / 8) * 37);
+        if(i % 16 == 5) {
+            CHECK(fceux_run_cycles(ctx, 3000 + 97 * i) > 0);
+            CHECK(fceux_midframe(ctx));
+        }
+        else {
+            CHECK(fceux_run_frames(ctx, &in, 1, nullptr) == 1);
+        }
+
+        Snapshot* snap = fceux_snapshot_create();
+        CHECK(fceux_snapstore_save(store, ctx, snap, i % 3 == 0 ? FCEUX_SNAPSHOT_SKIP_VIDEO : 0));
+        snaps.push_back(snap);
+        hashes.push_back(fceux_state_hash(ctx, 0));
+    }
+
+    // 近い状態どうしはほとんどのページを共有する
+    FceuxSnapStoreStats s = stats(store);
+    CHECK(s.snapshot_count == SNAPSHOTS);
+    CHECK(s.page_count * 4 < s.page_ref_count);
+
+    FceuxContext* check = fceux_create("pagestore.nes");
+    CHECK(check);
+    for(int i = 0; i < SNAPSHOTS; ++i) {
+        CHECK(fceux_snapshot_load(check, snaps[i]));
+        if(fceux_state_hash(check, 0) != hashes[i]) {
+            std::fprintf(stderr, "snapshot %d does not load as the state it was saved from\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // 同じ状態を別のスナップショットに保存しても、同じ状態で上書きしてもページは増えない
+    CHECK(fceux_snapshot_load(ctx, snaps.back()));
+    Snapshot* same = fceux_snapshot_create();
+    CHECK(fceux_snapstore_save(store, ctx, same, 0));
+    const FceuxSnapStoreStats twice = stats(store);
+    CHECK(twice.page_count == s.page_count);
+    CHECK(twice.page_ref_count > s.page_ref_count);
+    CHECK(fceux_snapstore_save(store, ctx, snaps.back(), 0));
+    CHECK(stats(store).page_count == s.page_count);
+    CHECK(stats(store).page_ref_count == twice.page_ref_count);
+    fceux_snapshot_destroy(same);
+    CHECK(stats(store).page_ref_count == s.page_ref_count);
+
+    // 前半を破棄するとその分の参照が外れ、後半はそのままロードできる
+    for(int i = 0; i < SNAPSHOTS / 2; ++i)
+        fceux_snapshot_destroy(snaps[i]);
+    const FceuxSnapStoreStats half = stats(store);
+    CHECK(half.snapshot_count == SNAPSHOTS - SNAPSHOTS / 2);
+    CHECK(half.page_count < s.page_count);
+    CHECK(half.page_ref_count < s.page_ref_count);
+
+    // ストアの外に保存し直すとストアのページを手放す
+    CHECK(fceux_snapshot_save(ctx, snaps[SNAPSHOTS / 2]));
+    CHECK(stats(store).snapshot_count == half.snapshot_count - 1);
+
+    // ストアを破棄しても残りはロードできる
+    fceux_snapstore_destroy(store);
+    for(int i = SNAPSHOTS / 2 + 1; i < SNAPSHOTS; ++i) {
+        CHECK(fceux_snapshot_load(check, snaps[i]));
+        CHECK(fceux_state_hash(check, 0) == hashes[i]);
+    }
+    for(int i = SNAPSHOTS / 2; i < SNAPSHOTS; ++i)
+        fceux_snapshot_destroy(snaps[i]);
+
+    // 全て手放せばページも残らない (別のストアで確かめる)
+    SnapStore* empty = fceux_snapstore_create(64);
+    CHECK(empty);
+    Snapshot* a = fceux_snapshot_create();
+    CHECK(fceux_snapstore_save(empty, ctx, a, 0));
+    CHECK(stats(empty).page_count > 0);
+    fceux_snapshot_destroy(a);
+    CHECK(stats(empty).snapshot_count == 0);
+    CHECK(stats(empty).page_count == 0);
+    CHECK(stats(empty).page_ref_count == 0);
+    fceux_snapstore_destroy(empty);
+
+    fceux_destroy(check);
+    fceux_destroy(ctx);
+
+    std::puts("pagestore_dedup: ok");
+    return EXIT_SUCCESS;
+}
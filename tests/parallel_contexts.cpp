@@ -0,0 +1,200 @@
+// 異なるコアのコンテキストを複数のスレッドから並列に動かしても、1 つずつ動かした場合と結果が変わらないことを確かめる。
+// NROM と MMC3 の ROM のコンテキストを 2 つずつ作り、まずコアを 1 つに制限して 1 スレッドで交互に実行し、
+// フレームごとの状態のハッシュ値と CPU レジスタ, フック関数の呼び出し回数を記録する。
+// 次にコアを CONTEXTS 個まで許して作り直し、コンテキストごとのスレッドで同時に実行して記録と比較する。
+// 並列側では以下も行う (基準側でも同じ位置で同じことをする)。
+// - フック関数から実行中のコンテキストの RAM を読む (コアのスレッド上でその場で実行される)
+// - フレーム途中で止めてから残りを実行する
+// - 基準側で保存した差分スナップショットを、同じ ROM の 2 つのコンテキストが同時にロードする
+// 並列側の最初のコンテキストは基準側が使ったコアに作られるので、コアの履歴が新しいコンテキストに残らないことも確かめられる。
+// また、並列側のフック関数がコンテキストごとに別のスレッドで呼ばれ、fceux_call_on_core() の関数も同じスレッドで呼ばれることを確かめる。
+// 最後に、フレーム途中で止めたコンテキストの残りを別のスレッドから実行しても、同じスレッドで続けた場合と一致することを確かめる
+// (コアを 1 つにしたビルドでは、呼び出し元のスレッドが変わると止めたフレームを先頭から実行し直す)。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int CONTEXTS = 4;
+constexpr int FRAMES = 120;
+// このフレームの先頭で基準側はスナップショットを保存し、並列側はそれをロードする
+constexpr int SNAP_FRAME = 60;
+// このフレームは途中で一度止める
+constexpr int STOP_FRAME = 90;
+constexpr std::uint64_t STOP_CYCLES = 12345;
+
+const char* const PATHS[2] = { "parallel_nrom.nes", "parallel_mmc3.nes" };
+
+// コンテキスト c の ROM は PATHS[c % 2]。
+// 同じ ROM のコンテキストは SNAP_FRAME までは同じ入力で、以降は別々の入力になる
+std::uint16_t input(int c, int frame) {
+    const int i = frame < SNAP_FRAME ? frame / 4 : frame / 4 + 11 * c;
+    return static_cast<std::uint16_t>((i * 37) ^ (i >> 2));
+}
+
+struct Hook {
+    FceuxContext* ctx;
+    std::uint64_t count;
+    std::uint64_t ram_sum;
+    std::thread::id thread;
+};
+
+void hook(void* userdata, std::uint16_t) {
+    auto h = static_cast<Hook*>(userdata);
+    if(h->count++ % 64 == 0)
+        h->ram_sum += fceux_mem_read(h->ctx, 0x12, FCEUX_MEMORY_RAM);
+    h->thread = std::this_thread::get_id();
+}
+
+struct Frame {
+    std::uint64_t hash;
+    Cpu cpu;
+    std::uint64_t hook_count;
+    std::uint64_t ram_sum;
+};
+
+struct Runner {
+    FceuxContext* ctx;
+    Hook hook;
+    std::vector<Frame> frames;
+    std::thread::id record_thread;
+};
+
+void create(Runner& r, int c) {
+    CHECK(r.ctx = fceux_create(PATHS[c % 2]));
+    r.hook = Hook { r.ctx, 0, 0, {} };
+    fceux_hook_before_exec(r.ctx, hook, &r.hook);
+    r.frames.clear();
+}
+
+void record(void* userdata) {
+    auto& r = *static_cast<Runner*>(userdata);
+    r.frames.push_back(Frame { fceux_state_hash(r.ctx, 0), cpu(r.ctx), r.hook.count, r.hook.ram_sum });
+    r.record_thread = std::this_thread::get_id();
+}
+
+// フレーム i を実行して記録する
+void step(Runner& r, int c, int i) {
+    const std::uint16_t in = input(c, i);
+    if(i == STOP_FRAME) {
+        // このフレームは直前の入力のまま実行される (基準側も同じ)
+        CHECK(fceux_run_cycles(r.ctx, STOP_CYCLES) >= STOP_CYCLES);
+        CHECK(fceux_midframe(r.ctx));
+    }
+    CHECK(fceux_run_frames(r.ctx, &in, 1, nullptr) == 1);
+    // 記録はコアのスレッド上でまとめて行う
+    fceux_call_on_core(r.ctx, record, &r);
+}
+
+} // anonymous namespace
+
+int main() {
+    write_rom(PATHS[0], 0);
+    write_rom(PATHS[1], 4);
+
+    // 基準: 1 つのコアで、1 スレッドから交互に実行する
+    fceux_set_core_limit(1);
+    Runner ref[CONTEXTS];
+    for(int c = 0; c < CONTEXTS; ++c)
+        create(ref[c], c);
+
+    // ROM ごとのスナップショット。base からの差分として snap を保存する
+    Snapshot* base[2];
+    Snapshot* snap[2];
+    for(int k = 0; k < 2; ++k) {
+        base[k] = fceux_snapshot_create();
+        snap[k] = fceux_snapshot_create();
+    }
+
+    for(int i = 0; i < FRAMES; ++i) {
+        for(int c = 0; c < CONTEXTS; ++c) {
+            if(c < 2 && i == SNAP_FRAME - 10)
+                CHECK(fceux_snapshot_save_ex(ref[c].ctx, base[c], FCEUX_SNAPSHOT_FLAT));
+            if(c < 2 && i == SNAP_FRAME)
+                CHECK(fceux_snapshot_save_delta(ref[c].ctx, snap[c], base[c], 0));
+            step(ref[c], c, i);
+        }
+    }
+
+    // 基準側でも全コンテキストが同じスレッドで動いている
+    for(int c = 1; c < CONTEXTS; ++c)
+        CHECK(ref[c].hook.thread == ref[0].hook.thread);
+    for(int c = 0; c < CONTEXTS; ++c)
+        fceux_destroy(ref[c].ctx);
+
+    // 並列: コンテキストごとに別のコアとスレッド
+    fceux_set_core_limit(CONTEXTS);
+    Runner par[CONTEXTS];
+    for(int c = 0; c < CONTEXTS; ++c)
+        create(par[c], c);
+
+    std::vector<std::thread> threads;
+    for(int c = 0; c < CONTEXTS; ++c) {
+        threads.emplace_back([&par, &snap, c] {
+            for(int i = 0; i < FRAMES; ++i) {
+                if(i == SNAP_FRAME)
+                    CHECK(fceux_snapshot_load(par[c].ctx, snap[c % 2]));
+                step(par[c], c, i);
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+
+    for(int c = 0; c < CONTEXTS; ++c) {
+        for(int i = 0; i < FRAMES; ++i) {
+            const Frame& a = ref[c].frames[i];
+            const Frame& b = par[c].frames[i];
+            if(a.hash == b.hash && a.cpu == b.cpu && a.hook_count == b.hook_count && a.ram_sum == b.ram_sum) continue;
+            std::fprintf(stderr, "context %d: frame %d differs from the sequential run\n", c, i);
+            return EXIT_FAILURE;
+        }
+        for(int d = 0; d < c; ++d)
+            CHECK(par[c].hook.thread != par[d].hook.thread);
+        CHECK(par[c].hook.thread != std::this_thread::get_id());
+        CHECK(par[c].record_thread == par[c].hook.thread);
+    }
+
+    for(int c = 0; c < CONTEXTS; ++c)
+        fceux_destroy(par[c].ctx);
+    fceux_destroy(nullptr); // 何もしない
+    for(int k = 0; k < 2; ++k) {
+        fceux_snapshot_destroy(base[k]);
+        fceux_snapshot_destroy(snap[k]);
+    }
+
+    // フレーム途中で止めた後、same は同じスレッドで、moved は別のスレッドで残りを実行する
+    FceuxContext* same = fceux_create(PATHS[1]);
+    FceuxContext* moved = fceux_create(PATHS[1]);
+    CHECK(same && moved);
+    for(FceuxContext* ctx : { same, moved }) {
+        for(int i = 0; i < 3; ++i) {
+            const std::uint16_t in = input(0, i * 4);
+            CHECK(fceux_run_frames(ctx, &in, 1, nullptr) == 1);
+        }
+        CHECK(fceux_run_cycles(ctx, STOP_CYCLES) >= STOP_CYCLES);
+        CHECK(fceux_midframe(ctx));
+    }
+    const std::uint16_t in = input(0, 12);
+    CHECK(fceux_run_frames(same, &in, 1, nullptr) == 1);
+    // moved を止めたフレームの途中の状態でコアに載せてから、別のスレッドに渡す
+    fceux_mem_read(moved, 0x10, FCEUX_MEMORY_RAM);
+    bool moved_ok = false;
+    std::thread([&] { moved_ok = fceux_midframe(moved) && fceux_run_frames(moved, &in, 1, nullptr) == 1; }).join();
+    CHECK(moved_ok);
+    CHECK(fceux_state_hash(moved, 0) == fceux_state_hash(same, 0));
+    CHECK(cpu(moved) == cpu(same));
+    fceux_destroy(same);
+    fceux_destroy(moved);
+
+    std::puts("parallel_contexts: ok");
+    return EXIT_SUCCESS;
+}
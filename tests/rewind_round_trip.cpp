@@ -0,0 +1,98 @@
+// 巻き戻しバッファに追加した状態に戻せることを確かめる。
+// フレームごとに状態を追加してハッシュ値を記録し、ランダムな k で戻ったときの状態が k 個前に追加した時点のものと一致することと、
+// 戻った後に別の入力で進めて (分岐して) 追加し直しても同じことが成り立つことを確かめる。
+// 上限の小さいバッファでは古いものが捨てられても、残っているものには正しく戻れることを確かめる。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int STEPS = 600;
+
+struct Case {
+    std::size_t budget;
+    std::uint32_t keyframe_interval;
+    bool trims; // 古いものが捨てられるはずか
+};
+
+// 追加した順のハッシュ値を hashes に持ち、バッファと同じように古いものを捨て、戻ったら新しいものを捨てる
+void run(FceuxContext* ctx, const Case& c) {
+    RewindBuffer* rw = fceux_rewind_create(c.budget, c.keyframe_interval);
+    CHECK(rw);
+    std::vector<std::uint64_t> hashes;
+    bool trimmed = false;
+
+    std::uint32_t rng = 1;
+    const auto next = [&rng](std::uint32_t n) {
+        rng = rng * 1103515245 + 12345;
+        return (rng >> 8) % n;
+    };
+
+    for(int i = 0; i < STEPS; ++i) {
+        const std::uint16_t in = static_cast<std::uint16_t>(next(0x10000));
+        CHECK(fceux_run_frames(ctx, &in, 1, nullptr) == 1);
+        CHECK(fceux_rewind_push(rw, ctx));
+        hashes.push_back(fceux_state_hash(ctx, 0));
+
+        const std::size_t count = fceux_rewind_count(rw);
+        CHECK(count >= 1 && count <= hashes.size());
+        trimmed |= count < hashes.size();
+        hashes.erase(hashes.begin(), hashes.end() - count);
+
+        if(next(8) == 0) {
+            const std::size_t k = next(static_cast<std::uint32_t>(count));
+            CHECK(fceux_rewind_back(rw, ctx, k));
+            hashes.resize(count - k);
+            CHECK(fceux_rewind_count(rw) == hashes.size());
+            if(fceux_state_hash(ctx, 0) != hashes.back()) {
+                std::fprintf(stderr, "step %d: rewinding %zu of %zu does not give the state pushed then\n", i, k, count);
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        // 保持している数以上は戻れず、ctx も変わらない
+        if(next(32) == 0) {
+            const std::uint64_t hash = fceux_state_hash(ctx, 0);
+            CHECK(!fceux_rewind_back(rw, ctx, fceux_rewind_count(rw)));
+            CHECK(fceux_state_hash(ctx, 0) == hash);
+        }
+    }
+
+    // 残っているもののうち最も古いものまで戻れる
+    CHECK(fceux_rewind_back(rw, ctx, fceux_rewind_count(rw) - 1));
+    CHECK(fceux_state_hash(ctx, 0) == hashes.front());
+    CHECK(fceux_rewind_count(rw) == 1);
+    CHECK(trimmed == c.trims);
+
+    // フレーム途中では追加しない
+    CHECK(fceux_run_cycles(ctx, 1000) >= 1000);
+    CHECK(fceux_midframe(ctx));
+    CHECK(!fceux_rewind_push(rw, ctx));
+    CHECK(fceux_rewind_count(rw) == 1);
+
+    fceux_rewind_destroy(rw);
+}
+
+} // anonymous namespace
+
+int main() {
+    write_rom("rewind.nes", 4);
+
+    // 上限が十分なもの、キーフレームごとのもの、古いものが捨てられるもの
+    for(const Case& c : { Case { 64 << 20, 16, false }, Case { 64 << 20, 1, false }, Case { 24 << 10, 8, true } }) {
+        FceuxContext* ctx = fceux_create("rewind.nes");
+        CHECK(ctx);
+        run(ctx, c);
+        fceux_destroy(ctx);
+    }
+
+    std::puts("rewind_round_trip: ok");
+    return EXIT_SUCCESS;
+}
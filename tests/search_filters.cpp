@@ -0,0 +1,170 @@
+// RAM サーチの絞り込みを、全アドレスを 1 つずつ調べる素朴な実装と比べる。
+// 内蔵 RAM と WRAM に小さな値をランダムに書いては実行してサンプルを集め、ランダムな条件の組で
+// fceux_search_filter() を繰り返したときの候補が素朴な実装と一致することを確かめる。
+// 相関による絞り込みは、ラベルを量子化せずに求めた相関係数と誤差の範囲で一致することを確かめる。
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int SAMPLES = 24;
+constexpr int ROUNDS = 400;
+// 量子化したラベルによる相関係数の誤差の許容値
+constexpr double R_TOLERANCE = 2e-3;
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+std::uint16_t index_addr(std::size_t i) {
+    return static_cast<std::uint16_t>(i < 0x800 ? i : 0x6000 + (i - 0x800));
+}
+
+bool holds(const FceuxSearchPredicate& p, const std::vector<std::vector<std::uint8_t>>& rows, std::size_t i) {
+    const std::uint8_t v = rows[p.sample][i];
+    const std::uint8_t b = rows[p.baseline][i];
+    switch(p.op) {
+    case FCEUX_SEARCH_EQUAL: return v == b;
+    case FCEUX_SEARCH_NOT_EQUAL: return v != b;
+    case FCEUX_SEARCH_GREATER: return v > b;
+    case FCEUX_SEARCH_LESS: return v < b;
+    case FCEUX_SEARCH_CHANGED_BY: return static_cast<std::uint8_t>(v - b) == static_cast<std::uint8_t>(p.k);
+    case FCEUX_SEARCH_VALUE: return v == static_cast<std::uint8_t>(p.k);
+    }
+    return false;
+}
+
+// 候補の CPU アドレス
+std::vector<std::uint16_t> results(RamSearch* search) {
+    std::vector<std::uint16_t> addrs(fceux_search_count(search));
+    CHECK(fceux_search_results(search, addrs.data(), addrs.size()) == addrs.size());
+    return addrs;
+}
+
+std::vector<std::uint16_t> reference(const std::vector<bool>& alive) {
+    std::vector<std::uint16_t> addrs;
+    for(std::size_t i = 0; i < alive.size(); ++i)
+        if(alive[i]) addrs.push_back(index_addr(i));
+    return addrs;
+}
+
+double pearson(const std::vector<std::vector<std::uint8_t>>& rows, const std::vector<double>& labels, std::size_t i) {
+    const std::size_t n = rows.size();
+    double mv = 0.0, ml = 0.0;
+    for(std::size_t s = 0; s < n; ++s) {
+        mv += rows[s][i];
+        ml += labels[s];
+    }
+    mv /= n;
+    ml /= n;
+    double cov = 0.0, vv = 0.0, vl = 0.0;
+    for(std::size_t s = 0; s < n; ++s) {
+        cov += (rows[s][i] - mv) * (labels[s] - ml);
+        vv += (rows[s][i] - mv) * (rows[s][i] - mv);
+        vl += (labels[s] - ml) * (labels[s] - ml);
+    }
+    return vv == 0.0 || vl == 0.0 ? 0.0 : cov / std::sqrt(vv * vl);
+}
+
+} // anonymous namespace
+
+int main() {
+    write_rom("search.nes", 4);
+
+    FceuxContext* ctx = fceux_create("search.nes");
+    CHECK(ctx);
+    RamSearch* search = fceux_search_create();
+    CHECK(search);
+
+    // 小さな値を書いて、条件が成り立つアドレスが適度に残るようにする
+    Rng rng { 1 };
+    std::vector<std::vector<std::uint8_t>> rows;
+    std::vector<double> labels;
+    for(int s = 0; s < SAMPLES; ++s) {
+        const std::uint16_t in = static_cast<std::uint16_t>(rng(0x10000));
+        CHECK(fceux_run_frames(ctx, &in, 1 + rng(3), nullptr) >= 1);
+        std::vector<std::uint8_t> buf(0x800 + 0x2000);
+        for(auto& v : buf) v = static_cast<std::uint8_t>(rng(4));
+        CHECK(fceux_mem_write_range(ctx, FCEUX_MEMORY_RAM, 0x100, buf.data() + 0x100, 0x700) == 0x700);
+        CHECK(fceux_mem_write_range(ctx, FCEUX_MEMORY_PRG_RAM, 0, buf.data() + 0x800, 0x2000) == 0x2000);
+
+        CHECK(fceux_search_add(search, ctx));
+        const std::uint8_t* row = fceux_search_sample(search, s);
+        rows.emplace_back(row, row + FCEUX_SEARCH_WIDTH);
+        labels.push_back(rng(1000) / 7.0);
+    }
+    CHECK(fceux_search_sample_count(search) == SAMPLES);
+
+    std::vector<bool> alive(FCEUX_SEARCH_WIDTH, true);
+    CHECK(results(search) == reference(alive));
+
+    for(int round = 0; round < ROUNDS; ++round) {
+        // 候補が少なくなったら戻す
+        if(fceux_search_count(search) < 32 || rng(16) == 0) {
+            fceux_search_reset(search);
+            std::fill(alive.begin(), alive.end(), true);
+        }
+
+        std::vector<FceuxSearchPredicate> preds(1 + rng(3));
+        for(auto& p : preds) {
+            p.op = static_cast<FceuxSearchOp>(rng(6));
+            p.sample = rng(SAMPLES);
+            p.baseline = rng(SAMPLES);
+            p.k = static_cast<std::int32_t>(rng(7)) - 3;
+        }
+        CHECK(fceux_search_filter(search, preds.data(), preds.size()));
+        for(std::size_t i = 0; i < alive.size(); ++i)
+            alive[i] = alive[i] && std::all_of(preds.begin(), preds.end(), [&](const FceuxSearchPredicate& p) { return holds(p, rows, i); });
+
+        if(results(search) != reference(alive)) {
+            std::fprintf(stderr, "round %d: the candidates differ from the reference\n", round);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // 存在しないサンプルや不明な op を含む組は何もしない
+    const std::size_t count = fceux_search_count(search);
+    FceuxSearchPredicate bad[2] = { { FCEUX_SEARCH_EQUAL, 0, 1, 0 }, { FCEUX_SEARCH_EQUAL, SAMPLES, 0, 0 } };
+    CHECK(!fceux_search_filter(search, bad, 2));
+    bad[1] = FceuxSearchPredicate { static_cast<FceuxSearchOp>(99), 0, 0, 0 };
+    CHECK(!fceux_search_filter(search, bad, 2));
+    CHECK(fceux_search_count(search) == count);
+
+    // 相関: 全アドレスの相関係数と、閾値による絞り込み
+    fceux_search_reset(search);
+    std::vector<float> r(FCEUX_SEARCH_WIDTH);
+    const double min_abs_r = 0.3;
+    CHECK(fceux_search_correlate(search, labels.data(), min_abs_r, r.data()));
+    std::vector<std::uint16_t> kept = results(search);
+    for(std::size_t i = 0; i < FCEUX_SEARCH_WIDTH; ++i) {
+        const double expected = pearson(rows, labels, i);
+        if(std::fabs(r[i] - expected) > R_TOLERANCE) {
+            std::fprintf(stderr, "$%04X: r = %f, expected %f\n", index_addr(i), r[i], expected);
+            return EXIT_FAILURE;
+        }
+        // 閾値の近くは量子化の誤差でどちらにもなりうる
+        if(std::fabs(std::fabs(expected) - min_abs_r) <= R_TOLERANCE) continue;
+        const bool in = std::binary_search(kept.begin(), kept.end(), index_addr(i));
+        CHECK(in == (std::fabs(expected) >= min_abs_r));
+    }
+
+    fceux_search_destroy(search);
+    fceux_destroy(ctx);
+
+    std::puts("search_filters: ok");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+// fceux_snapshot_serialize() の形式のバッファを検査する。
+// FCSX 形式とフラット形式のスナップショットを直列化し、そのままロードしたものが元と一致することと、
+// ヘッダを壊したものはロードも fceux_snapshot_deserialize() も失敗し、コンテキストとスナップショットが変わらないことを確かめる。
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+// 直列化の外側のヘッダの大きさ。状態はこの後に続く
+constexpr std::size_t SERIAL_HEADER_SIZE = 64;
+
+std::vector<std::uint8_t> serialize(Snapshot* snap) {
+    std::vector<std::uint8_t> buf(fceux_snapshot_serialize(snap, nullptr, 0));
+    CHECK(fceux_snapshot_serialize(snap, buf.data(), buf.size()) == buf.size());
+    return buf;
+}
+
+void put32(std::vector<std::uint8_t>& buf, std::size_t pos, std::uint32_t value) {
+    for(int i = 0; i < 4; ++i) buf[pos + i] = static_cast<std::uint8_t>(value >> (8 * i));
+}
+
+// blob を壊したものがロードできず、ctx と snap を変えないことを確かめる
+void check_rejected(FceuxContext* ctx, Snapshot* snap, const std::vector<std::uint8_t>& blob, const char* what) {
+    const std::uint64_t hash = fceux_state_hash(ctx, 0);
+    const std::vector<std::uint8_t> before = serialize(snap);
+
+    if(fceux_snapshot_load_serialized(ctx, blob.data(), blob.size()) || fceux_snapshot_deserialize(snap, blob.data(), blob.size())) {
+        std::fprintf(stderr, "%s: accepted\n", what);
+        std::exit(EXIT_FAILURE);
+    }
+    CHECK(fceux_state_hash(ctx, 0) == hash);
+    CHECK(serialize(snap) == before);
+}
+
+} // anonymous namespace
+
+int main() {
+    write_rom("serialized.nes", 4);
+
+    FceuxContext* ctx = fceux_create("serialized.nes");
+    CHECK(ctx);
+    for(int i = 0; i < 30; ++i) {
+        const std::uint16_t in = static_cast<std::uint16_t>(i * 37);
+        CHECK(fceux_run_frames(ctx, &in, 1, nullptr) == 1);
+    }
+
+    Snapshot* fcsx = fceux_snapshot_create();
+    Snapshot* flat = fceux_snapshot_create();
+    CHECK(fceux_snapshot_save(ctx, fcsx));
+    CHECK(fceux_snapshot_save_ex(ctx, flat, FCEUX_SNAPSHOT_FLAT));
+    const std::uint64_t hash = fceux_state_hash(ctx, 0);
+
+    // そのままなら往復できる
+    for(Snapshot* snap : { fcsx, flat }) {
+        const std::vector<std::uint8_t> blob = serialize(snap);
+        const std::uint16_t in = 0;
+        CHECK(fceux_run_frames(ctx, &in, 1, nullptr) == 1);
+        CHECK(fceux_snapshot_load_serialized(ctx, blob.data(), blob.size()));
+        CHECK(fceux_state_hash(ctx, 0) == hash);
+
+        Snapshot* copy = fceux_snapshot_create();
+        CHECK(fceux_snapshot_deserialize(copy, blob.data(), blob.size()));
+        CHECK(serialize(copy) == blob);
+        fceux_snapshot_destroy(copy);
+    }
+
+    // FCSX 形式の状態のヘッダ: "FCSX", 全体の大きさ, バージョン, 圧縮後の大きさ (非圧縮なら -1)
+    const std::vector<std::uint8_t> blob = serialize(fcsx);
+    const std::size_t inner = SERIAL_HEADER_SIZE;
+    {
+        std::vector<std::uint8_t> b = blob;
+        b[inner] = 'X';
+        check_rejected(ctx, fcsx, b, "bad FCSX magic");
+    }
+    for(std::uint32_t total : { 0xFFFFFFF0u, 0x7FFFFFFFu, 0u, static_cast<std::uint32_t>(blob.size() - inner - 16 + 1) }) {
+        std::vector<std::uint8_t> b = blob;
+        put32(b, inner + 4, total);
+        check_rejected(ctx, fcsx, b, "bad FCSX total size");
+    }
+    for(std::uint32_t comprlen : { 0x7FFFFFF0u, 0u, 1u }) {
+        std::vector<std::uint8_t> b = blob;
+        put32(b, inner + 12, comprlen);
+        check_rejected(ctx, fcsx, b, "bad FCSX compressed size");
+    }
+    {
+        // 状態が FCSX のヘッダより短い
+        std::vector<std::uint8_t> b(blob.begin(), blob.begin() + inner + 8);
+        put32(b, 12, 8);
+        check_rejected(ctx, fcsx, b, "truncated FCSX header");
+    }
+    {
+        std::vector<std::uint8_t> b(blob.begin(), blob.end() - 1);
+        check_rejected(ctx, fcsx, b, "truncated buffer");
+    }
+
+    // フラット形式も、ヘッダの大きさが状態と合わなければ失敗する
+    {
+        std::vector<std::uint8_t> b = serialize(flat);
+        put32(b, inner + 4, 0xFFFFFFF0u);
+        check_rejected(ctx, flat, b, "bad flat size");
+    }
+
+    fceux_snapshot_destroy(fcsx);
+    fceux_snapshot_destroy(flat);
+    fceux_destroy(ctx);
+
+    std::puts("serialized_snapshots: ok");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+// 描画の省略 (skip_video) とアイドルループの早送り (fceux_idle_skip()) と、PRG の読み出し関数の省略
+// (fceux_prg_direct()) がエミュレーション結果を変えないことを確かめる。
+// 同じ ROM と入力を、省略の有無を変えた 5 つのコンテキストで並べて実行し、
+// フレームごとに RAM, CPU レジスタ, CPU サイクル数, (描画したフレームの) 映像を比較する。
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+// 以下の組み合わせで実行する
+struct Variant {
+    const char* name;
+    bool skip_video;
+    bool idle_skip;
+    bool prg_direct;
+};
+constexpr Variant VARIANTS[] = {
+    { "plain", false, false, true },
+    { "skip_video", true, false, true },
+    { "idle_skip", false, true, true },
+    { "both", true, true, true },
+    { "no_prg_direct", false, false, false },
+};
+constexpr int FRAMES = 600;
+// skip_video でもこの間隔で描画させ、映像を比較する
+constexpr int RENDER_INTERVAL = 8;
+
+std::uint16_t input(int frame) {
+    // 数フレームごとに変わる入力
+    const int i = frame / 5;
+    return static_cast<std::uint16_t>((i * 37) ^ (i >> 3));
+}
+
+void run(const char* path, int mapper) {
+    write_rom(path, mapper);
+
+    constexpr int N = sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+    FceuxContext* ctxs[N];
+    for(int v = 0; v < N; ++v) {
+        CHECK(ctxs[v] = fceux_create(path));
+        fceux_idle_skip(ctxs[v], VARIANTS[v].idle_skip);
+        fceux_prg_direct(ctxs[v], VARIANTS[v].prg_direct);
+    }
+
+    std::vector<std::uint8_t> video[N];
+    bool hit = false;
+    for(int i = 0; i < FRAMES; ++i) {
+        const std::uint16_t in = input(i);
+        const bool render = (i + 1) % RENDER_INTERVAL == 0;
+        for(int v = 0; v < N; ++v) {
+            video[v].assign(256 * 240, 0);
+            FceuxFrameResult out {};
+            out.output = FCEUX_FRAME_OUTPUT_LAST;
+            out.video = video[v].data();
+            out.skip_video = VARIANTS[v].skip_video && !render;
+            CHECK(fceux_run_frames(ctxs[v], &in, 1, &out) == 1);
+        }
+
+        const Cpu cpu0 = cpu(ctxs[0]);
+        const auto ram0 = memory(ctxs[0], FCEUX_MEMORY_RAM);
+        const auto wram0 = memory(ctxs[0], FCEUX_MEMORY_PRG_RAM);
+        for(int v = 1; v < N; ++v) {
+            const bool ok_cpu = cpu(ctxs[v]) == cpu0;
+            const bool ok_ram = memory(ctxs[v], FCEUX_MEMORY_RAM) == ram0 && memory(ctxs[v], FCEUX_MEMORY_PRG_RAM) == wram0;
+            const bool ok_video = (VARIANTS[v].skip_video && !render) || video[v] == video[0];
+            if(!(ok_cpu && ok_ram && ok_video)) {
+                std::fprintf(stderr, "mapper %d, frame %d: %s differs from plain (cpu %d, ram %d, video %d)\n",
+                    mapper, i, VARIANTS[v].name, ok_cpu, ok_ram, ok_video);
+                std::exit(1);
+            }
+        }
+        hit |= ram0[0x14] != 0;
+    }
+
+    // 比較したものが実際に省略を通っていること
+    CHECK(hit);
+    for(int v = 0; v < N; ++v)
+        CHECK((fceux_idle_skipped_cycles(ctxs[v]) > 0) == VARIANTS[v].idle_skip);
+
+    std::printf("mapper %d: %d frames, %llu idle cycles skipped\n", mapper, FRAMES,
+        static_cast<unsigned long long>(fceux_idle_skipped_cycles(ctxs[2])));
+
+    for(FceuxContext* ctx : ctxs) fceux_destroy(ctx);
+    std::remove(path);
+}
+
+} // anonymous namespace
+
+int main() {
+    run("skip_equivalence_nrom.nes", 0);
+    run("skip_equivalence_mmc3.nes", 4);
+    return 0;
+}
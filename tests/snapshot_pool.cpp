@@ -0,0 +1,124 @@
+// スナップショットのプールを検査する。
+// - 確保と破棄を繰り返しながらフラット形式・差分・フレーム途中の状態を保存し、残っているものが
+//   保存した時点の状態にロードできること (破棄した親を持つ差分も含む)
+// - release_all() で破棄したものは、同じ領域が再び確保された後もロードできず、サイズは 0 で、
+//   fceux_snapshot_destroy() に渡しても新しく確保したものに影響しないこと
+// - 二重の破棄と fceux_snapshot_destroy(NULL) は何もしないこと
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "fceux.h"
+#include "test_rom.hpp"
+
+namespace {
+
+constexpr int ROUNDS = 400;
+
+struct Rng {
+    std::uint32_t state;
+
+    std::uint32_t operator()(std::uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 8) % n;
+    }
+};
+
+FceuxSnapshotPoolStats stats(SnapshotPool* pool) {
+    FceuxSnapshotPoolStats s;
+    fceux_snapshot_pool_stats(pool, &s);
+    return s;
+}
+
+struct Saved {
+    Snapshot* snap;
+    std::uint64_t hash;
+};
+
+} // anonymous namespace
+
+int main() {
+    write_rom("pool.nes", 4);
+
+    // NULL はプールのものと同様に何もしない
+    fceux_snapshot_destroy(nullptr);
+
+    FceuxContext* ctx = fceux_create("pool.nes");
+    FceuxContext* check = fceux_create("pool.nes");
+    CHECK(ctx && check);
+    SnapshotPool* pool = fceux_snapshot_pool_create(ctx, FCEUX_SNAPSHOT_FLAT, 8);
+    CHECK(pool);
+    CHECK(stats(pool).state_size > 0);
+
+    Rng rng { 1 };
+    std::vector<Saved> live;
+    for(int i = 0; i < ROUNDS; ++i) {
+        const std::uint16_t in = static_cast<std::uint16_t>(rng(0x10000));
+        CHECK(fceux_run_frames(ctx, &in, 1, nullptr) == 1);
+        if(i % 7 == 3) {
+            CHECK(fceux_run_cycles(ctx, 1000 + rng(20000)) > 0);
+            CHECK(fceux_midframe(ctx));
+        }
+
+        Snapshot* snap = fceux_snapshot_pool_alloc(pool);
+        CHECK(snap);
+        if(!live.empty() && i % 5 == 1 && !fceux_midframe(ctx))
+            CHECK(fceux_snapshot_save_delta(ctx, snap, live.back().snap, 0));
+        else
+            CHECK(fceux_snapshot_save_ex(ctx, snap, FCEUX_SNAPSHOT_FLAT));
+        live.push_back(Saved { snap, fceux_state_hash(ctx, 0) });
+
+        // 差分の親になったものも破棄してよい
+        if(live.size() > 16 && rng(2) == 0) {
+            const std::size_t k = rng(static_cast<std::uint32_t>(live.size()));
+            fceux_snapshot_destroy(live[k].snap);
+            live.erase(live.begin() + k);
+        }
+    }
+    for(const Saved& s : live) {
+        CHECK(fceux_snapshot_load(check, s.snap));
+        CHECK(fceux_state_hash(check, 0) == s.hash);
+    }
+    const FceuxSnapshotPoolStats used = stats(pool);
+    CHECK(used.in_use == live.size());
+    CHECK(used.capacity >= used.in_use && used.peak_in_use >= used.in_use);
+
+    // 破棄したものは、同じ領域が再び確保された後も使えない
+    Snapshot* a = fceux_snapshot_pool_alloc(pool);
+    CHECK(fceux_snapshot_save_ex(ctx, a, FCEUX_SNAPSHOT_FLAT));
+    const std::uint64_t hash = fceux_state_hash(ctx, 0);
+    fceux_snapshot_pool_release_all(pool);
+    CHECK(stats(pool).in_use == 0);
+    std::vector<Snapshot*> again;
+    for(std::size_t i = 0; i < used.capacity + 1; ++i) {
+        again.push_back(fceux_snapshot_pool_alloc(pool));
+        CHECK(fceux_snapshot_save_ex(ctx, again.back(), FCEUX_SNAPSHOT_FLAT));
+    }
+    CHECK(!fceux_snapshot_load(check, a));
+    CHECK(fceux_snapshot_size(a) == 0);
+    CHECK(!fceux_snapshot_load(check, live.front().snap));
+    fceux_snapshot_destroy(a);
+    for(const Saved& s : live) fceux_snapshot_destroy(s.snap);
+    CHECK(stats(pool).in_use == again.size());
+    for(Snapshot* s : again) {
+        CHECK(fceux_snapshot_load(check, s));
+        CHECK(fceux_state_hash(check, 0) == hash);
+    }
+
+    // 二重に破棄しても何も起こらない
+    fceux_snapshot_destroy(again.back());
+    fceux_snapshot_destroy(again.back());
+    CHECK(stats(pool).in_use == again.size() - 1);
+    fceux_snapshot_destroy(nullptr);
+    CHECK(stats(pool).in_use == again.size() - 1);
+
+    fceux_snapshot_pool_destroy(pool);
+    fceux_destroy(check);
+    fceux_destroy(ctx);
+
+    std::puts("snapshot_pool: ok");
+    return EXIT_SUCCESS;
+}
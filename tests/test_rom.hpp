@@ -0,0 +1,186 @@
+#pragma once
+
+// テスト用 ROM の生成と、テスト間で共通の比較用の関数。
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fceux.h"
+
+#define CHECK(cond) \
+    do { \
+        if(!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1); \
+        } \
+    } while(0)
+
+// テスト用 ROM を組み立てる最小限のアセンブラ。コードは $E000 から置く。
+class Asm {
+public:
+    void b(std::initializer_list<int> xs) { for(int x : xs) code_.push_back(static_cast<std::uint8_t>(x)); }
+    void abs(int op, int addr) { b({ op, addr & 0xFF, addr >> 8 }); }
+    void label(const std::string& name) { labels_[name] = 0xE000 + static_cast<int>(code_.size()); }
+    void branch(int op, const std::string& name) { b({ op, 0 }); fixups_.push_back({ code_.size() - 1, name, true }); }
+    void jmp(const std::string& name) { b({ 0x4C, 0, 0 }); fixups_.push_back({ code_.size() - 2, name, false }); }
+
+    int at(const std::string& name) const { return labels_.at(name); }
+
+    std::vector<std::uint8_t> link() const {
+        std::vector<std::uint8_t> code = code_;
+        for(const auto& f : fixups_) {
+            const int target = labels_.at(f.name);
+            if(f.rel) {
+                const int d = target - (0xE000 + static_cast<int>(f.pos) + 1);
+                CHECK(-128 <= d && d < 128);
+                code[f.pos] = static_cast<std::uint8_t>(d);
+            }
+            else {
+                code[f.pos] = static_cast<std::uint8_t>(target);
+                code[f.pos + 1] = static_cast<std::uint8_t>(target >> 8);
+            }
+        }
+        return code;
+    }
+
+private:
+    struct Fixup {
+        std::size_t pos;
+        std::string name;
+        bool rel;
+    };
+
+    std::vector<std::uint8_t> code_;
+    std::map<std::string, int> labels_;
+    std::vector<Fixup> fixups_;
+};
+
+// NROM (mapper 0) か MMC3 (mapper 4) の ROM を作る。
+// メインループは NMI が $12 を進めるのを待つアイドルループで、その後に入力を読み、
+// スプライト 0 ヒットを数える。APU のフレーム IRQ と DMC を動かし、MMC3 ではスキャンライン IRQ で
+// フレーム途中にスクロールを変える。
+inline std::vector<std::uint8_t> make_rom(int mapper) {
+    Asm a;
+    a.label("reset");
+    a.b({ 0x78, 0xD8, 0xA2, 0xFF, 0x9A }); // sei cld ldx #$ff txs
+    a.b({ 0xA9, 0x40 }); a.abs(0x8D, 0x4017);
+    a.b({ 0xA9, 0x00 }); a.abs(0x8D, 0x2000); a.abs(0x8D, 0x2001);
+    a.label("w1"); a.abs(0x2C, 0x2002); a.branch(0x10, "w1");
+    a.label("w2"); a.abs(0x2C, 0x2002); a.branch(0x10, "w2");
+    // パレット
+    a.b({ 0xA9, 0x3F }); a.abs(0x8D, 0x2006); a.b({ 0xA9, 0x00 }); a.abs(0x8D, 0x2006);
+    a.b({ 0xA2, 0x00 });
+    a.label("pal"); a.b({ 0x8A, 0x29, 0x3F }); a.abs(0x8D, 0x2007); a.b({ 0xE8, 0xE0, 0x20 }); a.branch(0xD0, "pal");
+    // ネームテーブル: タイル 0 と 1 を交互に
+    a.b({ 0xA9, 0x20 }); a.abs(0x8D, 0x2006); a.b({ 0xA9, 0x00 }); a.abs(0x8D, 0x2006);
+    a.b({ 0xA0, 0x04, 0xA2, 0x00 });
+    a.label("nt"); a.b({ 0x8A, 0x29, 0x01 }); a.abs(0x8D, 0x2007); a.b({ 0xCA }); a.branch(0xD0, "nt"); a.b({ 0x88 }); a.branch(0xD0, "nt");
+    // $0200 の OAM: スプライト 0 は y=40, x=41, タイル 1
+    a.b({ 0xA2, 0x00 });
+    a.label("oam"); a.b({ 0x8A, 0x9D, 0x00, 0x02, 0xE8 }); a.branch(0xD0, "oam");
+    a.b({ 0xA9, 40, 0x8D, 0x00, 0x02, 0xA9, 1, 0x8D, 0x01, 0x02, 0xA9, 0, 0x8D, 0x02, 0x02, 0xA9, 41, 0x8D, 0x03, 0x02 });
+    // APU: 矩形波、DMC (ループ、IRQ あり)、フレーム IRQ
+    a.b({ 0xA9, 0xBF }); a.abs(0x8D, 0x4000); a.b({ 0xA9, 0x40 }); a.abs(0x8D, 0x4002); a.b({ 0xA9, 0x08 }); a.abs(0x8D, 0x4003);
+    a.b({ 0xA9, 0x4F }); a.abs(0x8D, 0x4010); a.b({ 0xA9, 0x00 }); a.abs(0x8D, 0x4012); a.b({ 0xA9, 0x04 }); a.abs(0x8D, 0x4013);
+    a.b({ 0xA9, 0x1F }); a.abs(0x8D, 0x4015); a.b({ 0xA9, 0x00 }); a.abs(0x8D, 0x4017);
+    if(mapper == 4) {
+        a.b({ 0xA9, 0x80 }); a.abs(0x8D, 0xA001);
+        a.b({ 0xA9, 60 }); a.abs(0x8D, 0xC000); a.abs(0x8D, 0xC001); a.abs(0x8D, 0xE001);
+    }
+    a.b({ 0x58 }); // cli
+    a.b({ 0xA9, 0x00 }); a.abs(0x8D, 0x2005); a.abs(0x8D, 0x2005);
+    a.b({ 0xA9, 0x80 }); a.abs(0x8D, 0x2000);
+    a.b({ 0xA9, 0x1E }); a.abs(0x8D, 0x2001);
+
+    a.label("main");
+    a.b({ 0xA5, 0x12 }); a.label("wait"); a.b({ 0xC5, 0x12 }); a.branch(0xF0, "wait");
+    // 入力を $10 に読む
+    a.b({ 0xA9, 1 }); a.abs(0x8D, 0x4016); a.b({ 0xA9, 0 }); a.abs(0x8D, 0x4016);
+    a.b({ 0xA2, 8 });
+    a.label("joy"); a.abs(0xAD, 0x4016); a.b({ 0x4A, 0x26, 0x10, 0xCA }); a.branch(0xD0, "joy");
+    // スプライト 0 ヒットが立っていれば $14 を増やす
+    a.abs(0x2C, 0x2002); a.branch(0x50, "nohit"); a.b({ 0xE6, 0x14 });
+    a.label("nohit");
+    a.b({ 0xE6, 0x11, 0xA5, 0x10, 0x65, 0x11, 0x85, 0x15 }); // inc $11; $15 = $10 + $11
+    a.b({ 0xA5, 0x11 }); a.abs(0x8D, 0x6000);
+    a.jmp("main");
+
+    a.label("nmi");
+    a.b({ 0x48, 0xE6, 0x12 });
+    a.b({ 0xA9, 0x00 }); a.abs(0x8D, 0x2003); a.b({ 0xA9, 0x02 }); a.abs(0x8D, 0x4014);
+    a.b({ 0xA5, 0x10, 0x29, 0x03 }); a.abs(0x8D, 0x2005); a.b({ 0xA9, 0 }); a.abs(0x8D, 0x2005);
+    a.b({ 0x68, 0x40 });
+
+    a.label("irq");
+    a.b({ 0x48, 0xE6, 0x13 });
+    a.abs(0xAD, 0x4015);
+    if(mapper == 4) {
+        a.abs(0x8D, 0xE000); a.abs(0x8D, 0xE001);
+        a.b({ 0xA5, 0x11 }); a.abs(0x8D, 0x2006); a.abs(0x8D, 0x2006);
+    }
+    a.b({ 0x68, 0x40 });
+
+    const std::vector<std::uint8_t> code = a.link();
+    std::vector<std::uint8_t> prg(0x8000, 0xEA);
+    std::copy(code.begin(), code.end(), prg.begin() + 0x6000);
+    for(const auto& v : { std::make_pair(0xFFFA, "nmi"), std::make_pair(0xFFFC, "reset"), std::make_pair(0xFFFE, "irq") }) {
+        prg[v.first - 0x8000] = static_cast<std::uint8_t>(a.at(v.second));
+        prg[v.first - 0x8000 + 1] = static_cast<std::uint8_t>(a.at(v.second) >> 8);
+    }
+    // MMC3 はどのバンクが $E000 に来ても同じコードになるようにする
+    if(mapper != 0)
+        for(int i = 0; i < 3; ++i) std::copy(prg.begin() + 0x6000, prg.end(), prg.begin() + 0x2000 * i);
+
+    std::vector<std::uint8_t> chr(0x2000, 0);
+    std::memset(chr.data() + 16, 0xFF, 16); // タイル 1 は塗りつぶし
+
+    // 最終的なサイズで確保してから書き込む (16 Byte の vector に insert すると GCC 12 が -Warray-bounds を誤検出する)
+    const std::uint8_t header[16] = { 0x4E, 0x45, 0x53, 0x1A, 2, 1,
+        static_cast<std::uint8_t>(((mapper & 0xF) << 4) | 0x02), static_cast<std::uint8_t>(mapper & 0xF0) };
+    std::vector<std::uint8_t> rom(sizeof(header) + prg.size() + chr.size());
+    std::copy(std::begin(header), std::end(header), rom.begin());
+    std::copy(prg.begin(), prg.end(), rom.begin() + sizeof(header));
+    std::copy(chr.begin(), chr.end(), rom.begin() + sizeof(header) + prg.size());
+    return rom;
+}
+
+// make_rom() の ROM をファイルに書き出す
+inline void write_rom(const char* path, int mapper) {
+    const std::vector<std::uint8_t> rom = make_rom(mapper);
+    std::FILE* fp = std::fopen(path, "wb");
+    CHECK(fp);
+    CHECK(std::fwrite(rom.data(), 1, rom.size(), fp) == rom.size());
+    std::fclose(fp);
+}
+
+struct Cpu {
+    std::uint16_t pc;
+    std::uint8_t a, x, y, s, p;
+    std::uint64_t cycles;
+
+    bool operator==(const Cpu& o) const {
+        return pc == o.pc && a == o.a && x == o.x && y == o.y && s == o.s && p == o.p && cycles == o.cycles;
+    }
+};
+
+inline Cpu cpu(FceuxContext* ctx) {
+    FceuxCpuRegs r;
+    fceux_cpu_regs(ctx, &r);
+    return Cpu { r.pc, r.a, r.x, r.y, r.s, r.p, r.cycles };
+}
+
+inline std::vector<std::uint8_t> memory(FceuxContext* ctx, FceuxMemoryDomain domain) {
+    std::size_t size = 0;
+    const std::uint8_t* p = fceux_mem_domain_view(ctx, domain, &size);
+    CHECK(p);
+    return std::vector<std::uint8_t>(p, p + size);
+}